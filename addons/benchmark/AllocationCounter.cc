@@ -0,0 +1,53 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+
+static bool allocation_counting_enabled = false;
+static unsigned long allocation_count = 0;
+
+#if defined(__GLIBC__)
+extern "C" {
+  void *__libc_malloc (size_t size);
+  void *__libc_calloc (size_t count, size_t size);
+  void *__libc_realloc (void *ptr, size_t size);
+
+  void *malloc (size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_malloc (size);
+  }
+
+  void *calloc (size_t count, size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_calloc (count, size);
+  }
+
+  void *realloc (void *ptr, size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_realloc (ptr, size);
+  }
+}
+
+bool allocation_counter_supported () {
+  return true;
+}
+#else
+bool allocation_counter_supported () {
+  return false;
+}
+#endif
+
+void allocation_counter_start () {
+  allocation_count = 0;
+  allocation_counting_enabled = true;
+}
+
+unsigned long allocation_counter_stop () {
+  allocation_counting_enabled = false;
+  return allocation_count;
+}
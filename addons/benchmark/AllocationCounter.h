@@ -0,0 +1,19 @@
+#ifndef _ALLOCATION_COUNTER_H
+#define _ALLOCATION_COUNTER_H
+
+/** Returns whether heap allocations can be counted on this system.
+ *
+ * Counting is implemented by replacing malloc(), calloc(), and realloc()
+ * of the benchmark executable which is only supported on glibc based
+ * systems.
+ */
+bool allocation_counter_supported ();
+
+/// Resets the number of counted allocations and starts counting.
+void allocation_counter_start ();
+
+/// Stops counting and returns the number of allocations since the last
+/// call to allocation_counter_start().
+unsigned long allocation_counter_stop ();
+
+#endif
@@ -0,0 +1,103 @@
+#include "PerfCounters.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const unsigned long long counter_configs[PerfCounters::CounterLast] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static int open_counter (unsigned long long config) {
+  struct perf_event_attr attr;
+  memset (&attr, 0, sizeof (attr));
+  attr.size = sizeof (attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return static_cast<int>(syscall (__NR_perf_event_open, &attr, 0, -1, -1,
+        0));
+}
+#endif
+
+PerfCounters::PerfCounters() {
+  for (int i = 0; i < CounterLast; i++) {
+    fds[i] = -1;
+    values[i] = 0;
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  close();
+}
+
+bool PerfCounters::open () {
+  bool result = false;
+
+#if defined(__linux__)
+  for (int i = 0; i < CounterLast; i++) {
+    fds[i] = open_counter (counter_configs[i]);
+    result = result || fds[i] >= 0;
+  }
+#endif
+
+  return result;
+}
+
+void PerfCounters::close () {
+  for (int i = 0; i < CounterLast; i++) {
+#if defined(__linux__)
+    if (fds[i] >= 0) {
+      ::close (fds[i]);
+    }
+#endif
+    fds[i] = -1;
+  }
+}
+
+void PerfCounters::start () {
+#if defined(__linux__)
+  for (int i = 0; i < CounterLast; i++) {
+    if (fds[i] >= 0) {
+      ioctl (fds[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl (fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+}
+
+void PerfCounters::stop () {
+  for (int i = 0; i < CounterLast; i++) {
+    values[i] = 0;
+#if defined(__linux__)
+    if (fds[i] >= 0) {
+      ioctl (fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      if (read (fds[i], &values[i], sizeof (values[i]))
+          != sizeof (values[i])) {
+        values[i] = 0;
+      }
+    }
+#endif
+  }
+}
+
+const char* PerfCounters::name (CounterId id) {
+  switch (id) {
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case CacheMisses: return "cache_misses";
+    case BranchMisses: return "branch_misses";
+    default: break;
+  }
+  return "unknown";
+}
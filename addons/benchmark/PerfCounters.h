@@ -0,0 +1,43 @@
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+/** Hardware performance counters of the calling thread.
+ *
+ * The counters are read using perf_event_open() and are therefore only
+ * available on Linux. Depending on the value of
+ * /proc/sys/kernel/perf_event_paranoid or in virtual machines some or all
+ * counters may not be available in which case they are reported as
+ * unavailable instead of failing the benchmark.
+ */
+struct PerfCounters {
+  enum CounterId {
+    Cycles = 0,
+    Instructions,
+    CacheMisses,
+    BranchMisses,
+    CounterLast
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+
+  /// Opens the counters and returns whether at least one is available.
+  bool open ();
+  void close ();
+
+  /// Resets and enables all available counters.
+  void start ();
+  /// Disables all counters and stores their values in values.
+  void stop ();
+
+  bool available (CounterId id) const {
+    return fds[id] >= 0;
+  }
+
+  static const char* name (CounterId id);
+
+  int fds[CounterLast];
+  unsigned long long values[CounterLast];
+};
+
+#endif
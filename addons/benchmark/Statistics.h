@@ -0,0 +1,100 @@
+#ifndef _STATISTICS_H
+#define _STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "rbdl/rbdl_math.h"
+
+/** Summary of the durations of a single benchmark run.
+ *
+ * min, p50, p99, and max are computed from all samples. sum, mean, and
+ * stddev exclude outliers, i.e. samples that are larger than the third
+ * quartile by more than three times the interquartile range. Such samples
+ * are usually caused by preemption or interrupts and would otherwise
+ * dominate the mean.
+ */
+struct SampleStatistics {
+  SampleStatistics() :
+    count (0), outlier_count (0),
+    sum (0.), mean (0.), stddev (0.),
+    min (0.), p50 (0.), p99 (0.), max (0.)
+  {}
+
+  /// number of samples used for sum, mean, and stddev
+  unsigned int count;
+  /// number of samples that were rejected as outliers
+  unsigned int outlier_count;
+
+  double sum;
+  double mean;
+  double stddev;
+
+  double min;
+  double p50;
+  double p99;
+  double max;
+};
+
+/** Returns the value at the given percentile (0 - 100) of sorted values
+ * using linear interpolation between the closest ranks. */
+inline double percentile (const std::vector<double> &sorted_values,
+    double p) {
+  if (sorted_values.size() == 0) {
+    return 0.;
+  }
+
+  double rank = p / 100. * (sorted_values.size() - 1);
+  size_t lower = static_cast<size_t>(std::floor (rank));
+  size_t upper = static_cast<size_t>(std::ceil (rank));
+  double weight = rank - lower;
+
+  return sorted_values[lower] * (1. - weight) + sorted_values[upper] * weight;
+}
+
+inline SampleStatistics compute_statistics (
+    const RigidBodyDynamics::Math::VectorNd &durations) {
+  SampleStatistics result;
+
+  if (durations.size() == 0) {
+    return result;
+  }
+
+  std::vector<double> sorted (durations.data(),
+      durations.data() + durations.size());
+  std::sort (sorted.begin(), sorted.end());
+
+  result.min = sorted.front();
+  result.p50 = percentile (sorted, 50.);
+  result.p99 = percentile (sorted, 99.);
+  result.max = sorted.back();
+
+  double q1 = percentile (sorted, 25.);
+  double q3 = percentile (sorted, 75.);
+  double upper_fence = q3 + 3. * (q3 - q1);
+
+  for (size_t i = 0; i < sorted.size(); i++) {
+    if (sorted[i] > upper_fence) {
+      result.outlier_count++;
+      continue;
+    }
+    result.count++;
+    result.sum += sorted[i];
+  }
+
+  result.mean = result.sum / result.count;
+
+  double squared_error_sum = 0.;
+  for (size_t i = 0; i < result.count; i++) {
+    squared_error_sum += (sorted[i] - result.mean) * (sorted[i] - result.mean);
+  }
+
+  if (result.count > 1) {
+    result.stddev = std::sqrt (squared_error_sum / (result.count - 1));
+  }
+
+  return result;
+}
+
+#endif
@@ -1,29 +1,53 @@
 #ifndef _TIMER_H
 #define _TIMER_H
 
-#include <ctime>
+#include <chrono>
+
+/// Monotonic clock with the highest available resolution that is used for
+/// all measurements. Unlike clock() it measures wall time and is not
+/// affected by adjustments of the system time.
+typedef std::chrono::steady_clock TimerClock;
 
 struct TimerInfo {
   /// time stamp when timer_start() gets called
-  clock_t clock_start_value;
+  TimerClock::time_point clock_start_value;
 
   /// time stamp when the timer was stopped
-  clock_t clock_end_value;
+  TimerClock::time_point clock_end_value;
 
   /// duration between clock_start_value and clock_end_value in seconds
   double duration_sec;
 };
 
 inline void timer_start (TimerInfo *timer) {
-  timer->clock_start_value = clock();
+  timer->clock_start_value = TimerClock::now();
 }
 
 inline double timer_stop (TimerInfo *timer) {
-  timer->clock_end_value = clock();
+  timer->clock_end_value = TimerClock::now();
 
-  timer->duration_sec = static_cast<double>(timer->clock_end_value - timer->clock_start_value) * 1 / CLOCKS_PER_SEC;
+  timer->duration_sec = std::chrono::duration<double>(
+      timer->clock_end_value - timer->clock_start_value).count();
 
   return timer->duration_sec;
 }
 
+/** Estimates the time in seconds that a timer_start() / timer_stop() pair
+ * takes by itself. This is subtracted from the measured durations as it is
+ * not negligible for the fast algorithms on small models. */
+inline double timer_calibrate_overhead (int sample_count = 1000) {
+  TimerInfo tinfo;
+  double overhead = timer_stop (&tinfo);
+
+  for (int i = 0; i < sample_count; i++) {
+    timer_start (&tinfo);
+    double duration = timer_stop (&tinfo);
+    if (i == 0 || duration < overhead) {
+      overhead = duration;
+    }
+  }
+
+  return overhead;
+}
+
 #endif
@@ -13,6 +13,9 @@
 #include "Human36Model.h"
 #include "SampleData.h"
 #include "Timer.h"
+#include "Statistics.h"
+#include "AllocationCounter.h"
+#include "PerfCounters.h"
 
 #ifdef RBDL_BUILD_ADDON_LUAMODEL
 #include "../addons/luamodel/luamodel.h"
@@ -35,6 +38,9 @@ using namespace RigidBodyDynamics::Math;
 
 int benchmark_sample_count = 1000;
 int benchmark_model_max_depth = 5;
+int benchmark_warmup_count = 100;
+int benchmark_repetitions = 1;
+bool benchmark_perf_counters = false;
 
 bool benchmark_run_fd_aba = true;
 bool benchmark_run_fd_lagrangian = true;
@@ -49,6 +55,10 @@ bool json_output = false;
 
 string model_name;
 
+/// duration of a timer_start() / timer_stop() pair that gets subtracted
+/// from all measurements
+double timer_overhead = 0.;
+
 enum ContactsMethod {
     ConstraintsMethodDirect = 0,
     ConstraintsMethodRangeSpaceSparse,
@@ -66,6 +76,12 @@ struct BenchmarkRun {
     double avg;
     double min;
     double max;
+
+    SampleStatistics statistics;
+    double allocations_per_call;
+    bool have_perf_counters;
+    double perf_counters_per_call[PerfCounters::CounterLast];
+    bool perf_counter_available[PerfCounters::CounterLast];
 };
 
 vector<BenchmarkRun> benchmark_runs;
@@ -76,42 +92,150 @@ void report_section (const char* section_name) {
   }
 }
 
-void register_run(const Model &model, const SampleData &data, const char *run_name) {
+void register_run(const Model &model, const SampleData &data,
+    const char *run_name, unsigned long allocation_count,
+    const PerfCounters *perf_counters) {
   BenchmarkRun run;
   run.benchmark = run_name;
   run.model_name = model_name;
   run.model_dof = model.dof_count;
-  run.sample_count = data.count;
+  run.sample_count = data.durations.size();
+  run.statistics = compute_statistics (data.durations);
 
   run.duration = data.durations.sum();
-  run.avg = data.durations.mean();
-  run.min = data.durations.minCoeff();
-  run.max = data.durations.maxCoeff();
+  run.avg = run.statistics.mean;
+  run.min = run.statistics.min;
+  run.max = run.statistics.max;
+
+  run.allocations_per_call = static_cast<double>(allocation_count)
+    / run.sample_count;
+
+  run.have_perf_counters = perf_counters != NULL;
+  for (int i = 0; i < PerfCounters::CounterLast; i++) {
+    run.perf_counter_available[i] = perf_counters != NULL
+      && perf_counters->available (static_cast<PerfCounters::CounterId>(i));
+    run.perf_counters_per_call[i] = run.perf_counter_available[i]
+      ? static_cast<double>(perf_counters->values[i]) / run.sample_count : 0.;
+  }
 
   benchmark_runs.push_back(run);
 }
 
+void print_run_statistics (const BenchmarkRun &run) {
+  const SampleStatistics &stats = run.statistics;
+
+  cout << " duration = " << setw(10) << run.duration << "(s)"
+       << " (~" << setw(8) << stats.mean * 1.0e9 << "(ns) per call)"
+       << " p50 = " << setw(8) << stats.p50 * 1.0e9 << "(ns)"
+       << " p99 = " << setw(8) << stats.p99 * 1.0e9 << "(ns)"
+       << " max = " << setw(8) << stats.max * 1.0e9 << "(ns)";
+
+  if (stats.outlier_count > 0) {
+    cout << " outliers = " << stats.outlier_count;
+  }
+
+  if (allocation_counter_supported()) {
+    cout << " allocs/call = " << run.allocations_per_call;
+  }
+
+  if (run.have_perf_counters) {
+    for (int i = 0; i < PerfCounters::CounterLast; i++) {
+      if (run.perf_counter_available[i]) {
+        cout << " " << PerfCounters::name (static_cast<PerfCounters::CounterId>(i))
+             << "/call = " << run.perf_counters_per_call[i];
+      }
+    }
+  }
+
+  cout << endl;
+}
+
 void report_run(const Model &model, const SampleData &data,
-        const char *run_name) {
-  register_run(model, data, run_name);
+        const char *run_name, unsigned long allocation_count,
+        const PerfCounters *perf_counters) {
+  register_run(model, data, run_name, allocation_count, perf_counters);
 
   if (!json_output) {
     cout << "#DOF: " << setw(3) << model.dof_count
-         << " #samples: " << data.count
-         << " duration = " << setw(10) << data.durations.sum() << "(s)"
-         << " (~" << setw(10) << data.durations.mean() << "(s) per call)" << endl;
+         << " #samples: " << data.durations.size();
+    print_run_statistics (benchmark_runs.back());
   }
 }
 
 void report_constraints_run(const Model &model, const SampleData &data,
-        const char *run_name) {
-  register_run(model, data, run_name);
+        const char *run_name, unsigned long allocation_count,
+        const PerfCounters *perf_counters) {
+  register_run(model, data, run_name, allocation_count, perf_counters);
 
   if (!json_output) {
-    cout << model_name << ": "
-         << " duration = " << setw(10) << data.durations.sum() << "(s)"
-         << " (~" << setw(10) << data.durations.mean() << "(s) per call)" << endl;
+    cout << model_name << ": ";
+    print_run_statistics (benchmark_runs.back());
+  }
+}
+
+/** Measures fn (i) for all samples i of sample_data.
+ *
+ * Before the measurement fn is evaluated benchmark_warmup_count times such
+ * that caches are warm and lazily allocated workspaces exist. Afterwards
+ * every sample is evaluated benchmark_repetitions times and each call is
+ * timed individually. The durations are stored in sample_data.durations.
+ */
+template <typename Function>
+void measure_samples (SampleData &sample_data, Function fn,
+    unsigned long &allocation_count, PerfCounters &perf_counters) {
+  for (int i = 0; i < benchmark_warmup_count; i++) {
+    fn (i % sample_data.count);
   }
+
+  int sample_count = sample_data.count;
+  sample_data.durations = VectorNd::Zero (sample_count * benchmark_repetitions);
+
+  if (benchmark_perf_counters) {
+    perf_counters.open();
+  }
+
+  TimerInfo tinfo;
+
+  allocation_counter_start();
+  perf_counters.start();
+
+  for (int r = 0; r < benchmark_repetitions; r++) {
+    for (int i = 0; i < sample_count; i++) {
+      timer_start (&tinfo);
+      fn (i);
+      sample_data.durations[r * sample_count + i] =
+        std::max (timer_stop (&tinfo) - timer_overhead, 0.);
+    }
+  }
+
+  perf_counters.stop();
+  allocation_count = allocation_counter_stop();
+}
+
+template <typename Function>
+double run_benchmark (const Model &model, SampleData &sample_data,
+    const char *run_name, Function fn) {
+  unsigned long allocation_count = 0;
+  PerfCounters perf_counters;
+
+  measure_samples (sample_data, fn, allocation_count, perf_counters);
+  report_run (model, sample_data, run_name, allocation_count,
+      benchmark_perf_counters ? &perf_counters : NULL);
+
+  return benchmark_runs.back().duration;
+}
+
+template <typename Function>
+double run_constraints_benchmark (const Model &model, SampleData &sample_data,
+    const char *run_name, Function fn) {
+  unsigned long allocation_count = 0;
+  PerfCounters perf_counters;
+
+  measure_samples (sample_data, fn, allocation_count, perf_counters);
+  report_constraints_run (model, sample_data, run_name, allocation_count,
+      benchmark_perf_counters ? &perf_counters : NULL);
+
+  return benchmark_runs.back().duration;
 }
 
 /** Parses /proc/cpuinfo for the CPU model name. */
@@ -150,73 +274,52 @@ double run_forward_dynamics_ABA_benchmark (Model *model, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamics (*model,
-        sample_data.q[i],
-        sample_data.qdot[i],
-        sample_data.tau[i],
-        sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_run(*model, sample_data, "ForwardDynamics");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data, "ForwardDynamics",
+      [&] (int i) {
+        ForwardDynamics (*model,
+            sample_data.q[i],
+            sample_data.qdot[i],
+            sample_data.tau[i],
+            sample_data.qddot[i]);
+      });
 }
 
 double run_forward_dynamics_lagrangian_benchmark (Model *model, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
   MatrixNd H (MatrixNd::Zero(model->dof_count, model->dof_count));
   VectorNd C (VectorNd::Zero(model->dof_count));
 
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamicsLagrangian (*model,
-        sample_data.q[i],
-        sample_data.qdot[i],
-        sample_data.tau[i],
-        sample_data.qddot[i],
-        Math::LinearSolverPartialPivLU,
-        NULL,
-        &H,
-        &C
-        );
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_run(*model, sample_data, "ForwardDynamicsLagrangian_PivLU");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data,
+      "ForwardDynamicsLagrangian_PivLU",
+      [&] (int i) {
+        ForwardDynamicsLagrangian (*model,
+            sample_data.q[i],
+            sample_data.qdot[i],
+            sample_data.tau[i],
+            sample_data.qddot[i],
+            Math::LinearSolverPartialPivLU,
+            NULL,
+            &H,
+            &C
+            );
+      });
 }
 
 double run_inverse_dynamics_RNEA_benchmark (Model *model, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-  timer_start (&tinfo);
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    InverseDynamics (*model,
-        sample_data.q[i],
-        sample_data.qdot[i],
-        sample_data.qddot[i],
-        sample_data.tau[i]
-        );
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_run(*model, sample_data, "InverseDynamics");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data, "InverseDynamics",
+      [&] (int i) {
+        InverseDynamics (*model,
+            sample_data.q[i],
+            sample_data.qdot[i],
+            sample_data.qddot[i],
+            sample_data.tau[i]
+            );
+      });
 }
 
 double run_CRBA_benchmark (Model *model, int sample_count) {
@@ -224,146 +327,104 @@ double run_CRBA_benchmark (Model *model, int sample_count) {
   sample_data.fillRandom(model->dof_count, sample_count);
 
   Math::MatrixNd H = Math::MatrixNd::Zero(model->dof_count, model->dof_count);
-  Math::MatrixNd identity = Math::MatrixNd::Identity(model->dof_count, model->dof_count);
-  Math::MatrixNd Hinv = Math::MatrixNd::Zero(model->dof_count, model->dof_count);
-
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    CompositeRigidBodyAlgorithm (*model, sample_data.q[i], H, true);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
 
-  report_run(*model, sample_data, "CompositeRigidBodyAlgorithm");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data, "CompositeRigidBodyAlgorithm",
+      [&] (int i) {
+        CompositeRigidBodyAlgorithm (*model, sample_data.q[i], H, true);
+      });
 }
 
 double run_nle_benchmark (Model *model, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    NonlinearEffects (*model,
-        sample_data.q[i],
-        sample_data.qdot[i],
-        sample_data.tau[i]
-        );
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_run(*model, sample_data, "NonlinearEffects");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data, "NonlinearEffects",
+      [&] (int i) {
+        NonlinearEffects (*model,
+            sample_data.q[i],
+            sample_data.qdot[i],
+            sample_data.tau[i]
+            );
+      });
 }
 
 double run_calc_minv_times_tau_benchmark (Model *model, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  CalcMInvTimesTau (*model, sample_data.q[0], sample_data.tau[0], sample_data.qddot[0]);
-
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    CalcMInvTimesTau (*model, sample_data.q[i], sample_data.tau[i], sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_run(*model, sample_data, "NonlinearEffects");
-
-  return sample_data.durations.sum();
+  return run_benchmark (*model, sample_data, "CalcMInvTimesTau",
+      [&] (int i) {
+        CalcMInvTimesTau (*model, sample_data.q[i], sample_data.tau[i],
+            sample_data.qddot[i]);
+      });
 }
 
 double run_inverse_dynamics_constraints_benchmark (Model *model, ConstraintSet *constraint_set, std::vector<bool> &dofActuated, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
   VectorNd qddot = VectorNd::Zero(model->dof_count);
-  TimerInfo tinfo;
-  timer_start (&tinfo);
 
   constraint_set->SetActuationMap(*model, dofActuated);
 
-  for (int i = 0; i < sample_count; i++) {
-    InverseDynamicsConstraintsRelaxed (*model, sample_data.q[i], sample_data.qdot[i], sample_data.qddot[i], *constraint_set, qddot, sample_data.tau[i]); 
-  }
-
-  double duration = timer_stop (&tinfo);
-
-  return duration;
+  return run_constraints_benchmark (*model, sample_data,
+      "InverseDynamicsConstraintsRelaxed",
+      [&] (int i) {
+        InverseDynamicsConstraintsRelaxed (*model, sample_data.q[i],
+            sample_data.qdot[i], sample_data.qddot[i], *constraint_set, qddot,
+            sample_data.tau[i]);
+      });
 }
 
 double run_contacts_lagrangian_benchmark (Model *model, ConstraintSet *constraint_set, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamicsConstraintsDirect (*model, sample_data.q[i], sample_data.qdot[i], sample_data.tau[i], *constraint_set, sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_constraints_run(*model, sample_data, "ForwardDynamicsConstraintsDirect");
-
-  return sample_data.durations.sum();
+  return run_constraints_benchmark (*model, sample_data,
+      "ForwardDynamicsConstraintsDirect",
+      [&] (int i) {
+        ForwardDynamicsConstraintsDirect (*model, sample_data.q[i],
+            sample_data.qdot[i], sample_data.tau[i], *constraint_set,
+            sample_data.qddot[i]);
+      });
 }
 
 double run_contacts_lagrangian_sparse_benchmark (Model *model, ConstraintSet *constraint_set, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamicsConstraintsRangeSpaceSparse (*model, sample_data.q[i], sample_data.qdot[i], sample_data.tau[i], *constraint_set, sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_constraints_run(*model, sample_data, "ForwardDynamicsConstraintsRangeSpaceSparse");
-
-  return sample_data.durations.sum();
+  return run_constraints_benchmark (*model, sample_data,
+      "ForwardDynamicsConstraintsRangeSpaceSparse",
+      [&] (int i) {
+        ForwardDynamicsConstraintsRangeSpaceSparse (*model, sample_data.q[i],
+            sample_data.qdot[i], sample_data.tau[i], *constraint_set,
+            sample_data.qddot[i]);
+      });
 }
 
 double run_contacts_null_space (Model *model, ConstraintSet *constraint_set, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamicsConstraintsNullSpace (*model, sample_data.q[i], sample_data.qdot[i], sample_data.tau[i], *constraint_set, sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_constraints_run(*model, sample_data, "ForwardDynamicsConstraintsNullSpace");
-
-  return sample_data.durations.sum();
+  return run_constraints_benchmark (*model, sample_data,
+      "ForwardDynamicsConstraintsNullSpace",
+      [&] (int i) {
+        ForwardDynamicsConstraintsNullSpace (*model, sample_data.q[i],
+            sample_data.qdot[i], sample_data.tau[i], *constraint_set,
+            sample_data.qddot[i]);
+      });
 }
 
 double run_contacts_kokkevis_benchmark (Model *model, ConstraintSet *constraint_set, int sample_count) {
   SampleData sample_data;
   sample_data.fillRandom(model->dof_count, sample_count);
 
-  TimerInfo tinfo;
-
-  for (int i = 0; i < sample_count; i++) {
-    timer_start (&tinfo);
-    ForwardDynamicsContactsKokkevis(*model, sample_data.q[i], sample_data.qdot[i], sample_data.tau[i], *constraint_set, sample_data.qddot[i]);
-    sample_data.durations[i] = timer_stop (&tinfo);
-  }
-
-  report_constraints_run(*model, sample_data, "ForwardDynamicsContactsKokkevis");
-
-  return sample_data.durations.sum();
+  return run_constraints_benchmark (*model, sample_data,
+      "ForwardDynamicsContactsKokkevis",
+      [&] (int i) {
+        ForwardDynamicsContactsKokkevis (*model, sample_data.q[i],
+            sample_data.qdot[i], sample_data.tau[i], *constraint_set,
+            sample_data.qddot[i]);
+      });
 }
 
 void contacts_benchmark (int sample_count, ContactsMethod contacts_method) {
@@ -548,21 +609,30 @@ void contacts_benchmark (int sample_count, ContactsMethod contacts_method) {
 }
 
 double run_single_inverse_kinematics_benchmark(Model *model, std::vector<InverseKinematicsConstraintSet> &CS, int sample_count){
-  TimerInfo tinfo;
-  timer_start (&tinfo);
+  SampleData sample_data;
+  sample_data.fillRandom(model->dof_count, sample_count);
+
   VectorNd qinit = VectorNd::Zero(model->dof_count);
   VectorNd qres = VectorNd::Zero(model->dof_count);
-  VectorNd failures = VectorNd::Zero(model->dof_count);
+  int failure_count = 0;
 
-  for (int i = 0; i < sample_count; i++) {
-    if (!InverseKinematics(*model, qinit, CS[i], qres)){
-      failures[i] = 1;
-    }
+  double duration = run_constraints_benchmark (*model, sample_data,
+      "InverseKinematics",
+      [&] (int i) {
+        if (!InverseKinematics(*model, qinit, CS[i], qres)) {
+          failure_count++;
+        }
+      });
+
+  if (!json_output) {
+    int call_count = sample_count * benchmark_repetitions
+      + benchmark_warmup_count;
+    std::cout << "  Success Rate: "
+      << (1. - static_cast<double>(failure_count) / call_count) * 100 << "%"
+      << std::endl;
   }
-  double duration = timer_stop (&tinfo);
-  std::cout << "Success Rate: " << (1-failures.mean())*100 << "%  for: ";
+
   return duration;
-  
 }
 
 double run_all_inverse_kinematics_benchmark (int sample_count){
@@ -650,34 +720,29 @@ double run_all_inverse_kinematics_benchmark (int sample_count){
     cs_five_full.push_back(five_full);
   }
   
-  cout << "= #DOF: " << setw(3) << model->dof_count << endl;
-  cout << "= #samples: " << sample_count << endl;
+  if (!json_output) {
+    cout << "= #DOF: " << setw(3) << model->dof_count << endl;
+    cout << "= #samples: " << sample_count << endl;
+  }
   double duration;
-  
+
+  model_name = "Human36_1Bodies1Points";
   duration = run_single_inverse_kinematics_benchmark(model, cs_one_point, sample_count);
-  cout << "Constraints: 1 Body:   1 Point                      : "
-  << " duration = " << setw(10) << duration << "(s)"
-  << " (~" << setw(10) << duration / sample_count << "(s) per call)" << endl;
-  
+
+  model_name = "Human36_3Bodies2Points1Orientation";
   duration = run_single_inverse_kinematics_benchmark(model, cs_two_point_one_orientation, sample_count);
-  cout << "Constraints: 3 Bodies: 2 Points 1 Orienation        : "
-  << " duration = " << setw(10) << duration << "(s)"
-  << " (~" << setw(10) << duration / sample_count << "(s) per call)" << endl;
-  
+
+  model_name = "Human36_3Bodies2Full1Point";
   duration = run_single_inverse_kinematics_benchmark(model, cs_two_full_one_point, sample_count);
-  cout << "Constraints: 3 Bodies: 2 Full 1 Point               : "
-  << " duration = " << setw(10) << duration << "(s)"
-  << " (~" << setw(10) << duration / sample_count << "(s) per call)" << endl;
-  
-  duration = run_single_inverse_kinematics_benchmark(model, cs_two_full_two_point_one_orientation, sample_count);  
-  cout << "Constraints: 5 Bodies: 2 Full 2 Points 1 Orienation : "
-  << " duration = " << setw(10) << duration << "(s)"
-  << " (~" << setw(10) << duration / sample_count << "(s) per call)" << endl;
-  
-  duration = run_single_inverse_kinematics_benchmark(model, cs_five_full, sample_count);  
-  cout << "Constraints: 5 Bodies: 5 Full                       : "
-  << " duration = " << setw(10) << duration << "(s)"
-  << " (~" << setw(10) << duration / sample_count << "(s) per call)" << endl;
+
+  model_name = "Human36_5Bodies2Full2Points1Orientation";
+  duration = run_single_inverse_kinematics_benchmark(model, cs_two_full_two_point_one_orientation, sample_count);
+
+  model_name = "Human36_5Bodies5Full";
+  duration = run_single_inverse_kinematics_benchmark(model, cs_five_full, sample_count);
+
+  delete model;
+
   return duration;
 }
 
@@ -695,7 +760,14 @@ void print_usage () {
 #if defined RBDL_BUILD_ADDON_URDFREADER
   cout << "  --floating-base | -f        : the specified URDF model is a floating base model." << endl;
 #endif
-  cout << "  --json                      : prints output in json format." << endl;
+  cout << "  --warmup | -w <count>       : number of calls before the measurement starts" << endl;
+  cout << "                (default: 100)." << endl;
+  cout << "  --repetitions | -r <count>  : number of times each sample state gets" << endl;
+  cout << "                evaluated (default: 1)." << endl;
+  cout << "  --perf                      : also reports hardware counters per call (requires" << endl;
+  cout << "                perf_event_open(), i.e. Linux)." << endl;
+  cout << "  --json                      : prints output in json format. Use" << endl;
+  cout << "                compare_benchmarks.py to compare two such outputs." << endl;
   cout << "  --no-fd                     : disables benchmarking of forward dynamics." << endl;
   cout << "  --no-fd-aba                 : disables benchmark for forwards dynamics using" << endl;
   cout << "                                the Articulated Body Algorithm" << endl;
@@ -721,6 +793,7 @@ void disable_all_benchmarks () {
   benchmark_run_nle = false;
   benchmark_run_calc_minv_times_tau = false;
   benchmark_run_contacts = false;
+  benchmark_run_ik = false;
 }
 
 void parse_args (int argc, char* argv[]) {
@@ -760,6 +833,32 @@ void parse_args (int argc, char* argv[]) {
     } else if (arg == "--floating-base" || arg == "-f") {
       urdf_floating_base = true;
 #endif
+    } else if (arg == "--warmup" || arg == "-w" ) {
+      if (argi == argc - 1) {
+        print_usage();
+
+        cerr << "Error: missing number of warmup calls!" << endl;
+        exit (1);
+      }
+
+      argi++;
+      stringstream warmup_stream (argv[argi]);
+
+      warmup_stream >> benchmark_warmup_count;
+    } else if (arg == "--repetitions" || arg == "-r" ) {
+      if (argi == argc - 1) {
+        print_usage();
+
+        cerr << "Error: missing number of repetitions!" << endl;
+        exit (1);
+      }
+
+      argi++;
+      stringstream repetitions_stream (argv[argi]);
+
+      repetitions_stream >> benchmark_repetitions;
+    } else if (arg == "--perf") {
+      benchmark_perf_counters = true;
     } else if (arg == "--json") {
       json_output = true;
     } else if (arg == "--no-fd" ) {
@@ -796,9 +895,17 @@ void parse_args (int argc, char* argv[]) {
   }
 }
 
+void set_planar_model_name (int depth) {
+  ostringstream model_name_stream;
+  model_name_stream << "planar_model_depth_" << depth;
+  model_name = model_name_stream.str();
+}
+
 int main (int argc, char *argv[]) {
   parse_args (argc, argv);
 
+  timer_overhead = timer_calibrate_overhead();
+
   Model *model = NULL;
 
   model = new Model();
@@ -859,9 +966,7 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_fd_aba) {
     report_section("Forward Dynamics: ABA");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
-      ostringstream model_name_stream;
-      model_name_stream << "planar_model_depth_" << depth;
-      model_name = model_name_stream.str();
+      set_planar_model_name (depth);
 
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
@@ -877,6 +982,8 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_fd_lagrangian) {
     report_section("Forward Dynamics: Lagrangian (Piv. LU decomposition)");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
+      set_planar_model_name (depth);
+
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
 
@@ -891,6 +998,8 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_id_rnea) {
     report_section("Inverse Dynamics: RNEA");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
+      set_planar_model_name (depth);
+
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
 
@@ -905,6 +1014,8 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_crba) {
     report_section("Joint Space Inertia Matrix: CRBA");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
+      set_planar_model_name (depth);
+
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
 
@@ -919,6 +1030,8 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_nle) {
     report_section("Nonlinear Effects");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
+      set_planar_model_name (depth);
+
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
 
@@ -933,6 +1046,8 @@ int main (int argc, char *argv[]) {
   if (benchmark_run_calc_minv_times_tau) {
     report_section("CalcMInvTimesTau");
     for (int depth = 1; depth <= benchmark_model_max_depth; depth++) {
+      set_planar_model_name (depth);
+
       model = new Model();
       model->gravity = Vector3d (0., -9.81, 0.);
 
@@ -990,13 +1105,16 @@ int main (int argc, char *argv[]) {
 
     cout << "    \"host_info\" : {" << endl;
     cout << "        \"cpu_model_name\" : \"" << get_cpu_model_name() << "\"," << endl;
-    cout << "        \"time_utc\" : " << "\"" << get_utc_time_string() << "\"" << endl;
+    cout << "        \"time_utc\" : " << "\"" << get_utc_time_string() << "\"," << endl;
+    cout << "        \"timer_overhead\" : " << timer_overhead << "," << endl;
+    cout << "        \"warmup_count\" : " << benchmark_warmup_count << "," << endl;
+    cout << "        \"repetitions\" : " << benchmark_repetitions << endl;
     cout << "    }," << endl;
 
     cout << "    \"runs\" : ";
     cout << "[" << endl;
 
-    for (int i; i < benchmark_runs.size(); i++) {
+    for (size_t i = 0; i < benchmark_runs.size(); i++) {
       const BenchmarkRun& run = benchmark_runs[i];
 
       const char* indent = "            ";
@@ -1009,7 +1127,31 @@ int main (int argc, char *argv[]) {
       cout << indent << "\"sample_count\" : " << run.sample_count << "," << endl;
       cout << indent << "\"avg\" : " << run.avg << "," << endl;
       cout << indent << "\"min\" : " << run.min << "," << endl;
-      cout << indent << "\"max\" : " << run.max << endl;
+      cout << indent << "\"max\" : " << run.max << "," << endl;
+      cout << indent << "\"stddev\" : " << run.statistics.stddev << "," << endl;
+      cout << indent << "\"p50\" : " << run.statistics.p50 << "," << endl;
+      cout << indent << "\"p99\" : " << run.statistics.p99 << "," << endl;
+      cout << indent << "\"outliers\" : " << run.statistics.outlier_count << "," << endl;
+      cout << indent << "\"ns_per_call\" : " << run.statistics.mean * 1.0e9 << "," << endl;
+
+      if (allocation_counter_supported()) {
+        cout << indent << "\"allocations_per_call\" : " << run.allocations_per_call << "," << endl;
+      } else {
+        cout << indent << "\"allocations_per_call\" : null," << endl;
+      }
+
+      cout << indent << "\"perf_counters_per_call\" : {";
+      bool first_counter = true;
+      for (int ci = 0; ci < PerfCounters::CounterLast; ci++) {
+        if (!run.perf_counter_available[ci]) {
+          continue;
+        }
+        cout << (first_counter ? " " : ", ") << "\""
+          << PerfCounters::name (static_cast<PerfCounters::CounterId>(ci))
+          << "\" : " << run.perf_counters_per_call[ci];
+        first_counter = false;
+      }
+      cout << (first_counter ? "}" : " }") << endl;
       cout << "        " << "}";
 
       if (i != benchmark_runs.size() - 1) {
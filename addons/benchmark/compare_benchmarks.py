@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+"""
+Compares two outputs of 'benchmark --json' and flags regressions.
+
+Runs are matched by their model and benchmark name. A run is reported as a
+regression if the chosen metric (default: the median p50) of the current
+output is slower than the baseline by more than the given threshold, or if
+it performs more heap allocations per call. The exit code is 1 if at least
+one regression was found which allows to use the script in automated
+checks.
+
+Usage: compare_benchmarks.py [--metric p50|p99|avg|min] [--threshold <percent>]
+                             <baseline.json> <current.json>
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_runs(filename):
+    with open(filename) as json_file:
+        data = json.load(json_file)
+
+    runs = {}
+    for run in data["runs"]:
+        runs[(run["model"], run["benchmark"])] = run
+    return runs
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compares two json outputs of the RBDL benchmark.")
+    parser.add_argument("baseline", help="json output of the reference run")
+    parser.add_argument("current", help="json output of the run to check")
+    parser.add_argument("--metric", default="p50",
+                        choices=["p50", "p99", "avg", "min"],
+                        help="duration statistic that is compared")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="relative slowdown in percent that is reported "
+                        "as regression (default: 5)")
+    args = parser.parse_args()
+
+    baseline = load_runs(args.baseline)
+    current = load_runs(args.current)
+
+    print("%-42s %-44s %12s %12s %9s" % ("model", "benchmark",
+          "base (ns)", "curr (ns)", "change"))
+
+    regression_count = 0
+    for key in sorted(current.keys()):
+        if key not in baseline:
+            print("%-42s %-44s %12s %12.1f %9s" % (key[0], key[1], "-",
+                  current[key][args.metric] * 1.0e9, "new"))
+            continue
+
+        base_value = baseline[key][args.metric]
+        curr_value = current[key][args.metric]
+        change = 0.
+        if base_value > 0.:
+            change = (curr_value - base_value) / base_value * 100.
+
+        flags = []
+        is_regression = False
+        if change > args.threshold:
+            flags.append("REGRESSION")
+            is_regression = True
+        elif change < -args.threshold:
+            flags.append("improved")
+
+        base_allocs = baseline[key].get("allocations_per_call")
+        curr_allocs = current[key].get("allocations_per_call")
+        if base_allocs is not None and curr_allocs is not None \
+                and curr_allocs > base_allocs:
+            flags.append("ALLOCATIONS %g -> %g" % (base_allocs, curr_allocs))
+            is_regression = True
+
+        if is_regression:
+            regression_count += 1
+
+        print("%-42s %-44s %12.1f %12.1f %+8.1f%% %s" % (key[0], key[1],
+              base_value * 1.0e9, curr_value * 1.0e9, change,
+              " ".join(flags)))
+
+    for key in sorted(baseline.keys()):
+        if key not in current:
+            print("%-42s %-44s %12.1f %12s %9s" % (key[0], key[1],
+                  baseline[key][args.metric] * 1.0e9, "-", "missing"))
+
+    if regression_count > 0:
+        print("\n%d regression(s) found." % regression_count)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
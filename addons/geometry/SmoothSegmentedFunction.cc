@@ -39,6 +39,7 @@
 #include "SmoothSegmentedFunction.h"
 #include <fstream>
 #include <ostream>
+#include <algorithm>
 #include <rbdl/rbdl_errors.h>
 
 //=============================================================================
@@ -51,10 +52,12 @@ using namespace RigidBodyDynamics::Addons::Geometry;
 
 static bool     DEBUG     = false;
 static double   UTOL      = std::numeric_limits<double>::epsilon()*1e6;
+static double   UTOL_DESIRED = std::numeric_limits<double>::epsilon()*1e2;
 static double   INTTOL    = std::numeric_limits<double>::epsilon()*1e2;
 static double   SQRTEPS   = std::sqrt(numeric_limits<double>::epsilon());
 static int      MAXITER   = 20;
 static int      NUM_SAMPLE_PTS  = 100;
+static int      NUM_U_TABLE_INTERVALS = 32;
 //=============================================================================
 // UTILITY FUNCTIONS
 //=============================================================================
@@ -126,6 +129,7 @@ SmoothSegmentedFunction(
     _mXVec[s] = mX.col(s);
     _mYVec[s] = mY.col(s);
   }
+  updateLookupTable();
 }
 
 //==============================================================================
@@ -139,6 +143,7 @@ SmoothSegmentedFunction::SmoothSegmentedFunction():
   _mYVec.resize(0);
   //_splineYintX = SimTK::Spline();
   _numBezierSections = (int)NAN;
+  _lookupTableIsValid = false;
 }
 
 //==============================================================================
@@ -183,6 +188,7 @@ updSmoothSegmentedFunction(
   }
 
   _name = name;
+  updateLookupTable();
 }
 //==============================================================================
 void SmoothSegmentedFunction::shift(double xShift, double yShift)
@@ -198,6 +204,7 @@ void SmoothSegmentedFunction::shift(double xShift, double yShift)
       _mYVec.at(i)[j] += yShift;
     }
   }
+  updateLookupTable();
 
 }
 
@@ -230,10 +237,143 @@ void SmoothSegmentedFunction::scale(double xScale, double yScale)
       _mYVec.at(i)[j] *= yScale;
     }
   }
+  updateLookupTable();
 
 }
 
 
+//==============================================================================
+/*
+  x(u) and dx/du of every Bezier section are sampled at NUM_U_TABLE_INTERVALS+1
+  uniformly spaced values of u. Since x(u) is monotonic within a section the
+  table can be searched with a binary search and interpolated to get an
+  initial value for u(x) that is within a few ulps of the solution after one
+  or two Newton steps: the bisection and the search for the extent of the
+  section that SegmentedQuinticBezierToolkit::calcU performs on every call are
+  no longer needed. If the curve is not monotonically increasing in x (which
+  is only the case after a scale with a negative xScale) the table is marked
+  as invalid and the toolkit functions are used instead.
+*/
+void SmoothSegmentedFunction::updateLookupTable()
+{
+  int n = NUM_U_TABLE_INTERVALS+1;
+
+  _xSectionStart.resize(_numBezierSections);
+  _uTableX.resize(_numBezierSections*n);
+  _uTableDxDu.resize(_numBezierSections*n);
+  _lookupTableIsValid = _numBezierSections > 0;
+
+  for(int s=0; s < _numBezierSections; ++s) {
+    _xSectionStart[s] = _mXVec[s][0];
+    if(s > 0 && _xSectionStart[s] < _xSectionStart[s-1]) {
+      _lookupTableIsValid = false;
+    }
+
+    for(int k=0; k < n; ++k) {
+      double u = double(k)/double(NUM_U_TABLE_INTERVALS);
+      _uTableX[s*n+k] = SegmentedQuinticBezierToolkit::
+                        calcQuinticBezierCurveVal(u,_mXVec[s]);
+      _uTableDxDu[s*n+k] = SegmentedQuinticBezierToolkit::
+                           calcQuinticBezierCurveDerivU(u,_mXVec[s],1);
+      if(k > 0 && !(_uTableX[s*n+k] > _uTableX[s*n+k-1])) {
+        _lookupTableIsValid = false;
+      }
+    }
+  }
+}
+
+//==============================================================================
+int SmoothSegmentedFunction::calcIndex(double x) const
+{
+  if(!_lookupTableIsValid) {
+    return SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
+  }
+
+  int idx = int(std::upper_bound(_xSectionStart.begin(),
+                                 _xSectionStart.end(), x)
+                - _xSectionStart.begin()) - 1;
+  return std::max(0, std::min(idx, _numBezierSections-1));
+}
+
+//==============================================================================
+int SmoothSegmentedFunction::calcIndex(double x, int idxGuess) const
+{
+  if(_lookupTableIsValid && x >= _xSectionStart[idxGuess]
+      && (idxGuess == _numBezierSections-1
+          || x < _xSectionStart[idxGuess+1])) {
+    return idxGuess;
+  }
+  return calcIndex(x);
+}
+
+//==============================================================================
+double SmoothSegmentedFunction::calcU(double x, int idx) const
+{
+  if(!_lookupTableIsValid) {
+    return SegmentedQuinticBezierToolkit::calcU(x,_mXVec[idx],UTOL,MAXITER);
+  }
+
+  int n = NUM_U_TABLE_INTERVALS+1;
+  const double *xTable    = &_uTableX[idx*n];
+  const double *dxduTable = &_uTableDxDu[idx*n];
+
+  int k = int(std::upper_bound(xTable, xTable+n, x) - xTable) - 1;
+  k = std::max(0, std::min(k, n-2));
+
+  double du = 1.0/double(NUM_U_TABLE_INTERVALS);
+  double uL = k*du;
+  double uR = uL + du;
+  double dx = xTable[k+1]-xTable[k];
+  double t  = std::max(0., std::min((x-xTable[k])/dx, 1.));
+
+  //Cubic Hermite interpolation of u(x) using du/dx = 1/(dx/du). Close to
+  //the ends of a section dx/du can vanish: there the secant is used.
+  double secant = du/dx;
+  double mL = secant;
+  double mR = secant;
+  if(dxduTable[k]   > 0.1*dx/du) {
+    mL = 1.0/dxduTable[k];
+  }
+  if(dxduTable[k+1] > 0.1*dx/du) {
+    mR = 1.0/dxduTable[k+1];
+  }
+  double t2 = t*t;
+  double t3 = t2*t;
+  double u  = (2*t3-3*t2+1)*uL + (t3-2*t2+t)*dx*mL
+              + (-2*t3+3*t2)*uR + (t3-t2)*dx*mR;
+  u = std::max(uL, std::min(u, uR));
+
+  //Polish the solution with Newton steps. The iteration continues past
+  //UTOL_DESIRED as long as the error keeps decreasing so that u is accurate
+  //to machine precision: the derivatives of the muscle models are checked
+  //with finite differences that are sensitive to any noise in u(x).
+  double f = SegmentedQuinticBezierToolkit::
+             calcQuinticBezierCurveVal(u,_mXVec[idx]) - x;
+  int iter = 0;
+  while(f != 0. && iter < MAXITER) {
+    double df = SegmentedQuinticBezierToolkit::
+                calcQuinticBezierCurveDerivU(u,_mXVec[idx],1);
+    if(!(abs(df) > 0)) {
+      break;
+    }
+    double uNext = std::max(uL, std::min(u - f/df, uR));
+    double fNext = SegmentedQuinticBezierToolkit::
+                   calcQuinticBezierCurveVal(uNext,_mXVec[idx]) - x;
+    if(abs(f) <= UTOL_DESIRED && !(abs(fNext) < abs(f))) {
+      break;
+    }
+    u = uNext;
+    f = fNext;
+    iter++;
+  }
+
+  if(abs(f) > UTOL) {
+    u = SegmentedQuinticBezierToolkit::calcU(x,_mXVec[idx],UTOL,MAXITER);
+  }
+
+  return u;
+}
+
 //==============================================================================
 
 
@@ -262,9 +402,8 @@ double SmoothSegmentedFunction::calcValue(double x) const
 {
   double yVal = 0;
   if(x >= _x0 && x <= _x1 ) {
-    int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
-    double u = SegmentedQuinticBezierToolkit::
-               calcU(x,_mXVec[idx], UTOL, MAXITER);
+    int idx  = calcIndex(x);
+    double u = calcU(x,idx);
     yVal = SegmentedQuinticBezierToolkit::
            calcQuinticBezierCurveVal(u,_mYVec[idx]);
   } else {
@@ -392,9 +531,8 @@ double SmoothSegmentedFunction::calcDerivative(double x, int order) const
     yVal = calcValue(x);
   } else {
     if(x >= _x0 && x <= _x1) {
-      int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
-      double u = SegmentedQuinticBezierToolkit::
-                 calcU(x,_mXVec[idx],UTOL,MAXITER);
+      int idx  = calcIndex(x);
+      double u = calcU(x,idx);
       yVal = SegmentedQuinticBezierToolkit::
              calcQuinticBezierCurveDerivDYDX(u, _mXVec[idx],
                                              _mYVec[idx], order);
@@ -419,6 +557,77 @@ double SmoothSegmentedFunction::calcDerivative(double x, int order) const
 
 
 
+//==============================================================================
+/*
+  The batch versions evaluate the curve exactly like calcValue and
+  calcDerivative. Consecutive values of x that fall into the same Bezier
+  section, as is typical for a sampled trajectory, reuse the section of the
+  previous value instead of searching for it again.
+*/
+void SmoothSegmentedFunction::calcValues(const double *x, double *y,
+    size_t n) const
+{
+  int idx = 0;
+  for(size_t i=0; i < n; ++i) {
+    if(x[i] >= _x0 && x[i] <= _x1) {
+      idx  = calcIndex(x[i],idx);
+      y[i] = SegmentedQuinticBezierToolkit::
+             calcQuinticBezierCurveVal(calcU(x[i],idx),_mYVec[idx]);
+    } else if(x[i] < _x0) {
+      y[i] = _y0 + _dydx0*(x[i]-_x0);
+    } else {
+      y[i] = _y1 + _dydx1*(x[i]-_x1);
+    }
+  }
+}
+
+//==============================================================================
+void SmoothSegmentedFunction::calcDerivatives(const double *x, double *y,
+    size_t n, int order) const
+{
+  if(order == 0) {
+    calcValues(x,y,n);
+    return;
+  }
+
+  int idx = 0;
+  for(size_t i=0; i < n; ++i) {
+    if(x[i] >= _x0 && x[i] <= _x1) {
+      idx  = calcIndex(x[i],idx);
+      y[i] = SegmentedQuinticBezierToolkit::
+             calcQuinticBezierCurveDerivDYDX(calcU(x[i],idx), _mXVec[idx],
+                                             _mYVec[idx], order);
+    } else if(order == 1) {
+      y[i] = x[i] < _x0 ? _dydx0 : _dydx1;
+    } else {
+      y[i] = 0;
+    }
+  }
+}
+
+//==============================================================================
+void SmoothSegmentedFunction::calcValues(
+  const RigidBodyDynamics::Math::VectorNd& x,
+  RigidBodyDynamics::Math::VectorNd& y) const
+{
+  if(y.size() != x.size()) {
+    y.resize(x.size());
+  }
+  calcValues(x.data(),y.data(),x.size());
+}
+
+//==============================================================================
+void SmoothSegmentedFunction::calcDerivatives(
+  const RigidBodyDynamics::Math::VectorNd& x,
+  RigidBodyDynamics::Math::VectorNd& y,
+  int order) const
+{
+  if(y.size() != x.size()) {
+    y.resize(x.size());
+  }
+  calcDerivatives(x.data(),y.data(),x.size(),order);
+}
+
 double SmoothSegmentedFunction::
 calcDerivative( const std::vector<int>& derivComponents,
                 const RigidBodyDynamics::Math::VectorNd& ax) const
@@ -286,6 +286,40 @@ namespace RigidBodyDynamics {
      */
      double calcDerivative(double x, int order) const;   
 
+     /**Calculates the value of the curve at n points. This gives the same
+     results as calling calcValue(double x) for each point, but is cheaper
+     when consecutive points lie close to each other, e.g. when a whole
+     trajectory is evaluated.
+
+     @param x   Array of the n domain points of interest
+     @param y   (output) Array of n values of the curve
+     @param n   The number of points
+     */
+     void calcValues(const double *x, double *y, size_t n) const;
+
+     /**Calculates the derivative of the curve at n points. This gives the
+     same results as calling calcDerivative(double x, int order) for each
+     point (see calcValues).
+
+     @param x   Array of the n domain points of interest
+     @param y   (output) Array of n values of the d^ny/dx^n th derivative
+     @param n   The number of points
+     @param order The order of the derivative to compute.
+     */
+     void calcDerivatives(const double *x, double *y, size_t n,
+                          int order) const;
+
+     /**Same as calcValues(const double *x, double *y, size_t n). y is
+     resized to the size of x if necessary.*/
+     void calcValues(const RigidBodyDynamics::Math::VectorNd& x,
+                     RigidBodyDynamics::Math::VectorNd& y) const;
+
+     /**Same as calcDerivatives(const double *x, double *y, size_t n,
+     int order). y is resized to the size of x if necessary.*/
+     void calcDerivatives(const RigidBodyDynamics::Math::VectorNd& x,
+                          RigidBodyDynamics::Math::VectorNd& y,
+                          int order) const;
+
      
 
      
@@ -497,6 +531,31 @@ namespace RigidBodyDynamics {
     /**The number of quintic Bezier curves that describe the relation*/
     int _numBezierSections;
 
+    /**The x value at the start of each Bezier section*/
+    std::vector<double> _xSectionStart;
+    /**x(u) of each Bezier section sampled at uniformly spaced values of u.
+    Used to look up u(x) without iterating from scratch*/
+    std::vector<double> _uTableX;
+    /**dx/du of each Bezier section at the same values of u as _uTableX*/
+    std::vector<double> _uTableDxDu;
+    /**False if x is not monotonically increasing over the curve, in which
+    case the table is not used*/
+    bool _lookupTableIsValid;
+
+    /**Samples x(u) of each section to update the lookup table. Called by
+    every function that changes the control points.*/
+    void updateLookupTable();
+
+    /**@return the index of the Bezier section that contains x*/
+    int calcIndex(double x) const;
+
+    /**@return the index of the Bezier section that contains x. idxGuess is
+    checked first.*/
+    int calcIndex(double x, int idxGuess) const;
+
+    /**@return the value of u for which x(u) of section idx equals x*/
+    double calcU(double x, int idx) const;
+
     /**The minimum value of the domain*/
     double _x0;
     /**The maximum value of the domain*/
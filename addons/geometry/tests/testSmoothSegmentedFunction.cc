@@ -390,6 +390,112 @@ TEST(SmoothSegmentedFunctionProperties)
 
 }
 
+TEST(SectionLookupMatchesBezierToolkit)
+{
+  //1. Make a curve with sections of very different lengths and with
+  //   vanishing dx/du at the ends of each section
+  RigidBodyDynamics::Math::VectorNd x(6);
+  RigidBodyDynamics::Math::VectorNd y(6);
+  RigidBodyDynamics::Math::VectorNd dydx(6);
+  double xPts[6] = {0., 0.01, 0.3, 0.35, 1.2, 1.5};
+  for(int i=0; i<x.size();++i){
+    x[i]      = xPts[i];
+    y[i]      = x[i]*x[i] + x[i];
+    dydx[i]   = 2.0*x[i] + 1.0;
+  }
+
+  RigidBodyDynamics::Math::MatrixNd mX(6,5), mY(6,5);
+  RigidBodyDynamics::Math::MatrixNd p0(6,2);
+  for(int i=0; i < 5; ++i){
+    p0 = SegmentedQuinticBezierToolkit::
+          calcQuinticBezierCornerControlPoints(  x[i],  y[i],  dydx[i],
+                                               x[i+1],y[i+1],dydx[i+1],0.9);
+    mX.col(i)  = p0.col(0);
+    mY.col(i)  = p0.col(1);
+  }
+  SmoothSegmentedFunction curve = SmoothSegmentedFunction();
+  curve.updSmoothSegmentedFunction(   mX,     mY,
+                                    x[0],   x[5],
+                                    y[0],   y[5],
+                                 dydx[0],dydx[5],
+                                 "testCurve");
+
+  //2. Compare against the section search and Newton iteration of the toolkit
+  int n = 1000;
+  for(int i=0; i <= n; ++i){
+    double xi = x[0] + (x[5]-x[0])*double(i)/double(n);
+    int idx = SegmentedQuinticBezierToolkit::calcIndex(xi,mX);
+    RigidBodyDynamics::Math::VectorNd bezierPtsX = mX.col(idx);
+    RigidBodyDynamics::Math::VectorNd bezierPtsY = mY.col(idx);
+    double u = SegmentedQuinticBezierToolkit::calcU(xi,bezierPtsX,1e-12,20);
+
+    double yExpected = SegmentedQuinticBezierToolkit::
+                        calcQuinticBezierCurveVal(u,bezierPtsY);
+    double dydxExpected = SegmentedQuinticBezierToolkit::
+                        calcQuinticBezierCurveDerivDYDX(u,bezierPtsX,
+                                                        bezierPtsY,1);
+
+    CHECK( abs(curve.calcValue(xi) - yExpected) < TOL_SMALL );
+    CHECK( abs(curve.calcDerivative(xi,1) - dydxExpected) < TOL_SMALL );
+  }
+
+  //3. The section boundaries
+  for(int i=0; i < x.size(); ++i){
+    CHECK( abs(curve.calcValue(x[i]) - y[i]) < TOL_SMALL );
+  }
+}
+
+TEST(BatchEvaluation)
+{
+  RigidBodyDynamics::Math::VectorNd xV(5);
+  RigidBodyDynamics::Math::VectorNd yV(5);
+  RigidBodyDynamics::Math::VectorNd dydxV(5);
+  for(int i=0; i<xV.size();++i){
+    xV[i]      = i*0.5*M_PI/(xV.size()-1);
+    yV[i]      = sin(xV[i]) + xV[i];
+    dydxV[i]   = cos(xV[i]) + 1.0;
+  }
+
+  RigidBodyDynamics::Math::MatrixNd mX(6,4), mY(6,4);
+  RigidBodyDynamics::Math::MatrixNd p0(6,2);
+  for(int i=0; i < 4; ++i){
+    p0 = SegmentedQuinticBezierToolkit::
+          calcQuinticBezierCornerControlPoints(  xV[i],  yV[i],  dydxV[i],
+                                               xV[i+1],yV[i+1],dydxV[i+1],0.5);
+    mX.col(i)  = p0.col(0);
+    mY.col(i)  = p0.col(1);
+  }
+  SmoothSegmentedFunction curve = SmoothSegmentedFunction();
+  curve.updSmoothSegmentedFunction(       mX,     mY,
+                                        xV[0],   xV[4],
+                                        yV[0],   yV[4],
+                                     dydxV[0],dydxV[4],
+                                     "testCurve");
+
+  //Sorted samples that extend past both ends of the curve, followed by
+  //samples in a random order
+  int n = 200;
+  RigidBodyDynamics::Math::VectorNd x(2*n);
+  for(int i=0; i < n; ++i){
+    x[i]   = -0.2 + (xV[4]+0.4)*double(i)/double(n-1);
+    x[n+i] = -0.2 + (xV[4]+0.4)*double(rand())/double(RAND_MAX);
+  }
+
+  RigidBodyDynamics::Math::VectorNd y;
+  curve.calcValues(x,y);
+  CHECK_EQUAL(x.size(), y.size());
+  for(int i=0; i < x.size(); ++i){
+    CHECK_EQUAL(curve.calcValue(x[i]), y[i]);
+  }
+
+  for(int order=0; order <= 3; ++order){
+    curve.calcDerivatives(x,y,order);
+    for(int i=0; i < x.size(); ++i){
+      CHECK_EQUAL(curve.calcDerivative(x[i],order), y[i]);
+    }
+  }
+}
+
 TEST(ShiftScale)
 {
   //1. Make a curve
@@ -370,13 +370,18 @@ bool LuaModelGetConstraintSetPhases(const char* filename,
     std::vector< unsigned int > &constraint_set_phases)
 {
   LuaTable     luaTable = LuaTable::fromFile (filename);
-  unsigned int phases = luaTable["constraint_set_phases"].length();
+  LuaTableReader reader (luaTable);
+  unsigned int phases = reader.length("constraint_set_phases");
   constraint_set_phases.resize(phases);
   bool found = false;
   std::string phaseName;
 
+  if (phases > 0) {
+    reader.enter("constraint_set_phases");
+  }
+
   for(unsigned int i=1; i<phases; ++i){
-    phaseName = luaTable["constraint_set_phases"][i].get<std::string>();
+    phaseName = reader.get<std::string>(i);
     found = false;
     for(unsigned int j=0; j<constraint_set_names.size();++j){
       if(constraint_set_names[j] == phaseName){
@@ -426,32 +431,39 @@ bool LuaModelReadFromFileWithConstraints (
 //==============================================================================
 bool LuaModelReadFromTable (LuaTable &model_table, Model* model, bool verbose)
 {
-  if (model_table["gravity"].exists()) {
-    model->gravity = model_table["gravity"].get<Vector3d>();
+  // All frames are read in a single pass over the model table
+  LuaTableReader reader (model_table);
+
+  if (reader.exists("gravity")) {
+    model->gravity = reader.get<Vector3d>("gravity");
 
     if (verbose) {
       cout << "gravity = " << model->gravity.transpose() << endl;
     }
   }
 
-  int frame_count = model_table["frames"].length();
+  int frame_count = 0;
+  if (reader.enter("frames")) {
+    frame_count = reader.length();
+  }
 
   body_table_id_map["ROOT"] = 0;
 
   for (int i = 1; i <= frame_count; i++) {
-    if (!model_table["frames"][i]["parent"].exists()) {
+    if (!reader.enter(i) || !reader.exists("parent")) {
       throw Errors::RBDLError("Parent not defined for frame ");
     }
 
-    string body_name = model_table["frames"][i]["name"].getDefault<string>("");
-    string parent_name = model_table["frames"][i]["parent"].get<string>();
+    string body_name = reader.getDefault<string>("name", "");
+    string parent_name = reader.get<string>("parent");
     unsigned int parent_id = body_table_id_map[parent_name];
 
     SpatialTransform joint_frame
-      = model_table["frames"][i]["joint_frame"].getDefault(SpatialTransform());
+      = reader.getDefault("joint_frame", SpatialTransform());
     Joint joint
-      = model_table["frames"][i]["joint"].getDefault(Joint(JointTypeFixed));
-    Body body = model_table["frames"][i]["body"].getDefault<Body>(Body());
+      = reader.getDefault("joint", Joint(JointTypeFixed));
+    Body body = reader.getDefault<Body>("body", Body());
+    reader.leave();
 
     unsigned int body_id
       = model->AddBody (parent_id, joint_frame, joint, body, body_name);
@@ -499,22 +511,22 @@ bool LuaModelReadConstraintsFromTable (
   bool localFramesLoaded =
       LuaModelReadLocalFrames(model_table,model,localFrameSet,verbose);
 
+  LuaTableReader reader (model_table);
+  bool has_constraint_sets = reader.enter("constraint_sets");
+
   for(size_t i = 0; i < constraint_set_names.size(); ++i) {
     conName = constraint_set_names[i];
     if (verbose) {
       std::cout << "==== Constraint Set: " << conName << std::endl;
     }
 
-    if(!model_table["constraint_sets"][conName.c_str()]
-        .exists()) {
+    if(!has_constraint_sets || !reader.enter(conName.c_str())) {
       ostringstream errormsg;
       errormsg << "Constraint set not existing: " << conName << "." << endl;
       throw Errors::RBDLFileParseError(errormsg.str());
     }
 
-    size_t num_constraints = model_table["constraint_sets"]
-                             [conName.c_str()]
-                             .length();
+    size_t num_constraints = reader.length();
 
     for(size_t ci = 0; ci < num_constraints; ++ci) {
       if (verbose) {
@@ -522,27 +534,22 @@ bool LuaModelReadConstraintsFromTable (
                   << " ==" << std::endl;
       }
 
-      if(!model_table["constraint_sets"]
-          [conName.c_str()][ci + 1]["constraint_type"].exists()) {
+      if(!reader.enter(int(ci + 1)) || !reader.exists("constraint_type")) {
         throw Errors::RBDLFileParseError("constraint_type not specified.\n");
       }
 
-      string constraintType = model_table["constraint_sets"]
-                              [conName.c_str()][ci + 1]["constraint_type"]
-                              .getDefault<string>("");
+      string constraintType =
+        reader.getDefault<string>("constraint_type", "");
       std::string constraint_name =
-        model_table["constraint_sets"][conName.c_str()]
-        [ci + 1]["name"].getDefault<string>("");
+        reader.getDefault<string>("name", "");
 
       bool enable_stabilization =
-        model_table["constraint_sets"][conName.c_str()][ci + 1]
-        ["enable_stabilization"].getDefault<bool>(false);
+        reader.getDefault<bool>("enable_stabilization", false);
       double stabilization_parameter = 0.1;
 
       if (enable_stabilization) {
         stabilization_parameter =
-          model_table["constraint_sets"][conName.c_str()][ci + 1]
-          ["stabilization_parameter"].getDefault<double>(0.1);
+          reader.getDefault<double>("stabilization_parameter", 0.1);
         if (stabilization_parameter <= 0.0) {
           std::stringstream errormsg;
           errormsg  << "Invalid stabilization parameter: "
@@ -561,11 +568,9 @@ bool LuaModelReadConstraintsFromTable (
         unsigned int constraint_user_id =
             std::numeric_limits<unsigned int>::max();
 
-        if(model_table["constraint_sets"][conName.c_str()][ci + 1]
-                      ["id"].exists()) {
+        if(reader.exists("id")) {
           constraint_user_id = unsigned(int(
-            model_table["constraint_sets"][conName.c_str()][ci + 1]
-                       ["id"].getDefault<double>(0.)));
+            reader.getDefault<double>("id", 0.)));
         }
 
         //Go get the body id and the local coordinates of the point:
@@ -574,10 +579,8 @@ bool LuaModelReadConstraintsFromTable (
         unsigned int bodyId;
         Vector3d bodyPoint;
 
-        if(model_table["constraint_sets"][conName.c_str()][ci+1]
-           ["point_name"].exists()){
-          std::string pointName = model_table["constraint_sets"]
-              [conName.c_str()][ci+1]["point_name"].getDefault<string>("");
+        if(reader.exists("point_name")){
+          std::string pointName = reader.getDefault<string>("point_name", "");
           bool pointFound = false;
           unsigned int pi=0;
           while(pi < pointSet.size() && pointFound == false){
@@ -596,28 +599,22 @@ bool LuaModelReadConstraintsFromTable (
             throw Errors::RBDLFileParseError(errormsg.str());
           }
         }else{
-          if(!model_table["constraint_sets"][conName.c_str()]
-              [ci + 1]["body"].exists()) {
+          if(!reader.exists("body")) {
             throw Errors::RBDLFileParseError("body not specified.\n");
           }
-          bodyId = model->GetBodyId(model_table["constraint_sets"]
-                                               [conName.c_str()][ci + 1]["body"]
-                                               .getDefault<string>("").c_str());
+          bodyId = model->GetBodyId(
+                     reader.getDefault<string>("body", "").c_str());
 
-          bodyPoint = model_table["constraint_sets"]
-                               [conName.c_str()][ci + 1]
-                               ["point"].getDefault<Vector3d>(Vector3d::Zero());
+          bodyPoint = reader.getDefault<Vector3d>("point", Vector3d::Zero());
         }
 
         normalSets.resize(0);
         normalSetsMatrix.resize(1,1);
 
-        if(model_table["constraint_sets"][conName.c_str()][ci + 1]
-            ["normal_sets"].exists()) {
+        if(reader.exists("normal_sets")) {
 
           normalSetsMatrix =
-            model_table["constraint_sets"][conName.c_str()]
-            [ci + 1]["normal_sets"].getDefault< MatrixNd >(MatrixNd::Zero(1,1));
+            reader.getDefault<MatrixNd>("normal_sets", MatrixNd::Zero(1,1));
 
           if(normalSetsMatrix.cols() != 3 ) {
             std::ostringstream errormsg;
@@ -640,12 +637,9 @@ bool LuaModelReadConstraintsFromTable (
             normalSets.push_back(normal);
           }
 
-        } else if(model_table["constraint_sets"][conName.c_str()]
-                  [ci + 1]["normal"].exists()) {
+        } else if(reader.exists("normal")) {
 
-          normal = model_table["constraint_sets"]
-                   [conName.c_str()][ci + 1]
-                   ["normal"].getDefault<Vector3d>(Vector3d::Zero());
+          normal = reader.getDefault<Vector3d>("normal", Vector3d::Zero());
           normalSets.push_back(normal);
 
         } else {
@@ -657,9 +651,8 @@ bool LuaModelReadConstraintsFromTable (
           throw Errors::RBDLFileParseError(errormsg.str());
         }
 
-        std::string contactName = model_table["constraint_sets"]
-                                  [conName.c_str()][ci + 1]
-                                  ["name"].getDefault<string>("").c_str();
+        std::string contactName =
+          reader.getDefault<string>("name", "").c_str();
 
         for(unsigned int c=0; c<normalSets.size(); ++c) {
           constraint_sets[i].AddContactConstraint(bodyId,
@@ -690,11 +683,9 @@ bool LuaModelReadConstraintsFromTable (
       } else if(constraintType == "loop") {
 
         unsigned int constraint_user_id=std::numeric_limits<unsigned int>::max();
-        if(model_table["constraint_sets"][conName.c_str()][ci + 1]
-            ["id"].exists()) {
+        if(reader.exists("id")) {
           constraint_user_id =
-              unsigned(int(model_table["constraint_sets"][conName.c_str()]
-                           [ci + 1]["id"].getDefault<double>(0.)));
+              unsigned(int(reader.getDefault<double>("id", 0.)));
         }
 
         //Get the local frames that this constraint will be applied to
@@ -705,12 +696,10 @@ bool LuaModelReadConstraintsFromTable (
         SpatialTransform Xp;
         SpatialTransform Xs;
 
-        if(model_table["constraint_sets"]
-           [conName.c_str()][ci + 1]["predecessor_local_frame"].exists()){
+        if(reader.exists("predecessor_local_frame")){
 
-          std::string localFrameName = model_table["constraint_sets"]
-              [conName.c_str()][ci + 1]["predecessor_local_frame"]
-              .getDefault<string>("");
+          std::string localFrameName =
+            reader.getDefault<string>("predecessor_local_frame", "");
           bool frameFound = false;
           unsigned int fi=0;
           while(fi < localFrameSet.size() && frameFound == false){
@@ -732,27 +721,22 @@ bool LuaModelReadConstraintsFromTable (
             throw Errors::RBDLFileParseError(errormsg.str());
           }
         }else{
-          if(!model_table["constraint_sets"][conName.c_str()]
-              [ci + 1]["predecessor_body"].exists()) {
+          if(!reader.exists("predecessor_body")) {
             throw Errors::RBDLFileParseError(
                   "predecessor_body not specified.\n");
           }
 
           idPredecessor =
-            model->GetBodyId(model_table["constraint_sets"]
-                             [conName.c_str()][ci + 1]["predecessor_body"]
-                             .getDefault<string>("").c_str());
-          Xp = model_table["constraint_sets"][conName.c_str()]
-                [ci + 1]["predecessor_transform"]
-                .getDefault<SpatialTransform>(SpatialTransform());
+            model->GetBodyId(reader.getDefault<string>("predecessor_body", "")
+                             .c_str());
+          Xp = reader.getDefault<SpatialTransform>("predecessor_transform",
+                                                   SpatialTransform());
         }
 
-        if(model_table["constraint_sets"]
-           [conName.c_str()][ci + 1]["successor_local_frame"].exists()){
+        if(reader.exists("successor_local_frame")){
 
-          std::string localFrameName = model_table["constraint_sets"]
-              [conName.c_str()][ci + 1]["successor_local_frame"]
-              .getDefault<string>("");
+          std::string localFrameName =
+            reader.getDefault<string>("successor_local_frame", "");
           bool frameFound = false;
           unsigned int fi=0;
           while(fi < localFrameSet.size() && frameFound == false){
@@ -776,20 +760,17 @@ bool LuaModelReadConstraintsFromTable (
 
         }else{
 
-          if(!model_table["constraint_sets"][conName.c_str()]
-              [ci + 1]["successor_body"].exists()) {
+          if(!reader.exists("successor_body")) {
             throw Errors::RBDLFileParseError("successor_body not specified.\n");
           }
 
           idSuccessor =
-            model->GetBodyId(model_table["constraint_sets"]
-                             [conName.c_str()][ci + 1]["successor_body"]
-                             .getDefault<string>("").c_str());
+            model->GetBodyId(reader.getDefault<string>("successor_body", "")
+                             .c_str());
 
 
-          Xs =  model_table["constraint_sets"][conName.c_str()]
-                  [ci + 1]["successor_transform"]
-                  .getDefault<SpatialTransform>(SpatialTransform());
+          Xs = reader.getDefault<SpatialTransform>("successor_transform",
+                                                   SpatialTransform());
         }
 
 
@@ -800,11 +781,9 @@ bool LuaModelReadConstraintsFromTable (
 
         axisSetsMatrix.resize(1,1);
         axisSets.resize(0);
-        if(model_table["constraint_sets"][conName.c_str()][ci + 1]
-            ["axis_sets"].exists()) {
+        if(reader.exists("axis_sets")) {
           axisSetsMatrix =
-            model_table["constraint_sets"][conName.c_str()][ci + 1]
-            ["axis_sets"].getDefault< MatrixNd >( MatrixNd::Zero(1,1));
+            reader.getDefault<MatrixNd>("axis_sets", MatrixNd::Zero(1,1));
 
           if(axisSetsMatrix.cols() != 6 ) {
             std::stringstream errormsg;
@@ -825,10 +804,9 @@ bool LuaModelReadConstraintsFromTable (
             axisSets.push_back(axis);
           }
 
-        } else if(model_table["constraint_sets"][conName.c_str()][ci + 1]
-                  ["axis"].exists()) {
-          axis = model_table["constraint_sets"][conName.c_str()][ci + 1]
-                 ["axis"].getDefault< SpatialVector >( SpatialVector::Zero());
+        } else if(reader.exists("axis")) {
+          axis = reader.getDefault<SpatialVector>("axis",
+                                                  SpatialVector::Zero());
 
           axisSets.push_back(axis);
 
@@ -884,7 +862,11 @@ bool LuaModelReadConstraintsFromTable (
         errormsg << "Invalid constraint type: " << constraintType << endl;
         throw Errors::RBDLFileParseError(errormsg.str());
       }
+
+      reader.leave();
     }
+
+    reader.leave();
   }
 
   return true;
@@ -900,20 +882,24 @@ bool LuaModelReadMotionCaptureMarkers (
 {
 
   LuaTable luaTable       = LuaTable::fromFile (filename);
+  LuaTableReader reader (luaTable);
   upd_marker_set.clear();
 
-  if(luaTable["frames"].exists()){
-    unsigned int frameCount = luaTable["frames"].length();
+  if(reader.enter("frames")){
+    unsigned int frameCount = reader.length();
     std::vector<LuaKey> marker_keys;
     MotionCaptureMarker marker;
     std::string body_name;
     unsigned int body_id;
     for(unsigned int i=1; i<frameCount; ++i){
-      if(luaTable["frames"][i]["markers"].exists()){
+      if(!reader.enter(i)){
+        continue;
+      }
 
-        body_name = luaTable["frames"][i]["name"].getDefault<string>("");
+      body_name = reader.getDefault<string>("name", "");
+      if(reader.enter("markers")){
         body_id = model->GetBodyId(body_name.c_str());
-        marker_keys = luaTable["frames"][i]["markers"].keys();
+        marker_keys = reader.keys();
 
         for(unsigned int j=0; j < marker_keys.size(); ++j){
           if (marker_keys[j].type != LuaKey::String) {
@@ -923,11 +909,13 @@ bool LuaModelReadMotionCaptureMarkers (
           marker.name      = marker_keys[j].string_value;
           marker.body_name = body_name;
           marker.body_id   = body_id;
-          marker.point_local = luaTable["frames"][i]["markers"][marker.name.c_str()]
-                              .getDefault<Vector3d>(Vector3d::Zero());
+          marker.point_local = reader.getDefault<Vector3d>(marker_keys[j],
+                                                           Vector3d::Zero());
           upd_marker_set.push_back(marker);
         }
+        reader.leave();
       }
+      reader.leave();
     }
   }
 
@@ -942,16 +930,18 @@ bool LuaModelReadLocalFrames (
 {
   //LuaTable luaTable       = LuaTable::fromFile (filename);
   upd_local_frame_set.clear();
+  LuaTableReader reader (model_table);
   unsigned int localFrameCount =
-      unsigned(int(model_table["local_frames"].length()));
+      unsigned(int(reader.length("local_frames")));
 
   if(localFrameCount > 0){
     upd_local_frame_set.resize(localFrameCount);
     LocalFrame localFrame;
+    reader.enter("local_frames");
 
     for (unsigned int i = 1; i <= localFrameCount; ++i) {
 
-      localFrame = model_table["local_frames"][signed(i)];
+      localFrame = reader.get<LocalFrame>(signed(i));
 
       localFrame.body_id     = model->GetBodyId (localFrame.body_name.c_str());
       upd_local_frame_set[i-1] = localFrame;
@@ -978,15 +968,17 @@ bool LuaModelReadPoints (
 {
 
   upd_point_set.clear();
-  unsigned int pointCount = unsigned(int(model_table["points"].length()));
+  LuaTableReader reader (model_table);
+  unsigned int pointCount = unsigned(int(reader.length("points")));
 
   if(pointCount > 0){
     upd_point_set.resize(pointCount);
     Point point;
+    reader.enter("points");
 
     for (unsigned int i = 1; i <= pointCount; ++i) {
 
-      point = model_table["points"][i];
+      point = reader.get<Point>(signed(i));
 
       point.body_id   = model->GetBodyId (point.body_name.c_str());
       upd_point_set[i-1]   = point;
@@ -1012,7 +1004,8 @@ bool LuaModelReadHumanMetaData(
 {
 
   LuaTable luaTable = LuaTable::fromFile (filename);
-  unsigned int subjectCount = luaTable["human_meta_data"].length();
+  LuaTableReader reader (luaTable);
+  unsigned int subjectCount = reader.length("human_meta_data");
 
   if(subjectCount != 1){
     ostringstream errormsg;
@@ -1023,7 +1016,8 @@ bool LuaModelReadHumanMetaData(
     throw Errors::RBDLError(errormsg.str());
   }
 
-  human_meta_data = luaTable["human_meta_data"][1];  
+  reader.enter("human_meta_data");
+  human_meta_data = reader.get<HumanMetaData>(1);
 
   return true;
 }
@@ -1112,7 +1106,8 @@ bool LuaModelReadMillard2016TorqueMuscleSets(
 
 
   LuaTable     luaTable  = LuaTable::fromFile (filename);
-  unsigned int mtgCount  = luaTable["millard2016_torque_muscles"].length();
+  LuaTableReader reader (luaTable);
+  unsigned int mtgCount  = reader.length("millard2016_torque_muscles");
 
 
   updMtgSet.resize(mtgCount);
@@ -1121,8 +1116,12 @@ bool LuaModelReadMillard2016TorqueMuscleSets(
   Millard2016TorqueMuscleConfig mtgInfoDefault;
   unsigned int id;
 
+  if(mtgCount > 0){
+    reader.enter("millard2016_torque_muscles");
+  }
+
   for(unsigned int i = 1; i <= mtgCount; ++i){
-    mtgInfo = luaTable["millard2016_torque_muscles"][i];
+    mtgInfo = reader.get<Millard2016TorqueMuscleConfig>(signed(i));
     id = i-unsigned(int(1));
 
     updMtgSetInfo[id] = mtgInfo;
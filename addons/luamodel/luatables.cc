@@ -976,3 +976,241 @@ std::string LuaTable::orderedSerialize()
 
   return result;
 }
+
+//
+// LuaTableReader
+//
+LuaTableReader::LuaTableReader (LuaTable &table) :
+  L (NULL),
+  luaTable (&table),
+  stackTop (0),
+  depth (0)
+{
+  table.pushRef();
+  L = table.L;
+
+  // tables of Lua expressions without a return statement are the global
+  // table
+  if (table.referencesGlobal) {
+    #if LUA_VERSION_NUM == 501
+    lua_pushvalue (L, LUA_GLOBALSINDEX);
+    #elif LUA_VERSION_NUM >= 502
+    lua_rawgeti (L, LUA_REGISTRYINDEX, LUA_RIDX_GLOBALS);
+    #endif
+  }
+
+  stackTop = lua_gettop(L);
+
+  if (!lua_istable (L, -1)) {
+    if (table.referencesGlobal) {
+      lua_pop (L, 1);
+    }
+    table.popRef();
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+      "Error: cannot read Lua table: value is not a table!\n");
+  }
+}
+
+LuaTableReader::LuaTableReader (lua_State *state,
+                                const std::vector<LuaKey> &key_stack) :
+  L (state),
+  luaTable (NULL),
+  stackTop (lua_gettop(state)),
+  keyStack (key_stack.rbegin(), key_stack.rend()),
+  depth (0)
+{
+  if (!lua_istable (L, -1)) {
+    LuaKey key = keyStack.back();
+    keyStack.pop_back();
+
+    std::ostringstream errormsg;
+    errormsg << "Error: value " << keyStackToString (key)
+             << " is not a table!" << std::endl;
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(errormsg.str());
+  }
+}
+
+LuaTableReader::~LuaTableReader()
+{
+  lua_settop (L, stackTop);
+
+  if (luaTable) {
+    if (luaTable->referencesGlobal) {
+      lua_pop (L, 1);
+    }
+    luaTable->popRef();
+  }
+}
+
+bool LuaTableReader::enter (const LuaKey &key)
+{
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  if (lua_isnil (L, -1)) {
+    lua_pop (L, 1);
+    return false;
+  }
+
+  if (!lua_istable (L, -1)) {
+    lua_pop (L, 1);
+    std::ostringstream errormsg;
+    errormsg << "Error: value " << keyStackToString (key)
+             << " is not a table!" << std::endl;
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(errormsg.str());
+  }
+
+  keyStack.push_back (key);
+  depth++;
+
+  return true;
+}
+
+void LuaTableReader::leave ()
+{
+  assert (depth > 0);
+
+  lua_pop (L, 1);
+  keyStack.pop_back();
+  depth--;
+}
+
+bool LuaTableReader::exists (const LuaKey &key)
+{
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  bool result = !lua_isnil (L, -1);
+  lua_pop (L, 1);
+
+  return result;
+}
+
+size_t LuaTableReader::length ()
+{
+  #if LUA_VERSION_NUM == 501
+  return lua_objlen(L, -1);
+  #elif LUA_VERSION_NUM >= 502
+  return lua_rawlen(L, -1);
+  #endif
+}
+
+size_t LuaTableReader::length (const LuaKey &key)
+{
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  size_t result = 0;
+  if (!lua_isnil (L, -1)) {
+    result = length();
+  }
+  lua_pop (L, 1);
+
+  return result;
+}
+
+std::vector<LuaKey> LuaTableReader::keys ()
+{
+  std::vector<LuaKey> result;
+
+  lua_pushnil(L);
+  while (lua_next(L, -2) != 0) {
+    if (lua_isnumber(L, -2)) {
+      double number = lua_tonumber (L, -2);
+      double frac;
+      if (modf (number, &frac) == 0) {
+        LuaKey key (static_cast<int>(number));
+        result.push_back (key);
+      }
+    } else if (lua_isstring (L, -2)) {
+      LuaKey key (lua_tostring(L, -2));
+      result.push_back (key);
+    } else {
+      cerr << "Warning: invalid LuaKey type for key "
+           << lua_typename(L, lua_type(L, -2)) << "!" << endl;
+    }
+
+    lua_pop(L, 1);
+  }
+
+  return result;
+}
+
+std::string LuaTableReader::keyStackToString (const LuaKey &key)
+{
+  ostringstream result_stream ("");
+  for (size_t i = 0; i <= keyStack.size(); i++) {
+    const LuaKey &stack_key = i < keyStack.size() ? keyStack[i] : key;
+    if (stack_key.type == LuaKey::String) {
+      result_stream << "[\"" << stack_key.string_value << "\"]";
+    } else {
+      result_stream << "[" << stack_key.int_value << "]";
+    }
+  }
+
+  return result_stream.str();
+}
+
+template<> bool LuaTableReader::getDefault<bool>(const LuaKey &key,
+    const bool &default_value)
+{
+  bool result = default_value;
+
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  if (!lua_isnil (L, -1)) {
+    result = lua_toboolean (L, -1);
+  }
+  lua_pop (L, 1);
+
+  return result;
+}
+
+template<> double LuaTableReader::getDefault<double>(const LuaKey &key,
+    const double &default_value)
+{
+  double result = default_value;
+
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  if (!lua_isnil (L, -1)) {
+    result = lua_tonumber (L, -1);
+  }
+  lua_pop (L, 1);
+
+  return result;
+}
+
+template<> float LuaTableReader::getDefault<float>(const LuaKey &key,
+    const float &default_value)
+{
+  float result = default_value;
+
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  if (!lua_isnil (L, -1)) {
+    result = static_cast<float>(lua_tonumber (L, -1));
+  }
+  lua_pop (L, 1);
+
+  return result;
+}
+
+template<> std::string LuaTableReader::getDefault<std::string>(
+    const LuaKey &key, const std::string &default_value)
+{
+  std::string result = default_value;
+
+  l_push_LuaKey (L, key);
+  lua_gettable (L, -2);
+
+  if (lua_isstring (L, -1)) {
+    result = lua_tostring (L, -1);
+  }
+  lua_pop (L, 1);
+
+  return result;
+}
@@ -278,5 +278,136 @@ struct RBDL_DLLAPI LuaTable {
   bool referencesGlobal;
 };
 
+/** Single-pass reader for nested Lua tables.
+ *
+ * A LuaTableNode resolves every value that is read by pushing its whole key
+ * path starting at the root table. Reading many fields of nested tables,
+ * e.g. the frames of a model, therefore traverses the same tables over and
+ * over. A LuaTableReader instead keeps the tables that it reads on the Lua
+ * stack: enter() pushes a child table once, all values of the current table
+ * are then read with a single lookup, and leave() pops the table again.
+ *
+ * \code
+ * LuaTableReader reader (model_table);
+ * if (reader.enter ("frames")) {
+ *   for (int i = 1; i <= int(reader.length()); i++) {
+ *     reader.enter (i);
+ *     std::string name = reader.getDefault<std::string>("name", "");
+ *     std::string parent = reader.get<std::string>("parent");
+ *     reader.leave();
+ *   }
+ *   reader.leave();
+ * }
+ * \endcode
+ *
+ * Custom types are supported by specializing read(), which reads the
+ * current table into a value. These specializations are also used by
+ * LuaTableNode::getDefault().
+ */
+struct RBDL_DLLAPI LuaTableReader {
+  /// Reads the given table.
+  explicit LuaTableReader (LuaTable &table);
+  /** Reads the table on top of the stack of a Lua state.
+   *
+   * \param state Lua state with a table on top of its stack
+   * \param key_stack key path of that table as returned by
+   * LuaTableNode::getKeyStack(), used for error messages
+   */
+  LuaTableReader (lua_State *state, const std::vector<LuaKey> &key_stack);
+  /// Restores the stack, i.e. leaves all tables that were entered.
+  ~LuaTableReader();
+
+  /** Makes the child table key the current table.
+   *
+   * Returns false if the current table has no value for key. Throws a
+   * RigidBodyDynamics::Errors::RBDLFileParseError if the value is not a
+   * table.
+   */
+  bool enter (const LuaKey &key);
+  /// Makes the parent of the current table the current table again.
+  void leave ();
+
+  bool exists (const LuaKey &key);
+  /// Length of the current table.
+  size_t length ();
+  /// Length of the value key of the current table (0 if it does not exist).
+  size_t length (const LuaKey &key);
+  /// Keys of the current table.
+  std::vector<LuaKey> keys ();
+  /// Key path from the root table to key of the current table.
+  std::string keyStackToString (const LuaKey &key);
+
+  /// Reads the current table into value. Specialized for custom types.
+  template <typename T>
+  void read (T &value);
+
+  /// Reads the value key of the current table. Specialized for scalars.
+  template <typename T>
+  T getDefault (const LuaKey &key, const T &default_value)
+  {
+    T result = default_value;
+
+    if (enter (key)) {
+      read (result);
+      leave ();
+    }
+
+    return result;
+  }
+
+  template <typename T>
+  T get (const LuaKey &key)
+  {
+    if (!exists (key)) {
+      std::ostringstream errormsg;
+      errormsg << "Error: could not find value " << keyStackToString (key)
+               << "." << std::endl;
+      throw RigidBodyDynamics::Errors::RBDLError(errormsg.str());
+    }
+    return getDefault (key, T());
+  }
+
+  lua_State *L;
+  /// The table passed to the constructor or NULL if the reader was created
+  /// from a Lua state.
+  LuaTable *luaTable;
+  /// Stack top of the root table
+  int stackTop;
+  /// Keys of the root table and all entered tables
+  std::vector<LuaKey> keyStack;
+  /// Number of tables entered with enter()
+  size_t depth;
+
+private:
+  LuaTableReader (const LuaTableReader &other);
+  LuaTableReader& operator= (const LuaTableReader &other);
+};
+
+template<> bool LuaTableReader::getDefault<bool>(const LuaKey &key,
+    const bool &default_value);
+template<> double LuaTableReader::getDefault<double>(const LuaKey &key,
+    const double &default_value);
+template<> float LuaTableReader::getDefault<float>(const LuaKey &key,
+    const float &default_value);
+template<> std::string LuaTableReader::getDefault<std::string>(
+    const LuaKey &key, const std::string &default_value);
+
+// Values of custom types are read with the single-pass reader once the
+// key path of the node has been resolved.
+template <typename T>
+T LuaTableNode::getDefault (const T &default_value)
+{
+  T result = default_value;
+
+  if (stackQueryValue()) {
+    LuaTableReader reader (luaTable->L, getKeyStack());
+    reader.read (result);
+  }
+
+  stackRestore();
+
+  return result;
+}
+
 /* LUATABLES_H */
 #endif
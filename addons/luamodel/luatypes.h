@@ -27,526 +27,336 @@
 #include "luastructs.h"
 
 
+// The custom types are read with the single-pass LuaTableReader, which is
+// also used by LuaTableNode::getDefault() for these types.
+
 //==============================================================================
 template<>
-RigidBodyDynamics::Math::Vector3d
-LuaTableNode::getDefault<RigidBodyDynamics::Math::Vector3d>(
-    const RigidBodyDynamics::Math::Vector3d &default_value)
+void LuaTableReader::read<RigidBodyDynamics::Math::Vector3d>(
+    RigidBodyDynamics::Math::Vector3d &result)
 {
-  RigidBodyDynamics::Math::Vector3d result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
-
-    if (vector_table.length() != 3) {
-      throw RigidBodyDynamics::Errors::RBDLFileParseError(
-            "LuaModel Error: invalid 3d vector!");
-    }
-
-    result[0] = vector_table[1];
-    result[1] = vector_table[2];
-    result[2] = vector_table[3];
+  if (length() != 3) {
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+          "LuaModel Error: invalid 3d vector!");
   }
 
-  stackRestore();
-
-  return result;
+  result[0] = get<double>(1);
+  result[1] = get<double>(2);
+  result[2] = get<double>(3);
 }
 
 //==============================================================================
 template<>
-RigidBodyDynamics::Math::SpatialVector
-LuaTableNode::getDefault<RigidBodyDynamics::Math::SpatialVector>(
-  const RigidBodyDynamics::Math::SpatialVector &default_value
-)
+void LuaTableReader::read<RigidBodyDynamics::Math::SpatialVector>(
+    RigidBodyDynamics::Math::SpatialVector &result)
 {
-  RigidBodyDynamics::Math::SpatialVector result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
-
-  //! [Parse Failed]
-    if (vector_table.length() != 6) {
-      throw RigidBodyDynamics::Errors::RBDLFileParseError(
-            "LuaModel Error: invalid 6d vector!");
-    }
   //! [Parse Failed]
-
-    result[0] = vector_table[1];
-    result[1] = vector_table[2];
-    result[2] = vector_table[3];
-    result[3] = vector_table[4];
-    result[4] = vector_table[5];
-    result[5] = vector_table[6];
+  if (length() != 6) {
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+          "LuaModel Error: invalid 6d vector!");
   }
+  //! [Parse Failed]
 
-  stackRestore();
-
-  return result;
+  result[0] = get<double>(1);
+  result[1] = get<double>(2);
+  result[2] = get<double>(3);
+  result[3] = get<double>(4);
+  result[4] = get<double>(5);
+  result[5] = get<double>(6);
 }
 
 //==============================================================================
 template<>
-RigidBodyDynamics::Math::MatrixNd
-LuaTableNode::getDefault<RigidBodyDynamics::Math::MatrixNd>(
-    const RigidBodyDynamics::Math::MatrixNd &default_value)
+void LuaTableReader::read<RigidBodyDynamics::Math::MatrixNd>(
+    RigidBodyDynamics::Math::MatrixNd &result)
 {
-  RigidBodyDynamics::Math::MatrixNd result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
+  int rows = int(length());
+  int cols = int(length(1));
 
-    result.resize( int(vector_table.length()),
-                   int(vector_table[1].length()));
+  result.resize(rows, cols);
 
-    for(int r=0; r<int(vector_table.length()); ++r) {
-      for(int c=0; c<int(vector_table[1].length()); ++c) {
-        result(r,c) = vector_table[r+1][c+1];
-      }
+  for(int r=0; r<rows; ++r) {
+    enter(r+1);
+    for(int c=0; c<cols; ++c) {
+      result(r,c) = get<double>(c+1);
     }
+    leave();
   }
-  stackRestore();
-
-  return result;
 }
 
 //==============================================================================
 template<>
-RigidBodyDynamics::Math::Matrix3d
-LuaTableNode::getDefault<RigidBodyDynamics::Math::Matrix3d>(
-    const RigidBodyDynamics::Math::Matrix3d &default_value)
+void LuaTableReader::read<RigidBodyDynamics::Math::Matrix3d>(
+    RigidBodyDynamics::Math::Matrix3d &result)
 {
-  RigidBodyDynamics::Math::Matrix3d result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
-
-    if (vector_table.length() != 3) {
-      throw RigidBodyDynamics::Errors::RBDLFileParseError(
-            "LuaModel Error: invalid 3d matrix!");
-    }
-
-    if (vector_table[1].length() != 3
-        || vector_table[2].length() != 3
-        || vector_table[3].length() != 3) {
-      throw RigidBodyDynamics::Errors::RBDLFileParseError(
-            "LuaModel Error: invalid 3d matrix!");
-    }
-
-    result(0,0) = vector_table[1][1];
-    result(0,1) = vector_table[1][2];
-    result(0,2) = vector_table[1][3];
-
-    result(1,0) = vector_table[2][1];
-    result(1,1) = vector_table[2][2];
-    result(1,2) = vector_table[2][3];
-
-    result(2,0) = vector_table[3][1];
-    result(2,1) = vector_table[3][2];
-    result(2,2) = vector_table[3][3];
+  if (length() != 3) {
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+          "LuaModel Error: invalid 3d matrix!");
   }
 
-  stackRestore();
+  if (length(1) != 3
+      || length(2) != 3
+      || length(3) != 3) {
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+          "LuaModel Error: invalid 3d matrix!");
+  }
 
-  return result;
+  for (int r = 0; r < 3; r++) {
+    enter(r+1);
+    result(r,0) = get<double>(1);
+    result(r,1) = get<double>(2);
+    result(r,2) = get<double>(3);
+    leave();
+  }
 }
 //==============================================================================
 template<>
-RigidBodyDynamics::Math::SpatialTransform
-LuaTableNode::getDefault<RigidBodyDynamics::Math::SpatialTransform>(
-  const RigidBodyDynamics::Math::SpatialTransform &default_value
-)
+void LuaTableReader::read<RigidBodyDynamics::Math::SpatialTransform>(
+    RigidBodyDynamics::Math::SpatialTransform &result)
 {
-  RigidBodyDynamics::Math::SpatialTransform result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
-
-    result.r = vector_table["r"].getDefault<RigidBodyDynamics::Math::Vector3d>(
-          RigidBodyDynamics::Math::Vector3d::Zero(3));
-    result.E = vector_table["E"].getDefault<RigidBodyDynamics::Math::Matrix3d>(
-          RigidBodyDynamics::Math::Matrix3d::Identity (3,3));
-  }
-
-  stackRestore();
-
-  return result;
+  result.r = getDefault<RigidBodyDynamics::Math::Vector3d>("r",
+        RigidBodyDynamics::Math::Vector3d::Zero(3));
+  result.E = getDefault<RigidBodyDynamics::Math::Matrix3d>("E",
+        RigidBodyDynamics::Math::Matrix3d::Identity (3,3));
 }
 
 //==============================================================================
 template<>
-RigidBodyDynamics::Joint
-LuaTableNode::getDefault<RigidBodyDynamics::Joint>(
-    const RigidBodyDynamics::Joint &default_value)
+void LuaTableReader::read<RigidBodyDynamics::Joint>(
+    RigidBodyDynamics::Joint &result)
 {
-  RigidBodyDynamics::Joint result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
-
-    int joint_dofs = vector_table.length();
-
-    if (joint_dofs == 1) {
-      std::string dof_string = vector_table[1].getDefault<std::string>("");
-      if (dof_string == "JointTypeSpherical") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeSpherical);
-      } else if (dof_string == "JointTypeEulerZYX") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeEulerZYX);
-      }
-      if (dof_string == "JointTypeEulerXYZ") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeEulerXYZ);
-      }
-      if (dof_string == "JointTypeEulerYXZ") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeEulerYXZ);
-      }
-      if (dof_string == "JointTypeTranslationXYZ") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeTranslationXYZ);
-      }
-      if (dof_string == "JointTypeFloatingBase") {
-        stackRestore();
-        return RigidBodyDynamics::Joint(
-              RigidBodyDynamics::JointTypeFloatingBase);
-      }
-    }
+  int joint_dofs = length();
 
-    if (joint_dofs > 0) {
-      if (vector_table[1].length() != 6) {
-        std::ostringstream errormsg;
-        errormsg << "LuaModel Error: invalid joint motion "
-                 << "subspace description at "
-                 << this->keyStackToString() << std::endl;
-        throw RigidBodyDynamics::Errors::RBDLFileParseError(errormsg.str());
-      }
-    }
-    switch (joint_dofs) {
-    case 0:
+  if (joint_dofs == 1) {
+    std::string dof_string = getDefault<std::string>(1, "");
+    if (dof_string == "JointTypeSpherical") {
       result = RigidBodyDynamics::Joint(
-            RigidBodyDynamics::JointTypeFixed);
-      break;
-    case 1:
-      result = RigidBodyDynamics::Joint (
-            vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>());
-      break;
-    case 2:
+            RigidBodyDynamics::JointTypeSpherical);
+      return;
+    } else if (dof_string == "JointTypeEulerZYX") {
       result = RigidBodyDynamics::Joint(
-                 vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[2].get<RigidBodyDynamics::Math::SpatialVector>()
-               );
-      break;
-    case 3:
+            RigidBodyDynamics::JointTypeEulerZYX);
+      return;
+    }
+    if (dof_string == "JointTypeEulerXYZ") {
       result = RigidBodyDynamics::Joint(
-                 vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[2].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[3].get<RigidBodyDynamics::Math::SpatialVector>()
-               );
-      break;
-    case 4:
+            RigidBodyDynamics::JointTypeEulerXYZ);
+      return;
+    }
+    if (dof_string == "JointTypeEulerYXZ") {
       result = RigidBodyDynamics::Joint(
-                 vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[2].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[3].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[4].get<RigidBodyDynamics::Math::SpatialVector>()
-               );
-      break;
-    case 5:
+            RigidBodyDynamics::JointTypeEulerYXZ);
+      return;
+    }
+    if (dof_string == "JointTypeTranslationXYZ") {
       result = RigidBodyDynamics::Joint(
-                 vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[2].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[3].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[4].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[5].get<RigidBodyDynamics::Math::SpatialVector>()
-               );
-      break;
-    case 6:
+            RigidBodyDynamics::JointTypeTranslationXYZ);
+      return;
+    }
+    if (dof_string == "JointTypeFloatingBase") {
       result = RigidBodyDynamics::Joint(
-                 vector_table[1].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[2].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[3].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[4].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[5].get<RigidBodyDynamics::Math::SpatialVector>(),
-                 vector_table[6].get<RigidBodyDynamics::Math::SpatialVector>()
-               );
-      break;
-    default:
-      throw RigidBodyDynamics::Errors::RBDLFileParseError(
-            "Invalid number of DOFs for joint.");
-      break;
+            RigidBodyDynamics::JointTypeFloatingBase);
+      return;
+    }
+  }
+
+  if (joint_dofs > 0) {
+    if (length(1) != 6) {
+      std::ostringstream errormsg;
+      errormsg << "LuaModel Error: invalid joint motion "
+               << "subspace description at "
+               << keyStackToString(1) << std::endl;
+      throw RigidBodyDynamics::Errors::RBDLFileParseError(errormsg.str());
     }
   }
 
-  stackRestore();
+  if (joint_dofs > 6) {
+    throw RigidBodyDynamics::Errors::RBDLFileParseError(
+          "Invalid number of DOFs for joint.");
+  }
+
+  RigidBodyDynamics::Math::SpatialVector axes[6];
+  for (int i = 0; i < joint_dofs; i++) {
+    axes[i] = get<RigidBodyDynamics::Math::SpatialVector>(i + 1);
+  }
 
-  return result;
+  switch (joint_dofs) {
+  case 0:
+    result = RigidBodyDynamics::Joint(
+          RigidBodyDynamics::JointTypeFixed);
+    break;
+  case 1:
+    result = RigidBodyDynamics::Joint (axes[0]);
+    break;
+  case 2:
+    result = RigidBodyDynamics::Joint(axes[0], axes[1]);
+    break;
+  case 3:
+    result = RigidBodyDynamics::Joint(axes[0], axes[1], axes[2]);
+    break;
+  case 4:
+    result = RigidBodyDynamics::Joint(axes[0], axes[1], axes[2], axes[3]);
+    break;
+  case 5:
+    result = RigidBodyDynamics::Joint(axes[0], axes[1], axes[2], axes[3],
+                                      axes[4]);
+    break;
+  case 6:
+    result = RigidBodyDynamics::Joint(axes[0], axes[1], axes[2], axes[3],
+                                      axes[4], axes[5]);
+    break;
+  }
 }
 
 
 //==============================================================================
 template<>
-RigidBodyDynamics::Body
-LuaTableNode::getDefault<RigidBodyDynamics::Body>(
-    const RigidBodyDynamics::Body &default_value)
+void LuaTableReader::read<RigidBodyDynamics::Body>(
+    RigidBodyDynamics::Body &result)
 {
-  RigidBodyDynamics::Body result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable vector_table = LuaTable::fromLuaState (luaTable->L);
+  double mass = 0.;
+  RigidBodyDynamics::Math::Vector3d com(
+        RigidBodyDynamics::Math::Vector3d::Zero(3));
+  RigidBodyDynamics::Math::Matrix3d inertia(
+        RigidBodyDynamics::Math::Matrix3d::Identity(3,3));
 
-    double mass = 0.;
-    RigidBodyDynamics::Math::Vector3d com(
-          RigidBodyDynamics::Math::Vector3d::Zero(3));
-    RigidBodyDynamics::Math::Matrix3d inertia(
-          RigidBodyDynamics::Math::Matrix3d::Identity(3,3));
-
-    mass = vector_table["mass"];
-    com = vector_table["com"]
-        .getDefault<RigidBodyDynamics::Math::Vector3d>(com);
-    inertia = vector_table["inertia"]
-        .getDefault<RigidBodyDynamics::Math::Matrix3d>(inertia);
-
-    result = RigidBodyDynamics::Body (mass, com, inertia);
-  }
+  mass = get<double>("mass");
+  com = getDefault<RigidBodyDynamics::Math::Vector3d>("com", com);
+  inertia = getDefault<RigidBodyDynamics::Math::Matrix3d>("inertia", inertia);
 
-  stackRestore();
-
-  return result;
+  result = RigidBodyDynamics::Body (mass, com, inertia);
 }
 
 //==============================================================================
 
-template<> Point
-LuaTableNode::getDefault<Point>(
-  const Point &default_value)
-{ 
-  Point result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable point_table = LuaTable::fromLuaState (luaTable->L);
-
-    result.name         = point_table["name"].get<std::string>();
-    result.point_local  = point_table["point"]
-                            .getDefault<RigidBodyDynamics::Math::Vector3d>(
-                              RigidBodyDynamics::Math::Vector3d::Zero());
-    result.body_name    = point_table["body"].get<std::string>();
-  }
-
-  stackRestore();
-
-  return result;
+template<>
+void LuaTableReader::read<Point>(Point &result)
+{
+  result.name         = get<std::string>("name");
+  result.point_local  = getDefault<RigidBodyDynamics::Math::Vector3d>(
+                          "point", RigidBodyDynamics::Math::Vector3d::Zero());
+  result.body_name    = get<std::string>("body");
 }
 
 //==============================================================================
 
-template<> MotionCaptureMarker
-LuaTableNode::getDefault<MotionCaptureMarker>(
-  const MotionCaptureMarker &default_value)
+template<>
+void LuaTableReader::read<MotionCaptureMarker>(MotionCaptureMarker &result)
 {
-  MotionCaptureMarker result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable marker_table = LuaTable::fromLuaState (luaTable->L);
-
-    result.name        = marker_table["name"].get<std::string>();
-    result.point_local = marker_table["point"]
-                          .getDefault<RigidBodyDynamics::Math::Vector3d>(
-                            RigidBodyDynamics::Math::Vector3d::Zero());
-    result.body_name   = marker_table["body"].get<std::string>();
-  }
-
-  stackRestore();
-
-  return result;
+  result.name        = get<std::string>("name");
+  result.point_local = getDefault<RigidBodyDynamics::Math::Vector3d>(
+                         "point", RigidBodyDynamics::Math::Vector3d::Zero());
+  result.body_name   = get<std::string>("body");
 }
 
 //==============================================================================
 
-template<> LocalFrame
-LuaTableNode::getDefault<LocalFrame>(
-  const LocalFrame &default_value)
+template<>
+void LuaTableReader::read<LocalFrame>(LocalFrame &result)
 {
-  LocalFrame result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable local_frame_table = LuaTable::fromLuaState (luaTable->L);
-
-    result.name     = local_frame_table["name"].get<std::string>();
-    result.body_name= local_frame_table["body"].get<std::string>();
-
-    result.r = local_frame_table["r"]
-                .getDefault<RigidBodyDynamics::Math::Vector3d>(
-                  RigidBodyDynamics::Math::Vector3d::Zero());
-    result.E = local_frame_table["E"]
-                .getDefault<RigidBodyDynamics::Math::Matrix3d>(
-                  RigidBodyDynamics::Math::Matrix3d::Identity());
-  }
-
-  stackRestore();
+  result.name     = get<std::string>("name");
+  result.body_name= get<std::string>("body");
 
-  return result;
+  result.r = getDefault<RigidBodyDynamics::Math::Vector3d>(
+               "r", RigidBodyDynamics::Math::Vector3d::Zero());
+  result.E = getDefault<RigidBodyDynamics::Math::Matrix3d>(
+               "E", RigidBodyDynamics::Math::Matrix3d::Identity());
 }
 //==============================================================================
 
-template<> HumanMetaData
-  LuaTableNode::getDefault<HumanMetaData>(
-                  const HumanMetaData &default_value)
+template<>
+void LuaTableReader::read<HumanMetaData>(HumanMetaData &result)
 {
-  HumanMetaData result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable metadata_table = LuaTable::fromLuaState (luaTable->L);
-
-    result.gender =
-      metadata_table["gender"].get<std::string>();
-
-    result.age  	= metadata_table["age"];
-    result.height = metadata_table["height"];
-    result.mass   = metadata_table["weight"];
-    result.age_group  = metadata_table["age_group"].get<std::string>();    
-  }
-
-  stackRestore();
-  return result;
+  result.gender     = get<std::string>("gender");
+  result.age        = get<double>("age");
+  result.height     = get<double>("height");
+  result.mass       = get<double>("weight");
+  result.age_group  = get<std::string>("age_group");
 }
 //==============================================================================
 #ifdef RBDL_BUILD_ADDON_MUSCLE
-template<> Millard2016TorqueMuscleConfig
-  LuaTableNode::getDefault<Millard2016TorqueMuscleConfig>(
-                    const Millard2016TorqueMuscleConfig &default_value)
+template<>
+void LuaTableReader::read<Millard2016TorqueMuscleConfig>(
+    Millard2016TorqueMuscleConfig &result)
 {
-  Millard2016TorqueMuscleConfig result = default_value;
-
-  if (stackQueryValue()) {
-    LuaTable mtg_table = LuaTable::fromLuaState (luaTable->L);
-
-    // First read mandatory fields
-    result.name     		= mtg_table["name"].get<std::string>();
-    result.angle_sign 	= mtg_table["angle_sign"].get<double>();
-    result.torque_sign 	= mtg_table["torque_sign"].get<double>();
-    result.body         = mtg_table["body"].get<std::string>();
-
-    if(mtg_table["joint_index"].exists()){
-      result.joint_index  =
-          unsigned(int(mtg_table["joint_index"].get<double>()));
-    }
-
-    //Optional parameters
-    if(mtg_table["data_set"].exists()){
-      result.data_set = mtg_table["data_set"].get<std::string>();
-    }
-    if(mtg_table["age_group"].exists()){
-      result.age_group = mtg_table["age_group"].get<std::string>();
-    }
-    if(mtg_table["gender"].exists()){
-      result.gender = mtg_table["gender"].get<std::string>();
-    }
-
-    if (mtg_table["q_scale"].exists()) {
-        result.q_scale = mtg_table["q_scale"].get<double>();
-    }
-    if (mtg_table["activation_index"].exists()) {
-        result.activation_index =
-            unsigned(int(mtg_table["activation_index"].get<double>()));
-    }
-    if (mtg_table["data_set"].exists()) {
-      result.data_set = mtg_table["data_set"].get<std::string>();
-    }
-    //if (mtg_table["angle_scale"].exists()) {
-    //    result.angle_scale = mtg_table["angle_scale"].get<double>();
-    //}
-    if (mtg_table["joint_angle_offset"].exists()) {
-        result.joint_angle_offset =
-          mtg_table["joint_angle_offset"].get<double>();
-    }
-    if (mtg_table["act_time"].exists()) {
-        result.activation_time_constant =
-          mtg_table["act_time"].get<double>();
-    }
-    if (mtg_table["deact_time"].exists()) {
-        result.deactivation_time_constant =
-          mtg_table["deact_time"].get<double>();
-    }
-
-    //Parameters for manual tuning
-    if (mtg_table["max_isometric_torque_scale"].exists()) {
-        result.max_isometric_torque_scale =
-          mtg_table["max_isometric_torque_scale"].get<double>();
-    }
-    if (mtg_table["max_angular_velocity_scale"].exists()) {
-        result.max_angular_velocity_scale =
-          mtg_table["max_angular_velocity_scale"].get<double>();
-    }
-
-    if (mtg_table["passive_element_torque_scale"].exists()) {
-        result.passive_element_torque_scale =
-          mtg_table["passive_element_torque_scale"].get<double>();
-    }
-    if (mtg_table["passive_element_angle_offset"].exists()) {
-        result.passive_element_angle_offset =
-          mtg_table["passive_element_angle_offset"].get<double>();
-    }
-    if (mtg_table["passive_element_damping_coeff"].exists()) {
-        result.passive_element_damping_coeff =
-          mtg_table["passive_element_damping_coeff"].get<double>();
-    }
-
-    //Optional passive-curve fitting coordinates
-    if (mtg_table["fit_passive_torque_scale"].exists()) {
-        result.fit_passive_torque_scale =
-          mtg_table["fit_passive_torque_scale"]
-            .get<RigidBodyDynamics::Math::Vector3d>();
-    }
-    if (mtg_table["fit_passive_torque_offset"].exists()) {
-        result.fit_passive_torque_offset =
-          mtg_table["fit_passive_torque_offset"]
-            .get<RigidBodyDynamics::Math::Vector3d>();
-    }
+  // First read mandatory fields
+  result.name         = get<std::string>("name");
+  result.angle_sign   = get<double>("angle_sign");
+  result.torque_sign  = get<double>("torque_sign");
+  result.body         = get<std::string>("body");
+
+  if(exists("joint_index")){
+    result.joint_index  =
+        unsigned(int(get<double>("joint_index")));
+  }
 
-    //Optional fitting parameters from the fitting routine
-    if (mtg_table["max_isometric_torque"].exists()) {
-        result.max_isometric_torque =
-          mtg_table["max_isometric_torque"].get<double>();
-    }
-    if (mtg_table["max_angular_velocity"].exists()) {
-        result.max_angular_velocity =
-          mtg_table["max_angular_velocity"].get<double>();
-    }
-    if (mtg_table["active_torque_angle_blending"].exists()) {
-        result.active_torque_angle_blending =
-          mtg_table["active_torque_angle_blending"].get<double>();
-    }
-    if (mtg_table["passive_torque_angle_blending"].exists()) {
-        result.passive_torque_angle_blending =
-          mtg_table["passive_torque_angle_blending"].get<double>();
-    }
-    if (mtg_table["torque_velocity_blending"].exists()) {
-        result.torque_velocity_blending =
-          mtg_table["torque_velocity_blending"].get<double>();
-    }
-    if (mtg_table["active_torque_angle_scale"].exists()) {
-        result.active_torque_angle_scale =
-          mtg_table["active_torque_angle_scale"].get<double>();
-    }
-    //if (mtg_table["passive_torque_angle_scale"].exists()) {
-    //    result.passive_torque_angle_scale =
-    //      mtg_table["passive_torque_angle_scale"].get<double>();
-    //}
-    //if (mtg_table["torque_velocity_scaling"].exists()) {
-    //    result.torque_velocity_scaling =
-    //      mtg_table["torque_velocity_scaling"].get<double>();
-    //}
+  //Optional parameters
+  result.data_set   = getDefault<std::string>("data_set", result.data_set);
+  result.age_group  = getDefault<std::string>("age_group", result.age_group);
+  result.gender     = getDefault<std::string>("gender", result.gender);
 
+  result.q_scale = getDefault<double>("q_scale", result.q_scale);
+  if (exists("activation_index")) {
+      result.activation_index =
+          unsigned(int(get<double>("activation_index")));
   }
-  stackRestore();
-  return result;
+  //result.angle_scale = getDefault<double>("angle_scale", result.angle_scale);
+  result.joint_angle_offset =
+    getDefault<double>("joint_angle_offset", result.joint_angle_offset);
+  result.activation_time_constant =
+    getDefault<double>("act_time", result.activation_time_constant);
+  result.deactivation_time_constant =
+    getDefault<double>("deact_time", result.deactivation_time_constant);
+
+  //Parameters for manual tuning
+  result.max_isometric_torque_scale =
+    getDefault<double>("max_isometric_torque_scale",
+                       result.max_isometric_torque_scale);
+  result.max_angular_velocity_scale =
+    getDefault<double>("max_angular_velocity_scale",
+                       result.max_angular_velocity_scale);
+
+  result.passive_element_torque_scale =
+    getDefault<double>("passive_element_torque_scale",
+                       result.passive_element_torque_scale);
+  result.passive_element_angle_offset =
+    getDefault<double>("passive_element_angle_offset",
+                       result.passive_element_angle_offset);
+  result.passive_element_damping_coeff =
+    getDefault<double>("passive_element_damping_coeff",
+                       result.passive_element_damping_coeff);
+
+  //Optional passive-curve fitting coordinates
+  result.fit_passive_torque_scale =
+    getDefault<RigidBodyDynamics::Math::Vector3d>(
+      "fit_passive_torque_scale", result.fit_passive_torque_scale);
+  result.fit_passive_torque_offset =
+    getDefault<RigidBodyDynamics::Math::Vector3d>(
+      "fit_passive_torque_offset", result.fit_passive_torque_offset);
+
+  //Optional fitting parameters from the fitting routine
+  result.max_isometric_torque =
+    getDefault<double>("max_isometric_torque", result.max_isometric_torque);
+  result.max_angular_velocity =
+    getDefault<double>("max_angular_velocity", result.max_angular_velocity);
+  result.active_torque_angle_blending =
+    getDefault<double>("active_torque_angle_blending",
+                       result.active_torque_angle_blending);
+  result.passive_torque_angle_blending =
+    getDefault<double>("passive_torque_angle_blending",
+                       result.passive_torque_angle_blending);
+  result.torque_velocity_blending =
+    getDefault<double>("torque_velocity_blending",
+                       result.torque_velocity_blending);
+  result.active_torque_angle_scale =
+    getDefault<double>("active_torque_angle_scale",
+                       result.active_torque_angle_scale);
+  //result.passive_torque_angle_scale =
+  //  getDefault<double>("passive_torque_angle_scale",
+  //                     result.passive_torque_angle_scale);
+  //result.torque_velocity_scaling =
+  //  getDefault<double>("torque_velocity_scaling",
+  //                     result.torque_velocity_scaling);
 }
 #endif
 
@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <cctype>
 #include <sstream>
 
 using namespace std;
@@ -18,11 +20,30 @@ void usage (const char* argv_0) {
   cerr << "  -o | --body-origins       print the origins of all bodies that have names" << endl;
   cerr << "  -c | --center_of_mass     print center of mass for bodies and full model" << endl;
   cerr << "  -s | --constraint_sets    print all constraint sets defined in the model file" << endl;
+  cerr << "  -g | --generate-code <file.h> write a header with fixed-size dynamics of the model" << endl;
+  cerr << "  -b | --binary <file>      write the model in the binary model format" << endl;
   cerr << "  -h | --help               print this help" << endl;
   exit (1);
 }
 
 
+/* Returns the file name without directory and extension where all
+ * characters that are not allowed in C++ identifiers are replaced by '_'. */
+string struct_name_from_filename (const string &header_filename) {
+  string result = header_filename.substr (header_filename.find_last_of ("/\\") + 1);
+  result = result.substr (0, result.find ('.'));
+
+  for (size_t i = 0; i < result.size(); i++) {
+    if (!isalnum (result[i]))
+      result[i] = '_';
+  }
+
+  if (result.size() == 0 || isdigit (result[0]))
+    result = "Model" + result;
+
+  return result;
+}
+
 int main (int argc, char *argv[]) {
   if (argc < 2) {
     cerr << "Error: not enough arguments!" << endl;
@@ -34,6 +55,8 @@ int main (int argc, char *argv[]) {
   bool model_hierarchy = false;
   bool body_origins = false;
   bool center_of_mass = false;
+  string code_filename = "";
+  string binary_filename = "";
   bool constraint_sets = false;
 
   string filename = argv[1];
@@ -49,6 +72,10 @@ int main (int argc, char *argv[]) {
       body_origins = true;
     else if (string(argv[i]) == "-c" || string (argv[i]) == "--center-of-mass")
       center_of_mass = true;
+    else if ((string(argv[i]) == "-g" || string (argv[i]) == "--generate-code") && i + 1 < argc)
+      code_filename = argv[++i];
+    else if ((string(argv[i]) == "-b" || string (argv[i]) == "--binary") && i + 1 < argc)
+      binary_filename = argv[++i];
     else if (string(argv[i]) == "-s" || string (argv[i]) == "--constraint-sets")
       constraint_sets = true;
     else if (string(argv[i]) == "-h" || string (argv[i]) == "--help")
@@ -120,5 +147,17 @@ int main (int argc, char *argv[]) {
     cout << setw(14) << "Model mass: " << mass << endl;
   }
 
+  if (code_filename != "") {
+    ofstream code_file (code_filename.c_str());
+    code_file << RigidBodyDynamics::Utils::GenerateFixedSizeModelCode (model,
+        struct_name_from_filename (code_filename));
+    cout << "Fixed-size model code written to " << code_filename << endl;
+  }
+
+  if (binary_filename != "") {
+    RigidBodyDynamics::BinaryModelWriteToFile (model, binary_filename.c_str());
+    cout << "Binary model written to " << binary_filename << endl;
+  }
+
   return 0;
 }
@@ -11,6 +11,7 @@
 #include "csvtools.h"
 
 #include <rbdl/rbdl_errors.h>
+#include "../../src/rbdl_parallel.h"
 
 
 #include <limits>
@@ -383,6 +384,7 @@ Millard2016TorqueMuscle( )
    mMuscleName("empty")
 {
   mMuscleCurvesAreDirty = true;
+  mDataSet = DataSet::Last;
   mUseTabularMaxActiveIsometricTorque = true;
   mUseTabularOmegaMax = true;
   mPassiveTorqueScale = 1.0;
@@ -615,36 +617,39 @@ Millard2016TorqueMuscle::Millard2016TorqueMuscle(
  Muscle Model Code
 *************************************************************/
 /*
- To explain the const casting:
- 1. calcJointTorque does not modify any member variables which affect
-    the output fo the model, and thus it should be const for the user.
-
- 2. To make the code maintainable the model is evaluated only in 2
-    places updTorqueMuscleSummary & updTorqueMuscleInfo.
-
- 3. To save on memory, these upd functions modify a struct, which is a member
-    variable, but is only being used as cache.
-
- To achieve a const calcJointTorque function, maintainable code (e.g. model
- evaluated in only 2 spots), and with minimal use of memory/copying I am
- using const_casting.
-
- There is perhaps a more elegant way to do this. I dislike
- const_casting, but for now I do not see a better solution.
+ The curves of the muscle are rebuilt by every function that changes one of
+ their parameters. As a result, none of the const functions below modify the
+ muscle, and they can be called concurrently on the same muscle.
 */
+void Millard2016TorqueMuscle::checkTorqueMuscleCurves() const
+{
+  if(mMuscleCurvesAreDirty) {
+    ostringstream errormsg;
+    errormsg << "Millard2016TorqueMuscle::"
+             << mMuscleName
+             << ": the muscle curves have not been created. Construct the"
+             << " muscle with a data set before evaluating it.";
+    throw RigidBodyDynamics::Errors::RBDLError(errormsg.str());
+  }
+}
+
 double Millard2016TorqueMuscle::
 calcJointTorque(    double jointAngle,
                     double jointAngularVelocity,
                     double activation) const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
+  TorqueMuscleSummary tms;
+  return calcJointTorque(jointAngle,jointAngularVelocity,activation,tms);
+}
+
+double Millard2016TorqueMuscle::
+calcJointTorque(    double jointAngle,
+                    double jointAngularVelocity,
+                    double activation,
+                    TorqueMuscleSummary &tms) const
+{
+  checkTorqueMuscleCurves();
 
-  Millard2016TorqueMuscle* mutableThis =
-    const_cast<Millard2016TorqueMuscle* >(this);
   updTorqueMuscleSummary(activation,
                          jointAngle,jointAngularVelocity,
                          mTaLambda,mTpLambda,mTvLambda,
@@ -652,9 +657,9 @@ calcJointTorque(    double jointAngle,
                          mPassiveCurveAngleOffset,
                          mOmegaMax,
                          mMaxActiveIsometricTorque,
-                         mutableThis->mTmSummary);
+                         tms);
 
-  return mTmSummary.jointTorque;
+  return tms.jointTorque;
 }
 
 
@@ -665,11 +670,7 @@ calcActivation(double jointAngle,
                double jointTorque,
                TorqueMuscleSummary &tms) const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
+  checkTorqueMuscleCurves();
 
   updInvertTorqueMuscleSummary(jointTorque,jointAngle,jointAngularVelocity,
                                mTaLambda,mTpLambda,mTvLambda,
@@ -688,29 +689,11 @@ calcMaximumActiveIsometricTorqueScalingFactor(
   double activation,
   double jointTorque) const
 {
+  TorqueMuscleSummary tms;
+  double jointTorqueAtActivation =
+    calcJointTorque(jointAngle,jointAngularVelocity,activation,tms);
 
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
-
-  double scaleFactor = 0.;
-
-  Millard2016TorqueMuscle* mutableThis =
-    const_cast<Millard2016TorqueMuscle* >(this);
-
-  updTorqueMuscleSummary(activation,
-                         jointAngle,jointAngularVelocity,
-                         mTaLambda,mTpLambda,mTvLambda,
-                         mTaAngleScaling,
-                         mAngleAtOneNormActiveTorque,
-                         mPassiveCurveAngleOffset,
-                         mOmegaMax,
-                         mMaxActiveIsometricTorque,
-                         mutableThis->mTmSummary);
-
-  scaleFactor = jointTorque/mTmSummary.jointTorque;
+  double scaleFactor = jointTorque/jointTorqueAtActivation;
 
   return scaleFactor;
 }
@@ -722,13 +705,7 @@ calcTorqueMuscleInfo(double jointAngle,
                      double activation,
                      TorqueMuscleInfo& tmi) const
 {
-
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
-
+  checkTorqueMuscleCurves();
 
   updTorqueMuscleInfo(activation, jointAngle, jointAngularVelocity,
                       mTaLambda,mTpLambda,mTvLambda,
@@ -739,6 +716,57 @@ calcTorqueMuscleInfo(double jointAngle,
                       tmi);
 }
 
+void Millard2016TorqueMuscle::calcJointTorqueBatch(
+  const std::vector< Millard2016TorqueMuscle > &muscles,
+  const RigidBodyDynamics::Math::MatrixNd &jointAngles,
+  const RigidBodyDynamics::Math::MatrixNd &jointAngularVelocities,
+  const RigidBodyDynamics::Math::MatrixNd &activations,
+  RigidBodyDynamics::Math::MatrixNd &jointTorques,
+  unsigned int numberOfThreads)
+{
+  unsigned int numberOfMuscles = unsigned(muscles.size());
+  unsigned int numberOfSamples = unsigned(jointAngles.cols());
+
+  if(   jointAngles.rows()            != numberOfMuscles
+     || jointAngularVelocities.rows() != numberOfMuscles
+     || jointAngularVelocities.cols() != numberOfSamples
+     || activations.rows()            != numberOfMuscles
+     || activations.cols()            != numberOfSamples) {
+    ostringstream errormsg;
+    errormsg << "Millard2016TorqueMuscle::calcJointTorqueBatch:"
+             << " jointAngles, jointAngularVelocities, and activations must"
+             << " have one row per muscle (" << numberOfMuscles << ")"
+             << " and the same number of columns.";
+    throw RigidBodyDynamics::Errors::RBDLSizeMismatchError(errormsg.str());
+  }
+
+  for(unsigned int i=0; i<numberOfMuscles; ++i) {
+    muscles[i].checkTorqueMuscleCurves();
+  }
+
+  if(   jointTorques.rows() != numberOfMuscles
+     || jointTorques.cols() != numberOfSamples) {
+    jointTorques.resize(numberOfMuscles, numberOfSamples);
+  }
+
+  //The muscle-sample pairs are distributed in column-major order so that
+  //short trajectories of many muscles are split as well.
+  RigidBodyDynamics::ParallelFor(numberOfMuscles*numberOfSamples,
+                                 numberOfThreads,
+    [&](unsigned int, unsigned int begin, unsigned int end) {
+      TorqueMuscleSummary tms;
+      for(unsigned int k=begin; k<end; ++k) {
+        unsigned int i = k % numberOfMuscles;
+        unsigned int j = k / numberOfMuscles;
+        jointTorques(i,j) = muscles[i].calcJointTorque(
+                              jointAngles(i,j),
+                              jointAngularVelocities(i,j),
+                              activations(i,j),
+                              tms);
+      }
+  });
+}
+
 
 /*************************************************************
  Get / Set Functions
@@ -747,33 +775,18 @@ calcTorqueMuscleInfo(double jointAngle,
 double Millard2016TorqueMuscle::
 getJointTorqueSign() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mSignOfJointTorque;
 }
 
 double Millard2016TorqueMuscle::
 getJointAngleSign() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mSignOfJointAngle;
 }
 
 double Millard2016TorqueMuscle::
 getJointAngleOffset() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mAngleOffset;
 }
 
@@ -781,11 +794,6 @@ getJointAngleOffset() const
 double Millard2016TorqueMuscle::
 getNormalizedDampingCoefficient() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mBetaMax;
 }
 
@@ -812,11 +820,6 @@ setNormalizedDampingCoefficient(double betaUpd)
 double Millard2016TorqueMuscle::
 getMaximumActiveIsometricTorque() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
 
   /*
   if(mUseTabularMaxActiveIsometricTorque){
@@ -832,22 +835,12 @@ getMaximumActiveIsometricTorque() const
 double Millard2016TorqueMuscle::
 getMaximumConcentricJointAngularVelocity() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return calcJointAngularVelocity( mOmegaMax );
 }
 
 double Millard2016TorqueMuscle::
 getTorqueVelocityMultiplierAtHalfOmegaMax() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mTorqueVelocityMultiplierAtHalfOmegaMax;
 }
 
@@ -865,19 +858,19 @@ setTorqueVelocityMultiplierAtHalfOmegaMax(double tvAtHalfOmegaMax)
              << " data sets or stop using this function.";
     throw RigidBodyDynamics::Errors::RBDLError(errormsg.str());
   }
-  mMuscleCurvesAreDirty                = true;
   mUseTabularTorqueVelocityMultiplierAtHalfOmegaMax = false;
   mTorqueVelocityMultiplierAtHalfOmegaMax = tvAtHalfOmegaMax;
+  updateTorqueMuscleCurves();
 }
 
 
 void Millard2016TorqueMuscle::
 setMaximumActiveIsometricTorque(double maxIsoTorque)
 {
-  mMuscleCurvesAreDirty                = true;
   mUseTabularMaxActiveIsometricTorque  = false;
   //mMaxActiveIsometricTorqueUserDefined = maxIsoTorque;
   mMaxActiveIsometricTorque = maxIsoTorque;
+  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::
@@ -894,30 +887,20 @@ setMaximumConcentricJointAngularVelocity(double maxAngularVelocity)
     throw RigidBodyDynamics::Errors::RBDLInvalidParameterError(errormsg.str());
   }
 
-  mMuscleCurvesAreDirty = true;
   mUseTabularOmegaMax   = false;
   mOmegaMax             = fabs(maxAngularVelocity);
+  updateTorqueMuscleCurves();
 }
 
 double Millard2016TorqueMuscle::
 getJointAngleAtMaximumActiveIsometricTorque() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return calcJointAngle(mAngleAtOneNormActiveTorque);
 }
 
 double Millard2016TorqueMuscle::
 getActiveTorqueAngleCurveWidth() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   VectorNd domain = mTaCurve.getCurveDomain();
   double activeTorqueAngleAngleScaling
     = getActiveTorqueAngleCurveAngleScaling();
@@ -931,22 +914,12 @@ getActiveTorqueAngleCurveWidth() const
 double Millard2016TorqueMuscle::
 getJointAngleAtOneNormalizedPassiveIsometricTorque() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return calcJointAngle(mAngleAtOneNormPassiveTorque);
 }
 
 double Millard2016TorqueMuscle::
 getJointAngleAtSmallestNormalizedPassiveIsometricTorque() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return calcJointAngle(mAngleAtSmallestNormPassiveTorque);
 }
 
@@ -955,38 +928,28 @@ getJointAngleAtSmallestNormalizedPassiveIsometricTorque() const
 double Millard2016TorqueMuscle::
 getPassiveTorqueScale() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mPassiveTorqueScale;
 }
 
 void Millard2016TorqueMuscle::
 setPassiveTorqueScale(double passiveTorqueScaling)
 {
-  mMuscleCurvesAreDirty = true;
   mPassiveTorqueScale = passiveTorqueScaling;
+  updateTorqueMuscleCurves();
 }
 
 
 double Millard2016TorqueMuscle::
 getPassiveCurveAngleOffset() const
 {
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mPassiveCurveAngleOffset;
 }
 
 void Millard2016TorqueMuscle::
 setPassiveCurveAngleOffset(double passiveCurveAngleOffsetVal)
 {
-  mMuscleCurvesAreDirty = true;
   mPassiveCurveAngleOffset = passiveCurveAngleOffsetVal;
+  updateTorqueMuscleCurves();
 }
 
 
@@ -994,9 +957,7 @@ void Millard2016TorqueMuscle::
 fitPassiveCurveAngleOffset(double jointAngleTarget,
                            double passiveFiberTorqueTarget)
 {
-  mMuscleCurvesAreDirty = true;
   setPassiveCurveAngleOffset(0.0);
-  updateTorqueMuscleCurves();
 
   if(passiveFiberTorqueTarget < SQRTEPSILON) {
     ostringstream errormsg;
@@ -1025,7 +986,6 @@ fitPassiveCurveAngleOffset(double jointAngleTarget,
                              -currentFiberAngle;
 
   setPassiveCurveAngleOffset(fiberAngleOffset);
-  updateTorqueMuscleCurves();
 
 }
 
@@ -1033,9 +993,7 @@ void Millard2016TorqueMuscle::
 fitPassiveTorqueScale(double jointAngleTarget,
                       double passiveFiberTorqueTarget)
 {
-  mMuscleCurvesAreDirty = true;
   setPassiveTorqueScale(1.0);
-  updateTorqueMuscleCurves();
 
   double normPassiveFiberTorqueTarget = passiveFiberTorqueTarget
                                         /mMaxActiveIsometricTorque;
@@ -1051,7 +1009,6 @@ fitPassiveTorqueScale(double jointAngleTarget,
 
 
   setPassiveTorqueScale(passiveTorqueScale);
-  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::calcTorqueMuscleDataFeatures(
@@ -1121,36 +1078,18 @@ void Millard2016TorqueMuscle::calcTorqueMuscleDataFeatures(
 const SmoothSegmentedFunction& Millard2016TorqueMuscle::
 getActiveTorqueAngleCurve() const
 {
-  //This must be updated if the parameters have changed
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mTaCurve;
 }
 
 const SmoothSegmentedFunction& Millard2016TorqueMuscle::
 getPassiveTorqueAngleCurve() const
 {
-  //This must be updated if the parameters have changed
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mTpCurve;
 }
 
 const SmoothSegmentedFunction& Millard2016TorqueMuscle::
 getTorqueAngularVelocityCurve() const
 {
-  //This must be updated if the parameters have changed
-  if(mMuscleCurvesAreDirty) {
-    Millard2016TorqueMuscle* mutableThis =
-      const_cast<Millard2016TorqueMuscle* >(this);
-    mutableThis->updateTorqueMuscleCurves();
-  }
   return mTvCurve;
 }
 
@@ -1163,8 +1102,8 @@ string Millard2016TorqueMuscle::getName()
 
 void Millard2016TorqueMuscle::setName(string &name)
 {
-  mMuscleCurvesAreDirty = true;
   mMuscleName = name;
+  updateTorqueMuscleCurves();
 }
 
 
@@ -1206,8 +1145,8 @@ setActiveTorqueAngleCurveAngleScaling(double angleScaling)
     throw RigidBodyDynamics::Errors::RBDLInvalidParameterError(errormsg.str());
   }
 
-  mMuscleCurvesAreDirty = true;
   mTaAngleScaling = angleScaling;
+  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::
@@ -1224,8 +1163,8 @@ setActiveTorqueAngleCurveBlendingVariable(double blendingVariable)
              << endl;
     throw RigidBodyDynamics::Errors::RBDLInvalidParameterError(errormsg.str());
   }
-  mMuscleCurvesAreDirty = true;
   mTaLambda = blendingVariable;
+  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::
@@ -1242,8 +1181,8 @@ setPassiveTorqueAngleCurveBlendingVariable(double blendingVariable)
              << endl;
     throw RigidBodyDynamics::Errors::RBDLInvalidParameterError(errormsg.str());
   }
-  mMuscleCurvesAreDirty = true;
   mTpLambda = blendingVariable;
+  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::
@@ -1261,8 +1200,8 @@ setTorqueAngularVelocityCurveBlendingVariable(double blendingVariable)
              << endl;
     throw RigidBodyDynamics::Errors::RBDLInvalidParameterError(errormsg.str());
   }
-  mMuscleCurvesAreDirty = true;
   mTvLambda = blendingVariable;
+  updateTorqueMuscleCurves();
 }
 
 void Millard2016TorqueMuscle::setFittedParameters(
@@ -1330,6 +1269,12 @@ calcJointAngularVelocity(double fiberAngularVelocity) const
 
 void Millard2016TorqueMuscle::updateTorqueMuscleCurves()
 {
+  //A default constructed muscle has no data set and thus no curves that
+  //could be updated.
+  if(mDataSet == DataSet::Last) {
+    return;
+  }
+
   std::string tempName = mMuscleName;
 
   switch(mDataSet) {
@@ -1048,6 +1048,68 @@ namespace RigidBodyDynamics {
                         double jointAngularVelocity,
                         double activation) const;
 
+                /**
+                Calculates the signed joint torque developed by the muscle
+                (see calcJointTorque above) and stores the internal values of
+                the muscle in a struct that is provided by the caller. Like
+                all const functions of this class it does not modify the
+                muscle and can be called concurrently from several threads.
+
+                @param jointAngle (radians)
+
+                @param jointAngularVelocity (radians/sec)
+
+                @param activation: the percentage of the muscle that is
+                        turned on [0-1].
+
+                @param updTorqueMuscleSummaryStruct: the TorqueMuscleSummary
+                        struct that is updated with the internal values of
+                        the muscle.
+
+                @returns torque developed by the muscle in (Nm).
+                */
+                double calcJointTorque(
+                        double jointAngle,
+                        double jointAngularVelocity,
+                        double activation,
+                        TorqueMuscleSummary
+                          &updTorqueMuscleSummaryStruct) const;
+
+                /**
+                Evaluates calcJointTorque for several muscles over a whole
+                trajectory. Row i of each matrix belongs to muscles[i] and
+                each column is one sample of the trajectory. The samples of
+                all muscles are distributed over the given number of
+                threads.
+
+                @param muscles: the muscles to evaluate
+
+                @param jointAngles: the joint angle of each muscle (radians)
+
+                @param jointAngularVelocities: the joint angular velocity of
+                        each muscle (radians/sec)
+
+                @param activations: the activation of each muscle
+
+                @param jointTorques: (output, resized if necessary) the joint
+                        torque developed by each muscle (Nm)
+
+                @param numberOfThreads: the number of threads that are used.
+                        A value of 0 uses all available hardware threads
+                        (default: 1).
+
+                @throws RBDLSizeMismatchError if the sizes of the matrices
+                        do not match the number of muscles.
+                */
+                static void calcJointTorqueBatch(
+                  const std::vector< Millard2016TorqueMuscle > &muscles,
+                  const RigidBodyDynamics::Math::MatrixNd &jointAngles,
+                  const RigidBodyDynamics::Math::MatrixNd
+                    &jointAngularVelocities,
+                  const RigidBodyDynamics::Math::MatrixNd &activations,
+                  RigidBodyDynamics::Math::MatrixNd &jointTorques,
+                  unsigned int numberOfThreads = 1);
+
 
                 /**
                 This function will calculate the muscle activation needed to
@@ -1455,8 +1517,10 @@ namespace RigidBodyDynamics {
 
               bool mMuscleCurvesAreDirty;
               void updateTorqueMuscleCurves();
+              //Throws if the curves have not been created, which is only the
+              //case for a default constructed muscle.
+              void checkTorqueMuscleCurves() const;
               TorqueMuscleInfo mTmInfo;
-              TorqueMuscleSummary mTmSummary;
 
               RigidBodyDynamics::Addons::Geometry::
                 SmoothSegmentedFunction mTaCurve;
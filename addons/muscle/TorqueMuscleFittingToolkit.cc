@@ -25,11 +25,7 @@ void TorqueMuscleFittingToolkit::
         bool verbose) 
 {
 
-  if(tqMcl.mMuscleCurvesAreDirty){
-    Millard2016TorqueMuscle* mutableTqMcl =
-        const_cast<Millard2016TorqueMuscle* >(&tqMcl);
-    mutableTqMcl->updateTorqueMuscleCurves();
-  }
+  tqMcl.checkTorqueMuscleCurves();
 
 
   assert(jointAngle.rows() > 1);
@@ -124,6 +124,7 @@ double const TorqueMuscleFittingHardTestCase[100][4] =
 #include "../../geometry/tests/numericalTestFunctions.h"
 #include <UnitTest++.h>
 #include <rbdl/rbdl_math.h>
+#include <rbdl/rbdl_errors.h>
 #include <ctime>
 #include <string>
 #include <ostream>
@@ -272,6 +273,89 @@ TEST(calcJointTorqueCorrectnessTests){
     CHECK(fabs(taAngleScaling-tq.getActiveTorqueAngleCurveAngleScaling()) <TOL);
 }
 
+TEST(calcJointTorqueBatchTests){
+
+    SubjectInformation subjectInfo;
+      subjectInfo.gender          = GenderSet::Male;
+      subjectInfo.ageGroup        = AgeGroupSet::Young18To25;
+      subjectInfo.heightInMeters  =  1.732;
+      subjectInfo.massInKg        = 69.0;
+
+    std::vector< Millard2016TorqueMuscle > muscles;
+    muscles.push_back(Millard2016TorqueMuscle(DataSet::Anderson2007,
+                                              subjectInfo,
+                                              Anderson2007::HipExtension,
+                                              0.0, 1.0, 1.0,
+                                              "hipExtension"));
+    muscles.push_back(Millard2016TorqueMuscle(DataSet::Anderson2007,
+                                              subjectInfo,
+                                              Anderson2007::KneeFlexion,
+                                              0.0, -1.0, -1.0,
+                                              "kneeFlexion"));
+    muscles.push_back(Millard2016TorqueMuscle(DataSet::Gymnast,
+                                              subjectInfo,
+                                              Gymnast::ShoulderFlexion,
+                                              0.0, 1.0, 1.0,
+                                              "shoulderFlexion"));
+
+    unsigned int numberOfSamples = 57;
+    RigidBodyDynamics::Math::MatrixNd angles(muscles.size(), numberOfSamples);
+    RigidBodyDynamics::Math::MatrixNd velocities(muscles.size(),
+                                                 numberOfSamples);
+    RigidBodyDynamics::Math::MatrixNd activations(muscles.size(),
+                                                  numberOfSamples);
+    for(unsigned int j=0; j<numberOfSamples; ++j){
+      double s = double(j)/double(numberOfSamples-1);
+      for(unsigned int i=0; i<muscles.size(); ++i){
+        angles(i,j)      = -0.5 + 2.0*s + 0.1*i;
+        velocities(i,j)  = -2.0 + 4.0*s;
+        activations(i,j) = s;
+      }
+    }
+
+    RigidBodyDynamics::Math::MatrixNd torques;
+    RigidBodyDynamics::Math::MatrixNd torquesThreaded;
+    Millard2016TorqueMuscle::calcJointTorqueBatch(muscles, angles, velocities,
+                                                  activations, torques);
+    Millard2016TorqueMuscle::calcJointTorqueBatch(muscles, angles, velocities,
+                                                  activations, torquesThreaded,
+                                                  0);
+
+    CHECK_EQUAL(muscles.size(), (size_t) torques.rows());
+    CHECK_EQUAL(numberOfSamples, (unsigned int) torques.cols());
+
+    TorqueMuscleSummary tms;
+    for(unsigned int i=0; i<muscles.size(); ++i){
+      for(unsigned int j=0; j<numberOfSamples; ++j){
+        double tau = muscles[i].calcJointTorque(angles(i,j), velocities(i,j),
+                                                activations(i,j));
+        double tauSummary = muscles[i].calcJointTorque(angles(i,j),
+                                                       velocities(i,j),
+                                                       activations(i,j),
+                                                       tms);
+        CHECK_EQUAL(tau, tauSummary);
+        CHECK_EQUAL(tau, tms.jointTorque);
+        CHECK_EQUAL(tau, torques(i,j));
+        CHECK_EQUAL(tau, torquesThreaded(i,j));
+      }
+    }
+
+    RigidBodyDynamics::Math::MatrixNd wrongSize(muscles.size()+1,
+                                                numberOfSamples);
+    CHECK_THROW(Millard2016TorqueMuscle::calcJointTorqueBatch(muscles,
+                  wrongSize, velocities, activations, torques),
+                RigidBodyDynamics::Errors::RBDLSizeMismatchError);
+
+    //A default constructed muscle has no curves and cannot be evaluated
+    muscles.push_back(Millard2016TorqueMuscle());
+    angles.conservativeResize(muscles.size(), numberOfSamples);
+    velocities.conservativeResize(muscles.size(), numberOfSamples);
+    activations.conservativeResize(muscles.size(), numberOfSamples);
+    CHECK_THROW(Millard2016TorqueMuscle::calcJointTorqueBatch(muscles,
+                  angles, velocities, activations, torques),
+                RigidBodyDynamics::Errors::RBDLError);
+}
+
 TEST(dampingTermTests){
 
   double err = 0.;
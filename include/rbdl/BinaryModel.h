@@ -0,0 +1,102 @@
+/*
+ * RBDL - Rigid Body Dynamics Library
+ * Copyright (c) 2011-2018 Martin Felis <martin@fysx.org>
+ *
+ * Licensed under the zlib license. See LICENSE for more details.
+ */
+
+#ifndef RBDL_BINARY_MODEL_H
+#define RBDL_BINARY_MODEL_H
+
+#include <cstddef>
+#include <vector>
+#include <rbdl/rbdl_config.h>
+
+namespace RigidBodyDynamics {
+
+struct Model;
+
+/** \page binary_model_page Binary Models
+ *
+ * Models that were built from a Lua or URDF file (or by code) can be
+ * stored in a compact binary file. Loading such a file does not run any
+ * parser: the file is mapped into memory (where supported, otherwise
+ * read as a whole) and the model is rebuilt directly from fixed-size
+ * records. This is intended for applications that load many models at
+ * startup. The utilities rbdl_luamodel_util and rbdl_urdfreader_util
+ * convert existing models with the option --binary <file>.
+ *
+ * The file contains (all values in the byte order of the writing machine,
+ * which is checked when reading):
+ *   - a header with the magic string "RBDLBIN", the format version, the
+ *     number of bodies, the number of fixed bodies, and the gravity,
+ *   - one record per movable body (including the root) with the id of
+ *     the parent, the joint frame, the joint type and axes, the mass,
+ *     center of mass, inertia, and the offset of its name,
+ *   - one record per fixed body with its movable parent, its transform,
+ *     its mass, center of mass, inertia, and the offset of its name,
+ *   - the names of all bodies.
+ *
+ * The bodies are stored as they appear in the model, i.e. multi-DoF
+ * joints are stored as the chain of virtual bodies that emulates them
+ * and the masses of fixed bodies are already merged into their movable
+ * parents. Loading therefore restores a model with identical body ids,
+ * degrees of freedom, and names.
+ *
+ * \note Models with a CustomJoint cannot be stored as their joints are
+ * defined by code.
+ */
+
+/** \brief Version of the binary model format that is written by
+ * BinaryModelWriteToBuffer() */
+const unsigned int BinaryModelFormatVersion = 1;
+
+/** \brief Serializes a model into the binary model format
+ *
+ * \param model the model that is stored
+ * \param buffer (output) contains the binary model afterwards
+ *
+ * Throws an Errors::RBDLError if the model contains a CustomJoint.
+ */
+RBDL_DLLAPI void BinaryModelWriteToBuffer (
+    const Model &model,
+    std::vector<char> &buffer);
+
+/** \brief Writes a model in the binary model format to a file
+ *
+ * Throws an Errors::RBDLInvalidFileError if the file cannot be written.
+ */
+RBDL_DLLAPI void BinaryModelWriteToFile (
+    const Model &model,
+    const char *filename);
+
+/** \brief Builds a model from the binary model format
+ *
+ * \param buffer the binary model
+ * \param size size of buffer in bytes
+ * \param model (output) the model that is built. It must not contain any
+ * bodies yet.
+ *
+ * Throws an Errors::RBDLFileParseError if the buffer is not a valid
+ * binary model of a supported version.
+ */
+RBDL_DLLAPI void BinaryModelReadFromBuffer (
+    const char *buffer,
+    size_t size,
+    Model *model);
+
+/** \brief Builds a model from a file in the binary model format
+ *
+ * On POSIX systems the file is memory mapped, otherwise it is read into
+ * memory. See BinaryModelReadFromBuffer() for details.
+ *
+ * Throws an Errors::RBDLInvalidFileError if the file cannot be opened.
+ */
+RBDL_DLLAPI void BinaryModelReadFromFile (
+    const char *filename,
+    Model *model);
+
+}
+
+/* RBDL_BINARY_MODEL_H */
+#endif
@@ -143,6 +143,22 @@ public:
                                 ConstraintCache &cache,
                                 bool updateKinematics=false) override;
 
+  /**
+    @brief Fills the rows of this constraint in the system Jacobian from an
+            already evaluated point Jacobian of the contact point, e.g. one
+            computed by CalcPointJacobians() for all contacts at once.
+
+    @param pointJacobians: a matrix that holds the 3 x N point Jacobian of
+            the contact point in the rows pointJacobianRow to
+            pointJacobianRow + 2
+    @param pointJacobianRow: the first row of the point Jacobian
+    @param GSysUpd: the system's constraint Jacobian
+  */
+  void calcConstraintJacobianFromPointJacobian(
+                                const Math::MatrixNd &pointJacobians,
+                                unsigned int pointJacobianRow,
+                                Math::MatrixNd &GSysUpd);
+
   void calcGamma( Model &model,
                   const double time,
                   const Math::VectorNd &Q,
@@ -201,6 +217,24 @@ public:
   void appendNormalVector(const Math::Vector3d &normal,
                           bool velocityLevelConstraint=true);
 
+  /**
+    @brief Sets the Coulomb friction coefficient of this contact. It is only
+            used by ForwardDynamicsContactsPGS, which treats the first normal
+            vector as the unilateral contact normal and the remaining ones as
+            the friction directions.
+
+    @param frictionCoefficient the non-negative friction coefficient. The
+            default of infinity results in sticking contact.
+  */
+  void setFrictionCoefficient(double frictionCoefficient);
+
+  /**
+    @return the Coulomb friction coefficient of this contact
+  */
+  double getFrictionCoefficient() const {
+    return frictionCoefficient;
+  }
+
   /*** @brief Added to support ForwardDynamicsKokkevis
 
     @param model: the multibody model
@@ -268,6 +302,8 @@ private:
   std::vector< Math::Vector3d > T;
   ///The location of the ground reference point
   Math::Vector3d groundPoint;
+  ///The Coulomb friction coefficient used by ForwardDynamicsContactsPGS
+  double frictionCoefficient;
   ///A working double 
   double dblA;
 
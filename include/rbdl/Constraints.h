@@ -691,6 +691,21 @@ struct RBDL_DLLAPI ConstraintSet {
                                 baumgartePositionVelocityCoefficientsOutput);
   }
 
+  /**
+     @brief Sets the Coulomb friction coefficient of a contact constraint
+            that is used by ForwardDynamicsContactsPGS.
+
+     @param groupIndex: the index number of this constraint (see getGroupIndex
+            index functions)
+     @param frictionCoefficient: the non-negative friction coefficient
+
+     \note Throws an Errors::RBDLError if the constraint is not a
+           ContactConstraint.
+  */
+  void setFrictionCoefficient(
+      unsigned int groupIndex,
+      double frictionCoefficient);
+
   /** @brief Adds a single contact constraint (point-ground) to the
       constraint set.
 
@@ -803,6 +818,12 @@ struct RBDL_DLLAPI ConstraintSet {
   }
 
   /** \brief Specifies which method should be used for solving undelying linear systems.
+   *
+   * \note For the direct methods (ForwardDynamicsConstraintsDirect() and
+   * ComputeConstraintImpulsesDirect()) Math::LinearSolverLLT selects the
+   * Schur complement method: it uses the Cholesky decomposition of the
+   * joint space inertia matrix and therefore requires a constraint Jacobian
+   * with full row rank.
    */
   void SetSolver (Math::LinearSolver solver) {
     linear_solver = solver;
@@ -917,12 +938,32 @@ struct RBDL_DLLAPI ConstraintSet {
   Math::VectorNd b;
   /// Workspace for the Lagrangian solution.
   Math::VectorNd x;
+  /// Workspace for the decomposition of the Lagrangian left-hand-side matrix.
+  Math::LinearSolverWorkspace A_solver;
+  /// The solver of the last decomposition of the Lagrangian left-hand-side
+  /// matrix that is still valid (LinearSolverUnknown if there is none). The
+  /// direct methods reuse it while H and G do not change.
+  Math::LinearSolver A_factorized_solver;
+  /// Workspace for the Cholesky decomposition of H (Schur complement method)
+  Eigen::LLT<Math::MatrixNd> H_llt;
+  /// Workspace for L^-1 G^T where H = L L^T (Schur complement method)
+  Math::MatrixNd schur_Y;
+  /// Workspace for the Schur complement G H^-1 G^T and its decomposition
+  Math::MatrixNd schur_K;
+  Eigen::LLT<Math::MatrixNd> schur_K_llt;
+  /// Workspace for the right-hand-side of the constrained system.
+  Math::VectorNd rhs;
 
   /// Selection matrix for the actuated parts of the model needed
   /// for the inverse-dynamics-with-constraints operator
   Math::MatrixNd S;
   /// Selection matrix for the non-actuated parts of the model
   Math::MatrixNd P;
+  /// Indices of the actuated degrees of freedom (the non-zero columns of S)
+  std::vector<unsigned int> actuatedDofIndices;
+  /// Indices of the non-actuated degrees of freedom (the non-zero columns
+  /// of P)
+  std::vector<unsigned int> unactuatedDofIndices;
   /// Matrix that holds the relative cost of deviating from the desired
   /// accelerations
   Math::MatrixNd W;
@@ -953,10 +994,26 @@ struct RBDL_DLLAPI ConstraintSet {
   Math::MatrixNd R;  
   Math::VectorNd qddot_y;
   Math::VectorNd qddot_z;
+  /// Workspace for G * Y and its decomposition (null-space method)
+  Math::MatrixNd GY;
+  Math::LinearSolverWorkspace GY_solver;
+  /// Workspace for H * Z (null-space method)
+  Math::MatrixNd HZ;
+  /// Workspace for Z^T * H * Z and its decomposition (null-space method)
+  Math::MatrixNd ZTHZ;
+  Eigen::LLT<Math::MatrixNd> ZTHZ_llt;
+  /// Temporary vectors of the solvers of size dof_count, size(), and
+  /// dof_count - size()
+  Math::VectorNd tmp_qdot_a;
+  Math::VectorNd tmp_qdot_b;
+  Math::VectorNd tmp_lambda;
+  Math::VectorNd tmp_z;
 
   // Variables used by the IABI methods
   /// Workspace for the Inverse Articulated-Body Inertia.
   Math::MatrixNd K;
+  /// Workspace for the decomposition of K
+  Math::LinearSolverWorkspace K_solver;
   /// Workspace for the accelerations of due to the test forces
   Math::VectorNd a;
   /// Workspace for the test accelerations.
@@ -985,6 +1042,14 @@ struct RBDL_DLLAPI ConstraintSet {
 
   std::vector<Math::Vector3d> d_multdof3_u;
 
+  /// Body ids of the contact points of all contact constraints (used to
+  /// evaluate their point Jacobians with CalcPointJacobians()).
+  std::vector<unsigned int> contactBodyIds;
+  /// Body-local positions of the contact points of all contact constraints
+  std::vector<Math::Vector3d> contactBodyPoints;
+  /// Workspace for the stacked point Jacobians of the contact points
+  Math::MatrixNd contactPointJacobians;
+
   ConstraintCache cache;
 
 
@@ -1291,6 +1356,54 @@ void ForwardDynamicsContactsKokkevis (
   Math::VectorNd &QDDotOutput
 );
 
+/** \brief Computes forward dynamics with unilateral, frictional contacts
+ *  using a projected Gauss-Seidel solver.
+ *
+ * In contrast to ForwardDynamicsContactsKokkevis() which treats all contacts
+ * as bilateral constraints, this function solves the complementarity problem
+ * of unilateral contacts with Coulomb friction: the first normal vector of
+ * each ContactConstraint is the contact normal whose force may only push
+ * (\f$\lambda_n \geq 0\f$) and the remaining normal vectors are the tangential
+ * directions whose forces are limited to the friction cone
+ * \f$\|\lambda_t\| \leq \mu \lambda_n\f$. The friction coefficient \f$\mu\f$
+ * is set with ConstraintSet::setFrictionCoefficient() and defaults to infinity
+ * (sticking contact).
+ *
+ * The operator \f$K\f$ that relates the contact forces to the contact point
+ * accelerations is built in the same way as in
+ * ForwardDynamicsContactsKokkevis() and then reused for all Gauss-Seidel
+ * sweeps. The solver is warm-started from the forces stored in
+ * ConstraintSet::force, e.g. the forces of the previous time step.
+ *
+ * \param model rigid body model
+ * \param Q     state vector of the internal joints
+ * \param QDot  velocity vector of the internal joints
+ * \param Tau   actuations of the internal joints
+ * \param CS a list of all contact points
+ * \param QDDotOutput accelerations of the internals joints
+ * \param max_iterations the maximum number of Gauss-Seidel sweeps
+ * \param tolerance the sweeps stop once no contact force changed by more
+ *        than this value
+ *
+ * \returns the number of Gauss-Seidel sweeps that were performed
+ *
+ * \note On return ConstraintSet::force contains the contact forces along the
+ * normal vectors of the contacts.
+ *
+ * \note This function supports only contact constraints.
+ */
+RBDL_DLLAPI
+unsigned int ForwardDynamicsContactsPGS (
+  Model &model,
+  const Math::VectorNd &Q,
+  const Math::VectorNd &QDot,
+  const Math::VectorNd &Tau,
+  ConstraintSet &CS,
+  Math::VectorNd &QDDotOutput,
+  unsigned int max_iterations = 100,
+  double tolerance = 1.0e-12
+);
+
 
 
 /**
@@ -1710,6 +1823,61 @@ void InverseDynamicsConstraints(
     Math::VectorNd &TauOutput,
     std::vector<Math::SpatialVector> *f_ext  = NULL);
 
+/**
+ \brief Computes the same solution as
+        RigidBodyDynamics::InverseDynamicsConstraints without forming the
+        joint space inertia matrix.
+
+ \par
+  The accelerations of the non-actuated degrees of freedom \f$v\f$ only
+  depend on the constraint Jacobian and \f$\gamma\f$. Once \f$\ddot{q}\f$
+  is known the remaining equations of RigidBodyDynamics::InverseDynamicsConstraints
+  only require \f$H\ddot{q} + C\f$, which is evaluated by the recursive
+  Newton-Euler algorithm (RigidBodyDynamics::InverseDynamics):
+  \f[
+    \begin{array}{rcl}
+      GP^T v &=& \gamma - GS^T u \\
+      PG^T \lambda &=& P(H\ddot{q} + C) \\
+      \tau &=& S^TS(H\ddot{q} + C - G^T \lambda)
+    \end{array}
+  \f]
+  with \f$u = S\ddot{q}^*\f$ and \f$\ddot{q} = S^Tu + P^Tv\f$. Apart from
+  the two linear systems of size \f$(c \times u)\f$ and \f$(u \times c)\f$
+  the cost is linear in the number of degrees of freedom and the number of
+  constraints, whereas RigidBodyDynamics::InverseDynamicsConstraints is
+  cubic in the number of degrees of freedom.
+
+ \note The same requirements as for
+       RigidBodyDynamics::InverseDynamicsConstraints apply. Unlike that
+       function this one does not update ConstraintSet::H,
+       ConstraintSet::C and the blocks of the projected system.
+
+ \param model: rigid body model
+ \param Q:     N-element vector of generalized positions
+ \param QDot:  N-element vector of generalized velocities
+ \param QDDotDesired:  N-element vector of desired generalized accelerations
+ \param CS: Structure that contains information about the set of kinematic
+            constraints. Note that the 'force' vector is appropriately updated
+            after this function is called so that it contains the Lagrange
+            multipliers.
+ \param QDDotOutput:  N-element vector of generalized accelerations which
+                      satisfy the kinematic constraints
+ \param TauOutput: N-element vector of generalized forces which satisfy the
+                   the equations of motion for this constrained system.
+ \param f_ext External forces acting on the body in base coordinates
+        (optional, defaults to NULL)
+*/
+RBDL_DLLAPI
+void InverseDynamicsConstraintsRecursive(
+    Model &model,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &QDDotDesired,
+    ConstraintSet &CS,
+    Math::VectorNd &QDDotOutput,
+    Math::VectorNd &TauOutput,
+    std::vector<Math::SpatialVector> *f_ext  = NULL);
+
 /**
   \brief A method to evaluate if the constrained system is fully actuated.
 
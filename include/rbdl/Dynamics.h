@@ -19,6 +19,7 @@
 namespace RigidBodyDynamics {
 
 struct Model;
+struct ModelData;
 
 /** \page dynamics_page Dynamics
  *
@@ -51,6 +52,22 @@ RBDL_DLLAPI void InverseDynamics (
     std::vector<Math::SpatialVector> *f_ext = NULL
     );
 
+/** \brief Computes inverse dynamics with the Newton-Euler Algorithm using
+ * separate ModelData
+ *
+ * Same as InverseDynamics() but all temporary values are stored in data
+ * such that the model can be shared between threads.
+ */
+RBDL_DLLAPI void InverseDynamics (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &QDDot,
+    Math::VectorNd &Tau,
+    std::vector<Math::SpatialVector> *f_ext = NULL
+    );
+
 /** \brief Computes the coriolis forces
  *
  * This function computes the generalized forces from given generalized
@@ -71,6 +88,19 @@ RBDL_DLLAPI void NonlinearEffects (
     std::vector<Math::SpatialVector> *f_ext = NULL
     );
 
+/** \brief Computes the coriolis forces using separate ModelData
+ *
+ * Same as NonlinearEffects() but all temporary values are stored in data.
+ */
+RBDL_DLLAPI void NonlinearEffects (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    Math::VectorNd &Tau,
+    std::vector<Math::SpatialVector> *f_ext = NULL
+    );
+
 /** \brief Computes the joint space inertia matrix by using the Composite Rigid Body Algorithm
  *
  * This function computes the joint space inertia matrix from a given model and
@@ -93,6 +123,53 @@ RBDL_DLLAPI void CompositeRigidBodyAlgorithm (
     bool update_kinematics = true
     );
 
+/** \brief Computes the joint space inertia matrix using separate ModelData
+ *
+ * Same as CompositeRigidBodyAlgorithm() but all temporary values are
+ * stored in data.
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithm (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    Math::MatrixNd &H,
+    bool update_kinematics = true
+    );
+
+/** \brief Computes the joint space inertia matrix in sparse storage
+ *
+ * Same as CompositeRigidBodyAlgorithm() but only the entries along the
+ * ancestor chains of the degrees of freedom are computed and stored in H
+ * (see Math::SparseJointSpaceMatrix). The result can be factorized with
+ * Math::SparseFactorizeLTL().
+ *
+ * \param model rigid body model
+ * \param Q     state vector of the model
+ * \param H     sparse matrix where the result will be stored in. Its
+ *              structure is initialized if it does not match the model.
+ * \param update_kinematics  whether the kinematics should be updated (safer, but at a higher computational cost!)
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmSparse (
+    Model& model,
+    const Math::VectorNd &Q,
+    Math::SparseJointSpaceMatrix &H,
+    bool update_kinematics = true
+    );
+
+/** \brief Computes the sparse joint space inertia matrix using separate
+ * ModelData
+ *
+ * Same as CompositeRigidBodyAlgorithmSparse() but all temporary values
+ * are stored in data.
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmSparse (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    Math::SparseJointSpaceMatrix &H,
+    bool update_kinematics = true
+    );
+
 /** \brief Computes forward dynamics with the Articulated Body Algorithm
  *
  * This function computes the generalized accelerations from given
@@ -117,6 +194,22 @@ RBDL_DLLAPI void ForwardDynamics (
     std::vector<Math::SpatialVector> *f_ext = NULL
     );
 
+/** \brief Computes forward dynamics with the Articulated Body Algorithm
+ * using separate ModelData
+ *
+ * Same as ForwardDynamics() but all temporary values are stored in data
+ * such that the model can be shared between threads.
+ */
+RBDL_DLLAPI void ForwardDynamics (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    std::vector<Math::SpatialVector> *f_ext = NULL
+    );
+
 /** \brief Computes forward dynamics by building and solving the full Lagrangian equation
  *
  * This method builds and solves the linear system
@@ -147,6 +240,25 @@ RBDL_DLLAPI void ForwardDynamicsLagrangian (
     Math::VectorNd *C = NULL	
     );
 
+/** \brief Computes forward dynamics by building and solving the full
+ * Lagrangian equation using separate ModelData
+ *
+ * Same as ForwardDynamicsLagrangian() but all temporary values are stored
+ * in data.
+ */
+RBDL_DLLAPI void ForwardDynamicsLagrangian (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    Math::LinearSolver linear_solver = Math::LinearSolverColPivHouseholderQR,
+    std::vector<Math::SpatialVector> *f_ext = NULL,
+    Math::MatrixNd *H = NULL,
+    Math::VectorNd *C = NULL
+    );
+
 /** \brief Computes the effect of multiplying the inverse of the joint
  * space inertia matrix with a vector in linear time.
  *
@@ -176,6 +288,378 @@ RBDL_DLLAPI void CalcMInvTimesTau (
     bool update_kinematics=true
     );
 
+/** \brief Computes the effect of multiplying the inverse of the joint
+ * space inertia matrix with a vector using separate ModelData
+ *
+ * Same as CalcMInvTimesTau() but all temporary values are stored in data.
+ * When update_kinematics is false the articulated body inertias of a
+ * previous call with the same data are reused.
+ */
+RBDL_DLLAPI void CalcMInvTimesTau (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    bool update_kinematics=true
+    );
+
+/** \brief Computes forward dynamics for multiple states at once
+ *
+ * Evaluates ForwardDynamics() for each column of the given matrices. Each
+ * column of Qs, QDots, and Taus describes a single state of the model and
+ * the resulting accelerations are stored in the corresponding column of
+ * QDDots.
+ *
+ * The states can be distributed over multiple threads where each thread
+ * uses its own ModelData. The model itself is not modified.
+ *
+ * \param model  rigid body model
+ * \param Qs     matrix of size q_size x N of generalized positions
+ * \param QDots  matrix of size qdot_size x N of generalized velocities
+ * \param Taus   matrix of size qdot_size x N of generalized forces
+ * \param QDDots matrix of size qdot_size x N where the accelerations are
+ *               stored in (output, resized if necessary)
+ * \param num_threads number of threads that are used. A value of 0 uses
+ *               all available hardware threads (default: 1).
+ *
+ * \note Models with a CustomJoint are not supported.
+ */
+RBDL_DLLAPI void ForwardDynamicsBatch (
+    const Model &model,
+    const Math::MatrixNd &Qs,
+    const Math::MatrixNd &QDots,
+    const Math::MatrixNd &Taus,
+    Math::MatrixNd &QDDots,
+    unsigned int num_threads = 1
+    );
+
+/** \brief Computes inverse dynamics for multiple states at once
+ *
+ * Evaluates InverseDynamics() for each column of the given matrices. See
+ * ForwardDynamicsBatch() for details on the layout and threading.
+ *
+ * \param model  rigid body model
+ * \param Qs     matrix of size q_size x N of generalized positions
+ * \param QDots  matrix of size qdot_size x N of generalized velocities
+ * \param QDDots matrix of size qdot_size x N of generalized accelerations
+ * \param Taus   matrix of size qdot_size x N where the generalized forces
+ *               are stored in (output, resized if necessary)
+ * \param num_threads number of threads that are used. A value of 0 uses
+ *               all available hardware threads (default: 1).
+ */
+RBDL_DLLAPI void InverseDynamicsBatch (
+    const Model &model,
+    const Math::MatrixNd &Qs,
+    const Math::MatrixNd &QDots,
+    const Math::MatrixNd &QDDots,
+    Math::MatrixNd &Taus,
+    unsigned int num_threads = 1
+    );
+
+/** \brief Computes the joint space inertia matrix for multiple states at
+ * once
+ *
+ * Evaluates CompositeRigidBodyAlgorithm() for each column of Qs. The
+ * joint space inertia matrix of state k is stored in the columns
+ * k * dof_count ... (k + 1) * dof_count - 1 of Hs.
+ *
+ * \param model  rigid body model
+ * \param Qs     matrix of size q_size x N of generalized positions
+ * \param Hs     matrix of size dof_count x (dof_count * N) where the
+ *               results are stored in (output, resized if necessary)
+ * \param num_threads number of threads that are used. A value of 0 uses
+ *               all available hardware threads (default: 1).
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmBatch (
+    const Model &model,
+    const Math::MatrixNd &Qs,
+    Math::MatrixNd &Hs,
+    unsigned int num_threads = 1
+    );
+
+class ThreadPool;
+
+/** \brief Decomposition of a model into independent subtrees that are
+ * evaluated concurrently by ForwardDynamicsParallel() and
+ * CompositeRigidBodyAlgorithmParallel()
+ *
+ * Starting at the children of the root body the largest subtree is
+ * repeatedly split into the subtrees of its children until each subtree
+ * contains at most 1 / num_threads of all bodies. The roots of split
+ * subtrees form the trunk of the model which is evaluated on the calling
+ * thread while the subtrees are distributed dynamically over the threads,
+ * largest first. Subtrees only have to be synchronized where they are
+ * attached to the trunk.
+ *
+ * The schedule owns the worker threads which are kept alive between calls
+ * such that a single evaluation of a large model (e.g. hands, multi-robot
+ * scenes) has a lower latency. A schedule must only be used by one
+ * thread at a time.
+ */
+struct RBDL_DLLAPI SubtreeSchedule {
+  /** \brief Creates the schedule for model
+   *
+   * \param model       rigid body model
+   * \param num_threads number of threads including the calling thread. A
+   *                    value of 0 uses all available hardware threads.
+   */
+  SubtreeSchedule (const Model &model, unsigned int num_threads = 0);
+  ~SubtreeSchedule ();
+
+  /// \brief Number of threads including the calling thread
+  unsigned int num_threads;
+  /// \brief Number of bodies of the model the schedule was created for
+  unsigned int body_count;
+  /// \brief Bodies that are evaluated on the calling thread (ascending)
+  std::vector<unsigned int> trunk;
+  /// \brief Root body of each subtree, largest subtree first
+  std::vector<unsigned int> subtree_root;
+  /** \brief The bodies of subtree k are stored (ascending) in
+   * subtree_bodies[subtree_start[k]] ... subtree_bodies[subtree_start[k +
+   * 1] - 1] */
+  std::vector<unsigned int> subtree_start;
+  /// \brief Bodies of all subtrees
+  std::vector<unsigned int> subtree_bodies;
+  /// \brief Worker threads
+  ThreadPool *thread_pool;
+
+private:
+  SubtreeSchedule (const SubtreeSchedule &);
+  SubtreeSchedule& operator= (const SubtreeSchedule &);
+};
+
+/** \brief Computes forward dynamics with the Articulated Body Algorithm
+ * where independent subtrees are evaluated concurrently
+ *
+ * Same as ForwardDynamics() but the bodies of the subtrees of schedule are
+ * evaluated on its worker threads. If the schedule has less than two
+ * subtrees (e.g. a single thread or a serial chain) ForwardDynamics() is
+ * called.
+ *
+ * \param model    rigid body model
+ * \param schedule subtree decomposition of model
+ * \param Q        state vector of the internal joints
+ * \param QDot     velocity vector of the internal joints
+ * \param Tau      actuations of the internal joints
+ * \param QDDot    accelerations of the internal joints (output)
+ * \param f_ext    External forces acting on the body in base coordinates (optional, defaults to NULL)
+ */
+RBDL_DLLAPI void ForwardDynamicsParallel (
+    Model &model,
+    SubtreeSchedule &schedule,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    std::vector<Math::SpatialVector> *f_ext = NULL
+    );
+
+/** \brief Computes forward dynamics with concurrently evaluated subtrees
+ * using separate ModelData
+ *
+ * Same as ForwardDynamicsParallel() but all temporary values are stored in
+ * data.
+ */
+RBDL_DLLAPI void ForwardDynamicsParallel (
+    const Model &model,
+    ModelData &data,
+    SubtreeSchedule &schedule,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    std::vector<Math::SpatialVector> *f_ext = NULL
+    );
+
+/** \brief Computes the joint space inertia matrix where independent
+ * subtrees are evaluated concurrently
+ *
+ * Same as CompositeRigidBodyAlgorithm() but the bodies of the subtrees of
+ * schedule are evaluated on its worker threads.
+ *
+ * \param model    rigid body model
+ * \param schedule subtree decomposition of model
+ * \param Q        state vector of the model
+ * \param H        a matrix where the result will be stored in
+ * \param update_kinematics  whether the kinematics should be updated (safer, but at a higher computational cost!)
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmParallel (
+    Model &model,
+    SubtreeSchedule &schedule,
+    const Math::VectorNd &Q,
+    Math::MatrixNd &H,
+    bool update_kinematics = true
+    );
+
+/** \brief Computes the joint space inertia matrix with concurrently
+ * evaluated subtrees using separate ModelData
+ *
+ * Same as CompositeRigidBodyAlgorithmParallel() but all temporary values
+ * are stored in data.
+ */
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmParallel (
+    const Model &model,
+    ModelData &data,
+    SubtreeSchedule &schedule,
+    const Math::VectorNd &Q,
+    Math::MatrixNd &H,
+    bool update_kinematics = true
+    );
+
+/** \brief Computes forward dynamics for multiple states in lockstep
+ *
+ * Same as ForwardDynamicsBatch() but instead of evaluating the states one
+ * after another, groups of states are evaluated simultaneously by the
+ * Articulated Body Algorithm. All spatial quantities are stored in
+ * structure-of-arrays layout where each SIMD lane holds the value of one
+ * state. This evaluates 4 states per instruction (8 when compiled with
+ * AVX-512 support) on a single thread.
+ *
+ * \note Only models that consist of revolute and prismatic joints
+ * (which includes multi degree of freedom joints that are emulated by
+ * virtual bodies) are evaluated in lockstep. For all other models the
+ * states are evaluated by ForwardDynamicsBatch() on a single thread.
+ *
+ * \param model  rigid body model
+ * \param Qs     matrix of size q_size x N of generalized positions
+ * \param QDots  matrix of size qdot_size x N of generalized velocities
+ * \param Taus   matrix of size qdot_size x N of generalized forces
+ * \param QDDots matrix of size qdot_size x N where the accelerations are
+ *               stored in (output, resized if necessary)
+ */
+RBDL_DLLAPI void ForwardDynamicsLockstep (
+    const Model &model,
+    const Math::MatrixNd &Qs,
+    const Math::MatrixNd &QDots,
+    const Math::MatrixNd &Taus,
+    Math::MatrixNd &QDDots
+    );
+
+/** \brief Computes inverse dynamics for multiple states in lockstep
+ *
+ * Same as InverseDynamicsBatch() but the Recursive Newton-Euler Algorithm
+ * evaluates groups of states simultaneously. See ForwardDynamicsLockstep()
+ * for details and restrictions.
+ *
+ * \param model  rigid body model
+ * \param Qs     matrix of size q_size x N of generalized positions
+ * \param QDots  matrix of size qdot_size x N of generalized velocities
+ * \param QDDots matrix of size qdot_size x N of generalized accelerations
+ * \param Taus   matrix of size qdot_size x N where the generalized forces
+ *               are stored in (output, resized if necessary)
+ */
+RBDL_DLLAPI void InverseDynamicsLockstep (
+    const Model &model,
+    const Math::MatrixNd &Qs,
+    const Math::MatrixNd &QDots,
+    const Math::MatrixNd &QDDots,
+    Math::MatrixNd &Taus
+    );
+
+/** \brief Computes the partial derivatives of the inverse dynamics
+ *
+ * Evaluates the derivatives of the generalized forces computed by
+ * InverseDynamics() with respect to the generalized positions and
+ * velocities analytically. Each column is obtained by differentiating the
+ * recursions of the Recursive Newton-Euler Algorithm along a single
+ * degree of freedom which only visits the subtree of the joint and its
+ * ancestors. The derivative with respect to QDDot is the joint space
+ * inertia matrix, see CompositeRigidBodyAlgorithm().
+ *
+ * \note Only models that consist of revolute and prismatic joints
+ * (which includes multi degree of freedom joints that are emulated by
+ * virtual bodies) are supported, for all other models an
+ * Errors::RBDLError is thrown. External forces are not supported.
+ *
+ * \param model      rigid body model
+ * \param Q          state vector of the internal joints
+ * \param QDot       velocity vector of the internal joints
+ * \param QDDot      accelerations of the internal joints
+ * \param dTau_dQ    dof_count x dof_count matrix where the derivative of
+ *                   Tau with respect to Q is stored in (output, resized if
+ *                   necessary)
+ * \param dTau_dQDot dof_count x dof_count matrix where the derivative of
+ *                   Tau with respect to QDot is stored in (output, resized
+ *                   if necessary)
+ */
+RBDL_DLLAPI void InverseDynamicsDerivatives (
+    Model &model,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &QDDot,
+    Math::MatrixNd &dTau_dQ,
+    Math::MatrixNd &dTau_dQDot
+    );
+
+/** \brief Computes the partial derivatives of the inverse dynamics using
+ * separate ModelData
+ *
+ * Same as InverseDynamicsDerivatives() but all temporary values are stored
+ * in data.
+ */
+RBDL_DLLAPI void InverseDynamicsDerivatives (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &QDDot,
+    Math::MatrixNd &dTau_dQ,
+    Math::MatrixNd &dTau_dQDot
+    );
+
+/** \brief Computes the forward dynamics and its partial derivatives
+ *
+ * Computes QDDot with ForwardDynamics() and its derivatives with respect
+ * to the generalized positions, velocities, and forces. They follow from
+ * the derivatives of the inverse dynamics:
+ *   \f$ \frac{\partial \ddot{q}}{\partial q} = -H^{-1} \frac{\partial
+ *   \tau}{\partial q}, \quad \frac{\partial \ddot{q}}{\partial \dot{q}} =
+ *   -H^{-1} \frac{\partial \tau}{\partial \dot{q}}, \quad \frac{\partial
+ *   \ddot{q}}{\partial \tau} = H^{-1} \f$
+ * where the derivatives of \f$\tau\f$ are evaluated at the computed
+ * accelerations. See InverseDynamicsDerivatives() for the supported
+ * models.
+ *
+ * \param model        rigid body model
+ * \param Q            state vector of the internal joints
+ * \param QDot         velocity vector of the internal joints
+ * \param Tau          actuations of the internal joints
+ * \param QDDot        accelerations of the internal joints (output)
+ * \param dQDDot_dQ    derivative of QDDot with respect to Q (output)
+ * \param dQDDot_dQDot derivative of QDDot with respect to QDot (output)
+ * \param dQDDot_dTau  derivative of QDDot with respect to Tau, i.e. the
+ *                     inverse of the joint space inertia matrix (output)
+ */
+RBDL_DLLAPI void ForwardDynamicsDerivatives (
+    Model &model,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    Math::MatrixNd &dQDDot_dQ,
+    Math::MatrixNd &dQDDot_dQDot,
+    Math::MatrixNd &dQDDot_dTau
+    );
+
+/** \brief Computes the forward dynamics and its partial derivatives using
+ * separate ModelData
+ *
+ * Same as ForwardDynamicsDerivatives() but all temporary values are stored
+ * in data.
+ */
+RBDL_DLLAPI void ForwardDynamicsDerivatives (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &Tau,
+    Math::VectorNd &QDDot,
+    Math::MatrixNd &dQDDot_dQ,
+    Math::MatrixNd &dQDDot_dQDot,
+    Math::MatrixNd &dQDDot_dTau
+    );
+
 /** @} */
 
 }
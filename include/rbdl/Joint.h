@@ -18,6 +18,7 @@ namespace RigidBodyDynamics
 {
 
 struct Model;
+struct ModelData;
 
 /** \page joint_description Joint Modeling
  *
@@ -718,9 +719,23 @@ void jcalc (
   const Math::VectorNd &qdot
 );
 
+/** \brief Computes all variables for a joint model and stores them in data
+ *
+ * Same as jcalc() but the results are written to the given ModelData
+ * instead of the model itself.
+ */
+RBDL_DLLAPI
+void jcalc (
+  const Model &model,
+  ModelData &data,
+  unsigned int joint_id,
+  const Math::VectorNd &q,
+  const Math::VectorNd &qdot
+);
+
 RBDL_DLLAPI
 Math::SpatialTransform jcalc_XJ (
-  Model &model,
+  const Model &model,
   unsigned int joint_id,
   const Math::VectorNd &q);
 
@@ -731,6 +746,50 @@ void jcalc_X_lambda_S (
   const Math::VectorNd &q
 );
 
+RBDL_DLLAPI
+void jcalc_X_lambda_S (
+  const Model &model,
+  ModelData &data,
+  unsigned int joint_id,
+  const Math::VectorNd &q
+);
+
+/// \brief Joint type specific implementation of jcalc()
+typedef void (*JointCalcFunction) (
+  const Model &model,
+  ModelData &data,
+  unsigned int joint_id,
+  const Math::VectorNd &q,
+  const Math::VectorNd &qdot);
+
+/// \brief Joint type specific implementation of jcalc_X_lambda_S()
+typedef void (*JointCalcXLambdaSFunction) (
+  const Model &model,
+  ModelData &data,
+  unsigned int joint_id,
+  const Math::VectorNd &q);
+
+/** \brief Joint type specific implementations of the joint calculations
+ *
+ * The entries are selected once per joint when the body is added to the
+ * model (see Model::mJointCalcDispatch) such that jcalc() and
+ * jcalc_X_lambda_S() call the implementation of the joint directly instead
+ * of comparing the joint type against all supported types on every call.
+ */
+struct RBDL_DLLAPI JointCalcDispatch {
+  JointCalcFunction jcalc;
+  JointCalcXLambdaSFunction jcalc_X_lambda_S;
+};
+
+/** \brief Selects the implementations of jcalc() and jcalc_X_lambda_S()
+ * for the given joint
+ *
+ * For joints of unsupported types the returned functions throw an
+ * Errors::RBDLError when they are called.
+ */
+RBDL_DLLAPI
+JointCalcDispatch jcalc_dispatch (const Joint &joint);
+
 struct RBDL_DLLAPI CustomJoint {
   CustomJoint()
   { }
@@ -15,6 +15,9 @@
 
 namespace RigidBodyDynamics {
 
+struct Model;
+struct ModelData;
+
 /** \page kinematics_page Kinematics
  * All functions related to kinematics are specified in the \ref
  * kinematics_group "Kinematics Module".
@@ -45,6 +48,15 @@ RBDL_DLLAPI void UpdateKinematics (Model &model,
     const Math::VectorNd &QDDot
     );
 
+/** \brief Same as UpdateKinematics() but operates on the given data
+ */
+RBDL_DLLAPI void UpdateKinematics (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    const Math::VectorNd &QDDot
+    );
+
 /** \brief Selectively updates model internal states of body positions, velocities and/or accelerations.
  *
  * This function updates the kinematic variables such as body velocities and
@@ -65,6 +77,120 @@ RBDL_DLLAPI void UpdateKinematicsCustom (Model &model,
     const Math::VectorNd *QDDot
     );
 
+/** \brief Same as UpdateKinematicsCustom() but operates on the given data
+ */
+RBDL_DLLAPI void UpdateKinematicsCustom (const Model &model,
+    ModelData &data,
+    const Math::VectorNd *Q,
+    const Math::VectorNd *QDot,
+    const Math::VectorNd *QDDot
+    );
+
+/** \brief Incrementally updates body positions, velocities and/or
+ * accelerations.
+ *
+ * Computes the same values as UpdateKinematicsCustom() but only for the
+ * bodies whose values are out of date. The values of Q, QDot, and QDDot
+ * are stored in the model data and compared joint by joint with the ones
+ * of the next call. A body is recomputed if the values of its own joint
+ * changed or if its parent was recomputed, i.e. changing the value of a
+ * single joint only updates the subtree of that joint. Calling it twice
+ * with the same values updates nothing.
+ *
+ * The state of each body is tracked in ModelData::kinematics_cache_state.
+ * Any other algorithm that evaluates the joints on the same data (e.g.
+ * ForwardDynamics() or CompositeRigidBodyAlgorithm()) resets it so the
+ * next call recomputes the affected bodies.
+ *
+ * Setting ModelData::use_kinematics_cache makes UpdateKinematics() and
+ * UpdateKinematicsCustom() call this function. This way all functions
+ * that take an update_kinematics parameter, e.g. CalcPointJacobian() or
+ * CalcBodyToBaseCoordinates(), skip the evaluation of unchanged bodies.
+ *
+ * \param model the model
+ * \param Q     the positional variables of the model (may be NULL if QDot
+ *              is NULL)
+ * \param QDot  the generalized velocities of the joints
+ * \param QDDot the generalized accelerations of the joints
+ *
+ * \note Accelerations are only updated for bodies with up to date
+ * velocities. Velocities become out of date if Q changes but QDot is NULL.
+ */
+RBDL_DLLAPI void UpdateKinematicsCached (Model &model,
+    const Math::VectorNd *Q,
+    const Math::VectorNd *QDot,
+    const Math::VectorNd *QDDot
+    );
+
+/** \brief Same as UpdateKinematicsCached() but operates on the given data
+ */
+RBDL_DLLAPI void UpdateKinematicsCached (const Model &model,
+    ModelData &data,
+    const Math::VectorNd *Q,
+    const Math::VectorNd *QDot,
+    const Math::VectorNd *QDDot
+    );
+
+/** \brief Updates the body positions on the path from the root to a
+ * single body.
+ *
+ * Only evaluates the joints of the ancestors of body_id (and of body_id
+ * itself) instead of all joints of the model. Afterwards all functions
+ * that only depend on the position of body_id can be called with
+ * update_kinematics = false, e.g. CalcBodyToBaseCoordinates(),
+ * CalcBaseToBodyCoordinates(), CalcBodyWorldOrientation(),
+ * CalcPointJacobian(), CalcPointJacobian6D(), and
+ * CalcBodySpatialJacobian():
+ *
+ * \code
+ * UpdateKinematicsChain (model, Q, hand_id);
+ * Vector3d position = CalcBodyToBaseCoordinates (model, Q, hand_id,
+ *     point, false);
+ * CalcPointJacobian (model, Q, hand_id, point, G, false);
+ * \endcode
+ *
+ * For an end-effector of a 7 DoF arm that is part of a model with 50
+ * bodies only 7 joints are evaluated.
+ *
+ * \param model the model
+ * \param Q     the positional variables of the model
+ * \param body_id the (movable or fixed) body whose position is needed
+ *
+ * \note The positions of all bodies that are not on the path are left
+ * unchanged and therefore do not match Q.
+ */
+RBDL_DLLAPI void UpdateKinematicsChain (Model &model,
+    const Math::VectorNd &Q,
+    unsigned int body_id
+    );
+
+/** \brief Same as UpdateKinematicsChain() but operates on the given data
+ */
+RBDL_DLLAPI void UpdateKinematicsChain (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id
+    );
+
+/** \brief Updates the body positions on the paths from the root to
+ * multiple bodies, see UpdateKinematicsChain().
+ *
+ * \note Joints that are shared by multiple paths are evaluated once for
+ * each of the bodies.
+ */
+RBDL_DLLAPI void UpdateKinematicsChain (Model &model,
+    const Math::VectorNd &Q,
+    const std::vector<unsigned int> &body_ids
+    );
+
+/** \brief Same as UpdateKinematicsChain() but operates on the given data
+ */
+RBDL_DLLAPI void UpdateKinematicsChain (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const std::vector<unsigned int> &body_ids
+    );
+
 /** \brief Returns the base coordinates of a point given in body coordinates.
  *
  * \param model the rigid body model
@@ -83,6 +209,16 @@ RBDL_DLLAPI Math::Vector3d CalcBodyToBaseCoordinates (
     const Math::Vector3d &body_point_position,
     bool update_kinematics = true);
 
+/** \brief Same as CalcBodyToBaseCoordinates() but operates on the given data
+ */
+RBDL_DLLAPI Math::Vector3d CalcBodyToBaseCoordinates (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id,
+    const Math::Vector3d &body_point_position,
+    bool update_kinematics = true);
+
 /** \brief Returns the body coordinates of a point given in base coordinates.
  *
  * \param model the rigid body model
@@ -101,6 +237,16 @@ RBDL_DLLAPI Math::Vector3d CalcBaseToBodyCoordinates (
     const Math::Vector3d &base_point_position,
     bool update_kinematics = true);
 
+/** \brief Same as CalcBaseToBodyCoordinates() but operates on the given data
+ */
+RBDL_DLLAPI Math::Vector3d CalcBaseToBodyCoordinates (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id,
+    const Math::Vector3d &base_point_position,
+    bool update_kinematics = true);
+
 /** \brief Returns the orientation of a given body as 3x3 matrix
  *
  * \param model the rigid body model
@@ -118,6 +264,15 @@ RBDL_DLLAPI Math::Matrix3d CalcBodyWorldOrientation (
     const unsigned int body_id,
     bool update_kinematics = true);
 
+/** \brief Same as CalcBodyWorldOrientation() but operates on the given data
+ */
+RBDL_DLLAPI Math::Matrix3d CalcBodyWorldOrientation (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const unsigned int body_id,
+    bool update_kinematics = true);
+
 /** \brief Computes the point jacobian for a point on a body
  *
  * If a position of a point is computed by a function \f$g(q(t))\f$ for which its
@@ -146,6 +301,56 @@ RBDL_DLLAPI void CalcPointJacobian (Model &model,
     bool update_kinematics = true
     );
 
+/** \brief Same as CalcPointJacobian() but operates on the given data
+ */
+RBDL_DLLAPI void CalcPointJacobian (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id,
+    const Math::Vector3d &point_position,
+    Math::MatrixNd &G,
+    bool update_kinematics = true
+    );
+
+/** \brief Computes the point jacobians of multiple points in a single pass
+ *
+ * Computes the same values as calling CalcPointJacobian() for each point
+ * but the motion subspace of every joint is transformed into base
+ * coordinates only once and then shared by all points that are supported
+ * by this joint. This is considerably faster for multiple points on the
+ * same or on neighbouring bodies, e.g. the contact points of a foot.
+ *
+ * \param model   rigid body model
+ * \param Q       state vector of the internal joints
+ * \param body_ids the ids of the bodies
+ * \param point_positions the positions of the points in body-local data
+ * \param G       a matrix of dimensions (3 * \#points) x \#qdot_size where
+ * the jacobian of point i is stored in rows 3 * i to 3 * i + 2
+ * \param update_kinematics whether UpdateKinematics() should be called or not (default: true)
+ *
+ * \note As for CalcPointJacobian() only the non-zero entries of G are
+ * evaluated and one has to ensure that all other values have been set to
+ * zero, e.g. by calling G.setZero().
+ */
+RBDL_DLLAPI void CalcPointJacobians (Model &model,
+    const Math::VectorNd &Q,
+    const std::vector<unsigned int> &body_ids,
+    const std::vector<Math::Vector3d> &point_positions,
+    Math::MatrixNd &G,
+    bool update_kinematics = true
+    );
+
+/** \brief Same as CalcPointJacobians() but operates on the given data
+ */
+RBDL_DLLAPI void CalcPointJacobians (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const std::vector<unsigned int> &body_ids,
+    const std::vector<Math::Vector3d> &point_positions,
+    Math::MatrixNd &G,
+    bool update_kinematics = true
+    );
+
 /** \brief Computes a 6-D Jacobian for a point on a body
  *
  * Computes the 6-D Jacobian \f$G(q)\f$ that when multiplied with
@@ -174,6 +379,17 @@ RBDL_DLLAPI void CalcPointJacobian6D (Model &model,
     bool update_kinematics = true
     );
 
+/** \brief Same as CalcPointJacobian6D() but operates on the given data
+ */
+RBDL_DLLAPI void CalcPointJacobian6D (const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id,
+    const Math::Vector3d &point_position,
+    Math::MatrixNd &G,
+    bool update_kinematics = true
+    );
+
 /** \brief Computes the spatial jacobian for a body
  *
  * The spatial velocity of a body at the origin of coordinate system of 
@@ -202,6 +418,17 @@ RBDL_DLLAPI void CalcBodySpatialJacobian (
     bool update_kinematics = true
     );
 
+/** \brief Same as CalcBodySpatialJacobian() but operates on the given data
+ */
+RBDL_DLLAPI void CalcBodySpatialJacobian (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    unsigned int body_id,
+    Math::MatrixNd &G,
+    bool update_kinematics = true
+    );
+
 /** \brief Computes the velocity of a point on a body 
  *
  * \param model   rigid body model
@@ -222,6 +449,18 @@ RBDL_DLLAPI Math::Vector3d CalcPointVelocity (
     bool update_kinematics = true
     );
 
+/** \brief Same as CalcPointVelocity() but operates on the given data
+ */
+RBDL_DLLAPI Math::Vector3d CalcPointVelocity (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    unsigned int body_id,
+    const Math::Vector3d &point_position,
+    bool update_kinematics = true
+    );
+
 /** \brief Computes angular and linear velocity of a point that is fixed on a body
  *
  * \param model   rigid body model
@@ -245,6 +484,19 @@ RBDL_DLLAPI
       bool update_kinematics = true
       );
 
+/** \brief Same as CalcPointVelocity6D() but operates on the given data
+ */
+RBDL_DLLAPI
+  Math::SpatialVector CalcPointVelocity6D (
+      const Model &model,
+      ModelData &data,
+      const Math::VectorNd &Q,
+      const Math::VectorNd &QDot,
+      unsigned int body_id,
+      const Math::Vector3d &point_position,
+      bool update_kinematics = true
+      );
+
 /** \brief Computes the linear acceleration of a point on a body 
  *
  * \param model   rigid body model
@@ -277,6 +529,20 @@ RBDL_DLLAPI
       bool update_kinematics = true
       );
 
+/** \brief Same as CalcPointAcceleration() but operates on the given data
+ */
+RBDL_DLLAPI
+  Math::Vector3d CalcPointAcceleration (
+      const Model &model,
+      ModelData &data,
+      const Math::VectorNd &Q,
+      const Math::VectorNd &QDot,
+      const Math::VectorNd &QDDot,
+      unsigned int body_id,
+      const Math::Vector3d &point_position,
+      bool update_kinematics = true
+      );
+
 /** \brief Computes linear and angular acceleration of a point on a body 
  *
  * \param model   rigid body model
@@ -311,6 +577,20 @@ RBDL_DLLAPI
       bool update_kinematics = true
       );
 
+/** \brief Same as CalcPointAcceleration6D() but operates on the given data
+ */
+RBDL_DLLAPI
+  Math::SpatialVector CalcPointAcceleration6D (
+      const Model &model,
+      ModelData &data,
+      const Math::VectorNd &Q,
+      const Math::VectorNd &QDot,
+      const Math::VectorNd &QDDot,
+      unsigned int body_id,
+      const Math::Vector3d &point_position,
+      bool update_kinematics = true
+      );
+
 /** \brief Computes the inverse kinematics iteratively using a damped Levenberg-Marquardt method (also known as Damped Least Squares method)
  *
  * \param model rigid body model
@@ -382,6 +662,16 @@ struct RBDL_DLLAPI InverseKinematicsConstraintSet {
   double constraint_tol; // Constraint tolerance (default = 1.0e-12). If error_norm is smaller than this value the algorithm terminates successfully, i.e. all constraints are satisfied.
   double error_norm; // Norm of the constraint residual vector.
   double delta_q_norm; //Norm of the change in generalized coordinates
+  double damping; // Damping of the last step of InverseKinematicsLM(). It never drops below lambda.
+
+  // Workspace of InverseKinematicsLM(), sized on the first call
+  Math::MatrixNd J_trial; /// Jacobian at the trial state
+  Math::MatrixNd JTJ; /// Damped normal equations J^T J + damping * I
+  Math::VectorNd JTe; /// Gradient J^T e
+  Math::VectorNd e_trial; /// Residual at the trial state
+  Math::VectorNd delta_q; /// Step of the current iteration
+  Math::VectorNd Q_trial; /// Trial state Qres + delta_q
+  Eigen::LLT<Math::MatrixNd> JTJ_llt; /// Cholesky decomposition of JTJ
 
   // everything to define a IKin constraint
   std::vector<ConstraintType> constraint_type;
@@ -417,6 +707,104 @@ RBDL_DLLAPI bool InverseKinematics (
     Math::VectorNd &Qres
     );
 
+/** \brief Computes the inverse kinematics with a Levenberg-Marquardt
+ * method that does not allocate memory
+ *
+ * \param model rigid body model
+ * \param Qinit initial guess for the state
+ * \param CS    the constraints that should be satisfied, also contains
+ *              the solver settings, the workspace, and the results
+ * \param Qres  output of the computed inverse kinematics (must have the
+ *              size model.q_size)
+ * \returns true on success, false otherwise
+ *
+ * Solves the same problem as InverseKinematics() (the constraint
+ * residuals and the weights are identical) but each step solves the damped
+ * normal equations
+ *   \f[ (J^T J + \mu I) \Delta q = J^T e \f]
+ * with a Cholesky decomposition. A step is only accepted if it decreases
+ * \f$||e||^2\f$. The damping \f$\mu\f$ is adapted from the ratio of the
+ * actual and the predicted decrease (Nielsen's update rule): it shrinks
+ * for good steps such that the method approaches the Gauss-Newton method
+ * close to the solution and grows for rejected steps, which turns the
+ * method into a gradient descent with small steps.
+ *
+ * All temporary values are stored in CS, which is sized on the first
+ * call. Subsequent calls with the same constraints do not allocate any
+ * memory.
+ *
+ * The initial damping is \f$\frac{1}{2} ||J^T e||_\infty^2\f$, i.e. the
+ * largest weight that InverseKinematics() uses. It is small if Qinit is
+ * already close to the solution, e.g. when Qinit is the solution of the
+ * previous frame of a motion capture recording.
+ *
+ * The function returns true when CS.error_norm < CS.constraint_tol or
+ * when the length of an accepted step is smaller than CS.step_tol. In
+ * the latter case the targets may be unreachable. CS.num_steps contains
+ * the number of iterations.
+ *
+ * Joints of type JointTypeSpherical are updated on the quaternion such
+ * that it stays normalized.
+ */
+RBDL_DLLAPI bool InverseKinematicsLM (
+    Model &model,
+    const Math::VectorNd &Qinit,
+    InverseKinematicsConstraintSet &CS,
+    Math::VectorNd &Qres
+    );
+
+/** \brief Same as InverseKinematicsLM() but operates on the given data
+ */
+RBDL_DLLAPI bool InverseKinematicsLM (
+    const Model &model,
+    ModelData &data,
+    const Math::VectorNd &Qinit,
+    InverseKinematicsConstraintSet &CS,
+    Math::VectorNd &Qres
+    );
+
+/** \brief Computes the inverse kinematics for a sequence of frames
+ *
+ * Solves InverseKinematicsLM() for every column of TargetPositions. Only
+ * the target positions change between the frames, all other properties of
+ * the constraints (including orientation targets) are taken from CS.
+ *
+ * The frames are split into contiguous chunks that are distributed over
+ * the threads. Each thread uses its own copy of CS and its own ModelData.
+ * Within a chunk the frames are solved in order where each frame is
+ * warm started from the solution of the previous frame.
+ * The first frame of every chunk starts from Qinit. With num_threads = 1
+ * the whole trajectory is solved sequentially.
+ *
+ * \param model rigid body model
+ * \param Qinit initial guess for the first frame of every chunk
+ * \param CS    the constraints of the problem and the solver settings
+ * \param TargetPositions matrix of size 3 * CS.body_ids.size() x N where
+ *              rows 3 k, 3 k + 1, 3 k + 2 of column f contain the target
+ *              position of constraint k in frame f. The rows of
+ *              constraints without a target position are ignored.
+ * \param Qs    matrix of size q_size x N where the solutions are stored in
+ *              (output, resized if necessary)
+ * \param num_threads number of threads that are used. A value of 0 uses
+ *              all available hardware threads (default: 1).
+ * \param error_norms if not NULL it is resized to N and contains the
+ *              CS.error_norm of each frame (default: NULL).
+ *
+ * \returns the number of frames for which InverseKinematicsLM() returned
+ *          true
+ *
+ * \note Models with a CustomJoint are not supported.
+ */
+RBDL_DLLAPI unsigned int InverseKinematicsTrajectory (
+    const Model &model,
+    const Math::VectorNd &Qinit,
+    const InverseKinematicsConstraintSet &CS,
+    const Math::MatrixNd &TargetPositions,
+    Math::MatrixNd &Qs,
+    unsigned int num_threads = 1,
+    Math::VectorNd *error_norms = NULL
+    );
+
 /** @} */
 
 }
@@ -19,6 +19,7 @@
 #include "rbdl/Logging.h"
 #include "rbdl/Joint.h"
 #include "rbdl/Body.h"
+#include "rbdl/ModelData.h"
 #include "rbdl/rbdl_errors.h"
 
 // std::vectors containing any objects that have Eigen matrices or vectors
@@ -109,6 +110,10 @@ namespace RigidBodyDynamics
  * Rigid Body Algorithm (which is implemented in ForwardDynamics()) and
  * follows the numbering as described in Featherstones book.
  *
+ * The temporary values are inherited from ModelData. Functions that take a
+ * Model & use these. To evaluate a single model concurrently use the
+ * overloads that take a const Model & and a separate ModelData &.
+ *
  * Please note that body 0 is the root body and the moving bodies start at
  * index 1. This numbering scheme is very beneficial in terms of
  * readability of the code as the resulting code is very similar to the
@@ -118,7 +123,7 @@ namespace RigidBodyDynamics
  *
  * \note To query the number of degrees of freedom use Model::dof_count.
  */
-struct RBDL_DLLAPI Model {
+struct RBDL_DLLAPI Model : public ModelData {
   Model();
 
   // Structural information
@@ -155,34 +160,33 @@ struct RBDL_DLLAPI Model {
    */
   unsigned int qdot_size;
 
+  /// \brief Generalized velocity of zeros (size q_size), used to evaluate
+  ///  the joint transformations without allocating a temporary vector
+  Math::VectorNd qdot_zero;
+
   /// \brief Id of the previously added body, required for Model::AppendBody()
   unsigned int previously_added_body_id;
 
   /// \brief the cartesian vector of the gravity
   Math::Vector3d gravity;
 
-  // State information
-  /// \brief The spatial velocity of the bodies
-  std::vector<Math::SpatialVector> v;
-  /// \brief The spatial acceleration of the bodies
-  std::vector<Math::SpatialVector> a;
-
   ////////////////////////////////////
   // Joints
 
   /// \brief All joints
 
   std::vector<Joint> mJoints;
-  /// \brief The joint axis for joint i
-  std::vector<Math::SpatialVector> S;
-
-  // Joint state variables
-  std::vector<Math::SpatialTransform> X_J;
-  std::vector<Math::SpatialVector> v_J;
-  std::vector<Math::SpatialVector> c_J;
 
   std::vector<unsigned int> mJointUpdateOrder;
 
+  /** \brief Joint type specific implementations of jcalc() and
+   * jcalc_X_lambda_S() for each joint
+   *
+   * Filled by Model::AddBody() using jcalc_dispatch() so that the joint
+   * type only needs to be examined once instead of on every evaluation.
+   */
+  std::vector<JointCalcDispatch> mJointCalcDispatch;
+
   /// \brief Transformations from the parent body to the frame of the joint.
   // It is expressed in the coordinate frame of the parent.
   std::vector<Math::SpatialTransform> X_T;
@@ -192,11 +196,6 @@ struct RBDL_DLLAPI Model {
 
   ////////////////////////////////////
   // Special variables for joints with 3 degrees of freedom
-  /// \brief Motion subspace for joints with 3 degrees of freedom
-  std::vector<Math::Matrix63> multdof3_S;
-  std::vector<Math::Matrix63> multdof3_U;
-  std::vector<Math::Matrix3d> multdof3_Dinv;
-  std::vector<Math::Vector3d> multdof3_u;
   std::vector<unsigned int> multdof3_w_index;
 
   std::vector<CustomJoint*> mCustomJoints;
@@ -204,39 +203,12 @@ struct RBDL_DLLAPI Model {
   ////////////////////////////////////
   // Dynamics variables
 
-  /// \brief The velocity dependent spatial acceleration
-  std::vector<Math::SpatialVector> c;
-  /// \brief The spatial inertia of the bodies
-  std::vector<Math::SpatialMatrix> IA;
-  /// \brief The spatial bias force
-  std::vector<Math::SpatialVector> pA;
-  /// \brief Temporary variable U_i (RBDA p. 130)
-  std::vector<Math::SpatialVector> U;
-  /// \brief Temporary variable D_i (RBDA p. 130)
-  Math::VectorNd d;
-  /// \brief Temporary variable u (RBDA p. 130)
-  Math::VectorNd u;
-  /// \brief Internal forces on the body (used only InverseDynamics())
-  std::vector<Math::SpatialVector> f;
-  /// \brief The spatial inertia of body i (used only in
-  ///  CompositeRigidBodyAlgorithm())
+  /// \brief The spatial inertia of body i
   std::vector<Math::SpatialRigidBodyInertia> I;
-  std::vector<Math::SpatialRigidBodyInertia> Ic;
-  std::vector<Math::SpatialVector> hc;
-  std::vector<Math::SpatialVector> hdotc;
 
   ////////////////////////////////////
   // Bodies
 
-  /** \brief Transformation from the parent body to the current body
-   * \f[
-   *	X_{\lambda(i)} = {}^{i} X_{\lambda(i)}
-   * \f]
-   */
-  std::vector<Math::SpatialTransform> X_lambda;
-  /// \brief Transformation from the base to bodies reference frame
-  std::vector<Math::SpatialTransform> X_base;
-
   /// \brief All bodies that are attached to a body via a fixed joint.
   std::vector<FixedBody> mFixedBodies;
   /** \brief Value that is used to discriminate between fixed and movable
@@ -265,6 +237,10 @@ struct RBDL_DLLAPI Model {
   /// \brief Human readable names for the bodies
   std::map<std::string, unsigned int> mBodyNameMap;
 
+  /// \brief Whether Model::Finalize() was called, i.e. whether the
+  ///  topology of the model is frozen
+  bool finalized;
+
   /** \brief Connects a given body to the model
    *
    * When adding a body there are basically informations required:
@@ -294,6 +270,9 @@ struct RBDL_DLLAPI Model {
    *                    retrieve its id with GetBodyId())
    *
    * \returns id of the added body
+   *
+   * \note Throws an Errors::RBDLError if the model was finalized with
+   * Model::Finalize().
    */
   unsigned int AddBody (
     const unsigned int parent_id,
@@ -332,6 +311,26 @@ struct RBDL_DLLAPI Model {
     std::string body_name = ""
   );
 
+  /** \brief Freezes the topology of the model
+   *
+   * Marks the model as complete. Afterwards no more bodies can be added,
+   * i.e. Model::AddBody() and all functions that are based on it throw an
+   * Errors::RBDLError. Joint frames, inertias, and gravity may still be
+   * modified as they do not change the layout of the model.
+   *
+   * All per-body buffers of the model and of its ModelData are
+   * reallocated with their exact size, one after the other, instead of
+   * the geometrically grown buffers that remain after the repeated calls
+   * to AddBody(). Bodies are already stored in traversal order (the
+   * parent of a body always has a smaller id) such that the recursive
+   * algorithms visit them in the order in which they are stored.
+   *
+   * Calling this function on a finalized model has no effect. A ModelData
+   * that is created from a finalized model remains valid for as long as
+   * the model exists.
+   */
+  void Finalize();
+
   /** \brief Returns the id of a body that was passed to AddBody()
    *
    * Bodies can be given a human readable name. This function allows to
@@ -371,7 +370,7 @@ struct RBDL_DLLAPI Model {
 
   /** \brief Checks whether the body is rigidly attached to another body.
   */
-  bool IsFixedBodyId (unsigned int body_id)
+  bool IsFixedBodyId (unsigned int body_id) const
   {
     if (body_id >= fixed_body_discriminator
         && body_id < std::numeric_limits<unsigned int>::max()
@@ -381,7 +380,7 @@ struct RBDL_DLLAPI Model {
     return false;
   }
 
-  bool IsBodyId (unsigned int id)
+  bool IsBodyId (unsigned int id) const
   {
     if (id > 0 && id < mBodies.size()) {
       return true;
@@ -402,7 +401,7 @@ struct RBDL_DLLAPI Model {
    * freedom. This function returns the id of the actual
    * non-virtual parent body.
    */
-  unsigned int GetParentBodyId (unsigned int id)
+  unsigned int GetParentBodyId (unsigned int id) const
   {
     if (id >= fixed_body_discriminator) {
       return mFixedBodies[id - fixed_body_discriminator].mMovableParent;
@@ -420,7 +419,7 @@ struct RBDL_DLLAPI Model {
   /** Returns the joint frame transformtion, i.e. the second argument to
     Model::AddBody().
     */
-  Math::SpatialTransform GetJointFrame (unsigned int id)
+  Math::SpatialTransform GetJointFrame (unsigned int id) const
   {
     if (id >= fixed_body_discriminator) {
       return mFixedBodies[id - fixed_body_discriminator].mParentTransform;
@@ -457,8 +456,10 @@ struct RBDL_DLLAPI Model {
         parent_id = lambda[child_id];
       }
       X_T[child_id] = transform;
+      kinematics_cache_state[child_id] = 0;
     } else if (id > 0) {
       X_T[id] = transform;
+      kinematics_cache_state[id] = 0;
     }
   }
 
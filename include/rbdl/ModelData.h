@@ -0,0 +1,182 @@
+/*
+ * RBDL - Rigid Body Dynamics Library
+ * Copyright (c) 2011-2018 Martin Felis <martin@fysx.org>
+ *
+ * Licensed under the zlib license. See LICENSE for more details.
+ */
+
+#ifndef RBDL_MODEL_DATA_H
+#define RBDL_MODEL_DATA_H
+
+#include "rbdl/rbdl_math.h"
+#include <vector>
+
+namespace RigidBodyDynamics
+{
+
+struct Model;
+
+/** \brief Mutable per-evaluation state of a Model
+ *
+ * This structure contains all variables that the algorithms of \ref
+ * kinematics_group and \ref dynamics_group write to while they are being
+ * evaluated, e.g. joint transformations, spatial velocities and
+ * accelerations, and the temporary variables of the Articulated Body
+ * Algorithm.
+ *
+ * Model derives from ModelData such that all existing functions that take
+ * a Model & operate on the data that is stored inside of the model. For
+ * each of these functions there exists an overload that takes a const
+ * Model & and a separate ModelData &. This allows to share a single model
+ * between multiple threads where each thread uses its own ModelData:
+ *
+ * \code
+ * Model model;
+ * // ... build the model ...
+ *
+ * ModelData data (model); // one instance per thread
+ * ForwardDynamics (model, data, Q, QDot, Tau, QDDot);
+ * \endcode
+ *
+ * \note A ModelData instance is only valid for the model it was created
+ * for. If bodies are added to the model afterwards the data has to be
+ * created again.
+ *
+ * \note Models that contain a CustomJoint can only be evaluated with the
+ * data that is stored in the model itself as the CustomJoint interface
+ * operates directly on the Model.
+ */
+struct RBDL_DLLAPI ModelData {
+  ModelData() : use_kinematics_cache (false) {}
+
+  /** \brief Creates the data for the given model
+   *
+   * All buffers are sized and initialized as the ones of the model.
+   */
+  explicit ModelData (const Model &model);
+
+  // State information
+  /// \brief The spatial velocity of the bodies
+  std::vector<Math::SpatialVector> v;
+  /// \brief The spatial acceleration of the bodies
+  std::vector<Math::SpatialVector> a;
+
+  ////////////////////////////////////
+  // Joints
+
+  /// \brief The joint axis for joint i
+  std::vector<Math::SpatialVector> S;
+
+  // Joint state variables
+  std::vector<Math::SpatialTransform> X_J;
+  std::vector<Math::SpatialVector> v_J;
+  std::vector<Math::SpatialVector> c_J;
+
+  ////////////////////////////////////
+  // Special variables for joints with 3 degrees of freedom
+  /// \brief Motion subspace for joints with 3 degrees of freedom
+  std::vector<Math::Matrix63> multdof3_S;
+  std::vector<Math::Matrix63> multdof3_U;
+  std::vector<Math::Matrix3d> multdof3_Dinv;
+  std::vector<Math::Vector3d> multdof3_u;
+
+  ////////////////////////////////////
+  // Dynamics variables
+
+  /// \brief The velocity dependent spatial acceleration
+  std::vector<Math::SpatialVector> c;
+  /// \brief The spatial inertia of the bodies
+  std::vector<Math::SpatialMatrix> IA;
+  /** \brief The articulated body inertia of the bodies in packed
+   * symmetric storage
+   *
+   * Used by ForwardDynamics() and CalcMInvTimesTau() in place of IA, which
+   * is only used by the contact algorithms of Constraints.h.
+   */
+  std::vector<Math::SpatialArticulatedInertia> IA_packed;
+  /// \brief The spatial bias force
+  std::vector<Math::SpatialVector> pA;
+  /// \brief Temporary variable U_i (RBDA p. 130)
+  std::vector<Math::SpatialVector> U;
+  /// \brief Temporary variable D_i (RBDA p. 130)
+  Math::VectorNd d;
+  /// \brief Temporary variable u (RBDA p. 130)
+  Math::VectorNd u;
+  /// \brief Internal forces on the body (used only InverseDynamics())
+  std::vector<Math::SpatialVector> f;
+  /// \brief The composite spatial inertia of body i (used only in
+  ///  CompositeRigidBodyAlgorithm())
+  std::vector<Math::SpatialRigidBodyInertia> Ic;
+  std::vector<Math::SpatialVector> hc;
+  std::vector<Math::SpatialVector> hdotc;
+
+  ////////////////////////////////////
+  // Bodies
+
+  /** \brief Transformation from the parent body to the current body
+   * \f[
+   *	X_{\lambda(i)} = {}^{i} X_{\lambda(i)}
+   * \f]
+   */
+  std::vector<Math::SpatialTransform> X_lambda;
+  /// \brief Transformation from the base to bodies reference frame
+  std::vector<Math::SpatialTransform> X_base;
+
+  ////////////////////////////////////
+  // Jacobians
+
+  /** \brief Cache of the motion subspaces of the degrees of freedom in
+   * base coordinates
+   *
+   * Column k holds the motion subspace of degree of freedom k. The
+   * columns of a joint are computed by the first jacobian query that
+   * needs them after the joint was evaluated by jcalc() or
+   * jcalc_X_lambda_S() and reused by all following queries, e.g.
+   * CalcPointJacobian() or CalcBodySpatialJacobian().
+   */
+  Math::MatrixNd S_base;
+  /// \brief Whether the columns of S_base for the joint of body i are up
+  ///  to date. Reset by jcalc() and jcalc_X_lambda_S(). Not a
+  ///  std::vector<bool> as joints of different subtrees may be evaluated
+  ///  concurrently (see ForwardDynamicsParallel()).
+  std::vector<unsigned char> S_base_valid;
+
+  ////////////////////////////////////
+  // Kinematics cache
+
+  /** \brief Whether UpdateKinematics() and UpdateKinematicsCustom() use
+   * UpdateKinematicsCached() (default: false)
+   *
+   * As all functions with an update_kinematics parameter call
+   * UpdateKinematicsCustom() this makes them only recompute the subtrees
+   * whose joint values changed since the previous update.
+   */
+  bool use_kinematics_cache;
+  /// \brief Values of Q, QDot, and QDDot of the last call to
+  ///  UpdateKinematicsCached()
+  Math::VectorNd kinematics_cache_q;
+  Math::VectorNd kinematics_cache_qdot;
+  Math::VectorNd kinematics_cache_qddot;
+  /** \brief Which kinematic quantities of body i match the cached values
+   *
+   * Bit 0: X_lambda and X_base match kinematics_cache_q, bit 1: v and c
+   * additionally match kinematics_cache_qdot, bit 2: a additionally
+   * matches kinematics_cache_qddot. Reset to 0 by jcalc() and
+   * jcalc_X_lambda_S() such that evaluating any other algorithm on the
+   * same data invalidates the cache of the evaluated joints.
+   *
+   * \note Model::SetJointFrame() only resets the entry of the model's own
+   * data. Other changes of the model, e.g. directly modifying Model::X_T,
+   * are not detected. Set all entries except the first one to 0 in this
+   * case.
+   */
+  std::vector<unsigned char> kinematics_cache_state;
+  /// \brief Which bits of kinematics_cache_state were recomputed for body
+  ///  i by the last call to UpdateKinematicsCached()
+  std::vector<unsigned char> kinematics_cache_updated;
+};
+
+}
+
+/* RBDL_MODEL_DATA_H */
+#endif
@@ -48,7 +48,7 @@ struct RBDL_DLLAPI SpatialRigidBodyInertia {
     Izx (Izx), Izy(Izy), Izz(Izz)
   { }
 
-  SpatialVector operator* (const SpatialVector &mv) {
+  SpatialVector operator* (const SpatialVector &mv) const {
     Vector3d mv_lower (mv[3], mv[4], mv[5]);
 
     Vector3d res_upper = Vector3d (
@@ -64,7 +64,7 @@ struct RBDL_DLLAPI SpatialRigidBodyInertia {
         );
   }
 
-  SpatialRigidBodyInertia operator+ (const SpatialRigidBodyInertia &rbi) {
+  SpatialRigidBodyInertia operator+ (const SpatialRigidBodyInertia &rbi) const {
     return SpatialRigidBodyInertia (
         m + rbi.m,
         h + rbi.h,
@@ -135,6 +135,162 @@ struct RBDL_DLLAPI SpatialRigidBodyInertia {
   double Ixx, Iyx, Iyy, Izx, Izy, Izz;
 };
 
+/** \brief Compact representation for articulated body inertias.
+ *
+ * An articulated body inertia is a symmetric 6x6 matrix
+ * \f[
+ *   I^A = \begin{pmatrix} I & H \\ H^T & M \end{pmatrix}
+ * \f]
+ * with symmetric 3x3 blocks \f$I\f$ and \f$M\f$. Only the 21 independent
+ * values are stored.
+ */
+struct RBDL_DLLAPI SpatialArticulatedInertia {
+  SpatialArticulatedInertia() :
+    Ixx (0.), Iyx (0.), Iyy (0.), Izx (0.), Izy (0.), Izz (0.),
+    H (Matrix3d::Zero()),
+    Mxx (0.), Myx (0.), Myy (0.), Mzx (0.), Mzy (0.), Mzz (0.)
+  {}
+  explicit SpatialArticulatedInertia (const SpatialRigidBodyInertia &rbi) :
+    Ixx (rbi.Ixx), Iyx (rbi.Iyx), Iyy (rbi.Iyy),
+    Izx (rbi.Izx), Izy (rbi.Izy), Izz (rbi.Izz),
+    H (VectorCrossMatrix (rbi.h)),
+    Mxx (rbi.m), Myx (0.), Myy (rbi.m), Mzx (0.), Mzy (0.), Mzz (rbi.m)
+  {}
+  /** Uses the lower triangles of the symmetric blocks I and M. */
+  SpatialArticulatedInertia (
+      const Matrix3d &I, const Matrix3d &H, const Matrix3d &M) :
+    Ixx (I(0,0)), Iyx (I(1,0)), Iyy (I(1,1)),
+    Izx (I(2,0)), Izy (I(2,1)), Izz (I(2,2)),
+    H (H),
+    Mxx (M(0,0)), Myx (M(1,0)), Myy (M(1,1)),
+    Mzx (M(2,0)), Mzy (M(2,1)), Mzz (M(2,2))
+  {}
+
+  void setZero() {
+    Ixx = 0.; Iyx = 0.; Iyy = 0.; Izx = 0.; Izy = 0.; Izz = 0.;
+    H.setZero();
+    Mxx = 0.; Myx = 0.; Myy = 0.; Mzx = 0.; Mzy = 0.; Mzz = 0.;
+  }
+
+  /** Uses the lower triangles of the symmetric blocks of IA. */
+  void createFromMatrix (const SpatialMatrix &IA) {
+    Ixx = IA(0,0);
+    Iyx = IA(1,0); Iyy = IA(1,1);
+    Izx = IA(2,0); Izy = IA(2,1); Izz = IA(2,2);
+    H = IA.block<3,3>(0,3);
+    Mxx = IA(3,3);
+    Myx = IA(4,3); Myy = IA(4,4);
+    Mzx = IA(5,3); Mzy = IA(5,4); Mzz = IA(5,5);
+  }
+
+  /// The upper left block
+  Matrix3d getI() const {
+    return Matrix3d (
+        Ixx, Iyx, Izx,
+        Iyx, Iyy, Izy,
+        Izx, Izy, Izz
+        );
+  }
+
+  /// The lower right block
+  Matrix3d getM() const {
+    return Matrix3d (
+        Mxx, Myx, Mzx,
+        Myx, Myy, Mzy,
+        Mzx, Mzy, Mzz
+        );
+  }
+
+  SpatialVector operator* (const SpatialVector &mv) const {
+    Vector3d mv_upper (mv[0], mv[1], mv[2]);
+    Vector3d mv_lower (mv[3], mv[4], mv[5]);
+
+    Vector3d res_upper = Vector3d (
+        Ixx * mv[0] + Iyx * mv[1] + Izx * mv[2],
+        Iyx * mv[0] + Iyy * mv[1] + Izy * mv[2],
+        Izx * mv[0] + Izy * mv[1] + Izz * mv[2]
+        ) + H * mv_lower;
+    Vector3d res_lower = Vector3d (
+        Mxx * mv[3] + Myx * mv[4] + Mzx * mv[5],
+        Myx * mv[3] + Myy * mv[4] + Mzy * mv[5],
+        Mzx * mv[3] + Mzy * mv[4] + Mzz * mv[5]
+        ) + H.transpose() * mv_upper;
+
+    return SpatialVector (
+        res_upper[0], res_upper[1], res_upper[2],
+        res_lower[0], res_lower[1], res_lower[2]
+        );
+  }
+
+  Matrix63 operator* (const Matrix63 &S) const {
+    Matrix63 result;
+    for (unsigned int j = 0; j < 3; j++) {
+      result.col(j) = (*this) * SpatialVector (S.col(j));
+    }
+    return result;
+  }
+
+  SpatialArticulatedInertia& operator+= (const SpatialArticulatedInertia &IA) {
+    Ixx += IA.Ixx;
+    Iyx += IA.Iyx; Iyy += IA.Iyy;
+    Izx += IA.Izx; Izy += IA.Izy; Izz += IA.Izz;
+    H += IA.H;
+    Mxx += IA.Mxx;
+    Myx += IA.Myx; Myy += IA.Myy;
+    Mzx += IA.Mzx; Mzy += IA.Mzy; Mzz += IA.Mzz;
+    return *this;
+  }
+
+  /** \brief Subtracts A * B^T, which has to be symmetric.
+   *
+   * A and B have to have 6 rows and the same number of columns. This is
+   * used for the updates \f$I^A - U D^{-1} U^T\f$ of the articulated body
+   * algorithm with A = U D^{-1} and B = U.
+   */
+  template <typename MatrixA, typename MatrixB>
+  void subtractSymmetricProduct (const MatrixA &A, const MatrixB &B) {
+    Ixx -= A.row(0).dot(B.row(0));
+    Iyx -= A.row(1).dot(B.row(0)); Iyy -= A.row(1).dot(B.row(1));
+    Izx -= A.row(2).dot(B.row(0)); Izy -= A.row(2).dot(B.row(1));
+    Izz -= A.row(2).dot(B.row(2));
+    for (unsigned int row = 0; row < 3; row++) {
+      for (unsigned int col = 0; col < 3; col++) {
+        H(row, col) -= A.row(row).dot(B.row(3 + col));
+      }
+    }
+    Mxx -= A.row(3).dot(B.row(3));
+    Myx -= A.row(4).dot(B.row(3)); Myy -= A.row(4).dot(B.row(4));
+    Mzx -= A.row(5).dot(B.row(3)); Mzy -= A.row(5).dot(B.row(4));
+    Mzz -= A.row(5).dot(B.row(5));
+  }
+
+  SpatialMatrix toMatrix() const {
+    SpatialMatrix result;
+    setSpatialMatrix (result);
+    return result;
+  }
+
+  void setSpatialMatrix (SpatialMatrix &mat) const {
+    mat(0,0) = Ixx; mat(0,1) = Iyx; mat(0,2) = Izx;
+    mat(1,0) = Iyx; mat(1,1) = Iyy; mat(1,2) = Izy;
+    mat(2,0) = Izx; mat(2,1) = Izy; mat(2,2) = Izz;
+
+    mat.block<3,3>(0,3) = H;
+    mat.block<3,3>(3,0) = H.transpose();
+
+    mat(3,3) = Mxx; mat(3,4) = Myx; mat(3,5) = Mzx;
+    mat(4,3) = Myx; mat(4,4) = Myy; mat(4,5) = Mzy;
+    mat(5,3) = Mzx; mat(5,4) = Mzy; mat(5,5) = Mzz;
+  }
+
+  /// Upper left block (symmetric)
+  double Ixx, Iyx, Iyy, Izx, Izy, Izz;
+  /// Upper right block
+  Matrix3d H;
+  /// Lower right block (symmetric)
+  double Mxx, Myx, Myy, Mzx, Mzy, Mzz;
+};
+
 /** \brief Compact representation of spatial transformations.
  *
  * Instead of using a verbose 6x6 matrix, this structure only stores a 3x3
@@ -156,7 +312,7 @@ struct RBDL_DLLAPI SpatialTransform {
    *
    * \returns (E * w, - E * rxw + E * v)
    */
-  SpatialVector apply (const SpatialVector &v_sp) {
+  SpatialVector apply (const SpatialVector &v_sp) const {
     Vector3d v_rxw (
         v_sp[3] - r[1]*v_sp[2] + r[2]*v_sp[1],
         v_sp[4] - r[2]*v_sp[0] + r[0]*v_sp[2],
@@ -176,7 +332,7 @@ struct RBDL_DLLAPI SpatialTransform {
    *
    * \returns (E^T * n + rx * E^T * f, E^T * f)
    */
-  SpatialVector applyTranspose (const SpatialVector &f_sp) {
+  SpatialVector applyTranspose (const SpatialVector &f_sp) const {
     Vector3d E_T_f (
         E(0,0) * f_sp[3] + E(1,0) * f_sp[4] + E(2,0) * f_sp[5],
         E(0,1) * f_sp[3] + E(1,1) * f_sp[4] + E(2,1) * f_sp[5],
@@ -195,7 +351,7 @@ struct RBDL_DLLAPI SpatialTransform {
 
   /** Same as X^* I X^{-1}
   */
-  SpatialRigidBodyInertia apply (const SpatialRigidBodyInertia &rbi) {
+  SpatialRigidBodyInertia apply (const SpatialRigidBodyInertia &rbi) const {
     return SpatialRigidBodyInertia (
         rbi.m,
         E * (rbi.h - rbi.m * r),
@@ -215,7 +371,7 @@ struct RBDL_DLLAPI SpatialTransform {
 
   /** Same as X^T I X
   */
-  SpatialRigidBodyInertia applyTranspose (const SpatialRigidBodyInertia &rbi) {
+  SpatialRigidBodyInertia applyTranspose (const SpatialRigidBodyInertia &rbi) const {
     Vector3d E_T_mr = E.transpose() * rbi.h + rbi.m * r;
     return SpatialRigidBodyInertia (
         rbi.m,
@@ -230,7 +386,51 @@ struct RBDL_DLLAPI SpatialTransform {
         - VectorCrossMatrix (E_T_mr) * VectorCrossMatrix (r));
   }
 
-  SpatialVector applyAdjoint (const SpatialVector &f_sp) {
+  /** Same as X^T I^A X
+   *
+   * Works on the 3x3 blocks of the transformation instead of the full 6x6
+   * matrices.
+   */
+  SpatialArticulatedInertia applyTranspose (
+      const SpatialArticulatedInertia &IA) const {
+    Matrix3d I_times_E = IA.getI() * E;
+    Matrix3d M_times_E = IA.getM() * E;
+    Matrix3d E_T_H_E = E.transpose() * (IA.H * E);
+
+    // the congruence transforms of the symmetric blocks only need their
+    // lower triangles
+    Matrix3d E_T_I_E;
+    Matrix3d E_T_M_E;
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j <= i; j++) {
+        E_T_I_E(i,j) = E.col(i).dot(I_times_E.col(j));
+        E_T_I_E(j,i) = E_T_I_E(i,j);
+        E_T_M_E(i,j) = E.col(i).dot(M_times_E.col(j));
+        E_T_M_E(j,i) = E_T_M_E(i,j);
+      }
+    }
+
+    // H = E^T H E + rx E^T M E
+    // I = E^T I E + rx (E^T H E)^T - H rx
+    // where the products with rx are evaluated as cross products.
+    Matrix3d H;
+    Matrix3d rx_E_T_H_E_T;
+    Matrix3d H_rx;
+    for (unsigned int j = 0; j < 3; j++) {
+      H.col(j) = E_T_H_E.col(j) + r.cross (Vector3d (E_T_M_E.col(j)));
+      rx_E_T_H_E_T.col(j) = r.cross (Vector3d (E_T_H_E.row(j).transpose()));
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+      H_rx.row(i) = - r.cross (Vector3d (H.row(i).transpose())).transpose();
+    }
+
+    return SpatialArticulatedInertia (
+        E_T_I_E + rx_E_T_H_E_T - H_rx,
+        H,
+        E_T_M_E);
+  }
+
+  SpatialVector applyAdjoint (const SpatialVector &f_sp) const {
     Vector3d En_rxf = E * (Vector3d (f_sp[0], f_sp[1], f_sp[2]) - r.cross(Vector3d (f_sp[3], f_sp[4], f_sp[5])));
     //		Vector3d En_rxf = E * (Vector3d (f_sp[0], f_sp[1], f_sp[2]) - r.cross(Eigen::Map<Vector3d> (&(f_sp[3]))));
 
@@ -321,6 +521,11 @@ inline std::ostream& operator<<(std::ostream& output, const SpatialRigidBodyIner
   return output;
 }
 
+inline std::ostream& operator<<(std::ostream& output, const SpatialArticulatedInertia &IA) {
+  output << IA.toMatrix();
+  return output;
+}
+
 inline std::ostream& operator<<(std::ostream& output, const SpatialTransform &X) {
   output << "X.E = " << std::endl << X.E << std::endl;
   output << "X.r = " << X.r.transpose();
@@ -21,6 +21,7 @@
 #include "rbdl/Constraints.h"
 
 #include "rbdl/rbdl_utils.h"
+#include "rbdl/BinaryModel.h"
 
 /** \page api_version_checking_page API Changes
  * @{
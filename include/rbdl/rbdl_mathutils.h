@@ -10,6 +10,7 @@
 
 #include <assert.h>
 #include <cmath>
+#include <vector>
 
 #include "rbdl/rbdl_math.h"
 
@@ -71,6 +72,39 @@ RBDL_DLLAPI inline MatrixNd MatrixFromPtr (unsigned int rows, unsigned int cols,
 /// \brief Solves a linear system using gaussian elimination with pivoting
 RBDL_DLLAPI bool LinSolveGaussElimPivot (MatrixNd A, VectorNd b, VectorNd &x);
 
+/** \brief Decompositions and temporary values to solve linear systems
+ * with any of the LinearSolver methods.
+ *
+ * Once the workspace has been sized, either by resize() or by a first call
+ * of compute(), neither compute() nor solve() allocate memory as long as
+ * the size of the matrix does not change.
+ */
+struct RBDL_DLLAPI LinearSolverWorkspace {
+  LinearSolverWorkspace() :
+    linear_solver (LinearSolverUnknown)
+  {}
+
+  /// \brief Allocates the decompositions for a rows x cols matrix
+  void resize (unsigned int rows, unsigned int cols);
+
+  /// \brief Decomposes A using the given linear solver
+  void compute (const MatrixNd &A, LinearSolver solver);
+
+  /// \brief Solves A x = b for the matrix of the last call to compute()
+  void solve (const VectorNd &b, VectorNd &x);
+
+  /// \brief The solver used in the last call to compute()
+  LinearSolver linear_solver;
+
+  Eigen::PartialPivLU<MatrixNd> partial_piv_lu;
+  Eigen::ColPivHouseholderQR<MatrixNd> col_piv_householder_qr;
+  Eigen::HouseholderQR<MatrixNd> householder_qr;
+  Eigen::LLT<MatrixNd> llt;
+
+  /// \brief Temporary vector for the QR based solvers
+  VectorNd temp;
+};
+
 // \todo write test 
 RBDL_DLLAPI void SpatialMatrixSetSubmatrix(SpatialMatrix &dest, unsigned int row, unsigned int col, const Matrix3d &matrix);
 
@@ -241,22 +275,110 @@ RBDL_DLLAPI inline Vector3d angular_acceleration_from_angle_rates (const Vector3
       );
 }
 
+/** \brief Joint space matrix that only stores the entries along the
+ * ancestor chains of the degrees of freedom (branch-induced sparsity)
+ *
+ * Two degrees of freedom only couple in the joint space inertia matrix H
+ * if one of them is an ancestor of the other, i.e. if it can be reached by
+ * walking Model::lambda_q. Row i therefore only stores the diagonal entry
+ * (i,i) followed by the entries (i,j) of all ancestors j of i, ordered
+ * from i towards the root. Entries above the diagonal are not stored: the
+ * matrix is either interpreted as symmetric (H) or lower triangular (L).
+ *
+ * For models with many branches (e.g. humanoids, multi-legged robots, or
+ * hands) this is a fraction of the dof_count x dof_count entries of the
+ * dense matrix.
+ *
+ * Use CompositeRigidBodyAlgorithmSparse() to compute H and
+ * SparseFactorizeLTL() to factorize it in place.
+ */
+struct RBDL_DLLAPI SparseJointSpaceMatrix {
+  SparseJointSpaceMatrix () {}
+  explicit SparseJointSpaceMatrix (const Model &model) {
+    Init (model);
+  }
+
+  /** \brief Initializes the sparsity structure from Model::lambda_q and
+   * sets all values to zero. */
+  void Init (const Model &model);
+
+  /// \brief Number of rows (and columns) of the matrix
+  unsigned int rows () const {
+    return row_start.size() > 0 ? row_start.size() - 1 : 0;
+  }
+
+  /// \brief Returns the dense symmetric matrix H
+  MatrixNd toMatrix () const;
+  /// \brief Returns the dense lower triangular matrix L
+  MatrixNd toLowerTriangularMatrix () const;
+
+  /** \brief Index of the diagonal entry of each row in values. The entries
+   * of row i are stored in values[row_start[i]] ... values[row_start[i +
+   * 1] - 1]. */
+  std::vector<unsigned int> row_start;
+  /// \brief Column of each entry in values
+  std::vector<unsigned int> col_index;
+  /// \brief Values of the stored entries
+  VectorNd values;
+};
+
+/** \brief Computes the factorization H = L^T L in place
+ *
+ * Only the entries along the ancestor chains in Model::lambda_q are
+ * evaluated. The upper triangular part of H is set to zero, all other
+ * entries that are not on the ancestor chains have to be zero.
+ */
 RBDL_DLLAPI
 void SparseFactorizeLTL (Model &model, Math::MatrixNd &H);
 
+/// \brief Computes result = H * x using only the lower triangular part of H
 RBDL_DLLAPI
-void SparseMultiplyHx (Model &model, Math::MatrixNd &L);
-
+void SparseMultiplyHx (Model &model, const Math::MatrixNd &H,
+    const Math::VectorNd &x, Math::VectorNd &result);
+/// \brief Computes result = L * x
 RBDL_DLLAPI
-void SparseMultiplyLx (Model &model, Math::MatrixNd &L);
+void SparseMultiplyLx (Model &model, const Math::MatrixNd &L,
+    const Math::VectorNd &x, Math::VectorNd &result);
+/// \brief Computes result = L^T * x
 RBDL_DLLAPI
-void SparseMultiplyLTx (Model &model, Math::MatrixNd &L);
+void SparseMultiplyLTx (Model &model, const Math::MatrixNd &L,
+    const Math::VectorNd &x, Math::VectorNd &result);
 
+/// \brief Solves L * x = b in place (x contains b when called)
 RBDL_DLLAPI
 void SparseSolveLx (Model &model, Math::MatrixNd &L, Math::VectorNd &x);
+/// \brief Solves L^T * x = b in place (x contains b when called)
 RBDL_DLLAPI
 void SparseSolveLTx (Model &model, Math::MatrixNd &L, Math::VectorNd &x); 
 
+/** \brief Computes the factorization H = L^T L in place
+ *
+ * The solution of H x = b is then obtained by calling SparseSolveLTx()
+ * followed by SparseSolveLx().
+ */
+RBDL_DLLAPI
+void SparseFactorizeLTL (SparseJointSpaceMatrix &H);
+
+/// \brief Computes result = H * x of a symmetric matrix H
+RBDL_DLLAPI
+void SparseMultiplyHx (const SparseJointSpaceMatrix &H,
+    const Math::VectorNd &x, Math::VectorNd &result);
+/// \brief Computes result = L * x of a lower triangular matrix L
+RBDL_DLLAPI
+void SparseMultiplyLx (const SparseJointSpaceMatrix &L,
+    const Math::VectorNd &x, Math::VectorNd &result);
+/// \brief Computes result = L^T * x of a lower triangular matrix L
+RBDL_DLLAPI
+void SparseMultiplyLTx (const SparseJointSpaceMatrix &L,
+    const Math::VectorNd &x, Math::VectorNd &result);
+
+/// \brief Solves L * x = b in place (x contains b when called)
+RBDL_DLLAPI
+void SparseSolveLx (const SparseJointSpaceMatrix &L, Math::VectorNd &x);
+/// \brief Solves L^T * x = b in place (x contains b when called)
+RBDL_DLLAPI
+void SparseSolveLTx (const SparseJointSpaceMatrix &L, Math::VectorNd &x);
+
 } /* Math */
 
 } /* RigidBodyDynamics */
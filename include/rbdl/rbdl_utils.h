@@ -85,6 +85,36 @@ RBDL_DLLAPI double CalcPotentialEnergy (Model &model, const Math::VectorNd &q, b
 
 /** \brief Computes the kinetic energy of the full model. */
 RBDL_DLLAPI double CalcKineticEnergy (Model &model, const Math::VectorNd &q, const Math::VectorNd &qdot, bool update_kinematics = true);
+
+/** \brief Generates a C++ header with fixed-size dynamics of the model.
+ *
+ * The header defines a struct with the given name that contains the
+ * constants of the model (joint axes, joint frames, inertias, and gravity)
+ * and a workspace of fixed-size Eigen types. Its member functions
+ * ForwardDynamics(), InverseDynamics(), and CompositeRigidBodyAlgorithm()
+ * are fully unrolled for the topology of the model, i.e. they contain
+ * neither loops over the bodies nor dispatching on joint types. The header
+ * only depends on the RBDL math headers and does not require linking
+ * against RBDL.
+ *
+ * This is useful for robots whose structure is known at compile time. The
+ * model can be loaded by any of the addons (e.g. the luamodel or
+ * urdfreader utilities have an option to write the header) and the
+ * generated header is then compiled into the application.
+ *
+ * External forces are not supported by the generated functions.
+ *
+ * \param model the model for which the code should be generated. All
+ * joints must be revolute or prismatic joints, i.e. multi-dof joints have
+ * to be emulated by multiple single-dof joints and custom joints are not
+ * supported.
+ * \param struct_name name of the generated struct
+ *
+ * \returns the contents of the header file
+ */
+RBDL_DLLAPI std::string GenerateFixedSizeModelCode (
+  const Model &model,
+  const std::string &struct_name);
 }
 
 }
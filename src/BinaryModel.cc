@@ -0,0 +1,475 @@
+/*
+ * RBDL - Rigid Body Dynamics Library
+ * Copyright (c) 2011-2018 Martin Felis <martin@fysx.org>
+ *
+ * Licensed under the zlib license. See LICENSE for more details.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <stdint.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RBDL_BINARY_MODEL_USE_MMAP
+#endif
+
+#include "rbdl/rbdl_errors.h"
+#include "rbdl/Model.h"
+#include "rbdl/BinaryModel.h"
+
+namespace RigidBodyDynamics {
+
+using namespace Math;
+
+/*
+ * On-disk layout. All records have a size that is a multiple of 8 bytes
+ * such that the doubles of a memory mapped file are aligned.
+ */
+static const char BinaryModelMagic[8] = "RBDLBIN";
+static const uint32_t BinaryModelByteOrderMark = 0x01020304;
+
+struct BinaryModelHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order_mark;
+  uint32_t body_count;
+  uint32_t fixed_body_count;
+  uint32_t names_size;
+  uint32_t fixed_body_discriminator;
+  double gravity[3];
+};
+
+struct BinaryModelBody {
+  uint32_t parent_id;
+  uint32_t joint_type;
+  uint32_t dof_count;
+  uint32_t is_virtual;
+  uint32_t name_offset;
+  uint32_t name_length;
+  /// joint frame: rotation (row major) followed by the translation
+  double joint_frame[12];
+  double joint_axes[3][6];
+  double mass;
+  double center_of_mass[3];
+  double inertia[9];
+};
+
+struct BinaryModelFixedBody {
+  uint32_t movable_parent_id;
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t padding;
+  double parent_transform[12];
+  double mass;
+  double center_of_mass[3];
+  double inertia[9];
+};
+
+static void WriteTransform (const SpatialTransform &X, double *values) {
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      values[i * 3 + j] = X.E(i,j);
+    }
+    values[9 + i] = X.r[i];
+  }
+}
+
+static SpatialTransform ReadTransform (const double *values) {
+  SpatialTransform X;
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      X.E(i,j) = values[i * 3 + j];
+    }
+    X.r[i] = values[9 + i];
+  }
+  return X;
+}
+
+static void WriteInertia (double mass_in, const Vector3d &com_in,
+    const Matrix3d &inertia_in, double &mass, double *com, double *inertia) {
+  mass = mass_in;
+  for (unsigned int i = 0; i < 3; i++) {
+    com[i] = com_in[i];
+    for (unsigned int j = 0; j < 3; j++) {
+      inertia[i * 3 + j] = inertia_in(i,j);
+    }
+  }
+}
+
+static void ReadInertia (double mass_in, const double *com_in,
+    const double *inertia_in, double &mass, Vector3d &com,
+    Matrix3d &inertia) {
+  mass = mass_in;
+  for (unsigned int i = 0; i < 3; i++) {
+    com[i] = com_in[i];
+    for (unsigned int j = 0; j < 3; j++) {
+      inertia(i,j) = inertia_in[i * 3 + j];
+    }
+  }
+}
+
+/*
+ * Degrees of freedom of the joint types that a model contains after
+ * Model::AddBody() split up emulated multi-DoF joints, 0 for all other
+ * types.
+ */
+static uint32_t StoredJointDoFCount (uint32_t joint_type) {
+  switch (joint_type) {
+    case JointTypeRevolute:
+    case JointTypePrismatic:
+    case JointTypeRevoluteX:
+    case JointTypeRevoluteY:
+    case JointTypeRevoluteZ:
+    case JointTypeHelical:
+      return 1;
+    case JointTypeSpherical:
+    case JointTypeEulerZYX:
+    case JointTypeEulerXYZ:
+    case JointTypeEulerYXZ:
+    case JointTypeTranslationXYZ:
+      return 3;
+    default:
+      return 0;
+  }
+}
+
+static size_t AlignedSize (size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+RBDL_DLLAPI void BinaryModelWriteToBuffer (
+    const Model &model,
+    std::vector<char> &buffer) {
+  if (!model.mCustomJoints.empty()) {
+    throw Errors::RBDLError("Error: models with custom joints cannot be "
+        "stored in the binary model format!");
+  }
+
+  // names of the bodies, ordered by id
+  std::vector<std::string> body_names (model.mBodies.size());
+  std::vector<std::string> fixed_body_names (model.mFixedBodies.size());
+  for (std::map<std::string, unsigned int>::const_iterator it =
+      model.mBodyNameMap.begin(); it != model.mBodyNameMap.end(); ++it) {
+    if (model.IsFixedBodyId (it->second)) {
+      fixed_body_names[it->second - model.fixed_body_discriminator] =
+        it->first;
+    } else if (it->second != 0) {
+      body_names[it->second] = it->first;
+    }
+  }
+
+  std::string names;
+  std::vector<BinaryModelBody> bodies (model.mBodies.size());
+  std::vector<BinaryModelFixedBody> fixed_bodies (model.mFixedBodies.size());
+
+  for (unsigned int i = 0; i < model.mBodies.size(); i++) {
+    BinaryModelBody &record = bodies[i];
+    std::memset (&record, 0, sizeof (record));
+
+    const Body &body = model.mBodies[i];
+    WriteInertia (body.mMass, body.mCenterOfMass, body.mInertia, record.mass,
+        record.center_of_mass, record.inertia);
+    record.is_virtual = body.mIsVirtual ? 1 : 0;
+    record.name_offset = names.size();
+    record.name_length = body_names[i].size();
+    names += body_names[i];
+
+    if (i == 0) {
+      WriteTransform (SpatialTransform(), record.joint_frame);
+      continue;
+    }
+
+    const Joint &joint = model.mJoints[i];
+    if (joint.mDoFCount != StoredJointDoFCount (joint.mJointType)) {
+      std::ostringstream errormsg;
+      errormsg << "Error: the binary model format does not support the"
+               << " joint type " << joint.mJointType << " of body " << i
+               << "!" << std::endl;
+      throw Errors::RBDLError(errormsg.str());
+    }
+
+    record.parent_id = model.lambda[i];
+    record.joint_type = joint.mJointType;
+    record.dof_count = joint.mDoFCount;
+    WriteTransform (model.X_T[i], record.joint_frame);
+    for (unsigned int j = 0; j < joint.mDoFCount; j++) {
+      for (unsigned int k = 0; k < 6; k++) {
+        record.joint_axes[j][k] = joint.mJointAxes[j][k];
+      }
+    }
+  }
+
+  for (unsigned int i = 0; i < model.mFixedBodies.size(); i++) {
+    BinaryModelFixedBody &record = fixed_bodies[i];
+    std::memset (&record, 0, sizeof (record));
+
+    const FixedBody &fixed_body = model.mFixedBodies[i];
+    record.movable_parent_id = fixed_body.mMovableParent;
+    WriteTransform (fixed_body.mParentTransform, record.parent_transform);
+    WriteInertia (fixed_body.mMass, fixed_body.mCenterOfMass,
+        fixed_body.mInertia, record.mass, record.center_of_mass,
+        record.inertia);
+    record.name_offset = names.size();
+    record.name_length = fixed_body_names[i].size();
+    names += fixed_body_names[i];
+  }
+
+  BinaryModelHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, BinaryModelMagic, sizeof (header.magic));
+  header.version = BinaryModelFormatVersion;
+  header.byte_order_mark = BinaryModelByteOrderMark;
+  header.body_count = bodies.size();
+  header.fixed_body_count = fixed_bodies.size();
+  header.names_size = names.size();
+  header.fixed_body_discriminator = model.fixed_body_discriminator;
+  for (unsigned int i = 0; i < 3; i++) {
+    header.gravity[i] = model.gravity[i];
+  }
+
+  size_t bodies_size = bodies.size() * sizeof (BinaryModelBody);
+  size_t fixed_bodies_size =
+    fixed_bodies.size() * sizeof (BinaryModelFixedBody);
+
+  buffer.assign (sizeof (header) + bodies_size + fixed_bodies_size
+      + AlignedSize (names.size()), 0);
+
+  char *out = &buffer[0];
+  std::memcpy (out, &header, sizeof (header));
+  out += sizeof (header);
+  if (bodies_size > 0) {
+    std::memcpy (out, &bodies[0], bodies_size);
+    out += bodies_size;
+  }
+  if (fixed_bodies_size > 0) {
+    std::memcpy (out, &fixed_bodies[0], fixed_bodies_size);
+    out += fixed_bodies_size;
+  }
+  if (names.size() > 0) {
+    std::memcpy (out, names.data(), names.size());
+  }
+}
+
+RBDL_DLLAPI void BinaryModelWriteToFile (
+    const Model &model,
+    const char *filename) {
+  std::vector<char> buffer;
+  BinaryModelWriteToBuffer (model, buffer);
+
+  std::ofstream file (filename, std::ios::out | std::ios::binary);
+  if (!file) {
+    std::ostringstream errormsg;
+    errormsg << "Error: could not open file '" << filename
+             << "' for writing!" << std::endl;
+    throw Errors::RBDLInvalidFileError(errormsg.str());
+  }
+
+  file.write (&buffer[0], buffer.size());
+  if (!file) {
+    std::ostringstream errormsg;
+    errormsg << "Error: could not write file '" << filename << "'!"
+             << std::endl;
+    throw Errors::RBDLInvalidFileError(errormsg.str());
+  }
+}
+
+static void ThrowParseError (const std::string &message) {
+  throw Errors::RBDLFileParseError("Error: invalid binary model: " + message
+      + "\n");
+}
+
+static std::string ReadName (const char *names, uint32_t names_size,
+    uint32_t offset, uint32_t length) {
+  if (static_cast<uint64_t>(offset) + length > names_size) {
+    ThrowParseError ("name out of range");
+  }
+  return std::string (names + offset, length);
+}
+
+RBDL_DLLAPI void BinaryModelReadFromBuffer (
+    const char *buffer,
+    size_t size,
+    Model *model) {
+  if (model->mBodies.size() != 1 || !model->mFixedBodies.empty()) {
+    throw Errors::RBDLInvalidParameterError("Error: binary models can only "
+        "be read into an empty model!\n");
+  }
+
+  BinaryModelHeader header;
+  if (size < sizeof (header)) {
+    ThrowParseError ("file too small");
+  }
+  std::memcpy (&header, buffer, sizeof (header));
+
+  if (std::memcmp (header.magic, BinaryModelMagic, sizeof (header.magic))
+      != 0) {
+    ThrowParseError ("wrong magic string");
+  }
+  if (header.byte_order_mark != BinaryModelByteOrderMark) {
+    ThrowParseError ("the file was written with a different byte order");
+  }
+  if (header.version != BinaryModelFormatVersion) {
+    std::ostringstream errormsg;
+    errormsg << "unsupported version " << header.version << " (expected "
+             << BinaryModelFormatVersion << ")";
+    ThrowParseError (errormsg.str());
+  }
+  if (header.body_count == 0
+      || header.fixed_body_discriminator != model->fixed_body_discriminator) {
+    ThrowParseError ("inconsistent header");
+  }
+
+  uint64_t expected_size = sizeof (header)
+    + static_cast<uint64_t>(header.body_count) * sizeof (BinaryModelBody)
+    + static_cast<uint64_t>(header.fixed_body_count)
+    * sizeof (BinaryModelFixedBody)
+    + AlignedSize (header.names_size);
+  if (size < expected_size) {
+    ThrowParseError ("file too small");
+  }
+
+  const char *body_records = buffer + sizeof (header);
+  const char *fixed_body_records = body_records
+    + header.body_count * sizeof (BinaryModelBody);
+  const char *names = fixed_body_records
+    + header.fixed_body_count * sizeof (BinaryModelFixedBody);
+
+  model->gravity = Vector3d (header.gravity[0], header.gravity[1],
+      header.gravity[2]);
+
+  BinaryModelBody record;
+  Body root_body;
+
+  for (unsigned int i = 0; i < header.body_count; i++) {
+    std::memcpy (&record, body_records + i * sizeof (record),
+        sizeof (record));
+
+    Body body;
+    ReadInertia (record.mass, record.center_of_mass, record.inertia,
+        body.mMass, body.mCenterOfMass, body.mInertia);
+    body.mIsVirtual = record.is_virtual != 0;
+
+    if (i == 0) {
+      root_body = body;
+      continue;
+    }
+
+    if (record.parent_id >= i
+        || record.dof_count != StoredJointDoFCount (record.joint_type)) {
+      std::ostringstream errormsg;
+      errormsg << "invalid joint of body " << i;
+      ThrowParseError (errormsg.str());
+    }
+
+    Joint joint;
+    joint.mJointType = static_cast<JointType>(record.joint_type);
+    joint.mDoFCount = record.dof_count;
+    joint.mJointAxes = new SpatialVector[record.dof_count];
+    for (unsigned int j = 0; j < record.dof_count; j++) {
+      for (unsigned int k = 0; k < 6; k++) {
+        joint.mJointAxes[j][k] = record.joint_axes[j][k];
+      }
+    }
+
+    model->AddBody (record.parent_id, ReadTransform (record.joint_frame),
+        joint, body, ReadName (names, header.names_size, record.name_offset,
+          record.name_length));
+  }
+
+  // the root may carry the masses of fixed bodies
+  model->mBodies[0] = root_body;
+  model->I[0] = SpatialRigidBodyInertia::createFromMassComInertiaC (
+      root_body.mMass, root_body.mCenterOfMass, root_body.mInertia);
+
+  // The masses of the fixed bodies are already contained in their movable
+  // parents, so they are not added through Model::AddBody().
+  BinaryModelFixedBody fixed_record;
+  for (unsigned int i = 0; i < header.fixed_body_count; i++) {
+    std::memcpy (&fixed_record,
+        fixed_body_records + i * sizeof (fixed_record),
+        sizeof (fixed_record));
+
+    if (fixed_record.movable_parent_id >= header.body_count) {
+      std::ostringstream errormsg;
+      errormsg << "invalid parent of fixed body " << i;
+      ThrowParseError (errormsg.str());
+    }
+
+    FixedBody fixed_body;
+    ReadInertia (fixed_record.mass, fixed_record.center_of_mass,
+        fixed_record.inertia, fixed_body.mMass, fixed_body.mCenterOfMass,
+        fixed_body.mInertia);
+    fixed_body.mMovableParent = fixed_record.movable_parent_id;
+    fixed_body.mParentTransform =
+      ReadTransform (fixed_record.parent_transform);
+    model->mFixedBodies.push_back (fixed_body);
+
+    std::string name = ReadName (names, header.names_size,
+        fixed_record.name_offset, fixed_record.name_length);
+    if (name.size() != 0) {
+      model->mBodyNameMap[name] = model->fixed_body_discriminator + i;
+    }
+  }
+}
+
+RBDL_DLLAPI void BinaryModelReadFromFile (
+    const char *filename,
+    Model *model) {
+#ifdef RBDL_BINARY_MODEL_USE_MMAP
+  int fd = open (filename, O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat (fd, &file_stat) != 0) {
+    if (fd >= 0) {
+      close (fd);
+    }
+    std::ostringstream errormsg;
+    errormsg << "Error: could not open file '" << filename << "'!"
+             << std::endl;
+    throw Errors::RBDLInvalidFileError(errormsg.str());
+  }
+
+  size_t size = file_stat.st_size;
+  void *data = MAP_FAILED;
+  if (size > 0) {
+    data = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close (fd);
+
+  if (data == MAP_FAILED) {
+    std::ostringstream errormsg;
+    errormsg << "Error: could not map file '" << filename << "'!"
+             << std::endl;
+    throw Errors::RBDLInvalidFileError(errormsg.str());
+  }
+
+  try {
+    BinaryModelReadFromBuffer (static_cast<const char*>(data), size, model);
+  } catch (...) {
+    munmap (data, size);
+    throw;
+  }
+  munmap (data, size);
+#else
+  std::ifstream file (filename, std::ios::in | std::ios::binary);
+  if (!file) {
+    std::ostringstream errormsg;
+    errormsg << "Error: could not open file '" << filename << "'!"
+             << std::endl;
+    throw Errors::RBDLInvalidFileError(errormsg.str());
+  }
+
+  std::vector<char> buffer ((std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+  BinaryModelReadFromBuffer (buffer.empty() ? NULL : &buffer[0],
+      buffer.size(), model);
+#endif
+}
+
+}
@@ -11,6 +11,7 @@
 #include <assert.h>
 
 #include "rbdl/rbdl_mathutils.h"
+#include "rbdl/rbdl_errors.h"
 #include "rbdl/Logging.h"
 
 #include "rbdl/Model.h"
@@ -26,7 +27,8 @@ using namespace Math;
 //==============================================================================
 ContactConstraint::ContactConstraint():
   Constraint("",ConstraintTypeContact,1,
-             std::numeric_limits<unsigned int>::max()){}
+             std::numeric_limits<unsigned int>::max()),
+  frictionCoefficient(std::numeric_limits<double>::infinity()){}
 
 //==============================================================================
 ContactConstraint::ContactConstraint(
@@ -41,7 +43,8 @@ ContactConstraint::ContactConstraint(
         Constraint(contactConstraintName,
                    ConstraintTypeContact,
                    unsigned(int(1)),
-                   userDefinedIdNumber)
+                   userDefinedIdNumber),
+        frictionCoefficient(std::numeric_limits<double>::infinity())
 {
 
   T.push_back(groundConstraintUnitVector); 
@@ -97,13 +100,27 @@ void ContactConstraint::calcConstraintJacobian( Model &model,
                     updateKinematics);
 
   for(unsigned int i=0; i < sizeOfConstraint; ++i){
-    GSysUpd.block(rowInSystem+i,0,1,GSysUpd.cols()) =
+    GSysUpd.block(rowInSystem+i,0,1,GSysUpd.cols()).noalias() =
         T[i].transpose()*cache.mat3NA;
   }
 }
 
 //==============================================================================
 
+void ContactConstraint::calcConstraintJacobianFromPointJacobian(
+                              const Math::MatrixNd &pointJacobians,
+                              unsigned int pointJacobianRow,
+                              Math::MatrixNd &GSysUpd)
+{
+  for(unsigned int i=0; i < sizeOfConstraint; ++i){
+    GSysUpd.block(rowInSystem+i,0,1,GSysUpd.cols()).noalias() =
+        T[i].transpose()*pointJacobians.block(pointJacobianRow,0,3,
+                                              pointJacobians.cols());
+  }
+}
+
+//==============================================================================
+
 void ContactConstraint::calcGamma(  Model &model,
                   const double time,
                   const Math::VectorNd &Q,
@@ -247,6 +264,19 @@ void ContactConstraint::
 
 //==============================================================================
 
+void ContactConstraint::setFrictionCoefficient(double frictionCoefficientIn)
+{
+  if (frictionCoefficientIn < 0.) {
+    std::ostringstream errormsg;
+    errormsg << "Error: the friction coefficient of a ContactConstraint must"
+             << " not be negative." << std::endl;
+    throw Errors::RBDLError(errormsg.str());
+  }
+  frictionCoefficient = frictionCoefficientIn;
+}
+
+//==============================================================================
+
 void ContactConstraint::
       calcPointAccelerations(Model &model,
                             const Math::VectorNd &Q,
@@ -109,7 +109,7 @@ void LoopConstraint::calcConstraintJacobian( Model &model,
       //Resolve each constraint axis into the global frame
       cache.svecA =cache.stA.apply(T[i]);
       //Take the dot product of the constraint axis with Gs-Gp
-      GSysUpd.block(rowInSystem+i,0,1,GSysUpd.cols())
+      GSysUpd.block(rowInSystem+i,0,1,GSysUpd.cols()).noalias()
           = cache.svecA.transpose()*cache.mat6NA;
     }
 
@@ -9,6 +9,8 @@
 #include <sstream>
 #include <string>
 #include <limits>
+#include <algorithm>
+#include <cmath>
 #include <assert.h>
 //The ConstraintCache input to each function contains all of the working
 //memory necessary for this constraint. So nothing appears here.
@@ -433,6 +435,13 @@ bool ConstraintSet::Bind (const Model &model)
   b.setZero();
   x.conservativeResize (model.dof_count + n_constr);
   x.setZero();
+  A_solver.resize (model.dof_count + n_constr, model.dof_count + n_constr);
+  A_factorized_solver = LinearSolverUnknown;
+  H_llt = Eigen::LLT<MatrixNd> (model.dof_count);
+  schur_Y = MatrixNd::Zero (model.dof_count, n_constr);
+  schur_K = MatrixNd::Zero (n_constr, n_constr);
+  schur_K_llt = Eigen::LLT<MatrixNd> (n_constr);
+  rhs = VectorNd::Zero (model.dof_count);
 
 
   S.conservativeResize(model.dof_count, model.dof_count);
@@ -445,11 +454,22 @@ bool ConstraintSet::Bind (const Model &model)
   GT_qr_Q = MatrixNd::Zero (model.dof_count, model.dof_count);
   Y = MatrixNd::Zero (model.dof_count, G.rows());
   Z = MatrixNd::Zero (model.dof_count, model.dof_count - G.rows());
-  qddot_y = VectorNd::Zero (model.dof_count);
-  qddot_z = VectorNd::Zero (model.dof_count);
+  qddot_y = VectorNd::Zero (n_constr);
+  qddot_z = VectorNd::Zero (model.dof_count - n_constr);
+  GY = MatrixNd::Zero (n_constr, n_constr);
+  GY_solver.resize (n_constr, n_constr);
+  HZ = MatrixNd::Zero (model.dof_count, model.dof_count - n_constr);
+  ZTHZ = MatrixNd::Zero (model.dof_count - n_constr,
+      model.dof_count - n_constr);
+  ZTHZ_llt = Eigen::LLT<MatrixNd> (model.dof_count - n_constr);
+  tmp_qdot_a = VectorNd::Zero (model.dof_count);
+  tmp_qdot_b = VectorNd::Zero (model.dof_count);
+  tmp_lambda = VectorNd::Zero (n_constr);
+  tmp_z = VectorNd::Zero (model.dof_count - n_constr);
 
   K.conservativeResize (n_constr, n_constr);
   K.setZero();
+  K_solver.resize (n_constr, n_constr);
   a.conservativeResize (n_constr);
   a.setZero();
   QDDot_t.conservativeResize (model.dof_count);
@@ -476,6 +496,15 @@ bool ConstraintSet::Bind (const Model &model)
   d_multdof3_u = std::vector<Math::Vector3d> (model.mBodies.size()
                  , Math::Vector3d::Zero());
 
+  contactBodyIds.resize (contactConstraints.size());
+  contactBodyPoints.resize (contactConstraints.size());
+  for (unsigned int i = 0; i < contactConstraints.size(); i++) {
+    contactBodyIds[i] = contactConstraints[i]->getBodyIds()[0];
+    contactBodyPoints[i] = contactConstraints[i]->getBodyFrames()[0].r;
+  }
+  contactPointJacobians = MatrixNd::Zero (3 * contactConstraints.size(),
+      model.qdot_size);
+
   bound = true;
 
   return bound;
@@ -514,14 +543,19 @@ void ConstraintSet::SetActuationMap(const Model &model,
   u.resize(na);
   v.resize(nu);
 
+  actuatedDofIndices.clear();
+  unactuatedDofIndices.clear();
+
   unsigned int j=0;
   unsigned int k=0;
   for(unsigned int i=0; i<model.dof_count; ++i) {
     if(actuatedDofUpd[i]) {
       S(j,i) = 1.;
+      actuatedDofIndices.push_back(i);
       ++j;
     } else {
       P(k,i) = 1.;
+      unactuatedDofIndices.push_back(i);
       ++k;
     }
   }
@@ -566,6 +600,7 @@ void ConstraintSet::clear()
   gamma.setZero();
   G.setZero();
   A.setZero();
+  A_factorized_solver = LinearSolverUnknown;
   b.setZero();
   x.setZero();
 
@@ -690,6 +725,16 @@ void SolveConstrainedSystemDirect (
   case (LinearSolverHouseholderQR) :
     x = A.householderQr().solve(b);
     break;
+  case (LinearSolverLLT) : {
+    // Schur complement of the Cholesky decomposition H = L L^T
+    Eigen::LLT<MatrixNd> H_llt (H);
+    MatrixNd Y = H_llt.matrixL().solve (G.transpose());
+    VectorNd z = H_llt.matrixL().solve (c);
+    VectorNd x_l = (Y.transpose() * Y).llt().solve (Y.transpose() * z - gamma);
+    x.block(0, 0, c.rows(), 1) = H_llt.matrixU().solve (z - Y * x_l);
+    x.block(c.rows(), 0, gamma.rows(), 1) = x_l;
+    break;
+  }
   default:
     LOG << "Error: Invalid linear solver: " << linear_solver << std::endl;
     assert (0);
@@ -792,6 +837,137 @@ void SolveConstrainedSystemNullSpace (
 }
 
 
+//==============================================================================
+/* The following variants of the SolveConstrainedSystem functions use the
+ * workspace of the ConstraintSet such that they do not allocate memory. The
+ * constrained system is described by CS.H, CS.G, the given right hand side
+ * c, and gamma. */
+static void SolveConstrainedSystemDirect (
+  ConstraintSet &CS,
+  const Math::VectorNd &c,
+  const Math::VectorNd &gamma
+)
+{
+  const unsigned int n = unsigned(c.rows());
+  const unsigned int m = unsigned(gamma.rows());
+
+  // The blocks H and G of A always hold the matrices of the last
+  // decomposition. If they did not change, e.g. when computing impulses and
+  // dynamics at the same configuration, the decomposition is reused.
+  bool reuse_decomposition = CS.A_factorized_solver == CS.linear_solver
+    && CS.A.block(0, 0, n, n) == CS.H
+    && CS.A.block(n, 0, m, n) == CS.G;
+
+  if (!reuse_decomposition) {
+    CS.A.block(0, 0, n, n) = CS.H;
+    CS.A.block(0, n, n, m) = CS.G.transpose();
+    CS.A.block(n, 0, m, n) = CS.G;
+
+    if (CS.linear_solver == LinearSolverLLT) {
+      // A is indefinite, therefore use the Cholesky decomposition
+      // H = L L^T and the Schur complement K = G H^-1 G^T = Y^T Y with
+      // Y = L^-1 G^T instead of a decomposition of A.
+      CS.H_llt.compute (CS.H);
+      CS.schur_Y = CS.G.transpose();
+      CS.H_llt.matrixL().solveInPlace (CS.schur_Y);
+      CS.schur_K.noalias() = CS.schur_Y.transpose() * CS.schur_Y;
+      CS.schur_K_llt.compute (CS.schur_K);
+    } else {
+      CS.A_solver.compute (CS.A, CS.linear_solver);
+    }
+    CS.A_factorized_solver = CS.linear_solver;
+  }
+
+  if (CS.linear_solver == LinearSolverLLT) {
+    // z = L^-1 c, K x_l = Y^T z - gamma, L^T x_q = z - Y x_l
+    CS.tmp_qdot_a = c;
+    CS.H_llt.matrixL().solveInPlace (CS.tmp_qdot_a);
+    CS.tmp_lambda = -gamma;
+    CS.tmp_lambda.noalias() += CS.schur_Y.transpose() * CS.tmp_qdot_a;
+    CS.schur_K_llt.solveInPlace (CS.tmp_lambda);
+    CS.tmp_qdot_a.noalias() -= CS.schur_Y * CS.tmp_lambda;
+    CS.H_llt.matrixU().solveInPlace (CS.tmp_qdot_a);
+
+    CS.x.head(n) = CS.tmp_qdot_a;
+    CS.x.tail(m) = CS.tmp_lambda;
+    return;
+  }
+
+  CS.b.block(0, 0, n, 1) = c;
+  CS.b.block(n, 0, m, 1) = gamma;
+
+  CS.A_solver.solve (CS.b, CS.x);
+}
+
+static void SolveConstrainedSystemRangeSpaceSparse (
+  Model &model,
+  ConstraintSet &CS,
+  const Math::VectorNd &c,
+  const Math::VectorNd &gamma,
+  Math::VectorNd &qddot,
+  Math::VectorNd &lambda
+)
+{
+  SparseFactorizeLTL (model, CS.H);
+
+  CS.Y = CS.G.transpose();
+
+  for (unsigned int i = 0; i < CS.Y.cols(); i++) {
+    CS.tmp_qdot_a = CS.Y.col(i);
+    SparseSolveLTx (model, CS.H, CS.tmp_qdot_a);
+    CS.Y.col(i) = CS.tmp_qdot_a;
+  }
+
+  CS.tmp_qdot_b = c;
+  SparseSolveLTx (model, CS.H, CS.tmp_qdot_b);
+
+  CS.K.noalias() = CS.Y.transpose() * CS.Y;
+
+  CS.a = gamma;
+  CS.a.noalias() -= CS.Y.transpose() * CS.tmp_qdot_b;
+
+  CS.K_solver.compute (CS.K, LinearSolverLLT);
+  CS.K_solver.solve (CS.a, lambda);
+
+  qddot = c;
+  qddot.noalias() += CS.G.transpose() * lambda;
+  SparseSolveLTx (model, CS.H, qddot);
+  SparseSolveLx (model, CS.H, qddot);
+}
+
+static void SolveConstrainedSystemNullSpace (
+  ConstraintSet &CS,
+  const Math::VectorNd &c,
+  const Math::VectorNd &gamma,
+  Math::VectorNd &qddot,
+  Math::VectorNd &lambda
+)
+{
+  CS.GY.noalias() = CS.G * CS.Y;
+  CS.GY_solver.compute (CS.GY, CS.linear_solver);
+  CS.GY_solver.solve (gamma, CS.qddot_y);
+
+  // qddot_z = (Z^T H Z)^-1 Z^T (c - H Y qddot_y)
+  CS.tmp_qdot_a.noalias() = CS.Y * CS.qddot_y;
+  CS.tmp_qdot_b = c;
+  CS.tmp_qdot_b.noalias() -= CS.H * CS.tmp_qdot_a;
+  CS.tmp_z.noalias() = CS.Z.transpose() * CS.tmp_qdot_b;
+
+  CS.HZ.noalias() = CS.H * CS.Z;
+  CS.ZTHZ.noalias() = CS.Z.transpose() * CS.HZ;
+  CS.ZTHZ_llt.compute (CS.ZTHZ);
+  CS.qddot_z = CS.ZTHZ_llt.solve (CS.tmp_z);
+
+  qddot.noalias() = CS.Y * CS.qddot_y;
+  qddot.noalias() += CS.Z * CS.qddot_z;
+
+  // lambda = (G Y)^-1 Y^T (H qddot - c)
+  CS.tmp_qdot_a = -c;
+  CS.tmp_qdot_a.noalias() += CS.H * qddot;
+  CS.tmp_lambda.noalias() = CS.Y.transpose() * CS.tmp_qdot_a;
+  CS.GY_solver.solve (CS.tmp_lambda, lambda);
+}
+
 //==============================================================================
 RBDL_DLLAPI
 void CalcConstraintsPositionError (
@@ -828,9 +1004,27 @@ void CalcConstraintsJacobian (
     UpdateKinematicsCustom (model, &Q, NULL, NULL);
   }
 
+  // The point Jacobians of all contact constraints are evaluated in a
+  // single pass such that joints shared by several contact points are only
+  // processed once.
+  if (CS.contactConstraints.size() > 0) {
+    CS.contactPointJacobians.setZero();
+    CalcPointJacobians (model, Q, CS.contactBodyIds, CS.contactBodyPoints,
+        CS.contactPointJacobians, false);
+  }
+
+  unsigned int contact_index = 0;
   for(unsigned int i=0; i<CS.constraints.size(); ++i) {
-    CS.constraints[i]->calcConstraintJacobian(model,0,Q,CS.cache.vecNZeros,G,
-        CS.cache,update_kinematics);
+    if (contact_index < CS.contactConstraints.size()
+        && CS.constraints[i] == CS.contactConstraints[contact_index]) {
+      CS.contactConstraints[contact_index]
+        ->calcConstraintJacobianFromPointJacobian(CS.contactPointJacobians,
+            3 * contact_index, G);
+      contact_index++;
+    } else {
+      CS.constraints[i]->calcConstraintJacobian(model,0,Q,
+          CS.cache.vecNZeros,G,CS.cache,false);
+    }
   }
 }
 
@@ -1075,8 +1269,8 @@ void ForwardDynamicsConstraintsDirect (
 
   CalcConstrainedSystemVariables (model, Q, QDot, Tau, CS, f_ext);
 
-  SolveConstrainedSystemDirect (CS.H, CS.G, Tau - CS.C, CS.gamma
-                                , CS.force, CS.A, CS.b, CS.x, CS.linear_solver);
+  CS.rhs = Tau - CS.C;
+  SolveConstrainedSystemDirect (CS, CS.rhs, CS.gamma);
 
   // Copy back QDDot
   for (unsigned int i = 0; i < model.dof_count; i++) {
@@ -1103,8 +1297,9 @@ void ForwardDynamicsConstraintsRangeSpaceSparse (
 
   CalcConstrainedSystemVariables (model, Q, QDot, Tau, CS, f_ext);
 
-  SolveConstrainedSystemRangeSpaceSparse (model, CS.H, CS.G, Tau - CS.C
-                                          , CS.gamma, QDDot, CS.force, CS.K, CS.a, CS.linear_solver);
+  CS.rhs = Tau - CS.C;
+  SolveConstrainedSystemRangeSpaceSparse (model, CS, CS.rhs, CS.gamma, QDDot,
+      CS.force);
 }
 
 //==============================================================================
@@ -1125,13 +1320,13 @@ void ForwardDynamicsConstraintsNullSpace (
   CalcConstrainedSystemVariables (model, Q, QDot, Tau, CS, f_ext);
 
   CS.GT_qr.compute (CS.G.transpose());
-  CS.GT_qr.householderQ().evalTo (CS.GT_qr_Q);
+  CS.GT_qr.householderQ().evalTo (CS.GT_qr_Q, CS.tmp_qdot_a);
 
   CS.Y = CS.GT_qr_Q.block (0,0,QDot.rows(), CS.G.rows());
   CS.Z = CS.GT_qr_Q.block (0,CS.G.rows(),QDot.rows(), QDot.rows() - CS.G.rows());
 
-  SolveConstrainedSystemNullSpace (CS.H, CS.G, Tau - CS.C, CS.gamma, QDDot
-                                   , CS.force, CS.Y, CS.Z, CS.qddot_y, CS.qddot_z, CS.linear_solver);
+  CS.rhs = Tau - CS.C;
+  SolveConstrainedSystemNullSpace (CS, CS.rhs, CS.gamma, QDDot, CS.force);
 
 }
 
@@ -1153,8 +1348,8 @@ void ComputeConstraintImpulsesDirect (
   // Compute G
   CalcConstraintsJacobian (model, Q, CS, CS.G, false);
 
-  SolveConstrainedSystemDirect (CS.H, CS.G, CS.H * QDotMinus, CS.v_plus
-                                , CS.impulse, CS.A, CS.b, CS.x, CS.linear_solver);
+  CS.rhs.noalias() = CS.H * QDotMinus;
+  SolveConstrainedSystemDirect (CS, CS.rhs, CS.v_plus);
 
   // Copy back QDotPlus
   for (unsigned int i = 0; i < model.dof_count; i++) {
@@ -1186,8 +1381,9 @@ void ComputeConstraintImpulsesRangeSpaceSparse (
   // Compute G
   CalcConstraintsJacobian (model, Q, CS, CS.G, false);
 
-  SolveConstrainedSystemRangeSpaceSparse (model, CS.H, CS.G, CS.H * QDotMinus
-                                          , CS.v_plus, QDotPlus, CS.impulse, CS.K, CS.a, CS.linear_solver);
+  CS.rhs.noalias() = CS.H * QDotMinus;
+  SolveConstrainedSystemRangeSpaceSparse (model, CS, CS.rhs, CS.v_plus,
+      QDotPlus, CS.impulse);
 
 }
 
@@ -1210,15 +1406,15 @@ void ComputeConstraintImpulsesNullSpace (
   CalcConstraintsJacobian (model, Q, CS, CS.G, false);
 
   CS.GT_qr.compute(CS.G.transpose());
-  CS.GT_qr_Q = CS.GT_qr.householderQ();
+  CS.GT_qr.householderQ().evalTo (CS.GT_qr_Q, CS.tmp_qdot_a);
 
   CS.Y = CS.GT_qr_Q.block (0,0,QDotMinus.rows(), CS.G.rows());
   CS.Z = CS.GT_qr_Q.block (0,CS.G.rows(),QDotMinus.rows(), QDotMinus.rows()
                            - CS.G.rows());
 
-  SolveConstrainedSystemNullSpace (CS.H, CS.G, CS.H * QDotMinus, CS.v_plus
-                                   , QDotPlus, CS.impulse, CS.Y, CS.Z, CS.qddot_y, CS.qddot_z
-                                   , CS.linear_solver);
+  CS.rhs.noalias() = CS.H * QDotMinus;
+  SolveConstrainedSystemNullSpace (CS, CS.rhs, CS.v_plus, QDotPlus,
+      CS.impulse);
 }
 
 //==============================================================================
@@ -1535,18 +1731,19 @@ inline void set_zero (std::vector<SpatialVector> &spatial_values)
 }
 
 //==============================================================================
-RBDL_DLLAPI
-void ForwardDynamicsContactsKokkevis (
+/* Builds the quantities shared by the Kokkevis and the projected Gauss-Seidel
+ * contact methods: the unconstrained accelerations CS.QDDot_0, the
+ * constraint accelerations CS.a they cause, the test forces CS.f_t, and the
+ * operator CS.K that maps the test forces to the changes of the constraint
+ * accelerations. */
+static void CalcContactsKokkevisOperator (
   Model &model,
   const VectorNd &Q,
   const VectorNd &QDot,
   const VectorNd &Tau,
-  ConstraintSet &CS,
-  VectorNd &QDDot
+  ConstraintSet &CS
 )
 {
-  LOG << "-------- " << __func__ << " ------" << std::endl;
-
   assert (CS.f_ext_constraints.size() == model.mBodies.size());
   assert (CS.QDDot_0.size() == model.dof_count);
   assert (CS.QDDot_t.size() == model.dof_count);
@@ -1679,27 +1876,20 @@ void ForwardDynamicsContactsKokkevis (
 
   LOG << "K = " << std::endl << CS.K << std::endl;
   LOG << "a = " << std::endl << CS.a << std::endl;
+}
 
-  switch (CS.linear_solver) {
-  case (LinearSolverPartialPivLU) :
-    CS.force = CS.K.partialPivLu().solve(CS.a);
-    break;
-  case (LinearSolverColPivHouseholderQR) :
-    CS.force = CS.K.colPivHouseholderQr().solve(CS.a);
-    break;
-  case (LinearSolverHouseholderQR) :
-    CS.force = CS.K.householderQr().solve(CS.a);
-    break;
-  default:
-    LOG << "Error: Invalid linear solver: " << CS.linear_solver << std::endl;
-    assert (0);
-    break;
-  }
-
-  LOG << "f = " << CS.force.transpose() << std::endl;
-
-
-  for(bi=0; bi<CS.contactConstraints.size(); ++bi) {
+//==============================================================================
+/* Applies the contact forces CS.force along the test forces CS.f_t and
+ * evaluates the resulting accelerations. */
+static void ApplyContactsKokkevisForces (
+  Model &model,
+  const VectorNd &Tau,
+  ConstraintSet &CS,
+  VectorNd &QDDot
+)
+{
+  unsigned int ci = 0;
+  for(unsigned int bi=0; bi<CS.contactConstraints.size(); ++bi) {
     unsigned int body_id =
       CS.contactConstraints[bi]->getBodyIds()[0];
     unsigned int movable_body_id = body_id;
@@ -1729,6 +1919,142 @@ void ForwardDynamicsContactsKokkevis (
   LOG << "QDDot after applying f_ext: " << QDDot.transpose() << std::endl;
 }
 
+//==============================================================================
+RBDL_DLLAPI
+void ForwardDynamicsContactsKokkevis (
+  Model &model,
+  const VectorNd &Q,
+  const VectorNd &QDot,
+  const VectorNd &Tau,
+  ConstraintSet &CS,
+  VectorNd &QDDot
+)
+{
+  LOG << "-------- " << __func__ << " ------" << std::endl;
+
+  CalcContactsKokkevisOperator (model, Q, QDot, Tau, CS);
+
+  CS.K_solver.compute (CS.K, CS.linear_solver);
+  CS.K_solver.solve (CS.a, CS.force);
+
+  LOG << "f = " << CS.force.transpose() << std::endl;
+
+  ApplyContactsKokkevisForces (model, Tau, CS, QDDot);
+}
+
+//==============================================================================
+/* Projects the forces of one contact onto its friction cone: the first
+ * direction of a ContactConstraint is treated as the unilateral normal and
+ * the remaining ones as the tangential (friction) directions. */
+static void ProjectContactForceOntoFrictionCone (
+  ContactConstraint &contact,
+  VectorNd &force
+)
+{
+  unsigned int ci = contact.getConstraintIndex();
+  unsigned int size = contact.getConstraintSize();
+
+  if (force[ci] < 0.) {
+    force[ci] = 0.;
+  }
+
+  if (size < 2) {
+    return;
+  }
+
+  double friction_limit = 0.;
+  if (force[ci] > 0.) {
+    friction_limit = contact.getFrictionCoefficient() * force[ci];
+  }
+
+  double tangential_norm = 0.;
+  for (unsigned int k = 1; k < size; k++) {
+    tangential_norm += force[ci + k] * force[ci + k];
+  }
+  tangential_norm = std::sqrt (tangential_norm);
+
+  if (tangential_norm > friction_limit) {
+    double scale = friction_limit / tangential_norm;
+    for (unsigned int k = 1; k < size; k++) {
+      force[ci + k] *= scale;
+    }
+  }
+}
+
+//==============================================================================
+RBDL_DLLAPI
+unsigned int ForwardDynamicsContactsPGS (
+  Model &model,
+  const VectorNd &Q,
+  const VectorNd &QDot,
+  const VectorNd &Tau,
+  ConstraintSet &CS,
+  VectorNd &QDDot,
+  unsigned int max_iterations,
+  double tolerance
+)
+{
+  LOG << "-------- " << __func__ << " ------" << std::endl;
+
+  CalcContactsKokkevisOperator (model, Q, QDot, Tau, CS);
+
+  // The constraint accelerations that result from the forces are
+  // a - K^T force, therefore the diagonal of the Delassus operator is -K(j,j).
+  // The forces of the previous call are used as the initial guess.
+  for (unsigned int bi = 0; bi < CS.contactConstraints.size(); bi++) {
+    ProjectContactForceOntoFrictionCone (*CS.contactConstraints[bi], CS.force);
+  }
+
+  unsigned int iteration = 0;
+  while (iteration < max_iterations) {
+    iteration++;
+    double max_change = 0.;
+
+    for (unsigned int bi = 0; bi < CS.contactConstraints.size(); bi++) {
+      ContactConstraint &contact = *CS.contactConstraints[bi];
+      unsigned int ci = contact.getConstraintIndex();
+      unsigned int size = contact.getConstraintSize();
+
+      for (unsigned int k = 0; k < size; k++) {
+        CS.cache.vec3A[k] = CS.force[ci + k];
+      }
+
+      for (unsigned int k = 0; k < size; k++) {
+        unsigned int row = ci + k;
+        double delassus = -CS.K(row, row);
+        if (delassus <= 0.) {
+          continue;
+        }
+        double accel = CS.a[row] - CS.K.col(row).dot(CS.force);
+        CS.force[row] -= accel / delassus;
+
+        // project the normal force before the tangential rows use it
+        if (k == 0 && CS.force[row] < 0.) {
+          CS.force[row] = 0.;
+        }
+      }
+
+      ProjectContactForceOntoFrictionCone (contact, CS.force);
+
+      for (unsigned int k = 0; k < size; k++) {
+        max_change = std::max (max_change, std::fabs (CS.force[ci + k]
+                                                      - CS.cache.vec3A[k]));
+      }
+    }
+
+    LOG << "iteration " << iteration << " f = " << CS.force.transpose()
+        << std::endl;
+
+    if (max_change <= tolerance) {
+      break;
+    }
+  }
+
+  ApplyContactsKokkevisForces (model, Tau, CS, QDDot);
+
+  return iteration;
+}
+
 
 //==============================================================================
 
@@ -1854,6 +2180,83 @@ void InverseDynamicsConstraints(
 
 
 
+}
+
+RBDL_DLLAPI
+void InverseDynamicsConstraintsRecursive(
+  Model &model,
+  const Math::VectorNd &Q,
+  const Math::VectorNd &QDot,
+  const Math::VectorNd &QDDotDesired,
+  ConstraintSet &CS,
+  Math::VectorNd &QDDotOutput,
+  Math::VectorNd &TauOutput,
+  std::vector<Math::SpatialVector> *f_ext)
+{
+
+  LOG << "-------- " << __func__ << " ------" << std::endl;
+
+  assert (QDot.size()         == QDDotDesired.size());
+  assert (QDDotOutput.size()  == QDot.size());
+  assert (TauOutput.size()    == model.dof_count);
+
+  assert (CS.S.cols()     == QDDotDesired.rows());
+  assert (CS.actuatedDofIndices.size() == CS.S.rows());
+
+  unsigned int na = unsigned( CS.actuatedDofIndices.size());
+  unsigned int nu = unsigned( CS.unactuatedDofIndices.size());
+
+  // Kinematics with zero joint accelerations, as required by calcGamma()
+  CS.QDDot_0.setZero();
+  UpdateKinematicsCustom(model, &Q, &QDot, &CS.QDDot_0);
+
+  CalcConstraintsJacobian (model, Q, CS, CS.G, false);
+  CalcConstraintsPositionError (model, Q, CS, CS.err, false);
+  CalcConstraintsVelocityError (model, Q, QDot, CS, CS.errd, false);
+
+  for(unsigned int i=0; i<CS.constraints.size(); ++i) {
+    CS.constraints[i]->calcGamma(model,0,Q,QDot,CS.G,CS.gamma,CS.cache);
+    if(CS.constraints[i]->isBaumgarteStabilizationEnabled()) {
+      CS.constraints[i]->addInBaumgarteStabilizationForces(
+        CS.err,CS.errd,CS.gamma);
+    }
+  }
+
+  // u = S qdd*
+  // (GP') v = gamma - (GS') u
+  CS.tmp_lambda = CS.gamma;
+  for(unsigned int i=0; i<na; ++i) {
+    CS.u[i] = QDDotDesired[CS.actuatedDofIndices[i]];
+    CS.tmp_lambda -= CS.G.col(CS.actuatedDofIndices[i]) * CS.u[i];
+  }
+  for(unsigned int i=0; i<nu; ++i) {
+    CS.GPT.col(i) = CS.G.col(CS.unactuatedDofIndices[i]);
+  }
+  SolveLinearSystem(CS.GPT, CS.tmp_lambda, CS.v, CS.linear_solver);
+
+  for(unsigned int i=0; i<na; ++i) {
+    QDDotOutput[CS.actuatedDofIndices[i]] = CS.u[i];
+  }
+  for(unsigned int i=0; i<nu; ++i) {
+    QDDotOutput[CS.unactuatedDofIndices[i]] = CS.v[i];
+  }
+
+  // H qdd + C
+  InverseDynamics(model, Q, QDot, QDDotOutput, TauOutput, f_ext);
+
+  // (PG') lambda = P (H qdd + C)
+  VectorNd Ptau (nu);
+  for(unsigned int i=0; i<nu; ++i) {
+    Ptau[i] = TauOutput[CS.unactuatedDofIndices[i]];
+  }
+  CS.GTl = CS.GPT.transpose();
+  SolveLinearSystem(CS.GTl, Ptau, CS.force, CS.linear_solver);
+
+  // tau = S'S (H qdd + C - G' lambda)
+  TauOutput.noalias() -= CS.G.transpose() * CS.force;
+  for(unsigned int i=0; i<nu; ++i) {
+    TauOutput[CS.unactuatedDofIndices[i]] = 0.;
+  }
 }
 
 RBDL_DLLAPI
@@ -2177,4 +2580,24 @@ void ConstraintSet::calcBaumgarteStabilizationForces(
 
 }
 
+//==============================================================================
+
+void ConstraintSet::setFrictionCoefficient(
+  unsigned int groupIndex,
+  double frictionCoefficient)
+{
+  assert(groupIndex <= unsigned(constraints.size()-1));
+
+  ContactConstraint *contact =
+    dynamic_cast<ContactConstraint*>(constraints[groupIndex].get());
+  if (contact == NULL) {
+    std::ostringstream errormsg;
+    errormsg << "Error: the constraint group " << groupIndex
+             << " is not a ContactConstraint: a friction coefficient can"
+             << " only be assigned to contacts." << std::endl;
+    throw Errors::RBDLError(errormsg.str());
+  }
+  contact->setFrictionCoefficient(frictionCoefficient);
+}
+
 } /* namespace RigidBodyDynamics */
@@ -9,6 +9,8 @@
 #include <limits>
 #include <assert.h>
 #include <string.h>
+#include <sstream>
+#include <algorithm>
 
 #include "rbdl/rbdl_mathutils.h"
 #include "rbdl/Logging.h"
@@ -19,12 +21,16 @@
 #include "rbdl/Dynamics.h"
 #include "rbdl/Kinematics.h"
 
+#include "rbdl_lanes.h"
+#include "rbdl_parallel.h"
+
 namespace RigidBodyDynamics {
 
 using namespace Math;
 
 RBDL_DLLAPI void InverseDynamics (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &QDDot,
@@ -33,27 +39,27 @@ RBDL_DLLAPI void InverseDynamics (
   LOG << "-------- " << __func__ << " --------" << std::endl;
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
-  model.a[0].set (0., 0., 0., -model.gravity[0], -model.gravity[1], -model.gravity[2]);
+  data.v[0].setZero();
+  data.a[0].set (0., 0., 0., -model.gravity[0], -model.gravity[1], -model.gravity[2]);
 
   for (unsigned int i = 1; i < model.mBodies.size(); i++) {
     unsigned int q_index = model.mJoints[i].q_index;
     unsigned int lambda = model.lambda[i];
 
-    jcalc (model, i, Q, QDot);
+    jcalc (model, data, i, Q, QDot);
 
-    model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
-    model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
+    data.v[i] = data.X_lambda[i].apply(data.v[lambda]) + data.v_J[i];
+    data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
 
     if(model.mJoints[i].mJointType != JointTypeCustom){
       if (model.mJoints[i].mDoFCount == 1) {
-        model.a[i] =  model.X_lambda[i].apply(model.a[lambda])
-          + model.c[i]
-          + model.S[i] * QDDot[q_index];
+        data.a[i] =  data.X_lambda[i].apply(data.a[lambda])
+          + data.c[i]
+          + data.S[i] * QDDot[q_index];
       } else if (model.mJoints[i].mDoFCount == 3) {
-        model.a[i] =  model.X_lambda[i].apply(model.a[lambda])
-          + model.c[i]
-          + model.multdof3_S[i] * Vector3d (QDDot[q_index],
+        data.a[i] =  data.X_lambda[i].apply(data.a[lambda])
+          + data.c[i]
+          + data.multdof3_S[i] * Vector3d (QDDot[q_index],
               QDDot[q_index + 1],
               QDDot[q_index + 2]);
       }
@@ -63,49 +69,50 @@ RBDL_DLLAPI void InverseDynamics (
       for(unsigned z = 0; z < model.mCustomJoints[k]->mDoFCount; ++z){
         customJointQDDot[z] = QDDot[q_index+z];
       }
-      model.a[i] =  model.X_lambda[i].apply(model.a[lambda])
-        + model.c[i]
+      data.a[i] =  data.X_lambda[i].apply(data.a[lambda])
+        + data.c[i]
         + model.mCustomJoints[k]->S * customJointQDDot;
     }
 
     if (!model.mBodies[i].mIsVirtual) {
-      model.f[i] = model.I[i] * model.a[i] + crossf(model.v[i],model.I[i] * model.v[i]);
+      data.f[i] = model.I[i] * data.a[i] + crossf(data.v[i],model.I[i] * data.v[i]);
     } else {
-      model.f[i].setZero();
+      data.f[i].setZero();
     }
   }
 
   if (f_ext != NULL) {
     for (unsigned int i = 1; i < model.mBodies.size(); i++) {
       unsigned int lambda = model.lambda[i];
-      model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
-      model.f[i] -= model.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
+      data.X_base[i] = data.X_lambda[i] * data.X_base[lambda];
+      data.f[i] -= data.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
     }
   }
 
   for (unsigned int i = model.mBodies.size() - 1; i > 0; i--) {
     if(model.mJoints[i].mJointType != JointTypeCustom){
       if (model.mJoints[i].mDoFCount == 1) {
-        Tau[model.mJoints[i].q_index] = model.S[i].dot(model.f[i]);
+        Tau[model.mJoints[i].q_index] = data.S[i].dot(data.f[i]);
       } else if (model.mJoints[i].mDoFCount == 3) {
         Tau.block<3,1>(model.mJoints[i].q_index, 0)
-          = model.multdof3_S[i].transpose() * model.f[i];
+          = data.multdof3_S[i].transpose() * data.f[i];
       }
     } else if (model.mJoints[i].mJointType == JointTypeCustom) {  
       unsigned int k = model.mJoints[i].custom_joint_index;
       Tau.block(model.mJoints[i].q_index,0,
           model.mCustomJoints[k]->mDoFCount, 1)
-        = model.mCustomJoints[k]->S.transpose() * model.f[i];
+        = model.mCustomJoints[k]->S.transpose() * data.f[i];
     }
 
     if (model.lambda[i] != 0) {
-      model.f[model.lambda[i]] = model.f[model.lambda[i]] + model.X_lambda[i].applyTranspose(model.f[i]);
+      data.f[model.lambda[i]] = data.f[model.lambda[i]] + data.X_lambda[i].applyTranspose(data.f[i]);
     }
   }
 }
 
 RBDL_DLLAPI void NonlinearEffects ( 
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     VectorNd &Tau,
@@ -115,30 +122,30 @@ RBDL_DLLAPI void NonlinearEffects (
   SpatialVector spatial_gravity (0., 0., 0., -model.gravity[0], -model.gravity[1], -model.gravity[2]);
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
-  model.a[0] = spatial_gravity;
+  data.v[0].setZero();
+  data.a[0] = spatial_gravity;
 
   for (unsigned int i = 1; i < model.mJointUpdateOrder.size(); i++) {
-    jcalc (model, model.mJointUpdateOrder[i], Q, QDot);
+    jcalc (model, data, model.mJointUpdateOrder[i], Q, QDot);
   }
 
   for (unsigned int i = 1; i < model.mBodies.size(); i++) {
     if (model.lambda[i] == 0) {
-      model.v[i] = model.v_J[i];
-      model.a[i] = model.X_lambda[i].apply(spatial_gravity);
+      data.v[i] = data.v_J[i];
+      data.a[i] = data.X_lambda[i].apply(spatial_gravity);
     }	else {
-      model.v[i] = model.X_lambda[i].apply(model.v[model.lambda[i]]) + model.v_J[i];
-      model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
-      model.a[i] = model.X_lambda[i].apply(model.a[model.lambda[i]]) + model.c[i];
+      data.v[i] = data.X_lambda[i].apply(data.v[model.lambda[i]]) + data.v_J[i];
+      data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
+      data.a[i] = data.X_lambda[i].apply(data.a[model.lambda[i]]) + data.c[i];
     }
 
     if (!model.mBodies[i].mIsVirtual) {
-      model.f[i] = model.I[i] * model.a[i] + crossf(model.v[i],model.I[i] * model.v[i]);
+      data.f[i] = model.I[i] * data.a[i] + crossf(data.v[i],model.I[i] * data.v[i]);
       if (f_ext != NULL && (*f_ext)[i] != SpatialVector::Zero()) {
-        model.f[i] -= model.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
+        data.f[i] -= data.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
       }            
     } else {
-      model.f[i].setZero();
+      data.f[i].setZero();
     }
   }
 
@@ -146,26 +153,164 @@ RBDL_DLLAPI void NonlinearEffects (
     if(model.mJoints[i].mJointType != JointTypeCustom){
       if (model.mJoints[i].mDoFCount == 1) {
         Tau[model.mJoints[i].q_index]
-          = model.S[i].dot(model.f[i]);
+          = data.S[i].dot(data.f[i]);
       } else if (model.mJoints[i].mDoFCount == 3) {
         Tau.block<3,1>(model.mJoints[i].q_index, 0)
-          = model.multdof3_S[i].transpose() * model.f[i];
+          = data.multdof3_S[i].transpose() * data.f[i];
       }
     } else if(model.mJoints[i].mJointType == JointTypeCustom) {
       unsigned int k = model.mJoints[i].custom_joint_index;
       Tau.block(model.mJoints[i].q_index,0,
           model.mCustomJoints[k]->mDoFCount, 1)
-        = model.mCustomJoints[k]->S.transpose() * model.f[i];
+        = model.mCustomJoints[k]->S.transpose() * data.f[i];
     }
 
     if (model.lambda[i] != 0) {
-      model.f[model.lambda[i]] = model.f[model.lambda[i]] + model.X_lambda[i].applyTranspose(model.f[i]);
+      data.f[model.lambda[i]] = data.f[model.lambda[i]] + data.X_lambda[i].applyTranspose(data.f[i]);
+    }
+  }
+}
+
+/** \brief Computes the entries of H that belong to the degrees of freedom
+ * of body i and all its ancestors.
+ *
+ * Requires that data.Ic[i] contains the composite inertia of the subtree
+ * of body i. The entries of different bodies are disjoint.
+ */
+static void CompositeRigidBodyAlgorithmColumn (
+    const Model &model,
+    ModelData &data,
+    unsigned int i,
+    MatrixNd &H) {
+  unsigned int dof_index_i = model.mJoints[i].q_index;
+
+  if (model.mJoints[i].mDoFCount == 1 
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+
+    SpatialVector F             = data.Ic[i] * data.S[i];
+    H(dof_index_i, dof_index_i) = data.S[i].dot(F);
+
+    unsigned int j = i;
+    unsigned int dof_index_j = dof_index_i;
+
+    while (model.lambda[j] != 0) {
+      F = data.X_lambda[j].applyTranspose(F);
+      j = model.lambda[j];
+      dof_index_j = model.mJoints[j].q_index;
+
+      if(model.mJoints[j].mJointType != JointTypeCustom) {
+        if (model.mJoints[j].mDoFCount == 1) {
+          H(dof_index_i,dof_index_j) = F.dot(data.S[j]);
+          H(dof_index_j,dof_index_i) = H(dof_index_i,dof_index_j);
+        } else if (model.mJoints[j].mDoFCount == 3) {
+          Vector3d H_temp2 = 
+            (F.transpose() * data.multdof3_S[j]).transpose();
+          LOG << F.transpose() << std::endl 
+            << data.multdof3_S[j] << std::endl;
+          LOG << H_temp2.transpose() << std::endl;
+
+          H.block<1,3>(dof_index_i,dof_index_j) = H_temp2.transpose();
+          H.block<3,1>(dof_index_j,dof_index_i) = H_temp2;
+        }
+      } else if (model.mJoints[j].mJointType == JointTypeCustom){        
+        unsigned int k      = model.mJoints[j].custom_joint_index;
+        unsigned int dof    = model.mCustomJoints[k]->mDoFCount;
+        VectorNd H_temp2    =
+          (F.transpose() * model.mCustomJoints[k]->S).transpose();
+
+        LOG << F.transpose()
+          << std::endl
+          << model.mCustomJoints[j]->S << std::endl;
+
+        LOG << H_temp2.transpose() << std::endl;
+
+        H.block(dof_index_i,dof_index_j,1,dof) = H_temp2.transpose();
+        H.block(dof_index_j,dof_index_i,dof,1) = H_temp2;
+      }
+    }
+  } else if (model.mJoints[i].mDoFCount == 3
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    Matrix63 F_63 = data.Ic[i].toMatrix() * data.multdof3_S[i];
+    H.block<3,3>(dof_index_i, dof_index_i) = data.multdof3_S[i].transpose() * F_63;
+
+    unsigned int j = i;
+    unsigned int dof_index_j = dof_index_i;
+
+    while (model.lambda[j] != 0) {
+      F_63 = data.X_lambda[j].toMatrixTranspose() * (F_63);
+      j = model.lambda[j];
+      dof_index_j = model.mJoints[j].q_index;
+
+      if(model.mJoints[j].mJointType != JointTypeCustom){
+        if (model.mJoints[j].mDoFCount == 1) {
+          Vector3d H_temp2 = F_63.transpose() * (data.S[j]);
+
+          H.block<3,1>(dof_index_i,dof_index_j) = H_temp2;
+          H.block<1,3>(dof_index_j,dof_index_i) = H_temp2.transpose();
+        } else if (model.mJoints[j].mDoFCount == 3) {
+          Matrix3d H_temp2 = F_63.transpose() * (data.multdof3_S[j]);
+
+          H.block<3,3>(dof_index_i,dof_index_j) = H_temp2;
+          H.block<3,3>(dof_index_j,dof_index_i) = H_temp2.transpose();
+        }
+      } else if (model.mJoints[j].mJointType == JointTypeCustom){
+        unsigned int k = model.mJoints[j].custom_joint_index;
+        unsigned int dof = model.mCustomJoints[k]->mDoFCount;
+
+        MatrixNd H_temp2 = F_63.transpose() * (model.mCustomJoints[k]->S);
+
+        H.block(dof_index_i,dof_index_j,3,dof) = H_temp2;
+        H.block(dof_index_j,dof_index_i,dof,3) = H_temp2.transpose();
+      }
+    }
+  } else if (model.mJoints[i].mJointType == JointTypeCustom) {      
+    unsigned int kI = model.mJoints[i].custom_joint_index;
+    unsigned int dofI = model.mCustomJoints[kI]->mDoFCount;
+
+    MatrixNd F_Nd = data.Ic[i].toMatrix()
+      * model.mCustomJoints[kI]->S;
+
+    H.block(dof_index_i, dof_index_i,dofI,dofI)
+      = model.mCustomJoints[kI]->S.transpose() * F_Nd;
+
+    unsigned int j = i;
+    unsigned int dof_index_j = dof_index_i;
+
+    while (model.lambda[j] != 0) {
+      F_Nd = data.X_lambda[j].toMatrixTranspose() * (F_Nd);
+      j = model.lambda[j];
+      dof_index_j = model.mJoints[j].q_index;
+
+      if(model.mJoints[j].mJointType != JointTypeCustom){
+        if (model.mJoints[j].mDoFCount == 1) {
+          MatrixNd H_temp2 = F_Nd.transpose() * (data.S[j]);
+          H.block(   dof_index_i,  dof_index_j,
+              H_temp2.rows(),H_temp2.cols()) = H_temp2;
+          H.block(dof_index_j,dof_index_i,
+              H_temp2.cols(),H_temp2.rows()) = H_temp2.transpose();
+        } else if (model.mJoints[j].mDoFCount == 3) {
+          MatrixNd H_temp2 = F_Nd.transpose() * (data.multdof3_S[j]);
+          H.block(dof_index_i,   dof_index_j,
+              H_temp2.rows(),H_temp2.cols()) = H_temp2;
+          H.block(dof_index_j,   dof_index_i,
+              H_temp2.cols(),H_temp2.rows()) = H_temp2.transpose();
+        }
+      } else if (model.mJoints[j].mJointType == JointTypeCustom){
+        unsigned int k   = model.mJoints[j].custom_joint_index;
+        unsigned int dof = model.mCustomJoints[k]->mDoFCount;
+
+        MatrixNd H_temp2 = F_Nd.transpose() * (model.mCustomJoints[k]->S);
+
+        H.block(dof_index_i,dof_index_j,3,dof) = H_temp2;
+        H.block(dof_index_j,dof_index_i,dof,3) = H_temp2.transpose();
+      }
     }
   }
 }
 
 RBDL_DLLAPI void CompositeRigidBodyAlgorithm (
-    Model& model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     MatrixNd &H,
     bool update_kinematics) {
@@ -175,145 +320,283 @@ RBDL_DLLAPI void CompositeRigidBodyAlgorithm (
 
   for (unsigned int i = 1; i < model.mBodies.size(); i++) {
     if (update_kinematics) {
-      jcalc_X_lambda_S (model, i, Q);
+      jcalc_X_lambda_S (model, data, i, Q);
     }
-    model.Ic[i] = model.I[i];
+    data.Ic[i] = model.I[i];
   }
 
   for (unsigned int i = model.mBodies.size() - 1; i > 0; i--) {
     if (model.lambda[i] != 0) {
-      model.Ic[model.lambda[i]] = model.Ic[model.lambda[i]] + model.X_lambda[i].applyTranspose(model.Ic[i]);
+      data.Ic[model.lambda[i]] = data.Ic[model.lambda[i]] + data.X_lambda[i].applyTranspose(data.Ic[i]);
     }
 
-    unsigned int dof_index_i = model.mJoints[i].q_index;
-
-    if (model.mJoints[i].mDoFCount == 1 
-        && model.mJoints[i].mJointType != JointTypeCustom) {
+    CompositeRigidBodyAlgorithmColumn (model, data, i, H);
+  }
+}
 
-      SpatialVector F             = model.Ic[i] * model.S[i];
-      H(dof_index_i, dof_index_i) = model.S[i].dot(F);
-
-      unsigned int j = i;
-      unsigned int dof_index_j = dof_index_i;
-
-      while (model.lambda[j] != 0) {
-        F = model.X_lambda[j].applyTranspose(F);
-        j = model.lambda[j];
-        dof_index_j = model.mJoints[j].q_index;
-
-        if(model.mJoints[j].mJointType != JointTypeCustom) {
-          if (model.mJoints[j].mDoFCount == 1) {
-            H(dof_index_i,dof_index_j) = F.dot(model.S[j]);
-            H(dof_index_j,dof_index_i) = H(dof_index_i,dof_index_j);
-          } else if (model.mJoints[j].mDoFCount == 3) {
-            Vector3d H_temp2 = 
-              (F.transpose() * model.multdof3_S[j]).transpose();
-            LOG << F.transpose() << std::endl 
-              << model.multdof3_S[j] << std::endl;
-            LOG << H_temp2.transpose() << std::endl;
-
-            H.block<1,3>(dof_index_i,dof_index_j) = H_temp2.transpose();
-            H.block<3,1>(dof_index_j,dof_index_i) = H_temp2;
-          }
-        } else if (model.mJoints[j].mJointType == JointTypeCustom){        
-          unsigned int k      = model.mJoints[j].custom_joint_index;
-          unsigned int dof    = model.mCustomJoints[k]->mDoFCount;
-          VectorNd H_temp2    =
-            (F.transpose() * model.mCustomJoints[k]->S).transpose();
+/** \brief Motion subspace of a joint with at most 6 degrees of freedom
+ * that does not allocate any memory */
+typedef Eigen::Matrix<double, 6, Eigen::Dynamic, 0, 6, 6> JointMotionSubspace;
+
+static void GetJointMotionSubspace (
+    const Model &model,
+    const ModelData &data,
+    unsigned int body_id,
+    JointMotionSubspace &S) {
+  if (model.mJoints[body_id].mJointType == JointTypeCustom) {
+    S = model.mCustomJoints[model.mJoints[body_id].custom_joint_index]->S;
+  } else if (model.mJoints[body_id].mDoFCount == 1) {
+    S = data.S[body_id];
+  } else {
+    S = data.multdof3_S[body_id];
+  }
+}
 
-          LOG << F.transpose()
-            << std::endl
-            << model.mCustomJoints[j]->S << std::endl;
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmSparse (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    SparseJointSpaceMatrix &H,
+    bool update_kinematics) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
 
-          LOG << H_temp2.transpose() << std::endl;
+  if (H.rows() != model.dof_count || H.row_start.size() == 0) {
+    H.Init (model);
+  }
 
-          H.block(dof_index_i,dof_index_j,1,dof) = H_temp2.transpose();
-          H.block(dof_index_j,dof_index_i,dof,1) = H_temp2;
-        }
-      }
-    } else if (model.mJoints[i].mDoFCount == 3
-        && model.mJoints[i].mJointType != JointTypeCustom) {
-      Matrix63 F_63 = model.Ic[i].toMatrix() * model.multdof3_S[i];
-      H.block<3,3>(dof_index_i, dof_index_i) = model.multdof3_S[i].transpose() * F_63;
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    if (update_kinematics) {
+      jcalc_X_lambda_S (model, data, i, Q);
+    }
+    data.Ic[i] = model.I[i];
+  }
 
-      unsigned int j = i;
-      unsigned int dof_index_j = dof_index_i;
+  JointMotionSubspace S_i;
+  JointMotionSubspace S_j;
+  JointMotionSubspace F;
 
-      while (model.lambda[j] != 0) {
-        F_63 = model.X_lambda[j].toMatrixTranspose() * (F_63);
-        j = model.lambda[j];
-        dof_index_j = model.mJoints[j].q_index;
+  // position in H.values of the next entry of each row of joint i
+  unsigned int row_pos[6];
 
-        if(model.mJoints[j].mJointType != JointTypeCustom){
-          if (model.mJoints[j].mDoFCount == 1) {
-            Vector3d H_temp2 = F_63.transpose() * (model.S[j]);
+  for (unsigned int i = model.mBodies.size() - 1; i > 0; i--) {
+    if (model.lambda[i] != 0) {
+      data.Ic[model.lambda[i]] = data.Ic[model.lambda[i]]
+        + data.X_lambda[i].applyTranspose(data.Ic[i]);
+    }
 
-            H.block<3,1>(dof_index_i,dof_index_j) = H_temp2;
-            H.block<1,3>(dof_index_j,dof_index_i) = H_temp2.transpose();
-          } else if (model.mJoints[j].mDoFCount == 3) {
-            Matrix3d H_temp2 = F_63.transpose() * (model.multdof3_S[j]);
+    GetJointMotionSubspace (model, data, i, S_i);
+    unsigned int dof_index_i = model.mJoints[i].q_index;
+    unsigned int dof_i = S_i.cols();
+    assert (dof_i <= 6);
 
-            H.block<3,3>(dof_index_i,dof_index_j) = H_temp2;
-            H.block<3,3>(dof_index_j,dof_index_i) = H_temp2.transpose();
-          }
-        } else if (model.mJoints[j].mJointType == JointTypeCustom){
-          unsigned int k = model.mJoints[j].custom_joint_index;
-          unsigned int dof = model.mCustomJoints[k]->mDoFCount;
+    F.resize (6, dof_i);
+    for (unsigned int a = 0; a < dof_i; a++) {
+      F.col(a) = data.Ic[i] * SpatialVector (S_i.col(a));
+    }
 
-          MatrixNd H_temp2 = F_63.transpose() * (model.mCustomJoints[k]->S);
+    // Block of the joint itself: row dof_index_i + a contains the entries
+    // of the columns dof_index_i + a, ..., dof_index_i.
+    for (unsigned int a = 0; a < dof_i; a++) {
+      unsigned int row_start = H.row_start[dof_index_i + a];
+      for (unsigned int b = 0; b <= a; b++) {
+        H.values[row_start + a - b] = S_i.col(b).dot(F.col(a));
+      }
+      row_pos[a] = row_start + a + 1;
+    }
 
-          H.block(dof_index_i,dof_index_j,3,dof) = H_temp2;
-          H.block(dof_index_j,dof_index_i,dof,3) = H_temp2.transpose();
-        }
+    // The ancestor chain of each row continues with the last degree of
+    // freedom of the parent joint towards the root.
+    unsigned int j = i;
+    while (model.lambda[j] != 0) {
+      for (unsigned int a = 0; a < dof_i; a++) {
+        F.col(a) = data.X_lambda[j].applyTranspose (SpatialVector (F.col(a)));
       }
-    } else if (model.mJoints[i].mJointType == JointTypeCustom) {      
-      unsigned int kI = model.mJoints[i].custom_joint_index;
-      unsigned int dofI = model.mCustomJoints[kI]->mDoFCount;
-
-      MatrixNd F_Nd = model.Ic[i].toMatrix()
-        * model.mCustomJoints[kI]->S;
-
-      H.block(dof_index_i, dof_index_i,dofI,dofI)
-        = model.mCustomJoints[kI]->S.transpose() * F_Nd;
-
-      unsigned int j = i;
-      unsigned int dof_index_j = dof_index_i;
-
-      while (model.lambda[j] != 0) {
-        F_Nd = model.X_lambda[j].toMatrixTranspose() * (F_Nd);
-        j = model.lambda[j];
-        dof_index_j = model.mJoints[j].q_index;
-
-        if(model.mJoints[j].mJointType != JointTypeCustom){
-          if (model.mJoints[j].mDoFCount == 1) {
-            MatrixNd H_temp2 = F_Nd.transpose() * (model.S[j]);
-            H.block(   dof_index_i,  dof_index_j,
-                H_temp2.rows(),H_temp2.cols()) = H_temp2;
-            H.block(dof_index_j,dof_index_i,
-                H_temp2.cols(),H_temp2.rows()) = H_temp2.transpose();
-          } else if (model.mJoints[j].mDoFCount == 3) {
-            MatrixNd H_temp2 = F_Nd.transpose() * (model.multdof3_S[j]);
-            H.block(dof_index_i,   dof_index_j,
-                H_temp2.rows(),H_temp2.cols()) = H_temp2;
-            H.block(dof_index_j,   dof_index_i,
-                H_temp2.cols(),H_temp2.rows()) = H_temp2.transpose();
-          }
-        } else if (model.mJoints[j].mJointType == JointTypeCustom){
-          unsigned int k   = model.mJoints[j].custom_joint_index;
-          unsigned int dof = model.mCustomJoints[k]->mDoFCount;
+      j = model.lambda[j];
 
-          MatrixNd H_temp2 = F_Nd.transpose() * (model.mCustomJoints[k]->S);
+      GetJointMotionSubspace (model, data, j, S_j);
 
-          H.block(dof_index_i,dof_index_j,3,dof) = H_temp2;
-          H.block(dof_index_j,dof_index_i,dof,3) = H_temp2.transpose();
+      for (unsigned int a = 0; a < dof_i; a++) {
+        for (unsigned int c = S_j.cols(); c > 0; c--) {
+          assert (H.col_index[row_pos[a]] == model.mJoints[j].q_index + c - 1);
+          H.values[row_pos[a]] = F.col(a).dot(S_j.col(c - 1));
+          row_pos[a]++;
         }
       }
     }
   }
 }
 
+/*
+ * The passes of the Articulated Body Algorithm for a single body. They are
+ * shared by ForwardDynamics() and ForwardDynamicsParallel().
+ */
+
+/** \brief First pass: velocities, bias terms, and the rigid body inertia */
+static void ForwardDynamicsVelocityStep (
+    const Model &model,
+    ModelData &data,
+    unsigned int i,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    std::vector<SpatialVector> *f_ext) {
+  unsigned int lambda = model.lambda[i];
+
+  jcalc (model, data, i, Q, QDot);
+
+  if (lambda != 0)
+    data.X_base[i] = data.X_lambda[i] * data.X_base[lambda];
+  else
+    data.X_base[i] = data.X_lambda[i];
+
+  data.v[i] = data.X_lambda[i].apply( data.v[lambda]) + data.v_J[i];
+
+  data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
+  data.IA_packed[i] = SpatialArticulatedInertia (model.I[i]);
+
+  data.pA[i] = crossf(data.v[i],model.I[i] * data.v[i]);
+
+  if (f_ext != NULL && (*f_ext)[i] != SpatialVector::Zero()) {
+    data.pA[i] -= data.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
+  }
+}
+
+/** \brief Second pass: joint space quantities of the articulated body
+ *
+ * Requires that the articulated inertia and bias force of all children
+ * have been added to body i.
+ */
+static void ForwardDynamicsArticulatedBodyStep (
+    const Model &model,
+    ModelData &data,
+    unsigned int i,
+    const VectorNd &Tau) {
+  unsigned int q_index = model.mJoints[i].q_index;
+
+  if (model.mJoints[i].mDoFCount == 1
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    data.U[i] = data.IA_packed[i] * data.S[i];
+    data.d[i] = data.S[i].dot(data.U[i]);
+    data.u[i] = Tau[q_index] - data.S[i].dot(data.pA[i]);
+  } else if (model.mJoints[i].mDoFCount == 3
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    data.multdof3_U[i] = data.IA_packed[i] * data.multdof3_S[i];
+
+    data.multdof3_Dinv[i] = (data.multdof3_S[i].transpose()
+        * data.multdof3_U[i]).inverse().eval();
+
+    Vector3d tau_temp(Tau.block(q_index,0,3,1));
+    data.multdof3_u[i] = tau_temp 
+      - data.multdof3_S[i].transpose() * data.pA[i];
+  } else if (model.mJoints[i].mJointType == JointTypeCustom) {
+    unsigned int kI   = model.mJoints[i].custom_joint_index;
+    unsigned int dofI = model.mCustomJoints[kI]->mDoFCount;
+    model.mCustomJoints[kI]->U =
+      data.IA_packed[i].toMatrix() * model.mCustomJoints[kI]->S;
+
+    model.mCustomJoints[kI]->Dinv
+      = (model.mCustomJoints[kI]->S.transpose()
+          * model.mCustomJoints[kI]->U).inverse().eval();
+
+    VectorNd tau_temp(Tau.block(q_index,0,dofI,1));
+    model.mCustomJoints[kI]->u = tau_temp
+      - model.mCustomJoints[kI]->S.transpose() * data.pA[i];
+  }
+}
+
+/** \brief Second pass: adds the articulated inertia and bias force of body
+ * i to its parent */
+static void ForwardDynamicsPropagateStep (
+    const Model &model,
+    ModelData &data,
+    unsigned int i) {
+  unsigned int lambda = model.lambda[i];
+  if (lambda == 0) {
+    return;
+  }
+
+  SpatialArticulatedInertia Ia = data.IA_packed[i];
+  SpatialVector pa;
+
+  if (model.mJoints[i].mDoFCount == 1
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    Ia.subtractSymmetricProduct (data.U[i] / data.d[i], data.U[i]);
+
+    pa = data.pA[i]
+      + Ia * data.c[i]
+      + data.U[i] * data.u[i] / data.d[i];
+  } else if (model.mJoints[i].mDoFCount == 3
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    Ia.subtractSymmetricProduct (
+        Matrix63 (data.multdof3_U[i] * data.multdof3_Dinv[i]),
+        data.multdof3_U[i]);
+    pa = data.pA[i]
+      + Ia
+      * data.c[i]
+      + data.multdof3_U[i]
+      * data.multdof3_Dinv[i]
+      * data.multdof3_u[i];
+  } else {
+    unsigned int kI = model.mJoints[i].custom_joint_index;
+    Ia.subtractSymmetricProduct (
+        MatrixNd (model.mCustomJoints[kI]->U
+          * model.mCustomJoints[kI]->Dinv),
+        model.mCustomJoints[kI]->U);
+    pa =  data.pA[i] 
+      + Ia * data.c[i]
+      + (model.mCustomJoints[kI]->U
+          * model.mCustomJoints[kI]->Dinv
+          * model.mCustomJoints[kI]->u);
+  }
+
+  data.IA_packed[lambda] += data.X_lambda[i].applyTranspose (Ia);
+  data.pA[lambda].noalias()
+    += data.X_lambda[i].applyTranspose(pa);
+}
+
+/** \brief Third pass: joint and spatial accelerations */
+static void ForwardDynamicsAccelerationStep (
+    const Model &model,
+    ModelData &data,
+    unsigned int i,
+    VectorNd &QDDot) {
+  unsigned int q_index = model.mJoints[i].q_index;
+  unsigned int lambda = model.lambda[i];
+  SpatialTransform X_lambda = data.X_lambda[i];
+
+  data.a[i] = X_lambda.apply(data.a[lambda]) + data.c[i];
+
+  if (model.mJoints[i].mDoFCount == 1
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    QDDot[q_index] = (1./data.d[i]) * (data.u[i] - data.U[i].dot(data.a[i]));
+    data.a[i] = data.a[i] + data.S[i] * QDDot[q_index];
+  } else if (model.mJoints[i].mDoFCount == 3
+      && model.mJoints[i].mJointType != JointTypeCustom) {
+    Vector3d qdd_temp = data.multdof3_Dinv[i] * (data.multdof3_u[i] - data.multdof3_U[i].transpose() * data.a[i]);
+    QDDot[q_index] = qdd_temp[0];
+    QDDot[q_index + 1] = qdd_temp[1];
+    QDDot[q_index + 2] = qdd_temp[2];
+    data.a[i] = data.a[i] + data.multdof3_S[i] * qdd_temp;
+  } else if (model.mJoints[i].mJointType == JointTypeCustom) {
+    unsigned int kI = model.mJoints[i].custom_joint_index;
+    unsigned int dofI=model.mCustomJoints[kI]->mDoFCount;
+
+    VectorNd qdd_temp = model.mCustomJoints[kI]->Dinv
+      * (  model.mCustomJoints[kI]->u
+          - model.mCustomJoints[kI]->U.transpose()
+          * data.a[i]);
+
+    for(int z=0; z<dofI; ++z){
+      QDDot[q_index+z] = qdd_temp[z];
+    }
+
+    data.a[i] = data.a[i]
+      + model.mCustomJoints[kI]->S * qdd_temp;
+  } 
+}
+
 RBDL_DLLAPI void ForwardDynamics (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &Tau,
@@ -331,197 +614,35 @@ RBDL_DLLAPI void ForwardDynamics (
   LOG << "---" << std::endl;
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
+  data.v[0].setZero();
 
   for (i = 1; i < model.mBodies.size(); i++) {
-    unsigned int lambda = model.lambda[i];
-
-    jcalc (model, i, Q, QDot);
-
-    if (lambda != 0)
-      model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
-    else
-      model.X_base[i] = model.X_lambda[i];
-
-    model.v[i] = model.X_lambda[i].apply( model.v[lambda]) + model.v_J[i];
-
-    /*
-       LOG << "X_J (" << i << "):" << std::endl << X_J << std::endl;
-       LOG << "v_J (" << i << "):" << std::endl << v_J << std::endl;
-       LOG << "v_lambda" << i << ":" << std::endl << model.v.at(lambda) << std::endl;
-       LOG << "X_base (" << i << "):" << std::endl << model.X_base[i] << std::endl;
-       LOG << "X_lambda (" << i << "):" << std::endl << model.X_lambda[i] << std::endl;
-       LOG << "SpatialVelocity (" << i << "): " << model.v[i] << std::endl;
-       */
-    model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
-    model.I[i].setSpatialMatrix (model.IA[i]);
-
-    model.pA[i] = crossf(model.v[i],model.I[i] * model.v[i]);
-
-    if (f_ext != NULL && (*f_ext)[i] != SpatialVector::Zero()) {
-      LOG << "External force (" << i << ") = " << model.X_base[i].toMatrixAdjoint() * (*f_ext)[i] << std::endl;
-      model.pA[i] -= model.X_base[i].toMatrixAdjoint() * (*f_ext)[i];
-    }
+    ForwardDynamicsVelocityStep (model, data, i, Q, QDot, f_ext);
   }
 
-  // ClearLogOutput();
-
   LOG << "--- first loop ---" << std::endl;
 
   for (i = model.mBodies.size() - 1; i > 0; i--) {
-    unsigned int q_index = model.mJoints[i].q_index;
-
-    if (model.mJoints[i].mDoFCount == 1
-        && model.mJoints[i].mJointType != JointTypeCustom) {
-
-      model.U[i] = model.IA[i] * model.S[i];
-      model.d[i] = model.S[i].dot(model.U[i]);
-      model.u[i] = Tau[q_index] - model.S[i].dot(model.pA[i]);
-      //      LOG << "u[" << i << "] = " << model.u[i] << std::endl;
-
-      unsigned int lambda = model.lambda[i];
-      if (lambda != 0) {
-        SpatialMatrix Ia =    model.IA[i]
-          - model.U[i]
-          * (model.U[i] / model.d[i]).transpose();
-
-        SpatialVector pa =  model.pA[i]
-          + Ia * model.c[i]
-          + model.U[i] * model.u[i] / model.d[i];
-
-        model.IA[lambda].noalias()
-          += model.X_lambda[i].toMatrixTranspose()
-          * Ia * model.X_lambda[i].toMatrix();
-        model.pA[lambda].noalias()
-          += model.X_lambda[i].applyTranspose(pa);
-
-        LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose() << std::endl;
-      }
-    } else if (model.mJoints[i].mDoFCount == 3
-        && model.mJoints[i].mJointType != JointTypeCustom) {
-      model.multdof3_U[i] = model.IA[i] * model.multdof3_S[i];
-
-      model.multdof3_Dinv[i] = (model.multdof3_S[i].transpose()
-          * model.multdof3_U[i]).inverse().eval();
-
-      Vector3d tau_temp(Tau.block(q_index,0,3,1));
-      model.multdof3_u[i] = tau_temp 
-        - model.multdof3_S[i].transpose() * model.pA[i];
-
-      // LOG << "multdof3_u[" << i << "] = " 
-      //                      << model.multdof3_u[i].transpose() << std::endl;
-      unsigned int lambda = model.lambda[i];
-      if (lambda != 0) {
-        SpatialMatrix Ia = model.IA[i]
-          - model.multdof3_U[i]
-          * model.multdof3_Dinv[i]
-          * model.multdof3_U[i].transpose();
-        SpatialVector pa = model.pA[i]
-          + Ia
-          * model.c[i]
-          + model.multdof3_U[i]
-          * model.multdof3_Dinv[i]
-          * model.multdof3_u[i];
-
-        model.IA[lambda].noalias()
-          += model.X_lambda[i].toMatrixTranspose()
-          * Ia
-          * model.X_lambda[i].toMatrix();
-
-        model.pA[lambda].noalias()
-          += model.X_lambda[i].applyTranspose(pa);
-
-        LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose()
-          << std::endl;
-      }
-    } else if (model.mJoints[i].mJointType == JointTypeCustom) {
-      unsigned int kI   = model.mJoints[i].custom_joint_index;
-      unsigned int dofI = model.mCustomJoints[kI]->mDoFCount;
-      model.mCustomJoints[kI]->U =
-        model.IA[i] * model.mCustomJoints[kI]->S;
-
-      model.mCustomJoints[kI]->Dinv
-        = (model.mCustomJoints[kI]->S.transpose()
-            * model.mCustomJoints[kI]->U).inverse().eval();
-
-      VectorNd tau_temp(Tau.block(q_index,0,dofI,1));
-      model.mCustomJoints[kI]->u = tau_temp
-        - model.mCustomJoints[kI]->S.transpose() * model.pA[i];
-
-      //      LOG << "multdof3_u[" << i << "] = " 
-      //      << model.multdof3_u[i].transpose() << std::endl;
-      unsigned int lambda = model.lambda[i];
-      if (lambda != 0) {
-        SpatialMatrix Ia = model.IA[i]
-          - (model.mCustomJoints[kI]->U
-              * model.mCustomJoints[kI]->Dinv
-              * model.mCustomJoints[kI]->U.transpose());
-        SpatialVector pa =  model.pA[i] 
-          + Ia * model.c[i]
-          + (model.mCustomJoints[kI]->U
-              * model.mCustomJoints[kI]->Dinv
-              * model.mCustomJoints[kI]->u);
+    ForwardDynamicsArticulatedBodyStep (model, data, i, Tau);
+    ForwardDynamicsPropagateStep (model, data, i);
 
-        model.IA[lambda].noalias() += model.X_lambda[i].toMatrixTranspose()
-          * Ia
-          * model.X_lambda[i].toMatrix();
-        model.pA[lambda].noalias() += model.X_lambda[i].applyTranspose(pa);
-
-        LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose()
-          << std::endl;
-      }
-    }
+    LOG << "pA[" << model.lambda[i] << "] = "
+      << data.pA[model.lambda[i]].transpose() << std::endl;
   }
 
-  //  ClearLogOutput();
-
-  model.a[0] = spatial_gravity * -1.;
+  data.a[0] = spatial_gravity * -1.;
 
   for (i = 1; i < model.mBodies.size(); i++) {
-    unsigned int q_index = model.mJoints[i].q_index;
-    unsigned int lambda = model.lambda[i];
-    SpatialTransform X_lambda = model.X_lambda[i];
-
-    model.a[i] = X_lambda.apply(model.a[lambda]) + model.c[i];
-    LOG << "a'[" << i << "] = " << model.a[i].transpose() << std::endl;
-
-    if (model.mJoints[i].mDoFCount == 1
-        && model.mJoints[i].mJointType != JointTypeCustom) {
-      QDDot[q_index] = (1./model.d[i]) * (model.u[i] - model.U[i].dot(model.a[i]));
-      model.a[i] = model.a[i] + model.S[i] * QDDot[q_index];
-    } else if (model.mJoints[i].mDoFCount == 3
-        && model.mJoints[i].mJointType != JointTypeCustom) {
-      Vector3d qdd_temp = model.multdof3_Dinv[i] * (model.multdof3_u[i] - model.multdof3_U[i].transpose() * model.a[i]);
-      QDDot[q_index] = qdd_temp[0];
-      QDDot[q_index + 1] = qdd_temp[1];
-      QDDot[q_index + 2] = qdd_temp[2];
-      model.a[i] = model.a[i] + model.multdof3_S[i] * qdd_temp;
-    } else if (model.mJoints[i].mJointType == JointTypeCustom) {
-      unsigned int kI = model.mJoints[i].custom_joint_index;
-      unsigned int dofI=model.mCustomJoints[kI]->mDoFCount;
-
-      VectorNd qdd_temp = model.mCustomJoints[kI]->Dinv
-        * (  model.mCustomJoints[kI]->u
-            - model.mCustomJoints[kI]->U.transpose()
-            * model.a[i]);
-
-      for(int z=0; z<dofI; ++z){
-        QDDot[q_index+z] = qdd_temp[z];
-      }
-
-      model.a[i] = model.a[i]
-        + model.mCustomJoints[kI]->S * qdd_temp;
-    } 
+    ForwardDynamicsAccelerationStep (model, data, i, QDDot);
+    LOG << "a[" << i << "] = " << data.a[i].transpose() << std::endl;
   }
 
   LOG << "QDDot = " << QDDot.transpose() << std::endl;
 }
 
 RBDL_DLLAPI void ForwardDynamicsLagrangian (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &Tau,
@@ -549,8 +670,8 @@ RBDL_DLLAPI void ForwardDynamicsLagrangian (
   // method.
   QDDot.setZero();
 
-  InverseDynamics (model, Q, QDot, QDDot, (*C), f_ext);
-  CompositeRigidBodyAlgorithm (model, Q, *H, false);
+  InverseDynamics (model, data, Q, QDot, QDDot, (*C), f_ext);
+  CompositeRigidBodyAlgorithm (model, data, Q, *H, false);
 
   LOG << "A = " << std::endl << *H << std::endl;
   LOG << "b = " << std::endl << *C * -1. + Tau << std::endl;
@@ -585,7 +706,9 @@ RBDL_DLLAPI void ForwardDynamicsLagrangian (
   LOG << "x = " << QDDot << std::endl;
 }
 
-RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
+RBDL_DLLAPI void CalcMInvTimesTau (
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &Tau,
     VectorNd &QDDot,
@@ -595,23 +718,23 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
   LOG << "---" << std::endl;
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
-  model.a[0].setZero();
+  data.v[0].setZero();
+  data.a[0].setZero();
 
   if (update_kinematics) {
     for (unsigned int i = 1; i < model.mBodies.size(); i++) {
-      jcalc_X_lambda_S (model, model.mJointUpdateOrder[i], Q);
+      jcalc_X_lambda_S (model, data, model.mJointUpdateOrder[i], Q);
 
-      model.v_J[i].setZero();
-      model.v[i].setZero();
-      model.c[i].setZero();
-      model.pA[i].setZero();
-      model.I[i].setSpatialMatrix (model.IA[i]);
+      data.v_J[i].setZero();
+      data.v[i].setZero();
+      data.c[i].setZero();
+      data.pA[i].setZero();
+      data.IA_packed[i] = SpatialArticulatedInertia (model.I[i]);
     }
   }
 
   for (unsigned int i = 1; i < model.mBodies.size(); i++) {
-    model.pA[i].setZero();
+    data.pA[i].setZero();
   }
 
   // ClearLogOutput();
@@ -623,26 +746,24 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
 
       if (model.mJoints[i].mDoFCount == 1
           && model.mJoints[i].mJointType != JointTypeCustom) {
-        model.U[i] = model.IA[i] * model.S[i];
-        model.d[i] = model.S[i].dot(model.U[i]);
-        //      LOG << "u[" << i << "] = " << model.u[i] << std::endl;
+        data.U[i] = data.IA_packed[i] * data.S[i];
+        data.d[i] = data.S[i].dot(data.U[i]);
+        //      LOG << "u[" << i << "] = " << data.u[i] << std::endl;
         unsigned int lambda = model.lambda[i];
 
         if (lambda != 0) {
-          SpatialMatrix Ia = model.IA[i] - 
-            model.U[i] * (model.U[i] / model.d[i]).transpose();
+          SpatialArticulatedInertia Ia = data.IA_packed[i];
+          Ia.subtractSymmetricProduct (data.U[i] / data.d[i], data.U[i]);
 
-          model.IA[lambda].noalias() += model.X_lambda[i].toMatrixTranspose()
-            * Ia
-            * model.X_lambda[i].toMatrix();
+          data.IA_packed[lambda] += data.X_lambda[i].applyTranspose (Ia);
         }
       } else if (model.mJoints[i].mDoFCount == 3
           && model.mJoints[i].mJointType != JointTypeCustom) {
 
-        model.multdof3_U[i] = model.IA[i] * model.multdof3_S[i];
+        data.multdof3_U[i] = data.IA_packed[i] * data.multdof3_S[i];
 
-        model.multdof3_Dinv[i] = 
-          (model.multdof3_S[i].transpose()*model.multdof3_U[i]).inverse().eval();
+        data.multdof3_Dinv[i] = 
+          (data.multdof3_S[i].transpose()*data.multdof3_U[i]).inverse().eval();
 
         //      LOG << "mCustomJoints[kI]->u[" << i << "] = "
         //<< model.mCustomJoints[kI]->u[i].transpose() << std::endl;
@@ -650,20 +771,18 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
         unsigned int lambda = model.lambda[i];
 
         if (lambda != 0) {
-          SpatialMatrix Ia = model.IA[i]
-            - ( model.multdof3_U[i]
-                * model.multdof3_Dinv[i]
-                * model.multdof3_U[i].transpose());
-
-          model.IA[lambda].noalias() +=
-            model.X_lambda[i].toMatrixTranspose()
-            * Ia
-            * model.X_lambda[i].toMatrix();
+          SpatialArticulatedInertia Ia = data.IA_packed[i];
+          Ia.subtractSymmetricProduct (
+              Matrix63 (data.multdof3_U[i] * data.multdof3_Dinv[i]),
+              data.multdof3_U[i]);
+
+          data.IA_packed[lambda] += data.X_lambda[i].applyTranspose (Ia);
         }
       } else if (model.mJoints[i].mJointType == JointTypeCustom) {
         unsigned int kI     = model.mJoints[i].custom_joint_index;
         unsigned int dofI   = model.mCustomJoints[kI]->mDoFCount;
-        model.mCustomJoints[kI]->U = model.IA[i] * model.mCustomJoints[kI]->S;
+        model.mCustomJoints[kI]->U =
+          data.IA_packed[i].toMatrix() * model.mCustomJoints[kI]->S;
 
         model.mCustomJoints[kI]->Dinv = (model.mCustomJoints[kI]->S.transpose()
             * model.mCustomJoints[kI]->U
@@ -674,13 +793,12 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
         unsigned int lambda = model.lambda[i];
 
         if (lambda != 0) {
-          SpatialMatrix Ia = model.IA[i] 
-            - ( model.mCustomJoints[kI]->U
-                * model.mCustomJoints[kI]->Dinv
-                * model.mCustomJoints[kI]->U.transpose());
-          model.IA[lambda].noalias() += model.X_lambda[i].toMatrixTranspose()
-            * Ia
-            * model.X_lambda[i].toMatrix();
+          SpatialArticulatedInertia Ia = data.IA_packed[i];
+          Ia.subtractSymmetricProduct (
+              MatrixNd (model.mCustomJoints[kI]->U
+                * model.mCustomJoints[kI]->Dinv),
+              model.mCustomJoints[kI]->U);
+          data.IA_packed[lambda] += data.X_lambda[i].applyTranspose (Ia);
         }
       }
     }
@@ -693,16 +811,16 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
     if (model.mJoints[i].mDoFCount == 1
         && model.mJoints[i].mJointType != JointTypeCustom) {
 
-      model.u[i] = Tau[q_index] - model.S[i].dot(model.pA[i]);
-      // LOG << "u[" << i << "] = " << model.u[i] << std::endl;
+      data.u[i] = Tau[q_index] - data.S[i].dot(data.pA[i]);
+      // LOG << "u[" << i << "] = " << data.u[i] << std::endl;
       unsigned int lambda = model.lambda[i];
       if (lambda != 0) {
-        SpatialVector pa = model.pA[i] + model.U[i] * model.u[i] / model.d[i];
+        SpatialVector pa = data.pA[i] + data.U[i] * data.u[i] / data.d[i];
 
-        model.pA[lambda].noalias() += model.X_lambda[i].applyTranspose(pa);
+        data.pA[lambda].noalias() += data.X_lambda[i].applyTranspose(pa);
 
         LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose() << std::endl;
+          << data.pA[lambda].transpose() << std::endl;
       }
     } else if (model.mJoints[i].mDoFCount == 3
         && model.mJoints[i].mJointType != JointTypeCustom) {
@@ -710,23 +828,23 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
       Vector3d tau_temp ( Tau[q_index],
           Tau[q_index + 1],
           Tau[q_index + 2]);
-      model.multdof3_u[i] = tau_temp 
-        - model.multdof3_S[i].transpose()*model.pA[i];
+      data.multdof3_u[i] = tau_temp 
+        - data.multdof3_S[i].transpose()*data.pA[i];
       //      LOG << "multdof3_u[" << i << "] = "
-      // << model.multdof3_u[i].transpose() << std::endl;
+      // << data.multdof3_u[i].transpose() << std::endl;
       unsigned int lambda = model.lambda[i];
 
       if (lambda != 0) {
-        SpatialVector pa = model.pA[i]
-          + model.multdof3_U[i]
-          * model.multdof3_Dinv[i]
-          * model.multdof3_u[i];
+        SpatialVector pa = data.pA[i]
+          + data.multdof3_U[i]
+          * data.multdof3_Dinv[i]
+          * data.multdof3_u[i];
 
-        model.pA[lambda].noalias() +=
-          model.X_lambda[i].applyTranspose(pa);
+        data.pA[lambda].noalias() +=
+          data.X_lambda[i].applyTranspose(pa);
 
         LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose() << std::endl;
+          << data.pA[lambda].transpose() << std::endl;
       }
     } else if (model.mJoints[i].mJointType == JointTypeCustom) {
       unsigned int kI     = model.mJoints[i].custom_joint_index;
@@ -734,22 +852,22 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
       VectorNd tau_temp(Tau.block(q_index,0,dofI,1));
 
       model.mCustomJoints[kI]->u = 
-        tau_temp - ( model.mCustomJoints[kI]->S.transpose()* model.pA[i]);
+        tau_temp - ( model.mCustomJoints[kI]->S.transpose()* data.pA[i]);
       //      LOG << "mCustomJoints[kI]->u"
       // << model.mCustomJoints[kI]->u.transpose() << std::endl;
       unsigned int lambda = model.lambda[i];
 
       if (lambda != 0) {
-        SpatialVector pa = model.pA[i]
+        SpatialVector pa = data.pA[i]
           + (   model.mCustomJoints[kI]->U
               * model.mCustomJoints[kI]->Dinv
               * model.mCustomJoints[kI]->u);
 
-        model.pA[lambda].noalias() +=
-          model.X_lambda[i].applyTranspose(pa);
+        data.pA[lambda].noalias() +=
+          data.X_lambda[i].applyTranspose(pa);
 
         LOG << "pA[" << lambda << "] = "
-          << model.pA[lambda].transpose() << std::endl;
+          << data.pA[lambda].transpose() << std::endl;
       }
     }
   }
@@ -759,38 +877,38 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
   for (unsigned int i = 1; i < model.mBodies.size(); i++) {
     unsigned int q_index = model.mJoints[i].q_index;
     unsigned int lambda = model.lambda[i];
-    SpatialTransform X_lambda = model.X_lambda[i];
+    SpatialTransform X_lambda = data.X_lambda[i];
 
-    model.a[i] = X_lambda.apply(model.a[lambda]) + model.c[i];
-    LOG << "a'[" << i << "] = " << model.a[i].transpose() << std::endl;
+    data.a[i] = X_lambda.apply(data.a[lambda]) + data.c[i];
+    LOG << "a'[" << i << "] = " << data.a[i].transpose() << std::endl;
 
     if (model.mJoints[i].mDoFCount == 1
         && model.mJoints[i].mJointType != JointTypeCustom) {
-      QDDot[q_index] = (1./model.d[i])*(model.u[i]-model.U[i].dot(model.a[i]));
-      model.a[i]     = model.a[i] + model.S[i] * QDDot[q_index];
+      QDDot[q_index] = (1./data.d[i])*(data.u[i]-data.U[i].dot(data.a[i]));
+      data.a[i]     = data.a[i] + data.S[i] * QDDot[q_index];
     } else if (model.mJoints[i].mDoFCount == 3
         && model.mJoints[i].mJointType != JointTypeCustom) {
       Vector3d qdd_temp = 
-        model.multdof3_Dinv[i] * (model.multdof3_u[i]
-            - model.multdof3_U[i].transpose()*model.a[i]);
+        data.multdof3_Dinv[i] * (data.multdof3_u[i]
+            - data.multdof3_U[i].transpose()*data.a[i]);
 
       QDDot[q_index]      = qdd_temp[0];
       QDDot[q_index + 1]  = qdd_temp[1];
       QDDot[q_index + 2]  = qdd_temp[2];
-      model.a[i]          = model.a[i] + model.multdof3_S[i] * qdd_temp;
+      data.a[i]          = data.a[i] + data.multdof3_S[i] * qdd_temp;
     } else if (model.mJoints[i].mJointType == JointTypeCustom) {
       unsigned int kI     = model.mJoints[i].custom_joint_index;
       unsigned int dofI   = model.mCustomJoints[kI]->mDoFCount;
 
       VectorNd qdd_temp = model.mCustomJoints[kI]->Dinv
         * (  model.mCustomJoints[kI]->u 
-            - model.mCustomJoints[kI]->U.transpose() * model.a[i]);
+            - model.mCustomJoints[kI]->U.transpose() * data.a[i]);
 
       for(unsigned z = 0; z < dofI; ++z){
         QDDot[q_index+z]      = qdd_temp[z];
       }
 
-      model.a[i] =    model.a[i]
+      data.a[i] =    data.a[i]
         + model.mCustomJoints[kI]->S * qdd_temp;
     }
   }
@@ -798,4 +916,947 @@ RBDL_DLLAPI void CalcMInvTimesTau ( Model &model,
   LOG << "QDDot = " << QDDot.transpose() << std::endl;
 }
 
+static void CheckBatchSize (
+    const char *func_name,
+    const char *arg_name,
+    const MatrixNd &M,
+    unsigned int rows,
+    unsigned int cols) {
+  if (M.rows() != rows || M.cols() != cols) {
+    std::ostringstream errormsg;
+    errormsg << "Error: " << func_name << ": " << arg_name
+      << " has size " << M.rows() << "x" << M.cols()
+      << " but expected " << rows << "x" << cols << "!" << std::endl;
+    throw Errors::RBDLSizeMismatchError(errormsg.str());
+  }
+}
+
+RBDL_DLLAPI void ForwardDynamicsBatch (
+    const Model &model,
+    const MatrixNd &Qs,
+    const MatrixNd &QDots,
+    const MatrixNd &Taus,
+    MatrixNd &QDDots,
+    unsigned int num_threads) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_states = Qs.cols();
+  CheckBatchSize (__func__, "Qs", Qs, model.q_size, num_states);
+  CheckBatchSize (__func__, "QDots", QDots, model.qdot_size, num_states);
+  CheckBatchSize (__func__, "Taus", Taus, model.qdot_size, num_states);
+
+  if (QDDots.rows() != model.qdot_size || QDDots.cols() != num_states) {
+    QDDots.resize (model.qdot_size, num_states);
+  }
+
+  ParallelFor (num_states, num_threads,
+      [&] (unsigned int, unsigned int begin, unsigned int end) {
+    ModelData data (model);
+    VectorNd Q (model.q_size);
+    VectorNd QDot (model.qdot_size);
+    VectorNd Tau (model.qdot_size);
+    VectorNd QDDot (model.qdot_size);
+
+    for (unsigned int k = begin; k < end; k++) {
+      Q = Qs.col(k);
+      QDot = QDots.col(k);
+      Tau = Taus.col(k);
+      ForwardDynamics (model, data, Q, QDot, Tau, QDDot);
+      QDDots.col(k) = QDDot;
+    }
+  });
+}
+
+RBDL_DLLAPI void InverseDynamicsBatch (
+    const Model &model,
+    const MatrixNd &Qs,
+    const MatrixNd &QDots,
+    const MatrixNd &QDDots,
+    MatrixNd &Taus,
+    unsigned int num_threads) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_states = Qs.cols();
+  CheckBatchSize (__func__, "Qs", Qs, model.q_size, num_states);
+  CheckBatchSize (__func__, "QDots", QDots, model.qdot_size, num_states);
+  CheckBatchSize (__func__, "QDDots", QDDots, model.qdot_size, num_states);
+
+  if (Taus.rows() != model.qdot_size || Taus.cols() != num_states) {
+    Taus.resize (model.qdot_size, num_states);
+  }
+
+  ParallelFor (num_states, num_threads,
+      [&] (unsigned int, unsigned int begin, unsigned int end) {
+    ModelData data (model);
+    VectorNd Q (model.q_size);
+    VectorNd QDot (model.qdot_size);
+    VectorNd QDDot (model.qdot_size);
+    VectorNd Tau (model.qdot_size);
+
+    for (unsigned int k = begin; k < end; k++) {
+      Q = Qs.col(k);
+      QDot = QDots.col(k);
+      QDDot = QDDots.col(k);
+      InverseDynamics (model, data, Q, QDot, QDDot, Tau);
+      Taus.col(k) = Tau;
+    }
+  });
+}
+
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmBatch (
+    const Model &model,
+    const MatrixNd &Qs,
+    MatrixNd &Hs,
+    unsigned int num_threads) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_states = Qs.cols();
+  unsigned int dof = model.dof_count;
+  CheckBatchSize (__func__, "Qs", Qs, model.q_size, num_states);
+
+  if (Hs.rows() != dof || Hs.cols() != dof * num_states) {
+    Hs.resize (dof, dof * num_states);
+  }
+
+  ParallelFor (num_states, num_threads,
+      [&] (unsigned int, unsigned int begin, unsigned int end) {
+    ModelData data (model);
+    VectorNd Q (model.q_size);
+    MatrixNd H (MatrixNd::Zero (dof, dof));
+
+    for (unsigned int k = begin; k < end; k++) {
+      Q = Qs.col(k);
+      CompositeRigidBodyAlgorithm (model, data, Q, H, true);
+      Hs.block (0, k * dof, dof, dof) = H;
+    }
+  });
+}
+
+SubtreeSchedule::SubtreeSchedule (
+    const Model &model,
+    unsigned int num_threads) :
+  body_count (model.mBodies.size()),
+  thread_pool (new ThreadPool (num_threads)) {
+  this->num_threads = thread_pool->size();
+
+  std::vector<unsigned int> subtree_size (body_count, 1);
+  for (unsigned int i = body_count - 1; i > 0; i--) {
+    subtree_size[model.lambda[i]] += subtree_size[i];
+  }
+
+  std::vector<char> in_trunk (body_count, 0);
+  std::vector<unsigned int> roots;
+
+  if (this->num_threads > 1) {
+    roots = model.mu[0];
+
+    // Split the largest subtree until all of them can be balanced between
+    // the threads. The roots of split subtrees are moved to the trunk.
+    unsigned int max_size = (body_count - 1) / this->num_threads;
+
+    while (roots.size() > 0) {
+      unsigned int largest = 0;
+      for (unsigned int k = 1; k < roots.size(); k++) {
+        if (subtree_size[roots[k]] > subtree_size[roots[largest]]) {
+          largest = k;
+        }
+      }
+
+      unsigned int body_id = roots[largest];
+      if (subtree_size[body_id] <= max_size) {
+        break;
+      }
+
+      in_trunk[body_id] = 1;
+      roots.erase (roots.begin() + largest);
+      roots.insert (roots.end(), model.mu[body_id].begin(),
+          model.mu[body_id].end());
+    }
+  } else {
+    for (unsigned int i = 1; i < body_count; i++) {
+      in_trunk[i] = 1;
+    }
+  }
+
+  // largest subtrees first such that they are started early
+  for (unsigned int k = 1; k < roots.size(); k++) {
+    for (unsigned int l = k; l > 0
+        && subtree_size[roots[l]] > subtree_size[roots[l - 1]]; l--) {
+      std::swap (roots[l], roots[l - 1]);
+    }
+  }
+
+  std::vector<int> owner (body_count, -1);
+  for (unsigned int k = 0; k < roots.size(); k++) {
+    owner[roots[k]] = k;
+  }
+
+  std::vector<unsigned int> task_size (roots.size(), 0);
+  for (unsigned int i = 1; i < body_count; i++) {
+    if (in_trunk[i]) {
+      trunk.push_back (i);
+      continue;
+    }
+
+    if (owner[i] < 0) {
+      owner[i] = owner[model.lambda[i]];
+    }
+    task_size[owner[i]]++;
+  }
+
+  subtree_root = roots;
+  subtree_start.resize (roots.size() + 1, 0);
+  for (unsigned int k = 0; k < roots.size(); k++) {
+    subtree_start[k + 1] = subtree_start[k] + task_size[k];
+  }
+
+  subtree_bodies.resize (subtree_start[roots.size()]);
+  std::vector<unsigned int> fill (subtree_start.begin(),
+      subtree_start.end() - 1);
+  for (unsigned int i = 1; i < body_count; i++) {
+    if (!in_trunk[i]) {
+      subtree_bodies[fill[owner[i]]++] = i;
+    }
+  }
+}
+
+SubtreeSchedule::~SubtreeSchedule () {
+  delete thread_pool;
+}
+
+static void CheckSubtreeSchedule (
+    const Model &model,
+    const SubtreeSchedule &schedule) {
+  if (schedule.body_count != model.mBodies.size()) {
+    throw Errors::RBDLError("SubtreeSchedule was created for a different "
+        "model.");
+  }
+}
+
+RBDL_DLLAPI void ForwardDynamicsParallel (
+    const Model &model,
+    ModelData &data,
+    SubtreeSchedule &schedule,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    std::vector<SpatialVector> *f_ext) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  CheckSubtreeSchedule (model, schedule);
+
+  unsigned int task_count = schedule.subtree_root.size();
+  if (task_count < 2) {
+    ForwardDynamics (model, data, Q, QDot, Tau, QDDot, f_ext);
+    return;
+  }
+
+  const std::vector<unsigned int> &trunk = schedule.trunk;
+  const std::vector<unsigned int> &bodies = schedule.subtree_bodies;
+  const std::vector<unsigned int> &start = schedule.subtree_start;
+  std::atomic<unsigned int> next_task (0);
+
+  data.v[0].setZero();
+  for (unsigned int k = 0; k < trunk.size(); k++) {
+    ForwardDynamicsVelocityStep (model, data, trunk[k], Q, QDot, f_ext);
+  }
+
+  // Subtrees are independent until they reach the trunk, so the first and
+  // second pass are evaluated within the subtree. The contributions of
+  // the roots to their trunk parents are added afterwards.
+  auto subtree_articulated_bodies = [&] (unsigned int) {
+    unsigned int task;
+    while ((task = next_task++) < task_count) {
+      for (unsigned int k = start[task]; k < start[task + 1]; k++) {
+        ForwardDynamicsVelocityStep (model, data, bodies[k], Q, QDot, f_ext);
+      }
+      for (unsigned int k = start[task + 1]; k > start[task]; k--) {
+        ForwardDynamicsArticulatedBodyStep (model, data, bodies[k - 1], Tau);
+        if (k - 1 != start[task]) {
+          ForwardDynamicsPropagateStep (model, data, bodies[k - 1]);
+        }
+      }
+    }
+  };
+  schedule.thread_pool->Run (subtree_articulated_bodies);
+
+  for (unsigned int task = 0; task < task_count; task++) {
+    ForwardDynamicsPropagateStep (model, data, schedule.subtree_root[task]);
+  }
+  for (unsigned int k = trunk.size(); k > 0; k--) {
+    ForwardDynamicsArticulatedBodyStep (model, data, trunk[k - 1], Tau);
+    ForwardDynamicsPropagateStep (model, data, trunk[k - 1]);
+  }
+
+  data.a[0].set (0., 0., 0.,
+      -model.gravity[0], -model.gravity[1], -model.gravity[2]);
+  for (unsigned int k = 0; k < trunk.size(); k++) {
+    ForwardDynamicsAccelerationStep (model, data, trunk[k], QDDot);
+  }
+
+  next_task = 0;
+  auto subtree_accelerations = [&] (unsigned int) {
+    unsigned int task;
+    while ((task = next_task++) < task_count) {
+      for (unsigned int k = start[task]; k < start[task + 1]; k++) {
+        ForwardDynamicsAccelerationStep (model, data, bodies[k], QDDot);
+      }
+    }
+  };
+  schedule.thread_pool->Run (subtree_accelerations);
+}
+
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmParallel (
+    const Model &model,
+    ModelData &data,
+    SubtreeSchedule &schedule,
+    const VectorNd &Q,
+    MatrixNd &H,
+    bool update_kinematics) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  CheckSubtreeSchedule (model, schedule);
+
+  unsigned int task_count = schedule.subtree_root.size();
+  if (task_count < 2) {
+    CompositeRigidBodyAlgorithm (model, data, Q, H, update_kinematics);
+    return;
+  }
+
+  assert (H.rows() == model.dof_count && H.cols() == model.dof_count);
+
+  const std::vector<unsigned int> &trunk = schedule.trunk;
+  const std::vector<unsigned int> &bodies = schedule.subtree_bodies;
+  const std::vector<unsigned int> &start = schedule.subtree_start;
+  std::atomic<unsigned int> next_task (0);
+
+  for (unsigned int k = 0; k < trunk.size(); k++) {
+    if (update_kinematics) {
+      jcalc_X_lambda_S (model, data, trunk[k], Q);
+    }
+    data.Ic[trunk[k]] = model.I[trunk[k]];
+  }
+
+  // The entries of H of a body only depend on its composite inertia and
+  // the transformations of its ancestors which are all known once the
+  // subtree has been processed.
+  auto subtree_columns = [&] (unsigned int) {
+    unsigned int task;
+    while ((task = next_task++) < task_count) {
+      for (unsigned int k = start[task]; k < start[task + 1]; k++) {
+        if (update_kinematics) {
+          jcalc_X_lambda_S (model, data, bodies[k], Q);
+        }
+        data.Ic[bodies[k]] = model.I[bodies[k]];
+      }
+      for (unsigned int k = start[task + 1]; k > start[task]; k--) {
+        unsigned int i = bodies[k - 1];
+        if (k - 1 != start[task]) {
+          data.Ic[model.lambda[i]] = data.Ic[model.lambda[i]]
+            + data.X_lambda[i].applyTranspose(data.Ic[i]);
+        }
+        CompositeRigidBodyAlgorithmColumn (model, data, i, H);
+      }
+    }
+  };
+  schedule.thread_pool->Run (subtree_columns);
+
+  for (unsigned int task = 0; task < task_count; task++) {
+    unsigned int i = schedule.subtree_root[task];
+    if (model.lambda[i] != 0) {
+      data.Ic[model.lambda[i]] = data.Ic[model.lambda[i]]
+        + data.X_lambda[i].applyTranspose(data.Ic[i]);
+    }
+  }
+
+  for (unsigned int k = trunk.size(); k > 0; k--) {
+    unsigned int i = trunk[k - 1];
+    if (model.lambda[i] != 0) {
+      data.Ic[model.lambda[i]] = data.Ic[model.lambda[i]]
+        + data.X_lambda[i].applyTranspose(data.Ic[i]);
+    }
+    CompositeRigidBodyAlgorithmColumn (model, data, i, H);
+  }
+}
+
+/** \brief Checks whether all joints of the model have a constant single
+ * degree of freedom motion subspace without velocity product terms.
+ *
+ * Only such models can be evaluated by the lockstep kernels and the
+ * analytical derivatives.
+ */
+static bool HasOnlySimpleJoints (const Model &model) {
+  for (unsigned int i = 1; i < model.mJoints.size(); i++) {
+    JointType type = model.mJoints[i].mJointType;
+
+    if (type != JointTypeRevolute
+        && type != JointTypeRevoluteX
+        && type != JointTypeRevoluteY
+        && type != JointTypeRevoluteZ
+        && type != JointTypePrismatic) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** \brief Loads row of the matrix for the states starting at column
+ * first into a LaneScalar. Missing states are padded with the last state.
+ */
+static LaneScalar LoadLanes (
+    const MatrixNd &values,
+    unsigned int row,
+    unsigned int first) {
+  unsigned int last = values.cols() - 1;
+  LaneScalar result;
+
+  for (unsigned int l = 0; l < RBDL_SIMD_LANES; l++) {
+    result[l] = values (row, std::min (first + l, last));
+  }
+
+  return result;
+}
+
+static void StoreLanes (
+    const LaneScalar &lanes,
+    unsigned int row,
+    unsigned int first,
+    MatrixNd &values) {
+  for (unsigned int l = 0;
+      l < RBDL_SIMD_LANES && first + l < values.cols(); l++) {
+    values (row, first + l) = lanes[l];
+  }
+}
+
+/** \brief Computes X_lambda = X_J * X_T of a revolute or prismatic joint
+ * for all lanes.
+ */
+static void LockstepJointTransform (
+    const Model &model,
+    unsigned int joint_id,
+    const LaneScalar &q,
+    SpatialTransformLanes &X_lambda) {
+  const SpatialVector &axis = model.mJoints[joint_id].mJointAxes[0];
+  const SpatialTransform &X_T = model.X_T[joint_id];
+
+  if (model.mJoints[joint_id].mJointType == JointTypePrismatic) {
+    for (unsigned int j = 0; j < 3; j++) {
+      X_lambda.E[3 * j].setConstant (X_T.E(j, 0));
+      X_lambda.E[3 * j + 1].setConstant (X_T.E(j, 1));
+      X_lambda.E[3 * j + 2].setConstant (X_T.E(j, 2));
+
+      X_lambda.r[j] = X_T.r[j] + (X_T.E(0, j) * axis[3]
+          + X_T.E(1, j) * axis[4] + X_T.E(2, j) * axis[5]) * q;
+    }
+
+    return;
+  }
+
+  LaneScalar s = q.sin();
+  LaneScalar c = q.cos();
+  LaneScalar one_minus_c = 1. - c;
+
+  // same as Xrot (q, axis)
+  LaneScalar E_J[9];
+  E_J[0] = axis[0] * axis[0] * one_minus_c + c;
+  E_J[1] = axis[1] * axis[0] * one_minus_c + axis[2] * s;
+  E_J[2] = axis[0] * axis[2] * one_minus_c - axis[1] * s;
+  E_J[3] = axis[0] * axis[1] * one_minus_c - axis[2] * s;
+  E_J[4] = axis[1] * axis[1] * one_minus_c + c;
+  E_J[5] = axis[1] * axis[2] * one_minus_c + axis[0] * s;
+  E_J[6] = axis[0] * axis[2] * one_minus_c + axis[1] * s;
+  E_J[7] = axis[1] * axis[2] * one_minus_c - axis[0] * s;
+  E_J[8] = axis[2] * axis[2] * one_minus_c + c;
+
+  for (unsigned int row = 0; row < 3; row++) {
+    for (unsigned int col = 0; col < 3; col++) {
+      X_lambda.E[3 * row + col] = E_J[3 * row] * X_T.E(0, col)
+        + E_J[3 * row + 1] * X_T.E(1, col)
+        + E_J[3 * row + 2] * X_T.E(2, col);
+    }
+    X_lambda.r[row].setConstant (X_T.r[row]);
+  }
+}
+
+RBDL_DLLAPI void ForwardDynamicsLockstep (
+    const Model &model,
+    const MatrixNd &Qs,
+    const MatrixNd &QDots,
+    const MatrixNd &Taus,
+    MatrixNd &QDDots) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_states = Qs.cols();
+  CheckBatchSize (__func__, "Qs", Qs, model.q_size, num_states);
+  CheckBatchSize (__func__, "QDots", QDots, model.qdot_size, num_states);
+  CheckBatchSize (__func__, "Taus", Taus, model.qdot_size, num_states);
+
+  if (!HasOnlySimpleJoints (model)) {
+    ForwardDynamicsBatch (model, Qs, QDots, Taus, QDDots, 1);
+    return;
+  }
+
+  if (QDDots.rows() != model.qdot_size || QDDots.cols() != num_states) {
+    QDDots.resize (model.qdot_size, num_states);
+  }
+
+  unsigned int body_count = model.mBodies.size();
+
+  std::vector<SpatialMatrix> I (body_count);
+  for (unsigned int i = 1; i < body_count; i++) {
+    model.I[i].setSpatialMatrix (I[i]);
+  }
+
+  SpatialTransformLanesVector X_lambda (body_count);
+  SpatialVectorLanesVector v (body_count);
+  SpatialVectorLanesVector c (body_count);
+  SpatialVectorLanesVector pA (body_count);
+  SpatialVectorLanesVector U (body_count);
+  SpatialVectorLanesVector a (body_count);
+  SpatialMatrixLanesVector IA (body_count);
+  LaneScalarVector d (body_count);
+  LaneScalarVector u (body_count);
+  SpatialMatrixLanes Ia;
+
+  for (unsigned int first = 0; first < num_states; first += RBDL_SIMD_LANES) {
+    v[0].setZero();
+
+    for (unsigned int i = 1; i < body_count; i++) {
+      unsigned int q_index = model.mJoints[i].q_index;
+      unsigned int lambda = model.lambda[i];
+      const SpatialVector &S = model.mJoints[i].mJointAxes[0];
+
+      LockstepJointTransform (model, i, LoadLanes (Qs, q_index, first),
+          X_lambda[i]);
+      SpatialVectorLanes v_J = LanesScale (S,
+          LoadLanes (QDots, q_index, first));
+
+      v[i] = LanesApply (X_lambda[i], v[lambda]);
+      v[i] += v_J;
+      c[i] = LanesCrossm (v[i], v_J);
+      IA[i].setConstant (I[i]);
+      pA[i] = LanesCrossf (v[i], LanesMultiply (I[i], v[i]));
+    }
+
+    for (unsigned int i = body_count - 1; i > 0; i--) {
+      unsigned int q_index = model.mJoints[i].q_index;
+      unsigned int lambda = model.lambda[i];
+      const SpatialVector &S = model.mJoints[i].mJointAxes[0];
+
+      // U = IA * S where only the non-zero entries of S are considered
+      SpatialVectorLanes &U_i = U[i];
+      U_i.setZero();
+      for (unsigned int col = 0; col < 6; col++) {
+        if (S[col] != 0.) {
+          for (unsigned int row = 0; row < 6; row++) {
+            U_i.x[row] += IA[i].M[row * 6 + col] * S[col];
+          }
+        }
+      }
+
+      d[i] = LanesDot (S, U_i);
+      u[i] = LoadLanes (Taus, q_index, first) - LanesDot (S, pA[i]);
+
+      if (lambda != 0) {
+        LaneScalar d_inv = d[i].inverse();
+
+        for (unsigned int row = 0; row < 6; row++) {
+          LaneScalar U_row_d_inv = U_i.x[row] * d_inv;
+          for (unsigned int col = 0; col < 6; col++) {
+            Ia.M[row * 6 + col] = IA[i].M[row * 6 + col]
+              - U_row_d_inv * U_i.x[col];
+          }
+        }
+
+        SpatialVectorLanes pa = LanesMultiply (Ia, c[i]);
+        LaneScalar u_d_inv = u[i] * d_inv;
+        for (unsigned int row = 0; row < 6; row++) {
+          pa.x[row] += pA[i].x[row] + U_i.x[row] * u_d_inv;
+        }
+
+        LanesAddTransformedInertia (X_lambda[i], Ia, IA[lambda]);
+        pA[lambda] += LanesApplyTranspose (X_lambda[i], pa);
+      }
+    }
+
+    a[0].setConstant (SpatialVector (0., 0., 0.,
+          -model.gravity[0], -model.gravity[1], -model.gravity[2]));
+
+    for (unsigned int i = 1; i < body_count; i++) {
+      unsigned int q_index = model.mJoints[i].q_index;
+      unsigned int lambda = model.lambda[i];
+      const SpatialVector &S = model.mJoints[i].mJointAxes[0];
+
+      a[i] = LanesApply (X_lambda[i], a[lambda]);
+      a[i] += c[i];
+
+      LaneScalar qddot = (u[i] - LanesDot (U[i], a[i])) / d[i];
+      StoreLanes (qddot, q_index, first, QDDots);
+
+      a[i] += LanesScale (S, qddot);
+    }
+  }
+}
+
+RBDL_DLLAPI void InverseDynamicsLockstep (
+    const Model &model,
+    const MatrixNd &Qs,
+    const MatrixNd &QDots,
+    const MatrixNd &QDDots,
+    MatrixNd &Taus) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_states = Qs.cols();
+  CheckBatchSize (__func__, "Qs", Qs, model.q_size, num_states);
+  CheckBatchSize (__func__, "QDots", QDots, model.qdot_size, num_states);
+  CheckBatchSize (__func__, "QDDots", QDDots, model.qdot_size, num_states);
+
+  if (!HasOnlySimpleJoints (model)) {
+    InverseDynamicsBatch (model, Qs, QDots, QDDots, Taus, 1);
+    return;
+  }
+
+  if (Taus.rows() != model.qdot_size || Taus.cols() != num_states) {
+    Taus.resize (model.qdot_size, num_states);
+  }
+
+  unsigned int body_count = model.mBodies.size();
+
+  std::vector<SpatialMatrix> I (body_count);
+  for (unsigned int i = 1; i < body_count; i++) {
+    model.I[i].setSpatialMatrix (I[i]);
+  }
+
+  SpatialTransformLanesVector X_lambda (body_count);
+  SpatialVectorLanesVector v (body_count);
+  SpatialVectorLanesVector a (body_count);
+  SpatialVectorLanesVector f (body_count);
+
+  for (unsigned int first = 0; first < num_states; first += RBDL_SIMD_LANES) {
+    v[0].setZero();
+    a[0].setConstant (SpatialVector (0., 0., 0.,
+          -model.gravity[0], -model.gravity[1], -model.gravity[2]));
+
+    for (unsigned int i = 1; i < body_count; i++) {
+      unsigned int q_index = model.mJoints[i].q_index;
+      unsigned int lambda = model.lambda[i];
+      const SpatialVector &S = model.mJoints[i].mJointAxes[0];
+
+      LockstepJointTransform (model, i, LoadLanes (Qs, q_index, first),
+          X_lambda[i]);
+      SpatialVectorLanes v_J = LanesScale (S,
+          LoadLanes (QDots, q_index, first));
+
+      v[i] = LanesApply (X_lambda[i], v[lambda]);
+      v[i] += v_J;
+
+      a[i] = LanesApply (X_lambda[i], a[lambda]);
+      a[i] += LanesCrossm (v[i], v_J);
+      a[i] += LanesScale (S, LoadLanes (QDDots, q_index, first));
+
+      if (!model.mBodies[i].mIsVirtual) {
+        f[i] = LanesMultiply (I[i], a[i]);
+        f[i] += LanesCrossf (v[i], LanesMultiply (I[i], v[i]));
+      } else {
+        f[i].setZero();
+      }
+    }
+
+    for (unsigned int i = body_count - 1; i > 0; i--) {
+      const SpatialVector &S = model.mJoints[i].mJointAxes[0];
+      StoreLanes (LanesDot (S, f[i]), model.mJoints[i].q_index, first, Taus);
+
+      if (model.lambda[i] != 0) {
+        f[model.lambda[i]] += LanesApplyTranspose (X_lambda[i], f[i]);
+      }
+    }
+  }
+}
+
+/** \brief Workspace of the directional derivatives of the Recursive
+ * Newton-Euler Algorithm */
+struct InverseDynamicsDerivativeWorkspace {
+  InverseDynamicsDerivativeWorkspace (unsigned int body_count) :
+    dv (body_count),
+    da (body_count),
+    df (body_count),
+    nonzero (body_count) {
+    }
+
+  std::vector<SpatialVector> dv;
+  std::vector<SpatialVector> da;
+  std::vector<SpatialVector> df;
+  /// whether the derivative of body i may be nonzero
+  std::vector<char> nonzero;
+};
+
+/** \brief Computes the derivative of the generalized forces with respect
+ * to either the position or the velocity of the joint of body_id.
+ *
+ * The values of the Recursive Newton-Euler Algorithm have to be stored in
+ * data, i.e. the forces in data.f are the ones that are transmitted
+ * across the joints. Only the bodies in the subtree of body_id and their
+ * ancestors are visited.
+ */
+static void InverseDynamicsDirectionalDerivative (
+    const Model &model,
+    const ModelData &data,
+    const VectorNd &QDot,
+    unsigned int body_id,
+    bool wrt_q,
+    InverseDynamicsDerivativeWorkspace &ws,
+    MatrixNd &dTau,
+    unsigned int column) {
+  unsigned int body_count = model.mBodies.size();
+
+  for (unsigned int i = 0; i < body_count; i++) {
+    ws.nonzero[i] = 0;
+  }
+
+  for (unsigned int i = body_id; i < body_count; i++) {
+    unsigned int lambda = model.lambda[i];
+
+    if (i != body_id && !ws.nonzero[lambda]) {
+      continue;
+    }
+    ws.nonzero[i] = 1;
+
+    const SpatialVector &S = data.S[i];
+
+    if (i == body_id) {
+      if (wrt_q) {
+        // d(X_lambda v) / dq = (X_lambda v) x S
+        ws.dv[i] = crossm (data.X_lambda[i].apply (data.v[lambda]), S);
+        ws.da[i] = crossm (data.X_lambda[i].apply (data.a[lambda]), S);
+      } else {
+        ws.dv[i] = S;
+        ws.da[i] = crossm (data.v[i], S);
+      }
+    } else {
+      ws.dv[i] = data.X_lambda[i].apply (ws.dv[lambda]);
+      ws.da[i] = data.X_lambda[i].apply (ws.da[lambda]);
+    }
+    ws.da[i] += crossm (ws.dv[i], S * QDot[model.mJoints[i].q_index]);
+
+    if (!model.mBodies[i].mIsVirtual) {
+      ws.df[i] = model.I[i] * ws.da[i]
+        + crossf (ws.dv[i], model.I[i] * data.v[i])
+        + crossf (data.v[i], model.I[i] * ws.dv[i]);
+    } else {
+      ws.df[i].setZero();
+    }
+  }
+
+  for (unsigned int i = body_count - 1; i > 0; i--) {
+    if (!ws.nonzero[i]) {
+      dTau(model.mJoints[i].q_index, column) = 0.;
+      continue;
+    }
+
+    unsigned int lambda = model.lambda[i];
+    dTau(model.mJoints[i].q_index, column) = data.S[i].dot (ws.df[i]);
+
+    if (lambda != 0) {
+      SpatialVector df_lambda = data.X_lambda[i].applyTranspose (ws.df[i]);
+      if (i == body_id && wrt_q) {
+        df_lambda += data.X_lambda[i].applyTranspose (
+            crossf (data.S[i], data.f[i]));
+      }
+
+      if (ws.nonzero[lambda]) {
+        ws.df[lambda] += df_lambda;
+      } else {
+        ws.df[lambda] = df_lambda;
+        ws.nonzero[lambda] = 1;
+      }
+    }
+  }
+}
+
+RBDL_DLLAPI void InverseDynamicsDerivatives (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot,
+    MatrixNd &dTau_dQ,
+    MatrixNd &dTau_dQDot) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  if (!HasOnlySimpleJoints (model)) {
+    throw Errors::RBDLError("Analytical derivatives are only supported "
+        "for models that consist of revolute and prismatic joints.");
+  }
+
+  unsigned int dof_count = model.dof_count;
+  if (dTau_dQ.rows() != dof_count || dTau_dQ.cols() != dof_count) {
+    dTau_dQ.resize (dof_count, dof_count);
+  }
+  if (dTau_dQDot.rows() != dof_count || dTau_dQDot.cols() != dof_count) {
+    dTau_dQDot.resize (dof_count, dof_count);
+  }
+
+  VectorNd tau (dof_count);
+  InverseDynamics (model, data, Q, QDot, QDDot, tau, NULL);
+
+  InverseDynamicsDerivativeWorkspace ws (model.mBodies.size());
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    unsigned int q_index = model.mJoints[i].q_index;
+
+    InverseDynamicsDirectionalDerivative (model, data, QDot, i, true, ws,
+        dTau_dQ, q_index);
+    InverseDynamicsDirectionalDerivative (model, data, QDot, i, false, ws,
+        dTau_dQDot, q_index);
+  }
+}
+
+RBDL_DLLAPI void ForwardDynamicsDerivatives (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    MatrixNd &dQDDot_dQ,
+    MatrixNd &dQDDot_dQDot,
+    MatrixNd &dQDDot_dTau) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int dof_count = model.dof_count;
+
+  ForwardDynamics (model, data, Q, QDot, Tau, QDDot, NULL);
+
+  // Differentiating InverseDynamics (q, qdot, ForwardDynamics (q, qdot,
+  // tau)) = tau yields dQDDot_dx = -H^-1 dTau_dx and dQDDot_dTau = H^-1.
+  MatrixNd dTau_dQ;
+  MatrixNd dTau_dQDot;
+  InverseDynamicsDerivatives (model, data, Q, QDot, QDDot, dTau_dQ,
+      dTau_dQDot);
+
+  MatrixNd H (MatrixNd::Zero (dof_count, dof_count));
+  CompositeRigidBodyAlgorithm (model, data, Q, H, false);
+
+  Eigen::LLT<MatrixNd> H_llt (H);
+  dQDDot_dTau = H_llt.solve (MatrixNd::Identity (dof_count, dof_count));
+  dQDDot_dQ.noalias() = -dQDDot_dTau * dTau_dQ;
+  dQDDot_dQDot.noalias() = -dQDDot_dTau * dTau_dQDot;
+}
+
+RBDL_DLLAPI void InverseDynamics (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot,
+    VectorNd &Tau,
+    std::vector<SpatialVector> *f_ext) {
+  InverseDynamics (model, model, Q, QDot, QDDot, Tau, f_ext);
+}
+
+RBDL_DLLAPI void NonlinearEffects (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    VectorNd &Tau,
+    std::vector<Math::SpatialVector> *f_ext) {
+  NonlinearEffects (model, model, Q, QDot, Tau, f_ext);
+}
+
+RBDL_DLLAPI void CompositeRigidBodyAlgorithm (
+    Model& model,
+    const VectorNd &Q,
+    MatrixNd &H,
+    bool update_kinematics) {
+  CompositeRigidBodyAlgorithm (model, model, Q, H, update_kinematics);
+}
+
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmSparse (
+    Model& model,
+    const VectorNd &Q,
+    SparseJointSpaceMatrix &H,
+    bool update_kinematics) {
+  CompositeRigidBodyAlgorithmSparse (model, model, Q, H, update_kinematics);
+}
+
+RBDL_DLLAPI void ForwardDynamicsParallel (
+    Model &model,
+    SubtreeSchedule &schedule,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    std::vector<SpatialVector> *f_ext) {
+  ForwardDynamicsParallel (model, model, schedule, Q, QDot, Tau, QDDot,
+      f_ext);
+}
+
+RBDL_DLLAPI void CompositeRigidBodyAlgorithmParallel (
+    Model &model,
+    SubtreeSchedule &schedule,
+    const VectorNd &Q,
+    MatrixNd &H,
+    bool update_kinematics) {
+  CompositeRigidBodyAlgorithmParallel (model, model, schedule, Q, H,
+      update_kinematics);
+}
+
+RBDL_DLLAPI void ForwardDynamics (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    std::vector<SpatialVector> *f_ext) {
+  ForwardDynamics (model, model, Q, QDot, Tau, QDDot, f_ext);
+}
+
+RBDL_DLLAPI void ForwardDynamicsLagrangian (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    Math::LinearSolver linear_solver,
+    std::vector<SpatialVector> *f_ext,
+    Math::MatrixNd *H,
+    Math::VectorNd *C) {
+  ForwardDynamicsLagrangian (model, model, Q, QDot, Tau, QDDot,
+      linear_solver, f_ext, H, C);
+}
+
+RBDL_DLLAPI void CalcMInvTimesTau (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    bool update_kinematics) {
+  CalcMInvTimesTau (model, model, Q, Tau, QDDot, update_kinematics);
+}
+
+RBDL_DLLAPI void InverseDynamicsDerivatives (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot,
+    MatrixNd &dTau_dQ,
+    MatrixNd &dTau_dQDot) {
+  InverseDynamicsDerivatives (model, model, Q, QDot, QDDot, dTau_dQ,
+      dTau_dQDot);
+}
+
+RBDL_DLLAPI void ForwardDynamicsDerivatives (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &Tau,
+    VectorNd &QDDot,
+    MatrixNd &dQDDot_dQ,
+    MatrixNd &dQDDot_dQDot,
+    MatrixNd &dQDDot_dTau) {
+  ForwardDynamicsDerivatives (model, model, Q, QDot, Tau, QDDot, dQDDot_dQ,
+      dQDDot_dQDot, dQDDot_dTau);
+}
+
 } /* namespace RigidBodyDynamics */
@@ -19,210 +19,334 @@ namespace RigidBodyDynamics {
 
 using namespace Math;
 
+// CustomJoint operates directly on the Model and can therefore only be
+// evaluated when the data is the one stored in the model.
+static Model& custom_joint_model (const Model &model, ModelData &data) {
+  if (&data != static_cast<const ModelData*>(&model)) {
+    throw Errors::RBDLMissingImplementationError(
+        "Error: custom joints can only be evaluated with the data stored "
+        "in the model itself!");
+  }
+
+  return const_cast<Model&>(model);
+}
+
+/*
+ * Joint type specific implementations of jcalc(). Each of them computes
+ * X_J, v_J, c_J and the motion subspace of the joint. The transformation
+ * X_lambda is computed afterwards by jcalc() itself.
+ */
+
+static void jcalc_revolute_x (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] = Xrotx (q[model.mJoints[joint_id].q_index]);
+  data.v_J[joint_id][0] = qdot[model.mJoints[joint_id].q_index];
+}
+
+static void jcalc_revolute_y (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] = Xroty (q[model.mJoints[joint_id].q_index]);
+  data.v_J[joint_id][1] = qdot[model.mJoints[joint_id].q_index];
+}
+
+static void jcalc_revolute_z (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] = Xrotz (q[model.mJoints[joint_id].q_index]);
+  data.v_J[joint_id][2] = qdot[model.mJoints[joint_id].q_index];
+}
+
+static void jcalc_X_lambda_S_helical (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    );
+
+static void jcalc_helical (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] = jcalc_XJ (model, joint_id, q);
+  jcalc_X_lambda_S_helical (model, data, joint_id, q);
+  double Jqd = qdot[model.mJoints[joint_id].q_index];
+  data.v_J[joint_id] = data.S[joint_id] * Jqd;
+
+  Vector3d St = data.S[joint_id].block(0,0,3,1);
+  Vector3d c = data.X_J[joint_id].E * model.mJoints[joint_id].mJointAxes[0].block(3,0,3,1);
+  c = St.cross(c);
+  c *= -Jqd * Jqd;
+  data.c_J[joint_id] = SpatialVector(0,0,0,c[0],c[1],c[2]);
+}
+
+static void jcalc_single_dof (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] = jcalc_XJ (model, joint_id, q);
+  data.v_J[joint_id] =
+    data.S[joint_id] * qdot[model.mJoints[joint_id].q_index];
+}
+
+static void jcalc_spherical (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  data.X_J[joint_id] =
+    SpatialTransform (model.GetQuaternion (joint_id, q).toMatrix(),
+        Vector3d (0., 0., 0.));
+
+  data.multdof3_S[joint_id](0,0) = 1.;
+  data.multdof3_S[joint_id](1,1) = 1.;
+  data.multdof3_S[joint_id](2,2) = 1.;
+
+  Vector3d omega (qdot[model.mJoints[joint_id].q_index],
+      qdot[model.mJoints[joint_id].q_index+1],
+      qdot[model.mJoints[joint_id].q_index+2]);
+
+  data.v_J[joint_id] = SpatialVector (
+      omega[0], omega[1], omega[2],
+      0., 0., 0.);
+}
+
+static void jcalc_euler_zyx (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_J[joint_id].E = Matrix3d(
+      c0 * c1, s0 * c1, -s1,
+      c0 * s1 * s2 - s0 * c2, s0 * s1 * s2 + c0 * c2, c1 * s2,
+      c0 * s1 * c2 + s0 * s2, s0 * s1 * c2 - c0 * s2, c1 * c2
+      );
+
+  data.multdof3_S[joint_id](0,0) = -s1;
+  data.multdof3_S[joint_id](0,2) = 1.;
+
+  data.multdof3_S[joint_id](1,0) = c1 * s2;
+  data.multdof3_S[joint_id](1,1) = c2;
+
+  data.multdof3_S[joint_id](2,0) = c1 * c2;
+  data.multdof3_S[joint_id](2,1) = - s2;
+
+  double qdot0 = qdot[model.mJoints[joint_id].q_index];
+  double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
+  double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
+
+  data.v_J[joint_id] =
+    data.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
+
+  data.c_J[joint_id].set(
+      -c1*qdot0*qdot1,
+      -s1*s2*qdot0*qdot1 + c1*c2*qdot0*qdot2 - s2*qdot1*qdot2,
+      -s1*c2*qdot0*qdot1 - c1*s2*qdot0*qdot2 - c2*qdot1*qdot2,
+      0.,0., 0.);
+}
+
+static void jcalc_euler_xyz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_J[joint_id].E = Matrix3d(
+      c2 * c1, s2 * c0 + c2 * s1 * s0, s2 * s0 - c2 * s1 * c0,
+      -s2 * c1, c2 * c0 - s2 * s1 * s0, c2 * s0 + s2 * s1 * c0,
+      s1, -c1 * s0, c1 * c0
+      );
+
+  data.multdof3_S[joint_id](0,0) = c2 * c1;
+  data.multdof3_S[joint_id](0,1) = s2;
+
+  data.multdof3_S[joint_id](1,0) = -s2 * c1;
+  data.multdof3_S[joint_id](1,1) = c2;
+
+  data.multdof3_S[joint_id](2,0) = s1;
+  data.multdof3_S[joint_id](2,2) = 1.;
+
+  double qdot0 = qdot[model.mJoints[joint_id].q_index];
+  double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
+  double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
+
+  data.v_J[joint_id] =
+    data.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
+
+  data.c_J[joint_id].set(
+      -s2*c1*qdot2*qdot0 - c2*s1*qdot1*qdot0 + c2*qdot2*qdot1,
+      -c2*c1*qdot2*qdot0 + s2*s1*qdot1*qdot0 - s2*qdot2*qdot1,
+      c1*qdot1*qdot0,
+      0., 0., 0.
+      );
+}
+
+static void jcalc_euler_yxz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_J[joint_id].E = Matrix3d(
+      c2 * c0 + s2 * s1 * s0, s2 * c1, -c2 * s0 + s2 * s1 * c0,
+      -s2 * c0 + c2 * s1 * s0, c2 * c1,  s2 * s0 + c2 * s1 * c0,
+      c1 * s0,    - s1,                 c1 * c0);
+
+  data.multdof3_S[joint_id](0,0) = s2 * c1;
+  data.multdof3_S[joint_id](0,1) = c2;
+
+  data.multdof3_S[joint_id](1,0) = c2 * c1;
+  data.multdof3_S[joint_id](1,1) = -s2;
+
+  data.multdof3_S[joint_id](2,0) = -s1;
+  data.multdof3_S[joint_id](2,2) = 1.;
+
+  double qdot0 = qdot[model.mJoints[joint_id].q_index];
+  double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
+  double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
+
+  data.v_J[joint_id] =
+    data.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
+
+  data.c_J[joint_id].set(
+      c2*c1*qdot2*qdot0 - s2*s1*qdot1*qdot0 - s2*qdot2*qdot1,
+      -s2*c1*qdot2*qdot0 - c2*s1*qdot1*qdot0 - c2*qdot2*qdot1,
+      -c1*qdot1*qdot0,
+      0., 0., 0.
+      );
+}
+
+static void jcalc_translation_xyz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  data.X_J[joint_id].E = Matrix3d::Identity();
+  data.X_J[joint_id].r = Vector3d (q0, q1, q2);
+
+  data.multdof3_S[joint_id](3,0) = 1.;
+  data.multdof3_S[joint_id](4,1) = 1.;
+  data.multdof3_S[joint_id](5,2) = 1.;
+
+  double qdot0 = qdot[model.mJoints[joint_id].q_index];
+  double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
+  double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
+
+  data.v_J[joint_id] =
+    data.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
+
+  data.c_J[joint_id].set(0., 0., 0., 0., 0., 0.);
+}
+
+static void jcalc_custom (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  const Joint &joint = model.mJoints[joint_id];
+  CustomJoint *custom_joint =
+    model.mCustomJoints[joint.custom_joint_index];
+  custom_joint->jcalc (custom_joint_model (model, data), joint_id, q, qdot);
+}
+
+static void jcalc_invalid (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  std::ostringstream errormsg;
+  errormsg << "Error: invalid joint type " << model.mJoints[joint_id].mJointType << " at id " << joint_id << std::endl;
+  throw Errors::RBDLError(errormsg.str());
+}
+
 RBDL_DLLAPI void jcalc (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     unsigned int joint_id,
     const VectorNd &q,
     const VectorNd &qdot
     ) {
   // exception if we calculate it for the root body
   assert (joint_id > 0);
+  assert (joint_id < model.mJointCalcDispatch.size());
 
-  if (model.mJoints[joint_id].mJointType == JointTypeRevoluteX) {
-    model.X_J[joint_id] = Xrotx (q[model.mJoints[joint_id].q_index]);
-    model.v_J[joint_id][0] = qdot[model.mJoints[joint_id].q_index];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeRevoluteY) {
-    model.X_J[joint_id] = Xroty (q[model.mJoints[joint_id].q_index]);
-    model.v_J[joint_id][1] = qdot[model.mJoints[joint_id].q_index];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeRevoluteZ) {
-    model.X_J[joint_id] = Xrotz (q[model.mJoints[joint_id].q_index]);
-    model.v_J[joint_id][2] = qdot[model.mJoints[joint_id].q_index];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeHelical) {
-    model.X_J[joint_id] = jcalc_XJ (model, joint_id, q);
-    jcalc_X_lambda_S(model, joint_id, q);
-    double Jqd = qdot[model.mJoints[joint_id].q_index];
-    model.v_J[joint_id] = model.S[joint_id] * Jqd;
-    
-    Vector3d St = model.S[joint_id].block(0,0,3,1);
-    Vector3d c = model.X_J[joint_id].E * model.mJoints[joint_id].mJointAxes[0].block(3,0,3,1);
-    c = St.cross(c);
-    c *= -Jqd * Jqd;    
-    model.c_J[joint_id] = SpatialVector(0,0,0,c[0],c[1],c[2]);
-  } else if (model.mJoints[joint_id].mDoFCount == 1 &&
-      model.mJoints[joint_id].mJointType != JointTypeCustom) {
-    model.X_J[joint_id] = jcalc_XJ (model, joint_id, q);
-    model.v_J[joint_id] = 
-      model.S[joint_id] * qdot[model.mJoints[joint_id].q_index];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeSpherical) {
-    model.X_J[joint_id] = 
-      SpatialTransform (model.GetQuaternion (joint_id, q).toMatrix(), 
-          Vector3d (0., 0., 0.));
-
-    model.multdof3_S[joint_id](0,0) = 1.;
-    model.multdof3_S[joint_id](1,1) = 1.;
-    model.multdof3_S[joint_id](2,2) = 1.;
-
-    Vector3d omega (qdot[model.mJoints[joint_id].q_index],
-        qdot[model.mJoints[joint_id].q_index+1],
-        qdot[model.mJoints[joint_id].q_index+2]);
-
-    model.v_J[joint_id] = SpatialVector (
-        omega[0], omega[1], omega[2],
-        0., 0., 0.);
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerZYX) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_J[joint_id].E = Matrix3d(
-        c0 * c1, s0 * c1, -s1,
-        c0 * s1 * s2 - s0 * c2, s0 * s1 * s2 + c0 * c2, c1 * s2,
-        c0 * s1 * c2 + s0 * s2, s0 * s1 * c2 - c0 * s2, c1 * c2
-        );
-
-    model.multdof3_S[joint_id](0,0) = -s1;
-    model.multdof3_S[joint_id](0,2) = 1.;
-
-    model.multdof3_S[joint_id](1,0) = c1 * s2;
-    model.multdof3_S[joint_id](1,1) = c2;
-
-    model.multdof3_S[joint_id](2,0) = c1 * c2;
-    model.multdof3_S[joint_id](2,1) = - s2;
-
-    double qdot0 = qdot[model.mJoints[joint_id].q_index];
-    double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
-    double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
-
-    model.v_J[joint_id] = 
-      model.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
-
-    model.c_J[joint_id].set(
-        -c1*qdot0*qdot1,
-        -s1*s2*qdot0*qdot1 + c1*c2*qdot0*qdot2 - s2*qdot1*qdot2,
-        -s1*c2*qdot0*qdot1 - c1*s2*qdot0*qdot2 - c2*qdot1*qdot2,
-        0.,0., 0.);
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerXYZ) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_J[joint_id].E = Matrix3d(
-        c2 * c1, s2 * c0 + c2 * s1 * s0, s2 * s0 - c2 * s1 * c0,
-        -s2 * c1, c2 * c0 - s2 * s1 * s0, c2 * s0 + s2 * s1 * c0,
-        s1, -c1 * s0, c1 * c0
-        );
-
-    model.multdof3_S[joint_id](0,0) = c2 * c1;
-    model.multdof3_S[joint_id](0,1) = s2;
-
-    model.multdof3_S[joint_id](1,0) = -s2 * c1;
-    model.multdof3_S[joint_id](1,1) = c2;
-
-    model.multdof3_S[joint_id](2,0) = s1;
-    model.multdof3_S[joint_id](2,2) = 1.;
-
-    double qdot0 = qdot[model.mJoints[joint_id].q_index];
-    double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
-    double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
-
-    model.v_J[joint_id] = 
-      model.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
-
-    model.c_J[joint_id].set(
-        -s2*c1*qdot2*qdot0 - c2*s1*qdot1*qdot0 + c2*qdot2*qdot1,
-        -c2*c1*qdot2*qdot0 + s2*s1*qdot1*qdot0 - s2*qdot2*qdot1,
-        c1*qdot1*qdot0,
-        0., 0., 0.
-        );
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerYXZ) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_J[joint_id].E = Matrix3d(
-        c2 * c0 + s2 * s1 * s0, s2 * c1, -c2 * s0 + s2 * s1 * c0,
-        -s2 * c0 + c2 * s1 * s0, c2 * c1,  s2 * s0 + c2 * s1 * c0,
-        c1 * s0,    - s1,                 c1 * c0);
-
-    model.multdof3_S[joint_id](0,0) = s2 * c1;
-    model.multdof3_S[joint_id](0,1) = c2;
-
-    model.multdof3_S[joint_id](1,0) = c2 * c1;
-    model.multdof3_S[joint_id](1,1) = -s2;
-
-    model.multdof3_S[joint_id](2,0) = -s1;
-    model.multdof3_S[joint_id](2,2) = 1.;
-
-    double qdot0 = qdot[model.mJoints[joint_id].q_index];
-    double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
-    double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
-
-    model.v_J[joint_id] = 
-      model.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
-
-    model.c_J[joint_id].set(
-        c2*c1*qdot2*qdot0 - s2*s1*qdot1*qdot0 - s2*qdot2*qdot1,
-        -s2*c1*qdot2*qdot0 - c2*s1*qdot1*qdot0 - c2*qdot2*qdot1,
-        -c1*qdot1*qdot0,
-        0., 0., 0.
-        );
-  } else if(model.mJoints[joint_id].mJointType == JointTypeTranslationXYZ){
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    model.X_J[joint_id].E = Matrix3d::Identity();
-    model.X_J[joint_id].r = Vector3d (q0, q1, q2);
-
-    model.multdof3_S[joint_id](3,0) = 1.;
-    model.multdof3_S[joint_id](4,1) = 1.;
-    model.multdof3_S[joint_id](5,2) = 1.;
-
-    double qdot0 = qdot[model.mJoints[joint_id].q_index];
-    double qdot1 = qdot[model.mJoints[joint_id].q_index + 1];
-    double qdot2 = qdot[model.mJoints[joint_id].q_index + 2];
-
-    model.v_J[joint_id] = 
-      model.multdof3_S[joint_id] * Vector3d (qdot0, qdot1, qdot2);
-
-    model.c_J[joint_id].set(0., 0., 0., 0., 0., 0.);
-  } else if (model.mJoints[joint_id].mJointType == JointTypeCustom) {
-    const Joint &joint = model.mJoints[joint_id];
-    CustomJoint *custom_joint = 
-      model.mCustomJoints[joint.custom_joint_index];
-    custom_joint->jcalc (model, joint_id, q, qdot);
-  } else {
-    std::ostringstream errormsg;
-    errormsg << "Error: invalid joint type " << model.mJoints[joint_id].mJointType << " at id " << joint_id << std::endl;
-    throw Errors::RBDLError(errormsg.str());
-  }
+  model.mJointCalcDispatch[joint_id].jcalc (model, data, joint_id, q, qdot);
+  data.S_base_valid[joint_id] = false;
+  data.kinematics_cache_state[joint_id] = 0;
 
-  model.X_lambda[joint_id] = model.X_J[joint_id] * model.X_T[joint_id];
+  data.X_lambda[joint_id] = data.X_J[joint_id] * model.X_T[joint_id];
 }
 
 RBDL_DLLAPI Math::SpatialTransform jcalc_XJ (
-    Model &model,
+    const Model &model,
     unsigned int joint_id,
     const Math::VectorNd &q) {
   // exception if we calculate it for the root body
@@ -274,168 +398,325 @@ RBDL_DLLAPI Math::SpatialTransform jcalc_XJ (
   return SpatialTransform();
 }
 
+/*
+ * Joint type specific implementations of jcalc_X_lambda_S().
+ */
+
+static void jcalc_X_lambda_S_revolute_x (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  data.X_lambda[joint_id] =
+    Xrotx (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
+  data.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
+}
+
+static void jcalc_X_lambda_S_revolute_y (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  data.X_lambda[joint_id] =
+    Xroty (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
+  data.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
+}
+
+static void jcalc_X_lambda_S_revolute_z (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  data.X_lambda[joint_id] =
+    Xrotz (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
+  data.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
+}
+
+static void jcalc_X_lambda_S_helical (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  SpatialTransform XJ = jcalc_XJ (model, joint_id, q);
+  data.X_lambda[joint_id] = XJ * model.X_T[joint_id];
+  // Set the joint axis
+  Vector3d trans = XJ.E * model.mJoints[joint_id].mJointAxes[0].block(3,0,3,1);
+
+  data.S[joint_id] = SpatialVector(model.mJoints[joint_id].mJointAxes[0][0],
+      model.mJoints[joint_id].mJointAxes[0][1],
+      model.mJoints[joint_id].mJointAxes[0][2],
+      trans[0], trans[1], trans[2]);
+}
+
+static void jcalc_X_lambda_S_single_dof (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  data.X_lambda[joint_id] =
+    jcalc_XJ (model, joint_id, q) * model.X_T[joint_id];
+  data.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
+}
+
+static void jcalc_X_lambda_S_spherical (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  data.X_lambda[joint_id] = SpatialTransform (
+      model.GetQuaternion (joint_id, q).toMatrix(),
+      Vector3d (0., 0., 0.))
+    * model.X_T[joint_id];
+
+  data.multdof3_S[joint_id].setZero();
+
+  data.multdof3_S[joint_id](0,0) = 1.;
+  data.multdof3_S[joint_id](1,1) = 1.;
+  data.multdof3_S[joint_id](2,2) = 1.;
+}
+
+static void jcalc_X_lambda_S_euler_zyx (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_lambda[joint_id] = SpatialTransform (
+      Matrix3d(
+        c0 * c1, s0 * c1, -s1,
+        c0 * s1 * s2 - s0 * c2, s0 * s1 * s2 + c0 * c2, c1 * s2,
+        c0 * s1 * c2 + s0 * s2, s0 * s1 * c2 - c0 * s2, c1 * c2
+        ),
+      Vector3d (0., 0., 0.))
+    * model.X_T[joint_id];
+
+  data.multdof3_S[joint_id].setZero();
+
+  data.multdof3_S[joint_id](0,0) = -s1;
+  data.multdof3_S[joint_id](0,2) = 1.;
+
+  data.multdof3_S[joint_id](1,0) = c1 * s2;
+  data.multdof3_S[joint_id](1,1) = c2;
+
+  data.multdof3_S[joint_id](2,0) = c1 * c2;
+  data.multdof3_S[joint_id](2,1) = - s2;
+}
+
+static void jcalc_X_lambda_S_euler_xyz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_lambda[joint_id] = SpatialTransform (
+      Matrix3d(
+        c2 * c1, s2 * c0 + c2 * s1 * s0, s2 * s0 - c2 * s1 * c0,
+        -s2 * c1, c2 * c0 - s2 * s1 * s0, c2 * s0 + s2 * s1 * c0,
+        s1, -c1 * s0, c1 * c0
+        ),
+      Vector3d (0., 0., 0.))
+    * model.X_T[joint_id];
+
+  data.multdof3_S[joint_id].setZero();
+
+  data.multdof3_S[joint_id](0,0) = c2 * c1;
+  data.multdof3_S[joint_id](0,1) = s2;
+
+  data.multdof3_S[joint_id](1,0) = -s2 * c1;
+  data.multdof3_S[joint_id](1,1) = c2;
+
+  data.multdof3_S[joint_id](2,0) = s1;
+  data.multdof3_S[joint_id](2,2) = 1.;
+}
+
+static void jcalc_X_lambda_S_euler_yxz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  double s0 = sin (q0);
+  double c0 = cos (q0);
+  double s1 = sin (q1);
+  double c1 = cos (q1);
+  double s2 = sin (q2);
+  double c2 = cos (q2);
+
+  data.X_lambda[joint_id] = SpatialTransform (
+      Matrix3d(
+        c2 * c0 + s2 * s1 * s0, s2 * c1, -c2 * s0 + s2 * s1 * c0,
+        -s2 * c0 + c2 * s1 * s0, c2 * c1, s2 * s0 + c2 * s1 * c0,
+        c1 * s0, - s1, c1 * c0
+        ),
+      Vector3d (0., 0., 0.))
+    * model.X_T[joint_id];
+
+  data.multdof3_S[joint_id].setZero();
+
+  data.multdof3_S[joint_id](0,0) = s2 * c1;
+  data.multdof3_S[joint_id](0,1) = c2;
+
+  data.multdof3_S[joint_id](1,0) = c2 * c1;
+  data.multdof3_S[joint_id](1,1) = -s2;
+
+  data.multdof3_S[joint_id](2,0) = -s1;
+  data.multdof3_S[joint_id](2,2) = 1.;
+}
+
+static void jcalc_X_lambda_S_translation_xyz (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  double q0 = q[model.mJoints[joint_id].q_index];
+  double q1 = q[model.mJoints[joint_id].q_index + 1];
+  double q2 = q[model.mJoints[joint_id].q_index + 2];
+
+  data.X_lambda[joint_id] = SpatialTransform (
+      Matrix3d::Identity (3,3),
+      Vector3d (q0, q1, q2))
+    * model.X_T[joint_id];
+
+  data.multdof3_S[joint_id].setZero();
+
+  data.multdof3_S[joint_id](3,0) = 1.;
+  data.multdof3_S[joint_id](4,1) = 1.;
+  data.multdof3_S[joint_id](5,2) = 1.;
+}
+
+static void jcalc_X_lambda_S_custom (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  const Joint &joint = model.mJoints[joint_id];
+  CustomJoint *custom_joint
+    = model.mCustomJoints[joint.custom_joint_index];
+
+  custom_joint->jcalc_X_lambda_S (custom_joint_model (model, data),
+      joint_id, q);
+}
+
+static void jcalc_X_lambda_S_invalid (
+    const Model &model,
+    ModelData &data,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  throw Errors::RBDLError("Error: invalid joint type!");
+}
+
 RBDL_DLLAPI void jcalc_X_lambda_S (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     unsigned int joint_id,
     const VectorNd &q
     ) {
   // exception if we calculate it for the root body
   assert (joint_id > 0);
+  assert (joint_id < model.mJointCalcDispatch.size());
 
-  if (model.mJoints[joint_id].mJointType == JointTypeRevoluteX) {
-    model.X_lambda[joint_id] = 
-      Xrotx (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
-    model.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeRevoluteY) {
-    model.X_lambda[joint_id] = 
-      Xroty (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
-    model.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeRevoluteZ) {
-    model.X_lambda[joint_id] = 
-      Xrotz (q[model.mJoints[joint_id].q_index]) * model.X_T[joint_id];
-    model.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeHelical){
-    SpatialTransform XJ = jcalc_XJ (model, joint_id, q);
-    model.X_lambda[joint_id] = XJ * model.X_T[joint_id];
-    // Set the joint axis
-    Vector3d trans = XJ.E * model.mJoints[joint_id].mJointAxes[0].block(3,0,3,1);
-    
-    model.S[joint_id] = SpatialVector(model.mJoints[joint_id].mJointAxes[0][0],
-           model.mJoints[joint_id].mJointAxes[0][1],
-           model.mJoints[joint_id].mJointAxes[0][2],
-           trans[0], trans[1], trans[2]);
-  } else if (model.mJoints[joint_id].mDoFCount == 1
-      && model.mJoints[joint_id].mJointType != JointTypeCustom){
-    model.X_lambda[joint_id] = 
-      jcalc_XJ (model, joint_id, q) * model.X_T[joint_id];
-    model.S[joint_id] = model.mJoints[joint_id].mJointAxes[0];
-  } else if (model.mJoints[joint_id].mJointType == JointTypeSpherical) {
-    model.X_lambda[joint_id] = SpatialTransform (
-        model.GetQuaternion (joint_id, q).toMatrix(),
-        Vector3d (0., 0., 0.))
-      * model.X_T[joint_id];
-
-    model.multdof3_S[joint_id].setZero();
-
-    model.multdof3_S[joint_id](0,0) = 1.;
-    model.multdof3_S[joint_id](1,1) = 1.;
-    model.multdof3_S[joint_id](2,2) = 1.;
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerZYX) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_lambda[joint_id] = SpatialTransform ( 
-        Matrix3d(
-          c0 * c1, s0 * c1, -s1,
-          c0 * s1 * s2 - s0 * c2, s0 * s1 * s2 + c0 * c2, c1 * s2,
-          c0 * s1 * c2 + s0 * s2, s0 * s1 * c2 - c0 * s2, c1 * c2
-          ),
-        Vector3d (0., 0., 0.))
-      * model.X_T[joint_id];
-
-    model.multdof3_S[joint_id].setZero();
-
-    model.multdof3_S[joint_id](0,0) = -s1;
-    model.multdof3_S[joint_id](0,2) = 1.;
-
-    model.multdof3_S[joint_id](1,0) = c1 * s2;
-    model.multdof3_S[joint_id](1,1) = c2;
-
-    model.multdof3_S[joint_id](2,0) = c1 * c2;
-    model.multdof3_S[joint_id](2,1) = - s2;
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerXYZ) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_lambda[joint_id] = SpatialTransform (
-        Matrix3d(
-          c2 * c1, s2 * c0 + c2 * s1 * s0, s2 * s0 - c2 * s1 * c0,
-          -s2 * c1, c2 * c0 - s2 * s1 * s0, c2 * s0 + s2 * s1 * c0,
-          s1, -c1 * s0, c1 * c0
-          ),
-        Vector3d (0., 0., 0.))
-      * model.X_T[joint_id];
-
-    model.multdof3_S[joint_id].setZero();
-
-    model.multdof3_S[joint_id](0,0) = c2 * c1;
-    model.multdof3_S[joint_id](0,1) = s2;
-
-    model.multdof3_S[joint_id](1,0) = -s2 * c1;
-    model.multdof3_S[joint_id](1,1) = c2;
-
-    model.multdof3_S[joint_id](2,0) = s1;
-    model.multdof3_S[joint_id](2,2) = 1.;
-  } else if (model.mJoints[joint_id].mJointType == JointTypeEulerYXZ ) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    double s0 = sin (q0);
-    double c0 = cos (q0);
-    double s1 = sin (q1);
-    double c1 = cos (q1);
-    double s2 = sin (q2);
-    double c2 = cos (q2);
-
-    model.X_lambda[joint_id] = SpatialTransform (
-        Matrix3d(
-          c2 * c0 + s2 * s1 * s0, s2 * c1, -c2 * s0 + s2 * s1 * c0,
-          -s2 * c0 + c2 * s1 * s0, c2 * c1, s2 * s0 + c2 * s1 * c0,
-          c1 * s0, - s1, c1 * c0
-          ),
-        Vector3d (0., 0., 0.))
-      * model.X_T[joint_id];
-
-    model.multdof3_S[joint_id].setZero();
-
-    model.multdof3_S[joint_id](0,0) = s2 * c1;
-    model.multdof3_S[joint_id](0,1) = c2;
-
-    model.multdof3_S[joint_id](1,0) = c2 * c1;
-    model.multdof3_S[joint_id](1,1) = -s2;
-
-    model.multdof3_S[joint_id](2,0) = -s1;
-    model.multdof3_S[joint_id](2,2) = 1.;
-  } else if (model.mJoints[joint_id].mJointType == JointTypeTranslationXYZ) {
-    double q0 = q[model.mJoints[joint_id].q_index];
-    double q1 = q[model.mJoints[joint_id].q_index + 1];
-    double q2 = q[model.mJoints[joint_id].q_index + 2];
-
-    model.X_lambda[joint_id] = SpatialTransform (
-        Matrix3d::Identity (3,3),
-        Vector3d (q0, q1, q2))
-      * model.X_T[joint_id];
-
-    model.multdof3_S[joint_id].setZero();
-
-    model.multdof3_S[joint_id](3,0) = 1.;
-    model.multdof3_S[joint_id](4,1) = 1.;
-    model.multdof3_S[joint_id](5,2) = 1.;
-  } else if (model.mJoints[joint_id].mJointType == JointTypeCustom) {
-    const Joint &joint = model.mJoints[joint_id];
-    CustomJoint *custom_joint 
-      = model.mCustomJoints[joint.custom_joint_index];
-
-    custom_joint->jcalc_X_lambda_S (model, joint_id, q);
+  model.mJointCalcDispatch[joint_id].jcalc_X_lambda_S (model, data,
+      joint_id, q);
+  data.S_base_valid[joint_id] = false;
+  data.kinematics_cache_state[joint_id] = 0;
+}
+
+RBDL_DLLAPI JointCalcDispatch jcalc_dispatch (const Joint &joint) {
+  JointCalcDispatch result;
+
+  // The order of the checks matters: the axis specific revolute joints
+  // and helical joints are handled before all other single DoF joints.
+  if (joint.mJointType == JointTypeRevoluteX) {
+    result.jcalc = jcalc_revolute_x;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_revolute_x;
+  } else if (joint.mJointType == JointTypeRevoluteY) {
+    result.jcalc = jcalc_revolute_y;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_revolute_y;
+  } else if (joint.mJointType == JointTypeRevoluteZ) {
+    result.jcalc = jcalc_revolute_z;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_revolute_z;
+  } else if (joint.mJointType == JointTypeHelical) {
+    result.jcalc = jcalc_helical;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_helical;
+  } else if (joint.mDoFCount == 1 && joint.mJointType != JointTypeCustom) {
+    result.jcalc = jcalc_single_dof;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_single_dof;
+  } else if (joint.mJointType == JointTypeSpherical) {
+    result.jcalc = jcalc_spherical;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_spherical;
+  } else if (joint.mJointType == JointTypeEulerZYX) {
+    result.jcalc = jcalc_euler_zyx;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_euler_zyx;
+  } else if (joint.mJointType == JointTypeEulerXYZ) {
+    result.jcalc = jcalc_euler_xyz;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_euler_xyz;
+  } else if (joint.mJointType == JointTypeEulerYXZ) {
+    result.jcalc = jcalc_euler_yxz;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_euler_yxz;
+  } else if (joint.mJointType == JointTypeTranslationXYZ) {
+    result.jcalc = jcalc_translation_xyz;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_translation_xyz;
+  } else if (joint.mJointType == JointTypeCustom) {
+    result.jcalc = jcalc_custom;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_custom;
   } else {
-    throw Errors::RBDLError("Error: invalid joint type!");
+    result.jcalc = jcalc_invalid;
+    result.jcalc_X_lambda_S = jcalc_X_lambda_S_invalid;
   }
+
+  return result;
+}
+
+RBDL_DLLAPI void jcalc (
+    Model &model,
+    unsigned int joint_id,
+    const VectorNd &q,
+    const VectorNd &qdot
+    ) {
+  jcalc (model, model, joint_id, q, qdot);
 }
+
+RBDL_DLLAPI void jcalc_X_lambda_S (
+    Model &model,
+    unsigned int joint_id,
+    const VectorNd &q
+    ) {
+  jcalc_X_lambda_S (model, model, joint_id, q);
+}
+
 }
@@ -6,8 +6,11 @@
  */
 
 #include <iostream>
+#include <sstream>
 #include <limits>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 #include <assert.h>
 
 #include "rbdl/rbdl_mathutils.h"
@@ -18,70 +21,125 @@
 
 #include "rbdl/rbdl_utils.h"
 
+#include "rbdl_parallel.h"
+
 namespace RigidBodyDynamics {
 
 using namespace Math;
 
+/*
+ * Computes the spatial acceleration of body i from the acceleration of its
+ * parent, the velocity dependent acceleration c, and the joint
+ * acceleration.
+ */
+static void UpdateBodyAcceleration (
+    const Model &model,
+    ModelData &data,
+    unsigned int i,
+    const VectorNd &QDDot) {
+  unsigned int q_index = model.mJoints[i].q_index;
+  unsigned int lambda = model.lambda[i];
+
+  if (lambda != 0) {
+    data.a[i] = data.X_lambda[i].apply(data.a[lambda]) + data.c[i];
+  } else {
+    data.a[i] = data.c[i];
+  }
+
+  if( model.mJoints[i].mJointType != JointTypeCustom){
+    if (model.mJoints[i].mDoFCount == 1) {
+      data.a[i] = data.a[i] + data.S[i] * QDDot[q_index];
+    } else if (model.mJoints[i].mDoFCount == 3) {
+      Vector3d omegadot_temp (QDDot[q_index], 
+          QDDot[q_index + 1], 
+          QDDot[q_index + 2]);
+      data.a[i] = data.a[i] 
+        + data.multdof3_S[i] * omegadot_temp;
+    }
+  } else {
+    unsigned int k = model.mJoints[i].custom_joint_index;
+
+    const CustomJoint* custom_joint = model.mCustomJoints[k];
+    unsigned int joint_dof_count = custom_joint->mDoFCount;
+
+    data.a[i] = data.a[i]
+      + (  (model.mCustomJoints[k]->S)
+          *(QDDot.block(q_index, 0, joint_dof_count, 1)));
+  }
+}
+
 RBDL_DLLAPI void UpdateKinematics(
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &QDDot) {
+  if (data.use_kinematics_cache) {
+    UpdateKinematicsCached (model, data, &Q, &QDot, &QDDot);
+    return;
+  }
+
   LOG << "-------- " << __func__ << " --------" << std::endl;
 
   unsigned int i;
 
-  model.a[0].setZero();
+  data.a[0].setZero();
 
   for (i = 1; i < model.mBodies.size(); i++) {
     unsigned int q_index = model.mJoints[i].q_index;
     unsigned int lambda = model.lambda[i];
 
-    jcalc (model, i, Q, QDot);
+    jcalc (model, data, i, Q, QDot);
 
-    model.X_lambda[i] = model.X_J[i] * model.X_T[i];
+    data.X_lambda[i] = data.X_J[i] * model.X_T[i];
 
     if (lambda != 0) {
-      model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
-      model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
+      data.X_base[i] = data.X_lambda[i] * data.X_base[lambda];
+      data.v[i] = data.X_lambda[i].apply(data.v[lambda]) + data.v_J[i];
     } else {
-      model.X_base[i] = model.X_lambda[i];
-      model.v[i] = model.v_J[i];
+      data.X_base[i] = data.X_lambda[i];
+      data.v[i] = data.v_J[i];
     }
 
-    model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
-    model.a[i] = model.X_lambda[i].apply(model.a[lambda]) + model.c[i];
+    data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
+    data.a[i] = data.X_lambda[i].apply(data.a[lambda]) + data.c[i];
 
     if(model.mJoints[i].mJointType != JointTypeCustom){
       if (model.mJoints[i].mDoFCount == 1) {
-        model.a[i] = model.a[i] + model.S[i] * QDDot[q_index];
+        data.a[i] = data.a[i] + data.S[i] * QDDot[q_index];
       } else if (model.mJoints[i].mDoFCount == 3) {
         Vector3d omegadot_temp (QDDot[q_index], 
             QDDot[q_index + 1], 
             QDDot[q_index + 2]);
-        model.a[i] = model.a[i] + model.multdof3_S[i] * omegadot_temp;
+        data.a[i] = data.a[i] + data.multdof3_S[i] * omegadot_temp;
       }
     } else {
       unsigned int custom_index = model.mJoints[i].custom_joint_index;
       const CustomJoint* custom_joint = model.mCustomJoints[custom_index];
       unsigned int joint_dof_count = custom_joint->mDoFCount;
 
-      model.a[i] = model.a[i]
+      data.a[i] = data.a[i]
         + ( model.mCustomJoints[custom_index]->S 
             * QDDot.block(q_index, 0, joint_dof_count, 1));
     }
   }
 
   for (i = 1; i < model.mBodies.size(); i++) {
-    LOG << "a[" << i << "] = " << model.a[i].transpose() << std::endl;
+    LOG << "a[" << i << "] = " << data.a[i].transpose() << std::endl;
   }
 }
 
 RBDL_DLLAPI void UpdateKinematicsCustom(
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd *Q,
     const VectorNd *QDot,
     const VectorNd *QDDot) {
+  if (data.use_kinematics_cache) {
+    UpdateKinematicsCached (model, data, Q, QDot, QDDot);
+    return;
+  }
+
   LOG << "-------- " << __func__ << " --------" << std::endl;
 
   unsigned int i;
@@ -90,16 +148,14 @@ RBDL_DLLAPI void UpdateKinematicsCustom(
     for (i = 1; i < model.mBodies.size(); i++) {
       unsigned int lambda = model.lambda[i];
 
-      VectorNd QDot_zero (VectorNd::Zero (model.q_size));
+      jcalc (model, data, i, (*Q), model.qdot_zero);
 
-      jcalc (model, i, (*Q), QDot_zero);
-
-      model.X_lambda[i] = model.X_J[i] * model.X_T[i];
+      data.X_lambda[i] = data.X_J[i] * model.X_T[i];
 
       if (lambda != 0) {
-        model.X_base[i] = model.X_lambda[i] * model.X_base[lambda];
+        data.X_base[i] = data.X_lambda[i] * data.X_base[lambda];
       } else {
-        model.X_base[i] = model.X_lambda[i];
+        data.X_base[i] = data.X_lambda[i];
       }
     }
   }
@@ -108,65 +164,211 @@ RBDL_DLLAPI void UpdateKinematicsCustom(
     for (i = 1; i < model.mBodies.size(); i++) {
       unsigned int lambda = model.lambda[i];
 
-      jcalc (model, i, *Q, *QDot);
+      jcalc (model, data, i, *Q, *QDot);
 
       if (lambda != 0) {
-        model.v[i] = model.X_lambda[i].apply(model.v[lambda]) + model.v_J[i];
-        model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
+        data.v[i] = data.X_lambda[i].apply(data.v[lambda]) + data.v_J[i];
+        data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
       } else {
-        model.v[i] = model.v_J[i];
-        model.c[i] = model.c_J[i] + crossm(model.v[i],model.v_J[i]);
+        data.v[i] = data.v_J[i];
+        data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
       }
-      // LOG << "v[" << i << "] = " << model.v[i].transpose() << std::endl;
+      // LOG << "v[" << i << "] = " << data.v[i].transpose() << std::endl;
     }
   }
 
   // FIXME?: Changing QDot can alter body accelerations via c[] - update to QDot but not QDDot can result in incorrect a[]
   if (QDDot) {
     for (i = 1; i < model.mBodies.size(); i++) {
-      unsigned int q_index = model.mJoints[i].q_index;
+      UpdateBodyAcceleration (model, data, i, *QDDot);
+    }
+  }
+}
 
-      unsigned int lambda = model.lambda[i];
+/*
+ * Joint values that are compared by UpdateKinematicsCached(). For Q this
+ * includes the w component of spherical joints.
+ */
+static bool JointValuesChanged (
+    const Model &model,
+    unsigned int i,
+    const VectorNd &values,
+    const VectorNd &cached_values,
+    bool is_q) {
+  unsigned int q_index = model.mJoints[i].q_index;
+
+  for (unsigned int j = 0; j < model.mJoints[i].mDoFCount; j++) {
+    if (values[q_index + j] != cached_values[q_index + j]) {
+      return true;
+    }
+  }
+
+  if (is_q && model.mJoints[i].mJointType == JointTypeSpherical) {
+    unsigned int w_index = model.multdof3_w_index[i];
+    return values[w_index] != cached_values[w_index];
+  }
+
+  return false;
+}
 
+static const unsigned char KinematicsCacheQ = 1;
+static const unsigned char KinematicsCacheQDot = 2;
+static const unsigned char KinematicsCacheQDDot = 4;
+
+RBDL_DLLAPI void UpdateKinematicsCached(
+    const Model &model,
+    ModelData &data,
+    const VectorNd *Q,
+    const VectorNd *QDot,
+    const VectorNd *QDDot) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  assert (Q || !QDot);
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    unsigned int lambda = model.lambda[i];
+    unsigned char state = data.kinematics_cache_state[i];
+    unsigned char parent_updated = data.kinematics_cache_updated[lambda];
+    unsigned char updated = 0;
+
+    bool joint_q_changed = Q
+      && (!(state & KinematicsCacheQ)
+          || JointValuesChanged (model, i, *Q, data.kinematics_cache_q, true));
+    bool joint_qdot_changed = QDot
+      && (joint_q_changed
+          || !(state & KinematicsCacheQDot)
+          || JointValuesChanged (model, i, *QDot, data.kinematics_cache_qdot,
+            false));
+
+    // jcalc() evaluates the joint transformation and the joint velocity
+    // together
+    if (joint_qdot_changed) {
+      jcalc (model, data, i, *Q, *QDot);
+    } else if (joint_q_changed) {
+      jcalc (model, data, i, *Q, model.qdot_zero);
+      state &= ~(KinematicsCacheQDot | KinematicsCacheQDDot);
+    }
+
+    if (joint_q_changed || (parent_updated & KinematicsCacheQ)) {
       if (lambda != 0) {
-        model.a[i] = model.X_lambda[i].apply(model.a[lambda]) + model.c[i];
+        data.X_base[i] = data.X_lambda[i] * data.X_base[lambda];
       } else {
-        model.a[i] = model.c[i];
+        data.X_base[i] = data.X_lambda[i];
       }
+      data.S_base_valid[i] = false;
+      updated |= KinematicsCacheQ;
+    }
+    if (Q) {
+      state |= KinematicsCacheQ;
+    }
 
-      if( model.mJoints[i].mJointType != JointTypeCustom){
-        if (model.mJoints[i].mDoFCount == 1) {
-          model.a[i] = model.a[i] + model.S[i] * (*QDDot)[q_index];
-        } else if (model.mJoints[i].mDoFCount == 3) {
-          Vector3d omegadot_temp ((*QDDot)[q_index], 
-              (*QDDot)[q_index + 1], 
-              (*QDDot)[q_index + 2]);
-          model.a[i] = model.a[i] 
-            + model.multdof3_S[i] * omegadot_temp;
-        }
+    if (joint_qdot_changed || (parent_updated & KinematicsCacheQDot)) {
+      if (lambda != 0) {
+        data.v[i] = data.X_lambda[i].apply(data.v[lambda]) + data.v_J[i];
       } else {
-        unsigned int k = model.mJoints[i].custom_joint_index;
-
-        const CustomJoint* custom_joint = model.mCustomJoints[k];
-        unsigned int joint_dof_count = custom_joint->mDoFCount;
+        data.v[i] = data.v_J[i];
+      }
+      data.c[i] = data.c_J[i] + crossm(data.v[i],data.v_J[i]);
+      updated |= KinematicsCacheQDot;
+      state |= KinematicsCacheQDot;
+    }
 
-        model.a[i] = model.a[i]
-          + (  (model.mCustomJoints[k]->S)
-              *(QDDot->block(q_index, 0, joint_dof_count, 1)));
+    // the acceleration depends on X_lambda, c, the acceleration of the
+    // parent, and the joint acceleration
+    bool acceleration_inputs_changed = joint_q_changed
+      || (updated & KinematicsCacheQDot)
+      || (parent_updated & KinematicsCacheQDDot);
+
+    if (QDDot && (state & KinematicsCacheQDot)) {
+      if (acceleration_inputs_changed
+          || !(state & KinematicsCacheQDDot)
+          || JointValuesChanged (model, i, *QDDot,
+            data.kinematics_cache_qddot, false)) {
+        UpdateBodyAcceleration (model, data, i, *QDDot);
+        updated |= KinematicsCacheQDDot;
       }
-    } 
+      state |= KinematicsCacheQDDot;
+    } else if (acceleration_inputs_changed) {
+      state &= ~KinematicsCacheQDDot;
+    }
+
+    // quantities of a body can only be valid if the ones of its parent are
+    data.kinematics_cache_state[i] = state
+      & data.kinematics_cache_state[lambda];
+    data.kinematics_cache_updated[i] = updated;
+  }
+
+  if (Q) {
+    data.kinematics_cache_q = *Q;
+  }
+  if (QDot) {
+    data.kinematics_cache_qdot = *QDot;
+  }
+  if (QDDot) {
+    data.kinematics_cache_qddot = *QDDot;
+  }
+}
+
+/*
+ * Evaluates the joints on the path from the root to the movable body j,
+ * starting at the root.
+ */
+static void UpdateChainPositions (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    unsigned int j) {
+  if (j == 0) {
+    return;
+  }
+
+  unsigned int lambda = model.lambda[j];
+  UpdateChainPositions (model, data, Q, lambda);
+
+  jcalc_X_lambda_S (model, data, j, Q);
+
+  if (lambda != 0) {
+    data.X_base[j] = data.X_lambda[j] * data.X_base[lambda];
+  } else {
+    data.X_base[j] = data.X_lambda[j];
+  }
+}
+
+RBDL_DLLAPI void UpdateKinematicsChain(
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    unsigned int body_id) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  if (model.IsFixedBodyId (body_id)) {
+    body_id =
+      model.mFixedBodies[body_id - model.fixed_body_discriminator].mMovableParent;
+  }
+
+  UpdateChainPositions (model, data, Q, body_id);
+}
+
+RBDL_DLLAPI void UpdateKinematicsChain(
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    const std::vector<unsigned int> &body_ids) {
+  for (unsigned int k = 0; k < body_ids.size(); k++) {
+    UpdateKinematicsChain (model, data, Q, body_ids[k]);
   }
 }
 
 RBDL_DLLAPI Vector3d CalcBodyToBaseCoordinates (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     unsigned int body_id,
     const Vector3d &point_body_coordinates,
     bool update_kinematics) {
   // update the Kinematics if necessary
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
   if (body_id >= model.fixed_body_discriminator) {
@@ -177,28 +379,29 @@ RBDL_DLLAPI Vector3d CalcBodyToBaseCoordinates (
       model.mFixedBodies[fbody_id].mParentTransform.E.transpose();
     Vector3d fixed_position = model.mFixedBodies[fbody_id].mParentTransform.r;
 
-    Matrix3d parent_body_rotation = model.X_base[parent_id].E.transpose();
-    Vector3d parent_body_position = model.X_base[parent_id].r;
+    Matrix3d parent_body_rotation = data.X_base[parent_id].E.transpose();
+    Vector3d parent_body_position = data.X_base[parent_id].r;
 
     return (parent_body_position 
         + (parent_body_rotation 
           * (fixed_position + fixed_rotation * (point_body_coordinates))) );
   }
 
-  Matrix3d body_rotation = model.X_base[body_id].E.transpose();
-  Vector3d body_position = model.X_base[body_id].r;
+  Matrix3d body_rotation = data.X_base[body_id].E.transpose();
+  Vector3d body_position = data.X_base[body_id].r;
 
   return body_position + body_rotation * point_body_coordinates;
 }
 
 RBDL_DLLAPI Vector3d CalcBaseToBodyCoordinates (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     unsigned int body_id,
     const Vector3d &point_base_coordinates,
     bool update_kinematics) {
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
   if (body_id >= model.fixed_body_discriminator) {
@@ -208,8 +411,8 @@ RBDL_DLLAPI Vector3d CalcBaseToBodyCoordinates (
     Matrix3d fixed_rotation = model.mFixedBodies[fbody_id].mParentTransform.E;
     Vector3d fixed_position = model.mFixedBodies[fbody_id].mParentTransform.r;
 
-    Matrix3d parent_body_rotation = model.X_base[parent_id].E;
-    Vector3d parent_body_position = model.X_base[parent_id].r;
+    Matrix3d parent_body_rotation = data.X_base[parent_id].E;
+    Vector3d parent_body_position = data.X_base[parent_id].r;
 
     return (fixed_rotation 
         * ( - fixed_position 
@@ -217,36 +420,107 @@ RBDL_DLLAPI Vector3d CalcBaseToBodyCoordinates (
           * (parent_body_position - point_base_coordinates)));
   }
 
-  Matrix3d body_rotation = model.X_base[body_id].E;
-  Vector3d body_position = model.X_base[body_id].r;
+  Matrix3d body_rotation = data.X_base[body_id].E;
+  Vector3d body_position = data.X_base[body_id].r;
 
   return body_rotation * (point_base_coordinates - body_position);
 }
 
 RBDL_DLLAPI Matrix3d CalcBodyWorldOrientation(
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const unsigned int body_id,
     bool update_kinematics) {
   // update the Kinematics if necessary
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
   if (body_id >= model.fixed_body_discriminator) {
     unsigned int fbody_id = body_id - model.fixed_body_discriminator;
-    model.mFixedBodies[fbody_id].mBaseTransform = 
+    SpatialTransform base_transform =
       model.mFixedBodies[fbody_id].mParentTransform 
-      * model.X_base[model.mFixedBodies[fbody_id].mMovableParent];
+      * data.X_base[model.mFixedBodies[fbody_id].mMovableParent];
 
-    return model.mFixedBodies[fbody_id].mBaseTransform.E;
+    return base_transform.E;
   }
 
-  return model.X_base[body_id].E;
+  return data.X_base[body_id].E;
+}
+
+/*
+ * Ensures that the columns of data.S_base that belong to joint j hold the
+ * motion subspace of the joint in base coordinates. They are computed at
+ * most once after each evaluation of the joint (see jcalc()).
+ */
+static void UpdateBaseMotionSubspace (
+    const Model &model,
+    ModelData &data,
+    unsigned int j) {
+  if (data.S_base_valid[j]) {
+    return;
+  }
+
+  unsigned int q_index = model.mJoints[j].q_index;
+  SpatialTransform X_base_inv = data.X_base[j].inverse();
+
+  if (model.mJoints[j].mJointType != JointTypeCustom) {
+    if (model.mJoints[j].mDoFCount == 1) {
+      data.S_base.col(q_index) = X_base_inv.apply (data.S[j]);
+    } else if (model.mJoints[j].mDoFCount == 3) {
+      for (unsigned int k = 0; k < 3; k++) {
+        data.S_base.col(q_index + k) =
+          X_base_inv.apply (SpatialVector (data.multdof3_S[j].col(k)));
+      }
+    }
+  } else {
+    const CustomJoint *custom_joint =
+      model.mCustomJoints[model.mJoints[j].custom_joint_index];
+
+    for (unsigned int k = 0; k < custom_joint->mDoFCount; k++) {
+      data.S_base.col(q_index + k) =
+        X_base_inv.apply (SpatialVector (custom_joint->S.col(k)));
+    }
+  }
+
+  data.S_base_valid[j] = true;
+}
+
+/*
+ * Writes the point jacobian of the point at point_base (in base
+ * coordinates) that is attached to the movable body body_id into the rows
+ * row to row + 2 of G.
+ */
+static void GatherPointJacobian (
+    const Model &model,
+    ModelData &data,
+    unsigned int body_id,
+    const Vector3d &point_base,
+    MatrixNd &G,
+    unsigned int row) {
+  unsigned int j = body_id;
+
+  while (j != 0) {
+    UpdateBaseMotionSubspace (model, data, j);
+
+    unsigned int q_index = model.mJoints[j].q_index;
+
+    // linear velocity of the point for a unit velocity of the dof
+    for (unsigned int k = 0; k < model.mJoints[j].mDoFCount; k++) {
+      G.block<3,1>(row, q_index + k) =
+        data.S_base.block<3,1>(3, q_index + k)
+        - point_base.cross (
+            Vector3d (data.S_base.block<3,1>(0, q_index + k)));
+    }
+
+    j = model.lambda[j];
+  }
 }
 
 RBDL_DLLAPI void CalcPointJacobian (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     unsigned int body_id,
     const Vector3d &point_position,
@@ -256,16 +530,11 @@ RBDL_DLLAPI void CalcPointJacobian (
 
   // update the Kinematics if necessary
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
-  SpatialTransform point_trans = 
-    SpatialTransform (Matrix3d::Identity(), 
-        CalcBodyToBaseCoordinates ( model, 
-          Q, 
-          body_id,
-          point_position, 
-          false));
+  Vector3d point_base = CalcBodyToBaseCoordinates (model, data, Q, body_id,
+      point_position, false);
 
   assert (G.rows() == 3 && G.cols() == model.qdot_size );
 
@@ -276,41 +545,51 @@ RBDL_DLLAPI void CalcPointJacobian (
     reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
   }
 
-  unsigned int j = reference_body_id;
+  GatherPointJacobian (model, data, reference_body_id, point_base, G, 0);
+}
 
-  // e[j] is set to 1 if joint j contributes to the jacobian that we are
-  // computing. For all other joints the column will be zero.
-  while (j != 0) {
-    unsigned int q_index = model.mJoints[j].q_index;
+RBDL_DLLAPI void CalcPointJacobians (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    const std::vector<unsigned int> &body_ids,
+    const std::vector<Vector3d> &point_positions,
+    MatrixNd &G,
+    bool update_kinematics) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
 
-    if(model.mJoints[j].mJointType != JointTypeCustom){
-      if (model.mJoints[j].mDoFCount == 1) {
-        G.block(0,q_index, 3, 1) =
-          point_trans.apply(
-              model.X_base[j].inverse().apply(
-                model.S[j])).block(3,0,3,1);
-      } else if (model.mJoints[j].mDoFCount == 3) {
-        G.block(0, q_index, 3, 3) =
-          ((point_trans
-            * model.X_base[j].inverse()).toMatrix()
-           * model.multdof3_S[j]).block(3,0,3,3);
-      }
-    } else {
-      unsigned int k = model.mJoints[j].custom_joint_index;
+  if (body_ids.size() != point_positions.size()) {
+    throw Errors::RBDLSizeMismatchError(
+        "Error: number of body ids and point positions do not match!\n");
+  }
+
+  // update the Kinematics if necessary
+  if (update_kinematics) {
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
+  }
+
+  assert (G.rows() == 3 * body_ids.size() && G.cols() == model.qdot_size);
+
+  for (unsigned int i = 0; i < body_ids.size(); i++) {
+    Vector3d point_base = CalcBodyToBaseCoordinates (model, data, Q,
+        body_ids[i], point_positions[i], false);
 
-      G.block(0, q_index, 3, model.mCustomJoints[k]->mDoFCount) =
-        ((point_trans
-          * model.X_base[j].inverse()).toMatrix()
-         * model.mCustomJoints[k]->S).block( 
-           3,0,3,model.mCustomJoints[k]->mDoFCount);
+    unsigned int reference_body_id = body_ids[i];
+
+    if (model.IsFixedBodyId(reference_body_id)) {
+      unsigned int fbody_id = reference_body_id
+        - model.fixed_body_discriminator;
+      reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
     }
 
-    j = model.lambda[j];
+    GatherPointJacobian (model, data, reference_body_id, point_base, G,
+        3 * i);
   }
 }
 
 RBDL_DLLAPI void CalcPointJacobian6D (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     unsigned int body_id,
     const Vector3d &point_position,
@@ -320,16 +599,11 @@ RBDL_DLLAPI void CalcPointJacobian6D (
 
   // update the Kinematics if necessary
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
-  SpatialTransform point_trans =
-    SpatialTransform (Matrix3d::Identity(),
-        CalcBodyToBaseCoordinates (model,
-          Q,
-          body_id,
-          point_position,
-          false));
+  Vector3d point_base = CalcBodyToBaseCoordinates (model, data, Q, body_id,
+      point_position, false);
 
   assert (G.rows() == 6 && G.cols() == model.qdot_size );
 
@@ -343,28 +617,16 @@ RBDL_DLLAPI void CalcPointJacobian6D (
   unsigned int j = reference_body_id;
 
   while (j != 0) {
+    UpdateBaseMotionSubspace (model, data, j);
+
     unsigned int q_index = model.mJoints[j].q_index;
 
-    if(model.mJoints[j].mJointType != JointTypeCustom){
-      if (model.mJoints[j].mDoFCount == 1) {
-        G.block(0,q_index, 6, 1)
-          = point_trans.apply(
-              model.X_base[j].inverse().apply(
-                model.S[j])).block(0,0,6,1);
-      } else if (model.mJoints[j].mDoFCount == 3) {
-        G.block(0, q_index, 6, 3)
-          = ((point_trans
-                * model.X_base[j].inverse()).toMatrix()
-              * model.multdof3_S[j]).block(0,0,6,3);
-      }
-    } else {
-      unsigned int k = model.mJoints[j].custom_joint_index;
+    for (unsigned int k = 0; k < model.mJoints[j].mDoFCount; k++) {
+      Vector3d omega (data.S_base.block<3,1>(0, q_index + k));
 
-      G.block(0, q_index, 6, model.mCustomJoints[k]->mDoFCount)
-        = ((point_trans
-              * model.X_base[j].inverse()).toMatrix()
-            * model.mCustomJoints[k]->S).block(
-              0,0,6,model.mCustomJoints[k]->mDoFCount);
+      G.block<3,1>(0, q_index + k) = omega;
+      G.block<3,1>(3, q_index + k) =
+        data.S_base.block<3,1>(3, q_index + k) - point_base.cross (omega);
     }
 
     j = model.lambda[j];
@@ -372,7 +634,8 @@ RBDL_DLLAPI void CalcPointJacobian6D (
 }
 
 RBDL_DLLAPI void CalcBodySpatialJacobian (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     unsigned int body_id,
     MatrixNd &G,
@@ -381,7 +644,7 @@ RBDL_DLLAPI void CalcBodySpatialJacobian (
 
   // update the Kinematics if necessary
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, NULL, NULL);
+    UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
   }
 
   assert (G.rows() == 6 && G.cols() == model.qdot_size );
@@ -400,35 +663,21 @@ RBDL_DLLAPI void CalcBodySpatialJacobian (
 
     base_to_body = model.mFixedBodies[fbody_id]
       .mParentTransform
-      * model.X_base[reference_body_id];
+      * data.X_base[reference_body_id];
   } else {
-    base_to_body = model.X_base[reference_body_id];
+    base_to_body = data.X_base[reference_body_id];
   }
 
   unsigned int j = reference_body_id;
 
   while (j != 0) {
-    unsigned int q_index = model.mJoints[j].q_index;
+    UpdateBaseMotionSubspace (model, data, j);
 
-    if(model.mJoints[j].mJointType != JointTypeCustom){
-      if (model.mJoints[j].mDoFCount == 1) {
-        G.block(0,q_index,6,1) =
-          base_to_body.apply(
-              model.X_base[j]
-              .inverse()
-              .apply(model.S[j])
-              );
-      } else if (model.mJoints[j].mDoFCount == 3) {
-        G.block(0,q_index,6,3) =
-          (base_to_body * model.X_base[j].inverse()
-          ).toMatrix() * model.multdof3_S[j];
-      }
-    }else if(model.mJoints[j].mJointType == JointTypeCustom) {
-      unsigned int k = model.mJoints[j].custom_joint_index;
+    unsigned int q_index = model.mJoints[j].q_index;
 
-      G.block(0,q_index,6,model.mCustomJoints[k]->mDoFCount ) =
-        (base_to_body * model.X_base[j].inverse()
-        ).toMatrix() * model.mCustomJoints[k]->S;
+    for (unsigned int k = 0; k < model.mJoints[j].mDoFCount; k++) {
+      G.block<6,1>(0, q_index + k) = base_to_body.apply (
+          SpatialVector (data.S_base.col(q_index + k)));
     }
 
     j = model.lambda[j];
@@ -436,7 +685,8 @@ RBDL_DLLAPI void CalcBodySpatialJacobian (
 }
 
 RBDL_DLLAPI Vector3d CalcPointVelocity (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     unsigned int body_id,
@@ -448,11 +698,11 @@ RBDL_DLLAPI Vector3d CalcPointVelocity (
   assert (model.qdot_size == QDot.size());
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
+  data.v[0].setZero();
 
   // update the Kinematics with zero acceleration
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, &QDot, NULL);
+    UpdateKinematicsCustom (model, data, &Q, &QDot, NULL);
   }
 
   unsigned int reference_body_id = body_id;
@@ -462,15 +712,15 @@ RBDL_DLLAPI Vector3d CalcPointVelocity (
     unsigned int fbody_id = body_id - model.fixed_body_discriminator;
     reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
     Vector3d base_coords = 
-      CalcBodyToBaseCoordinates(model, Q, body_id, point_position, false);
+      CalcBodyToBaseCoordinates (model, data, Q, body_id, point_position, false);
     reference_point =
-      CalcBaseToBodyCoordinates(model, Q, reference_body_id, base_coords,false);
+      CalcBaseToBodyCoordinates (model, data, Q, reference_body_id, base_coords,false);
   }
 
   SpatialVector point_spatial_velocity = 
     SpatialTransform (
-        CalcBodyWorldOrientation (model, Q, reference_body_id, false).transpose(), 
-        reference_point).apply(model.v[reference_body_id]);
+        CalcBodyWorldOrientation (model, data, Q, reference_body_id, false).transpose(), 
+        reference_point).apply(data.v[reference_body_id]);
 
   return Vector3d (
       point_spatial_velocity[3],
@@ -480,7 +730,8 @@ RBDL_DLLAPI Vector3d CalcPointVelocity (
 }
 
 RBDL_DLLAPI Math::SpatialVector CalcPointVelocity6D(
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const Math::VectorNd &Q,
     const Math::VectorNd &QDot,
     unsigned int body_id,
@@ -492,11 +743,11 @@ RBDL_DLLAPI Math::SpatialVector CalcPointVelocity6D(
   assert (model.qdot_size == QDot.size());
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
+  data.v[0].setZero();
 
   // update the Kinematics with zero acceleration
   if (update_kinematics) {
-    UpdateKinematicsCustom (model, &Q, &QDot, NULL);
+    UpdateKinematicsCustom (model, data, &Q, &QDot, NULL);
   }
 
   unsigned int reference_body_id = body_id;
@@ -506,18 +757,19 @@ RBDL_DLLAPI Math::SpatialVector CalcPointVelocity6D(
     unsigned int fbody_id = body_id - model.fixed_body_discriminator;
     reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
     Vector3d base_coords = 
-      CalcBodyToBaseCoordinates(model, Q, body_id, point_position, false);
+      CalcBodyToBaseCoordinates (model, data, Q, body_id, point_position, false);
     reference_point = 
-      CalcBaseToBodyCoordinates(model, Q, reference_body_id, base_coords,false);
+      CalcBaseToBodyCoordinates (model, data, Q, reference_body_id, base_coords,false);
   }
 
   return SpatialTransform (
-      CalcBodyWorldOrientation (model, Q, reference_body_id, false).transpose(), 
-      reference_point).apply(model.v[reference_body_id]);
+      CalcBodyWorldOrientation (model, data, Q, reference_body_id, false).transpose(), 
+      reference_point).apply(data.v[reference_body_id]);
 }
 
 RBDL_DLLAPI Vector3d CalcPointAcceleration (
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &QDDot,
@@ -527,11 +779,11 @@ RBDL_DLLAPI Vector3d CalcPointAcceleration (
   LOG << "-------- " << __func__ << " --------" << std::endl;
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
-  model.a[0].setZero();
+  data.v[0].setZero();
+  data.a[0].setZero();
 
   if (update_kinematics)
-    UpdateKinematics (model, Q, QDot, QDDot);
+    UpdateKinematics (model, data, Q, QDot, QDDot);
 
   LOG << std::endl;
 
@@ -542,19 +794,19 @@ RBDL_DLLAPI Vector3d CalcPointAcceleration (
     unsigned int fbody_id = body_id - model.fixed_body_discriminator;
     reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
     Vector3d base_coords = 
-      CalcBodyToBaseCoordinates (model, Q, body_id, point_position, false);
+      CalcBodyToBaseCoordinates (model, data, Q, body_id, point_position, false);
     reference_point = 
-      CalcBaseToBodyCoordinates (model, Q, reference_body_id,base_coords,false);
+      CalcBaseToBodyCoordinates (model, data, Q, reference_body_id,base_coords,false);
   }
 
   SpatialTransform p_X_i (
-      CalcBodyWorldOrientation (model, Q, reference_body_id, false).transpose(),
+      CalcBodyWorldOrientation (model, data, Q, reference_body_id, false).transpose(),
       reference_point);
 
-  SpatialVector p_v_i = p_X_i.apply(model.v[reference_body_id]);
+  SpatialVector p_v_i = p_X_i.apply(data.v[reference_body_id]);
   Vector3d a_dash = Vector3d (p_v_i[0], p_v_i[1], p_v_i[2]
       ).cross(Vector3d (p_v_i[3], p_v_i[4], p_v_i[5]));
-  SpatialVector p_a_i = p_X_i.apply(model.a[reference_body_id]);
+  SpatialVector p_a_i = p_X_i.apply(data.a[reference_body_id]);
 
   return Vector3d (
       p_a_i[3] + a_dash[0],
@@ -564,7 +816,8 @@ RBDL_DLLAPI Vector3d CalcPointAcceleration (
 }
 
 RBDL_DLLAPI SpatialVector CalcPointAcceleration6D(
-    Model &model,
+    const Model &model,
+    ModelData &data,
     const VectorNd &Q,
     const VectorNd &QDot,
     const VectorNd &QDDot,
@@ -574,11 +827,11 @@ RBDL_DLLAPI SpatialVector CalcPointAcceleration6D(
   LOG << "-------- " << __func__ << " --------" << std::endl;
 
   // Reset the velocity of the root body
-  model.v[0].setZero();
-  model.a[0].setZero();
+  data.v[0].setZero();
+  data.a[0].setZero();
 
   if (update_kinematics)
-    UpdateKinematics (model, Q, QDot, QDDot);
+    UpdateKinematics (model, data, Q, QDot, QDDot);
 
   LOG << std::endl;
 
@@ -589,22 +842,186 @@ RBDL_DLLAPI SpatialVector CalcPointAcceleration6D(
     unsigned int fbody_id = body_id - model.fixed_body_discriminator;
     reference_body_id = model.mFixedBodies[fbody_id].mMovableParent;
     Vector3d base_coords = 
-      CalcBodyToBaseCoordinates (model, Q, body_id, point_position, false);
+      CalcBodyToBaseCoordinates (model, data, Q, body_id, point_position, false);
     reference_point = 
-      CalcBaseToBodyCoordinates (model, Q, reference_body_id,base_coords,false);
+      CalcBaseToBodyCoordinates (model, data, Q, reference_body_id,base_coords,false);
   }
 
   SpatialTransform p_X_i (
-      CalcBodyWorldOrientation (model, Q, reference_body_id, false).transpose(),
+      CalcBodyWorldOrientation (model, data, Q, reference_body_id, false).transpose(),
       reference_point);
 
-  SpatialVector p_v_i = p_X_i.apply(model.v[reference_body_id]);
+  SpatialVector p_v_i = p_X_i.apply(data.v[reference_body_id]);
   Vector3d a_dash = Vector3d (p_v_i[0], p_v_i[1], p_v_i[2]
       ).cross(Vector3d (p_v_i[3], p_v_i[4], p_v_i[5]));
-  return (p_X_i.apply(model.a[reference_body_id]) 
+  return (p_X_i.apply(data.a[reference_body_id]) 
       + SpatialVector (0, 0, 0, a_dash[0], a_dash[1], a_dash[2]));
 }
 
+RBDL_DLLAPI void UpdateKinematics(
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot) {
+  UpdateKinematics (model, model, Q, QDot, QDDot);
+}
+
+RBDL_DLLAPI void UpdateKinematicsCustom(
+    Model &model,
+    const VectorNd *Q,
+    const VectorNd *QDot,
+    const VectorNd *QDDot) {
+  UpdateKinematicsCustom (model, model, Q, QDot, QDDot);
+}
+
+RBDL_DLLAPI void UpdateKinematicsCached(
+    Model &model,
+    const VectorNd *Q,
+    const VectorNd *QDot,
+    const VectorNd *QDDot) {
+  UpdateKinematicsCached (model, model, Q, QDot, QDDot);
+}
+
+RBDL_DLLAPI void UpdateKinematicsChain(
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id) {
+  UpdateKinematicsChain (model, model, Q, body_id);
+}
+
+RBDL_DLLAPI void UpdateKinematicsChain(
+    Model &model,
+    const VectorNd &Q,
+    const std::vector<unsigned int> &body_ids) {
+  UpdateKinematicsChain (model, model, Q, body_ids);
+}
+
+RBDL_DLLAPI Vector3d CalcBodyToBaseCoordinates (
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id,
+    const Vector3d &point_body_coordinates,
+    bool update_kinematics) {
+  return CalcBodyToBaseCoordinates (model, model, Q, body_id,
+      point_body_coordinates, update_kinematics);
+}
+
+RBDL_DLLAPI Vector3d CalcBaseToBodyCoordinates (
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id,
+    const Vector3d &point_base_coordinates,
+    bool update_kinematics) {
+  return CalcBaseToBodyCoordinates (model, model, Q, body_id,
+      point_base_coordinates, update_kinematics);
+}
+
+RBDL_DLLAPI Matrix3d CalcBodyWorldOrientation(
+    Model &model,
+    const VectorNd &Q,
+    const unsigned int body_id,
+    bool update_kinematics) {
+  Matrix3d orientation = CalcBodyWorldOrientation (model, model, Q, body_id,
+      update_kinematics);
+
+  if (body_id >= model.fixed_body_discriminator) {
+    unsigned int fbody_id = body_id - model.fixed_body_discriminator;
+    model.mFixedBodies[fbody_id].mBaseTransform =
+      model.mFixedBodies[fbody_id].mParentTransform
+      * model.X_base[model.mFixedBodies[fbody_id].mMovableParent];
+  }
+
+  return orientation;
+}
+
+RBDL_DLLAPI void CalcPointJacobian (
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id,
+    const Vector3d &point_position,
+    MatrixNd &G,
+    bool update_kinematics) {
+  CalcPointJacobian (model, model, Q, body_id, point_position, G,
+      update_kinematics);
+}
+
+RBDL_DLLAPI void CalcPointJacobians (
+    Model &model,
+    const VectorNd &Q,
+    const std::vector<unsigned int> &body_ids,
+    const std::vector<Vector3d> &point_positions,
+    MatrixNd &G,
+    bool update_kinematics) {
+  CalcPointJacobians (model, model, Q, body_ids, point_positions, G,
+      update_kinematics);
+}
+
+RBDL_DLLAPI void CalcPointJacobian6D (
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id,
+    const Vector3d &point_position,
+    MatrixNd &G,
+    bool update_kinematics) {
+  CalcPointJacobian6D (model, model, Q, body_id, point_position, G,
+      update_kinematics);
+}
+
+RBDL_DLLAPI void CalcBodySpatialJacobian (
+    Model &model,
+    const VectorNd &Q,
+    unsigned int body_id,
+    MatrixNd &G,
+    bool update_kinematics) {
+  CalcBodySpatialJacobian (model, model, Q, body_id, G, update_kinematics);
+}
+
+RBDL_DLLAPI Vector3d CalcPointVelocity (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    unsigned int body_id,
+    const Vector3d &point_position,
+    bool update_kinematics) {
+  return CalcPointVelocity (model, model, Q, QDot, body_id, point_position,
+      update_kinematics);
+}
+
+RBDL_DLLAPI Math::SpatialVector CalcPointVelocity6D(
+    Model &model,
+    const Math::VectorNd &Q,
+    const Math::VectorNd &QDot,
+    unsigned int body_id,
+    const Math::Vector3d &point_position,
+    bool update_kinematics) {
+  return CalcPointVelocity6D (model, model, Q, QDot, body_id, point_position,
+      update_kinematics);
+}
+
+RBDL_DLLAPI Vector3d CalcPointAcceleration (
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot,
+    unsigned int body_id,
+    const Vector3d &point_position,
+    bool update_kinematics) {
+  return CalcPointAcceleration (model, model, Q, QDot, QDDot, body_id,
+      point_position, update_kinematics);
+}
+
+RBDL_DLLAPI SpatialVector CalcPointAcceleration6D(
+    Model &model,
+    const VectorNd &Q,
+    const VectorNd &QDot,
+    const VectorNd &QDDot,
+    unsigned int body_id,
+    const Vector3d &point_position,
+    bool update_kinematics) {
+  return CalcPointAcceleration6D (model, model, Q, QDot, QDDot, body_id,
+      point_position, update_kinematics);
+}
+
 RBDL_DLLAPI bool InverseKinematics (
     Model &model,
     const VectorNd &Qinit,
@@ -726,6 +1143,9 @@ InverseKinematicsConstraintSet::InverseKinematicsConstraintSet() {
   step_tol = 1e-12;
   constraint_tol = 1e-12;
   num_constraints = 0;
+  error_norm = 0.;
+  delta_q_norm = 0.;
+  damping = 0.;
 }
 
 RBDL_DLLAPI
@@ -1002,5 +1422,334 @@ bool InverseKinematics (
   return false;
 }
 
+/** Center of mass of all bodies. Requires updated kinematics in data. */
+static Vector3d CalcIKCenterOfMass (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q) {
+  double mass = 0.;
+  Vector3d com (Vector3d::Zero());
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    double body_mass = model.mBodies[i].mMass;
+    if (body_mass == 0.) {
+      continue;
+    }
+
+    com += body_mass * CalcBodyToBaseCoordinates (model, data, Q, i,
+        model.mBodies[i].mCenterOfMass, false);
+    mass += body_mass;
+  }
+
+  if (mass > 0.) {
+    com /= mass;
+  }
+
+  return com;
 }
 
+/** Evaluates the weighted residual e and, if J is not NULL, the weighted
+ * Jacobian of all constraints of CS in the same way as
+ * InverseKinematics(). */
+static void CalcIKResidual (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Q,
+    InverseKinematicsConstraintSet &CS,
+    VectorNd &e,
+    MatrixNd *J) {
+  UpdateKinematicsCustom (model, data, &Q, NULL, NULL);
+
+  for (unsigned int k = 0; k < CS.body_ids.size(); k++) {
+    InverseKinematicsConstraintSet::ConstraintType type =
+      CS.constraint_type[k];
+    unsigned int body_id = CS.body_ids[k];
+    unsigned int row = CS.constraint_row_index[k];
+    double weight = CS.constraint_weight[k];
+
+    Vector3d point_base;
+    Vector3d body_point;
+    if (type == InverseKinematicsConstraintSet::ConstraintTypePositionCoMXY) {
+      point_base = CalcIKCenterOfMass (model, data, Q);
+      body_point = CalcBaseToBodyCoordinates (model, data, Q, body_id,
+          point_base, false);
+    } else {
+      body_point = CS.body_points[k];
+      point_base = CalcBodyToBaseCoordinates (model, data, Q, body_id,
+          body_point, false);
+    }
+    Vector3d position_error = CS.target_positions[k] - point_base;
+
+    Vector3d orientation_error (Vector3d::Zero());
+    if (type == InverseKinematicsConstraintSet::ConstraintTypeOrientation
+        || type == InverseKinematicsConstraintSet::ConstraintTypeFull) {
+      Matrix3d R = CalcBodyWorldOrientation (model, data, Q, body_id, false);
+      orientation_error = R.transpose() * CalcAngularVelocityfromMatrix (
+          R * CS.target_orientations[k].transpose());
+    }
+
+    if (J) {
+      CS.G.setZero();
+      CalcPointJacobian6D (model, data, Q, body_id, body_point, CS.G, false);
+    }
+
+    switch (type) {
+      case InverseKinematicsConstraintSet::ConstraintTypeFull:
+        e.segment<3>(row) = weight * orientation_error;
+        e.segment<3>(row + 3) = weight * position_error;
+        if (J) {
+          J->middleRows (row, 6) = weight * CS.G;
+        }
+        break;
+      case InverseKinematicsConstraintSet::ConstraintTypeOrientation:
+        e.segment<3>(row) = weight * orientation_error;
+        if (J) {
+          J->middleRows (row, 3) = weight * CS.G.topRows (3);
+        }
+        break;
+      case InverseKinematicsConstraintSet::ConstraintTypePosition:
+        e.segment<3>(row) = weight * position_error;
+        if (J) {
+          J->middleRows (row, 3) = weight * CS.G.bottomRows (3);
+        }
+        break;
+      case InverseKinematicsConstraintSet::ConstraintTypePositionXY:
+      case InverseKinematicsConstraintSet::ConstraintTypePositionCoMXY:
+        e.segment<2>(row) = weight * position_error.head<2>();
+        if (J) {
+          J->middleRows (row, 2) = weight * CS.G.middleRows (3, 2);
+        }
+        break;
+      case InverseKinematicsConstraintSet::ConstraintTypePositionZ:
+        e[row] = weight * position_error[2];
+        if (J) {
+          J->row (row) = weight * CS.G.row (5);
+        }
+        break;
+      default:
+        assert (false && !"Invalid inverse kinematics constraint");
+    }
+  }
+}
+
+/** Computes Qout = Qin + delta_q where the quaternions of spherical joints
+ * are rotated and normalized instead. */
+static void IntegrateIKStep (
+    const Model &model,
+    const VectorNd &Qin,
+    const VectorNd &delta_q,
+    VectorNd &Qout) {
+  if (model.q_size == model.qdot_size) {
+    Qout = Qin + delta_q;
+    return;
+  }
+
+  Qout = Qin;
+  for (unsigned int i = 1; i < model.mJoints.size(); i++) {
+    unsigned int q_index = model.mJoints[i].q_index;
+
+    if (model.mJoints[i].mJointType == JointTypeSpherical) {
+      Quaternion quat = model.GetQuaternion (i, Qin);
+      Vector3d omega = delta_q.segment<3>(q_index);
+      quat += quat.omegaToQDot (omega);
+      quat /= quat.norm();
+      model.SetQuaternion (i, quat, Qout);
+    } else {
+      for (unsigned int j = 0; j < model.mJoints[i].mDoFCount; j++) {
+        Qout[q_index + j] += delta_q[q_index + j];
+      }
+    }
+  }
+}
+
+RBDL_DLLAPI
+bool InverseKinematicsLM (
+    const Model &model,
+    ModelData &data,
+    const VectorNd &Qinit,
+    InverseKinematicsConstraintSet &CS,
+    VectorNd &Qres) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  assert (Qinit.size() == model.q_size);
+  assert (Qres.size() == Qinit.size());
+
+  unsigned int nc = CS.num_constraints;
+  unsigned int n = model.qdot_size;
+
+  // InverseKinematics() shares J, G, and e, so each buffer is checked
+  // separately
+  if (CS.J.rows() != nc || CS.J.cols() != n) {
+    CS.J.resize (nc, n);
+  }
+  if (CS.J_trial.rows() != nc || CS.J_trial.cols() != n) {
+    CS.J_trial.resize (nc, n);
+  }
+  if (CS.e.size() != nc) {
+    CS.e.resize (nc);
+  }
+  if (CS.e_trial.size() != nc) {
+    CS.e_trial.resize (nc);
+  }
+  if (CS.G.rows() != 6 || CS.G.cols() != n) {
+    CS.G.resize (6, n);
+  }
+  if (CS.JTJ.rows() != n) {
+    CS.JTJ.resize (n, n);
+    CS.JTe.resize (n);
+    CS.delta_q.resize (n);
+    CS.JTJ_llt = Eigen::LLT<MatrixNd> (n);
+  }
+  if (CS.Q_trial.size() != model.q_size) {
+    CS.Q_trial.resize (model.q_size);
+  }
+
+  Qres = Qinit;
+  CalcIKResidual (model, data, Qres, CS, CS.e, &CS.J);
+  double cost = 0.5 * CS.e.squaredNorm();
+  CS.error_norm = CS.e.norm();
+  CS.delta_q_norm = 0.;
+
+  // factor by which the damping grows after a rejected step
+  double nu = 2.;
+
+  for (CS.num_steps = 0; CS.num_steps < CS.max_steps; CS.num_steps++) {
+    if (CS.error_norm < CS.constraint_tol) {
+      LOG << "Reached target close enough after " << CS.num_steps
+        << " steps" << std::endl;
+      return true;
+    }
+
+    CS.JTJ.setZero();
+    CS.JTJ.selfadjointView<Eigen::Lower>().rankUpdate (CS.J.transpose());
+    CS.JTe.noalias() = CS.J.transpose() * CS.e;
+
+    // the initial damping follows the weighting of InverseKinematics(): it
+    // is large far away from the solution and vanishes close to it
+    if (CS.num_steps == 0) {
+      double max_gradient = CS.JTe.cwiseAbs().maxCoeff();
+      CS.damping = 0.5 * max_gradient * max_gradient;
+    }
+    CS.damping = std::max (CS.damping, CS.lambda);
+
+    CS.JTJ.diagonal().array() += CS.damping;
+    CS.JTJ_llt.compute (CS.JTJ);
+    if (CS.JTJ_llt.info() != Eigen::Success) {
+      CS.damping *= nu;
+      nu *= 2.;
+      continue;
+    }
+
+    CS.delta_q = CS.JTe;
+    CS.JTJ_llt.solveInPlace (CS.delta_q);
+
+    IntegrateIKStep (model, Qres, CS.delta_q, CS.Q_trial);
+    CalcIKResidual (model, data, CS.Q_trial, CS, CS.e_trial, &CS.J_trial);
+    double cost_trial = 0.5 * CS.e_trial.squaredNorm();
+
+    // decrease of the cost that is predicted by the linearization
+    double predicted = 0.5 * CS.delta_q.dot (CS.damping * CS.delta_q
+        + CS.JTe);
+
+    if (cost_trial < cost && predicted > 0.) {
+      double rho_term = 2. * (cost - cost_trial) / predicted - 1.;
+
+      Qres = CS.Q_trial;
+      CS.e.swap (CS.e_trial);
+      CS.J.swap (CS.J_trial);
+      cost = cost_trial;
+      CS.error_norm = CS.e.norm();
+      CS.delta_q_norm = CS.delta_q.norm();
+
+      CS.damping *= std::max (1.0e-2, 1. - rho_term * rho_term * rho_term);
+      nu = 2.;
+
+      if (CS.delta_q_norm < CS.step_tol) {
+        LOG << "reached convergence after " << CS.num_steps << " steps"
+          << std::endl;
+        return true;
+      }
+    } else {
+      CS.damping *= nu;
+      nu *= 2.;
+    }
+  }
+
+  return CS.error_norm < CS.constraint_tol;
+}
+
+RBDL_DLLAPI
+bool InverseKinematicsLM (
+    Model &model,
+    const VectorNd &Qinit,
+    InverseKinematicsConstraintSet &CS,
+    VectorNd &Qres) {
+  return InverseKinematicsLM (model, model, Qinit, CS, Qres);
+}
+
+RBDL_DLLAPI
+unsigned int InverseKinematicsTrajectory (
+    const Model &model,
+    const VectorNd &Qinit,
+    const InverseKinematicsConstraintSet &CS,
+    const MatrixNd &TargetPositions,
+    MatrixNd &Qs,
+    unsigned int num_threads,
+    VectorNd *error_norms) {
+  LOG << "-------- " << __func__ << " --------" << std::endl;
+
+  unsigned int num_frames = TargetPositions.cols();
+
+  if (Qinit.size() != model.q_size
+      || TargetPositions.rows() != 3 * CS.body_ids.size()) {
+    std::ostringstream errormsg;
+    errormsg << "Error: " << __func__ << ": Qinit has size " << Qinit.size()
+      << " (expected " << model.q_size << ") and TargetPositions has "
+      << TargetPositions.rows() << " rows (expected "
+      << 3 * CS.body_ids.size() << ")!" << std::endl;
+    throw Errors::RBDLSizeMismatchError(errormsg.str());
+  }
+
+  if (Qs.rows() != model.q_size || Qs.cols() != num_frames) {
+    Qs.resize (model.q_size, num_frames);
+  }
+  if (error_norms && error_norms->size() != num_frames) {
+    error_norms->resize (num_frames);
+  }
+
+  std::vector<unsigned int> num_solved (ResolveThreadCount (num_threads), 0);
+
+  ParallelFor (num_frames, num_threads,
+      [&] (unsigned int thread_index, unsigned int begin, unsigned int end) {
+    ModelData data (model);
+    InverseKinematicsConstraintSet cs (CS);
+    VectorNd Q (Qinit);
+    VectorNd Qres (Qinit);
+
+    for (unsigned int f = begin; f < end; f++) {
+      for (unsigned int k = 0; k < cs.body_ids.size(); k++) {
+        cs.target_positions[k] = TargetPositions.block<3,1>(3 * k, f);
+      }
+
+      if (InverseKinematicsLM (model, data, Q, cs, Qres)) {
+        num_solved[thread_index]++;
+      }
+
+      Qs.col(f) = Qres;
+      if (error_norms) {
+        (*error_norms)[f] = cs.error_norm;
+      }
+
+      Q = Qres;
+    }
+  });
+
+  unsigned int result = 0;
+  for (unsigned int t = 0; t < num_solved.size(); t++) {
+    result += num_solved[t];
+  }
+
+  return result;
+}
+
+}
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <limits>
+#include <algorithm>
 #include <assert.h>
 
 #include "rbdl/rbdl_mathutils.h"
@@ -45,6 +46,7 @@ Model::Model()
 
   // Joints
   mJoints.push_back(root_joint);
+  mJointCalcDispatch.push_back (jcalc_dispatch (root_joint));
   S.push_back (zero_spatial);
   X_T.push_back(SpatialTransform());
 
@@ -62,6 +64,7 @@ Model::Model()
   // Dynamic variables
   c.push_back(zero_spatial);
   IA.push_back(SpatialMatrix::Identity());
+  IA_packed.push_back(SpatialArticulatedInertia());
   pA.push_back(zero_spatial);
   U.push_back(zero_spatial);
 
@@ -80,11 +83,24 @@ Model::Model()
   // Bodies
   X_lambda.push_back(SpatialTransform());
   X_base.push_back(SpatialTransform());
+  S_base_valid.push_back(false);
+
+  // The root never moves, so its kinematics are always up to date
+  kinematics_cache_state.push_back(7);
+  kinematics_cache_updated.push_back(0);
 
   mBodies.push_back(root_body);
   mBodyNameMap["ROOT"] = 0;
 
   fixed_body_discriminator = std::numeric_limits<unsigned int>::max() / 2;
+  finalized = false;
+}
+
+ModelData::ModelData (const Model &model)
+{
+  // The model holds its own data that is always consistent with the
+  // current topology, so we simply copy it.
+  *this = static_cast<const ModelData&>(model);
 }
 
 unsigned int AddBodyFixedJoint (
@@ -264,6 +280,13 @@ unsigned int Model::AddBody(
   assert (lambda.size() > 0);
   assert (joint.mJointType != JointTypeUndefined);
 
+  if (finalized) {
+    std::ostringstream errormsg;
+    errormsg << "Error: cannot add body '" << body_name
+             << "' as the model was already finalized!" << std::endl;
+    throw Errors::RBDLError(errormsg.str());
+  }
+
   if (joint.mJointType == JointTypeFixed) {
     previously_added_body_id = AddBodyFixedJoint (*this,
                                parent_id,
@@ -310,19 +333,23 @@ unsigned int Model::AddBody(
 
   // structural information
   lambda.push_back(movable_parent_id);
-  unsigned int lambda_q_last = mJoints[mJoints.size() - 1].q_index;
-
-  if (mJoints[mJoints.size() - 1].mDoFCount > 0
-      && mJoints[mJoints.size() - 1].mJointType != JointTypeCustom) {
-    lambda_q_last = lambda_q_last + mJoints[mJoints.size() - 1].mDoFCount;
-  } else if (mJoints[mJoints.size() - 1].mJointType == JointTypeCustom) {
-    unsigned int custom_index = mJoints[mJoints.size() - 1].custom_joint_index;
-    lambda_q_last = lambda_q_last
-                    + mCustomJoints[mCustomJoints.size() - 1]->mDoFCount;
+
+  // The first degree of freedom of the joint depends on the last degree of
+  // freedom of the movable parent, all others on their predecessor within
+  // the joint. Degrees of freedom on different branches therefore never
+  // depend on each other (branch-induced sparsity).
+  unsigned int lambda_q_parent = 0;
+  if (movable_parent_id != 0) {
+    lambda_q_parent = mJoints[movable_parent_id].q_index
+                      + mJoints[movable_parent_id].mDoFCount;
   }
 
   for (unsigned int i = 0; i < joint.mDoFCount; i++) {
-    lambda_q.push_back(lambda_q_last + i);
+    if (i == 0) {
+      lambda_q.push_back(lambda_q_parent);
+    } else {
+      lambda_q.push_back(qdot_size + i);
+    }
   }
   mu.push_back(std::vector<unsigned int>());
   mu.at(movable_parent_id).push_back(mBodies.size());
@@ -330,8 +357,16 @@ unsigned int Model::AddBody(
   // Bodies
   X_lambda.push_back(SpatialTransform());
   X_base.push_back(SpatialTransform());
+  S_base_valid.push_back(false);
   mBodies.push_back(body);
 
+  // the indices of the quaternion w components change, so the cached
+  // values of all bodies become meaningless
+  std::fill (kinematics_cache_state.begin() + 1, kinematics_cache_state.end(),
+      0);
+  kinematics_cache_state.push_back(0);
+  kinematics_cache_updated.push_back(0);
+
   if (body_name.size() != 0) {
     if (mBodyNameMap.find(body_name) != mBodyNameMap.end()) {
       std::ostringstream errormsg;
@@ -361,6 +396,7 @@ unsigned int Model::AddBody(
   }
 
   S.push_back (joint.mJointAxes[0]);
+  mJointCalcDispatch.push_back (jcalc_dispatch (joint));
 
   // Joint state variables
   X_J.push_back (SpatialTransform());
@@ -392,6 +428,12 @@ unsigned int Model::AddBody(
 
   qdot_size = qdot_size + joint.mDoFCount;
 
+  qdot_zero = VectorNd::Zero (q_size);
+  S_base = MatrixNd::Zero (6, qdot_size);
+  kinematics_cache_q = VectorNd::Zero (q_size);
+  kinematics_cache_qdot = VectorNd::Zero (qdot_size);
+  kinematics_cache_qddot = VectorNd::Zero (qdot_size);
+
   // we have to invert the transformation as it is later always used from the
   // child bodies perspective.
   X_T.push_back(joint_frame * movable_parent_transform);
@@ -399,6 +441,7 @@ unsigned int Model::AddBody(
   // Dynamic variables
   c.push_back(SpatialVector(0., 0., 0., 0., 0., 0.));
   IA.push_back(SpatialMatrix::Zero(6,6));
+  IA_packed.push_back(SpatialArticulatedInertia());
   pA.push_back(SpatialVector(0., 0., 0., 0., 0., 0.));
   U.push_back(SpatialVector(0., 0., 0., 0., 0., 0.));
 
@@ -464,6 +507,68 @@ unsigned int Model::AddBody(
   return previously_added_body_id;
 }
 
+/** Replaces the buffer of the vector by one that has exactly the size of
+ * its content. Unlike std::vector::shrink_to_fit() this is guaranteed to
+ * reallocate. */
+template <typename T>
+static void ReallocateExact (T &container)
+{
+  T (container.begin(), container.end()).swap (container);
+}
+
+void Model::Finalize()
+{
+  if (finalized) {
+    return;
+  }
+
+  for (unsigned int i = 1; i < lambda.size(); i++) {
+    assert (lambda[i] < i);
+  }
+
+  // ModelData in the order in which ForwardDynamics() accesses it
+  ReallocateExact (X_J);
+  ReallocateExact (v_J);
+  ReallocateExact (c_J);
+  ReallocateExact (S);
+  ReallocateExact (multdof3_S);
+  ReallocateExact (X_lambda);
+  ReallocateExact (X_base);
+  ReallocateExact (v);
+  ReallocateExact (c);
+  ReallocateExact (IA);
+  ReallocateExact (IA_packed);
+  ReallocateExact (pA);
+  ReallocateExact (U);
+  ReallocateExact (multdof3_U);
+  ReallocateExact (multdof3_Dinv);
+  ReallocateExact (multdof3_u);
+  ReallocateExact (a);
+  ReallocateExact (f);
+  ReallocateExact (Ic);
+  ReallocateExact (hc);
+  ReallocateExact (hdotc);
+  ReallocateExact (S_base_valid);
+  ReallocateExact (kinematics_cache_state);
+  ReallocateExact (kinematics_cache_updated);
+
+  // Structural information
+  ReallocateExact (lambda);
+  ReallocateExact (lambda_q);
+  ReallocateExact (mu);
+  ReallocateExact (mJoints);
+  ReallocateExact (mJointUpdateOrder);
+  ReallocateExact (mJointCalcDispatch);
+  ReallocateExact (X_T);
+  ReallocateExact (multdof3_w_index);
+  ReallocateExact (I);
+  ReallocateExact (mBodies);
+  ReallocateExact (mFixedBodies);
+  ReallocateExact (mCustomJoints);
+
+  finalized = true;
+}
+
 unsigned int Model::AppendBody (
   const Math::SpatialTransform &joint_frame,
   const Joint &joint,
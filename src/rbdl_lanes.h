@@ -0,0 +1,294 @@
+/*
+ * RBDL - Rigid Body Dynamics Library
+ * Copyright (c) 2011-2018 Martin Felis <martin@fysx.org>
+ *
+ * Licensed under the zlib license. See LICENSE for more details.
+ */
+
+#ifndef RBDL_LANES_H
+#define RBDL_LANES_H
+
+#include "rbdl/rbdl_math.h"
+
+/** \brief Number of states that are evaluated in lockstep
+ *
+ * Each lane holds the value of one state. When compiled with AVX-512
+ * support 8 states are processed per instruction, otherwise 4 (which maps
+ * onto a single AVX register or two SSE registers).
+ */
+#ifndef RBDL_SIMD_LANES
+#  ifdef __AVX512F__
+#    define RBDL_SIMD_LANES 8
+#  else
+#    define RBDL_SIMD_LANES 4
+#  endif
+#endif
+
+namespace RigidBodyDynamics {
+
+namespace Math {
+
+/** \brief A scalar value for each of the RBDL_SIMD_LANES states */
+typedef Eigen::Array<double, RBDL_SIMD_LANES, 1> LaneScalar;
+
+/** \brief Structure-of-arrays layout of a SpatialVector
+ *
+ * Component i of the spatial vector of all lanes is stored contiguously in
+ * x[i] such that all operations act on full SIMD registers.
+ */
+struct SpatialVectorLanes {
+  LaneScalar x[6];
+
+  void setZero () {
+    for (unsigned int i = 0; i < 6; i++) {
+      x[i].setZero();
+    }
+  }
+
+  void setConstant (const SpatialVector &v) {
+    for (unsigned int i = 0; i < 6; i++) {
+      x[i].setConstant (v[i]);
+    }
+  }
+
+  void operator+= (const SpatialVectorLanes &v) {
+    for (unsigned int i = 0; i < 6; i++) {
+      x[i] += v.x[i];
+    }
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** \brief Structure-of-arrays layout of a SpatialTransform
+ *
+ * The rotation is stored row-major, i.e. E[3 * row + col].
+ */
+struct SpatialTransformLanes {
+  LaneScalar E[9];
+  LaneScalar r[3];
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/** \brief Structure-of-arrays layout of a SpatialMatrix (row-major)
+ */
+struct SpatialMatrixLanes {
+  LaneScalar M[36];
+
+  void setConstant (const SpatialMatrix &m) {
+    for (unsigned int row = 0; row < 6; row++) {
+      for (unsigned int col = 0; col < 6; col++) {
+        M[row * 6 + col].setConstant (m(row, col));
+      }
+    }
+  }
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+typedef std::vector<LaneScalar, Eigen::aligned_allocator<LaneScalar> >
+  LaneScalarVector;
+typedef std::vector<SpatialVectorLanes,
+        Eigen::aligned_allocator<SpatialVectorLanes> > SpatialVectorLanesVector;
+typedef std::vector<SpatialTransformLanes,
+        Eigen::aligned_allocator<SpatialTransformLanes> >
+          SpatialTransformLanesVector;
+typedef std::vector<SpatialMatrixLanes,
+        Eigen::aligned_allocator<SpatialMatrixLanes> > SpatialMatrixLanesVector;
+
+/** \brief Same as SpatialTransform::apply() for all lanes */
+inline SpatialVectorLanes LanesApply (
+    const SpatialTransformLanes &X,
+    const SpatialVectorLanes &v) {
+  const LaneScalar *E = X.E;
+  const LaneScalar *r = X.r;
+  const LaneScalar *w = v.x;
+
+  LaneScalar v_rxw0 = w[3] - r[1] * w[2] + r[2] * w[1];
+  LaneScalar v_rxw1 = w[4] - r[2] * w[0] + r[0] * w[2];
+  LaneScalar v_rxw2 = w[5] - r[0] * w[1] + r[1] * w[0];
+
+  SpatialVectorLanes result;
+  result.x[0] = E[0] * w[0] + E[1] * w[1] + E[2] * w[2];
+  result.x[1] = E[3] * w[0] + E[4] * w[1] + E[5] * w[2];
+  result.x[2] = E[6] * w[0] + E[7] * w[1] + E[8] * w[2];
+  result.x[3] = E[0] * v_rxw0 + E[1] * v_rxw1 + E[2] * v_rxw2;
+  result.x[4] = E[3] * v_rxw0 + E[4] * v_rxw1 + E[5] * v_rxw2;
+  result.x[5] = E[6] * v_rxw0 + E[7] * v_rxw1 + E[8] * v_rxw2;
+
+  return result;
+}
+
+/** \brief Same as SpatialTransform::applyTranspose() for all lanes */
+inline SpatialVectorLanes LanesApplyTranspose (
+    const SpatialTransformLanes &X,
+    const SpatialVectorLanes &f) {
+  const LaneScalar *E = X.E;
+  const LaneScalar *r = X.r;
+  const LaneScalar *n = f.x;
+
+  LaneScalar E_T_f0 = E[0] * n[3] + E[3] * n[4] + E[6] * n[5];
+  LaneScalar E_T_f1 = E[1] * n[3] + E[4] * n[4] + E[7] * n[5];
+  LaneScalar E_T_f2 = E[2] * n[3] + E[5] * n[4] + E[8] * n[5];
+
+  SpatialVectorLanes result;
+  result.x[0] = E[0] * n[0] + E[3] * n[1] + E[6] * n[2]
+    - r[2] * E_T_f1 + r[1] * E_T_f2;
+  result.x[1] = E[1] * n[0] + E[4] * n[1] + E[7] * n[2]
+    + r[2] * E_T_f0 - r[0] * E_T_f2;
+  result.x[2] = E[2] * n[0] + E[5] * n[1] + E[8] * n[2]
+    - r[1] * E_T_f0 + r[0] * E_T_f1;
+  result.x[3] = E_T_f0;
+  result.x[4] = E_T_f1;
+  result.x[5] = E_T_f2;
+
+  return result;
+}
+
+/** \brief Same as crossm (v1, v2) for all lanes */
+inline SpatialVectorLanes LanesCrossm (
+    const SpatialVectorLanes &v1,
+    const SpatialVectorLanes &v2) {
+  const LaneScalar *a = v1.x;
+  const LaneScalar *b = v2.x;
+
+  SpatialVectorLanes result;
+  result.x[0] = -a[2] * b[1] + a[1] * b[2];
+  result.x[1] =  a[2] * b[0] - a[0] * b[2];
+  result.x[2] = -a[1] * b[0] + a[0] * b[1];
+  result.x[3] = -a[5] * b[1] + a[4] * b[2] - a[2] * b[4] + a[1] * b[5];
+  result.x[4] =  a[5] * b[0] - a[3] * b[2] + a[2] * b[3] - a[0] * b[5];
+  result.x[5] = -a[4] * b[0] + a[3] * b[1] - a[1] * b[3] + a[0] * b[4];
+
+  return result;
+}
+
+/** \brief Same as crossf (v1, v2) for all lanes */
+inline SpatialVectorLanes LanesCrossf (
+    const SpatialVectorLanes &v1,
+    const SpatialVectorLanes &v2) {
+  const LaneScalar *a = v1.x;
+  const LaneScalar *b = v2.x;
+
+  SpatialVectorLanes result;
+  result.x[0] = -a[2] * b[1] + a[1] * b[2] - a[5] * b[4] + a[4] * b[5];
+  result.x[1] =  a[2] * b[0] - a[0] * b[2] + a[5] * b[3] - a[3] * b[5];
+  result.x[2] = -a[1] * b[0] + a[0] * b[1] - a[4] * b[3] + a[3] * b[4];
+  result.x[3] = -a[2] * b[4] + a[1] * b[5];
+  result.x[4] =  a[2] * b[3] - a[0] * b[5];
+  result.x[5] = -a[1] * b[3] + a[0] * b[4];
+
+  return result;
+}
+
+/** \brief Multiplies a matrix that is the same for all lanes with v */
+inline SpatialVectorLanes LanesMultiply (
+    const SpatialMatrix &m,
+    const SpatialVectorLanes &v) {
+  SpatialVectorLanes result;
+
+  for (unsigned int row = 0; row < 6; row++) {
+    result.x[row] = m(row, 0) * v.x[0] + m(row, 1) * v.x[1]
+      + m(row, 2) * v.x[2] + m(row, 3) * v.x[3]
+      + m(row, 4) * v.x[4] + m(row, 5) * v.x[5];
+  }
+
+  return result;
+}
+
+/** \brief Computes m * v for all lanes */
+inline SpatialVectorLanes LanesMultiply (
+    const SpatialMatrixLanes &m,
+    const SpatialVectorLanes &v) {
+  SpatialVectorLanes result;
+
+  for (unsigned int row = 0; row < 6; row++) {
+    const LaneScalar *m_row = &m.M[row * 6];
+    result.x[row] = m_row[0] * v.x[0] + m_row[1] * v.x[1]
+      + m_row[2] * v.x[2] + m_row[3] * v.x[3]
+      + m_row[4] * v.x[4] + m_row[5] * v.x[5];
+  }
+
+  return result;
+}
+
+/** \brief Computes s * value where s is the same for all lanes */
+inline SpatialVectorLanes LanesScale (
+    const SpatialVector &s,
+    const LaneScalar &value) {
+  SpatialVectorLanes result;
+
+  for (unsigned int i = 0; i < 6; i++) {
+    result.x[i] = s[i] * value;
+  }
+
+  return result;
+}
+
+/** \brief Computes s^T v where s is the same for all lanes
+ *
+ * Zero entries of s are skipped as motion subspaces are mostly sparse.
+ */
+inline LaneScalar LanesDot (
+    const SpatialVector &s,
+    const SpatialVectorLanes &v) {
+  LaneScalar result (LaneScalar::Zero());
+
+  for (unsigned int i = 0; i < 6; i++) {
+    if (s[i] != 0.) {
+      result += s[i] * v.x[i];
+    }
+  }
+
+  return result;
+}
+
+/** \brief Computes a^T b for all lanes */
+inline LaneScalar LanesDot (
+    const SpatialVectorLanes &a,
+    const SpatialVectorLanes &b) {
+  return a.x[0] * b.x[0] + a.x[1] * b.x[1] + a.x[2] * b.x[2]
+    + a.x[3] * b.x[3] + a.x[4] * b.x[4] + a.x[5] * b.x[5];
+}
+
+/** \brief Computes result += X^T * m * X for all lanes
+ *
+ * This transforms an articulated body inertia into the frame of the
+ * parent body as it is done in the second pass of the Articulated Body
+ * Algorithm.
+ */
+inline void LanesAddTransformedInertia (
+    const SpatialTransformLanes &X,
+    const SpatialMatrixLanes &m,
+    SpatialMatrixLanes &result) {
+  // columns of X^T * m
+  SpatialVectorLanes XT_m[6];
+  SpatialVectorLanes column;
+
+  for (unsigned int col = 0; col < 6; col++) {
+    for (unsigned int row = 0; row < 6; row++) {
+      column.x[row] = m.M[row * 6 + col];
+    }
+    XT_m[col] = LanesApplyTranspose (X, column);
+  }
+
+  // row i of (X^T * m) * X is X^T applied to row i of X^T * m
+  for (unsigned int row = 0; row < 6; row++) {
+    for (unsigned int col = 0; col < 6; col++) {
+      column.x[col] = XT_m[col].x[row];
+    }
+
+    SpatialVectorLanes result_row = LanesApplyTranspose (X, column);
+    for (unsigned int col = 0; col < 6; col++) {
+      result.M[row * 6 + col] += result_row.x[col];
+    }
+  }
+}
+
+} /* Math */
+
+} /* RigidBodyDynamics */
+
+/* RBDL_LANES_H */
+#endif
@@ -9,6 +9,8 @@
 #include <limits>
 
 #include <iostream>
+#include <sstream>
+#include <algorithm>
 #include <assert.h>
 
 #include <rbdl/rbdl_mathutils.h>
@@ -121,6 +123,129 @@ RBDL_DLLAPI bool LinSolveGaussElimPivot (MatrixNd A, VectorNd b, VectorNd &x) {
   return true;
 }
 
+/* Computes x = Q^T x where Q is given by the first length Householder
+ * reflectors of a QR decomposition (see Eigen::HouseholderSequence). Unlike
+ * HouseholderSequence::applyOnTheLeft() this never allocates a workspace. */
+static void ApplyHouseholderQTranspose (
+    const MatrixNd &qr,
+    const VectorNd &h_coeffs,
+    Eigen::Index length,
+    VectorNd &x) {
+  for (Eigen::Index k = 0; k < length; k++) {
+    Eigen::Index tail_size = qr.rows() - k - 1;
+    double v_dot_x = x[k]
+      + qr.col(k).tail (tail_size).dot (x.segment (k + 1, tail_size));
+    double scale = h_coeffs[k] * v_dot_x;
+
+    x[k] -= scale;
+    x.segment (k + 1, tail_size) -= scale * qr.col(k).tail (tail_size);
+  }
+}
+
+RBDL_DLLAPI void LinearSolverWorkspace::resize (
+    unsigned int rows,
+    unsigned int cols) {
+  if (rows == cols) {
+    partial_piv_lu = Eigen::PartialPivLU<MatrixNd> (rows);
+    llt = Eigen::LLT<MatrixNd> (rows);
+  }
+
+  col_piv_householder_qr = Eigen::ColPivHouseholderQR<MatrixNd> (rows, cols);
+  householder_qr = Eigen::HouseholderQR<MatrixNd> (rows, cols);
+  temp = VectorNd::Zero (rows);
+}
+
+RBDL_DLLAPI void LinearSolverWorkspace::compute (
+    const MatrixNd &A,
+    LinearSolver solver) {
+  linear_solver = solver;
+
+  switch (linear_solver) {
+    case (LinearSolverPartialPivLU) :
+      partial_piv_lu.compute (A);
+      break;
+    case (LinearSolverColPivHouseholderQR) :
+      col_piv_householder_qr.compute (A);
+      break;
+    case (LinearSolverHouseholderQR) :
+      householder_qr.compute (A);
+      break;
+    case (LinearSolverLLT) :
+      llt.compute (A);
+      break;
+    default:
+      std::ostringstream errormsg;
+      errormsg << "Error: Invalid linear solver: " << linear_solver
+        << std::endl;
+      throw Errors::RBDLError(errormsg.str());
+      break;
+  }
+}
+
+RBDL_DLLAPI void LinearSolverWorkspace::solve (
+    const VectorNd &b,
+    VectorNd &x) {
+  // The QR solvers are evaluated as in Eigen's own solve() but use temp
+  // instead of allocating a copy of b and the Householder workspaces.
+  switch (linear_solver) {
+    case (LinearSolverPartialPivLU) :
+      x = partial_piv_lu.solve (b);
+      break;
+    case (LinearSolverColPivHouseholderQR) : {
+      const MatrixNd &qr = col_piv_householder_qr.matrixQR();
+      const Eigen::Index nonzero_pivots =
+        col_piv_householder_qr.nonzeroPivots();
+      const Eigen::VectorXi &permutation =
+        col_piv_householder_qr.colsPermutation().indices();
+
+      x.resize (qr.cols());
+      if (nonzero_pivots == 0) {
+        x.setZero();
+        break;
+      }
+
+      temp = b;
+      ApplyHouseholderQTranspose (qr,
+          col_piv_householder_qr.hCoeffs(), nonzero_pivots, temp);
+      qr.topLeftCorner (nonzero_pivots, nonzero_pivots)
+        .triangularView<Eigen::Upper>()
+        .solveInPlace (temp.head (nonzero_pivots));
+
+      for (Eigen::Index i = 0; i < nonzero_pivots; i++) {
+        x[permutation[i]] = temp[i];
+      }
+      for (Eigen::Index i = nonzero_pivots; i < qr.cols(); i++) {
+        x[permutation[i]] = 0.;
+      }
+      break;
+    }
+    case (LinearSolverHouseholderQR) : {
+      const MatrixNd &qr = householder_qr.matrixQR();
+      const Eigen::Index rank = std::min (qr.rows(), qr.cols());
+
+      temp = b;
+      ApplyHouseholderQTranspose (qr, householder_qr.hCoeffs(), rank, temp);
+      qr.topLeftCorner (rank, rank)
+        .triangularView<Eigen::Upper>()
+        .solveInPlace (temp.head (rank));
+
+      x.resize (qr.cols());
+      x.head (rank) = temp.head (rank);
+      x.tail (qr.cols() - rank).setZero();
+      break;
+    }
+    case (LinearSolverLLT) :
+      x = llt.solve (b);
+      break;
+    default:
+      std::ostringstream errormsg;
+      errormsg << "Error: Invalid linear solver: " << linear_solver
+        << std::endl;
+      throw Errors::RBDLError(errormsg.str());
+      break;
+  }
+}
+
 RBDL_DLLAPI void SpatialMatrixSetSubmatrix(
     SpatialMatrix &dest, 
     unsigned int row, 
@@ -281,16 +406,56 @@ RBDL_DLLAPI void SparseFactorizeLTL (Model &model, Math::MatrixNd &H) {
   }
 }
 
-RBDL_DLLAPI void SparseMultiplyHx (Model &model, Math::MatrixNd &L) {
-  assert (0 && !"Not yet implemented!");
+RBDL_DLLAPI void SparseMultiplyHx (
+    Model &model,
+    const Math::MatrixNd &H,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    result[i - 1] = H(i - 1,i - 1) * x[i - 1];
+  }
+
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    unsigned int j = model.lambda_q[i];
+    while (j != 0) {
+      result[i - 1] = result[i - 1] + H(i - 1,j - 1) * x[j - 1];
+      result[j - 1] = result[j - 1] + H(i - 1,j - 1) * x[i - 1];
+      j = model.lambda_q[j];
+    }
+  }
 }
 
-RBDL_DLLAPI void SparseMultiplyLx (Model &model, Math::MatrixNd &L) {
-  assert (0 && !"Not yet implemented!");
+RBDL_DLLAPI void SparseMultiplyLx (
+    Model &model,
+    const Math::MatrixNd &L,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    result[i - 1] = L(i - 1,i - 1) * x[i - 1];
+    unsigned int j = model.lambda_q[i];
+    while (j != 0) {
+      result[i - 1] = result[i - 1] + L(i - 1,j - 1) * x[j - 1];
+      j = model.lambda_q[j];
+    }
+  }
 }
 
-RBDL_DLLAPI void SparseMultiplyLTx (Model &model, Math::MatrixNd &L) {
-  assert (0 && !"Not yet implemented!");
+RBDL_DLLAPI void SparseMultiplyLTx (
+    Model &model,
+    const Math::MatrixNd &L,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    result[i - 1] = L(i - 1,i - 1) * x[i - 1];
+  }
+
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    unsigned int j = model.lambda_q[i];
+    while (j != 0) {
+      result[j - 1] = result[j - 1] + L(i - 1,j - 1) * x[i - 1];
+      j = model.lambda_q[j];
+    }
+  }
 }
 
 RBDL_DLLAPI void SparseSolveLx (Model &model, Math::MatrixNd &L, Math::VectorNd &x) {
@@ -315,5 +480,142 @@ RBDL_DLLAPI void SparseSolveLTx (Model &model, Math::MatrixNd &L, Math::VectorNd
   }
 }
 
+void SparseJointSpaceMatrix::Init (const Model &model) {
+  row_start.resize (model.qdot_size + 1);
+  col_index.clear();
+
+  for (unsigned int i = 1; i <= model.qdot_size; i++) {
+    row_start[i - 1] = col_index.size();
+
+    unsigned int j = i;
+    while (j != 0) {
+      col_index.push_back (j - 1);
+      j = model.lambda_q[j];
+    }
+  }
+  row_start[model.qdot_size] = col_index.size();
+
+  values = VectorNd::Zero (col_index.size());
+}
+
+MatrixNd SparseJointSpaceMatrix::toMatrix () const {
+  MatrixNd result (MatrixNd::Zero (rows(), rows()));
+
+  for (unsigned int i = 0; i < rows(); i++) {
+    for (unsigned int k = row_start[i]; k < row_start[i + 1]; k++) {
+      result(i, col_index[k]) = values[k];
+      result(col_index[k], i) = values[k];
+    }
+  }
+
+  return result;
+}
+
+MatrixNd SparseJointSpaceMatrix::toLowerTriangularMatrix () const {
+  MatrixNd result (MatrixNd::Zero (rows(), rows()));
+
+  for (unsigned int i = 0; i < rows(); i++) {
+    for (unsigned int k = row_start[i]; k < row_start[i + 1]; k++) {
+      result(i, col_index[k]) = values[k];
+    }
+  }
+
+  return result;
+}
+
+RBDL_DLLAPI void SparseFactorizeLTL (SparseJointSpaceMatrix &H) {
+  const std::vector<unsigned int> &row_start = H.row_start;
+  const std::vector<unsigned int> &col_index = H.col_index;
+  VectorNd &values = H.values;
+
+  for (unsigned int k = H.rows(); k > 0; k--) {
+    unsigned int diag_k = row_start[k - 1];
+    unsigned int end_k = row_start[k];
+
+    values[diag_k] = sqrt (values[diag_k]);
+    for (unsigned int a = diag_k + 1; a < end_k; a++) {
+      values[a] = values[a] / values[diag_k];
+    }
+
+    // The ancestors of an ancestor i of k are the remaining entries of row
+    // k such that row i can be updated in one contiguous sweep.
+    for (unsigned int a = diag_k + 1; a < end_k; a++) {
+      unsigned int diag_i = row_start[col_index[a]];
+      for (unsigned int b = a; b < end_k; b++) {
+        values[diag_i + b - a] = values[diag_i + b - a]
+          - values[a] * values[b];
+      }
+    }
+  }
+}
+
+RBDL_DLLAPI void SparseMultiplyHx (
+    const SparseJointSpaceMatrix &H,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 0; i < H.rows(); i++) {
+    result[i] = H.values[H.row_start[i]] * x[i];
+  }
+
+  for (unsigned int i = 0; i < H.rows(); i++) {
+    for (unsigned int k = H.row_start[i] + 1; k < H.row_start[i + 1]; k++) {
+      unsigned int j = H.col_index[k];
+      result[i] = result[i] + H.values[k] * x[j];
+      result[j] = result[j] + H.values[k] * x[i];
+    }
+  }
+}
+
+RBDL_DLLAPI void SparseMultiplyLx (
+    const SparseJointSpaceMatrix &L,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 0; i < L.rows(); i++) {
+    double value = 0.;
+    for (unsigned int k = L.row_start[i]; k < L.row_start[i + 1]; k++) {
+      value = value + L.values[k] * x[L.col_index[k]];
+    }
+    result[i] = value;
+  }
+}
+
+RBDL_DLLAPI void SparseMultiplyLTx (
+    const SparseJointSpaceMatrix &L,
+    const Math::VectorNd &x,
+    Math::VectorNd &result) {
+  for (unsigned int i = 0; i < L.rows(); i++) {
+    result[i] = L.values[L.row_start[i]] * x[i];
+  }
+
+  for (unsigned int i = 0; i < L.rows(); i++) {
+    for (unsigned int k = L.row_start[i] + 1; k < L.row_start[i + 1]; k++) {
+      unsigned int j = L.col_index[k];
+      result[j] = result[j] + L.values[k] * x[i];
+    }
+  }
+}
+
+RBDL_DLLAPI void SparseSolveLx (
+    const SparseJointSpaceMatrix &L,
+    Math::VectorNd &x) {
+  for (unsigned int i = 0; i < L.rows(); i++) {
+    for (unsigned int k = L.row_start[i] + 1; k < L.row_start[i + 1]; k++) {
+      x[i] = x[i] - L.values[k] * x[L.col_index[k]];
+    }
+    x[i] = x[i] / L.values[L.row_start[i]];
+  }
+}
+
+RBDL_DLLAPI void SparseSolveLTx (
+    const SparseJointSpaceMatrix &L,
+    Math::VectorNd &x) {
+  for (unsigned int i = L.rows(); i > 0; i--) {
+    x[i - 1] = x[i - 1] / L.values[L.row_start[i - 1]];
+    for (unsigned int k = L.row_start[i - 1] + 1; k < L.row_start[i]; k++) {
+      x[L.col_index[k]] = x[L.col_index[k]] - L.values[k] * x[i - 1];
+    }
+  }
+}
+
 } /* Math */
 } /* RigidBodyDynamics */
@@ -0,0 +1,262 @@
+/*
+ * RBDL - Rigid Body Dynamics Library
+ * Copyright (c) 2011-2018 Martin Felis <martin@fysx.org>
+ *
+ * Licensed under the zlib license. See LICENSE for more details.
+ */
+
+#ifndef RBDL_PARALLEL_H
+#define RBDL_PARALLEL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace RigidBodyDynamics {
+
+/** \brief Returns the number of threads that should be used for a
+ * given request where 0 means "use all available hardware threads".
+ */
+inline unsigned int ResolveThreadCount (unsigned int num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+
+  return num_threads > 0 ? num_threads : 1;
+}
+
+/** \brief Splits the range [0, count) into contiguous chunks and evaluates
+ * them concurrently.
+ *
+ * The function fn is called as fn (thread_index, begin, end) exactly once
+ * per used thread. The first chunk is evaluated on the calling thread.
+ * Exceptions thrown by any of the chunks are rethrown after all threads
+ * have finished.
+ */
+template <typename Function>
+void ParallelFor (unsigned int count, unsigned int num_threads, Function fn) {
+  num_threads = ResolveThreadCount (num_threads);
+  if (num_threads > count) {
+    num_threads = count;
+  }
+
+  if (num_threads <= 1) {
+    if (count > 0) {
+      fn (0u, 0u, count);
+    }
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  std::vector<std::exception_ptr> errors (num_threads);
+  threads.reserve (num_threads - 1);
+
+  unsigned int chunk_size = count / num_threads;
+  unsigned int remainder = count % num_threads;
+  unsigned int begin = 0;
+  unsigned int first_end = 0;
+
+  for (unsigned int t = 0; t < num_threads; t++) {
+    unsigned int end = begin + chunk_size + (t < remainder ? 1 : 0);
+
+    if (t == 0) {
+      first_end = end;
+    } else {
+      threads.push_back (std::thread ([&fn, &errors, t, begin, end] () {
+        try {
+          fn (t, begin, end);
+        } catch (...) {
+          errors[t] = std::current_exception();
+        }
+      }));
+    }
+
+    begin = end;
+  }
+
+  try {
+    fn (0u, 0u, first_end);
+  } catch (...) {
+    errors[0] = std::current_exception();
+  }
+
+  for (size_t t = 0; t < threads.size(); t++) {
+    threads[t].join();
+  }
+
+  for (size_t t = 0; t < errors.size(); t++) {
+    if (errors[t]) {
+      std::rethrow_exception (errors[t]);
+    }
+  }
+}
+
+/** \brief Persistent worker threads that repeatedly evaluate a function
+ * concurrently.
+ *
+ * In contrast to ParallelFor() the threads are only created once which
+ * makes the pool suitable for functions that only take a few microseconds
+ * such as a single evaluation of the dynamics. Idle workers briefly spin
+ * before they block to reduce the wake up latency of back-to-back calls.
+ */
+class ThreadPool {
+  public:
+    /** \brief Creates a pool with num_threads threads in total (including
+     * the calling thread) where 0 means all available hardware threads */
+    explicit ThreadPool (unsigned int num_threads) :
+      job (NULL),
+      context (NULL),
+      generation (0),
+      pending (0),
+      stop (false) {
+        num_threads = ResolveThreadCount (num_threads);
+        errors.resize (num_threads);
+        workers.reserve (num_threads - 1);
+
+        for (unsigned int t = 1; t < num_threads; t++) {
+          workers.push_back (std::thread (&ThreadPool::WorkerLoop, this, t));
+        }
+      }
+
+    ~ThreadPool () {
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        stop = true;
+        generation++;
+      }
+      start_condition.notify_all();
+
+      for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+      }
+    }
+
+    /// \brief Number of threads including the calling thread
+    unsigned int size () const {
+      return workers.size() + 1;
+    }
+
+    /** \brief Calls fn (thread_index) once on every thread of the pool
+     * and returns when all calls have finished.
+     *
+     * The calling thread has index 0. Exceptions thrown by any of the
+     * calls are rethrown on the calling thread.
+     */
+    template <typename Function>
+    void Run (Function &fn) {
+      Dispatch (&Invoke<Function>, &fn);
+    }
+
+  private:
+    ThreadPool (const ThreadPool &);
+    ThreadPool& operator= (const ThreadPool &);
+
+    template <typename Function>
+    static void Invoke (void *fn, unsigned int thread_index) {
+      (*static_cast<Function*>(fn)) (thread_index);
+    }
+
+    void Dispatch (void (*new_job)(void*, unsigned int), void *new_context) {
+      if (workers.empty()) {
+        new_job (new_context, 0);
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock (mutex);
+        job = new_job;
+        context = new_context;
+        pending = workers.size();
+        generation++;
+      }
+      start_condition.notify_all();
+
+      try {
+        job (context, 0);
+      } catch (...) {
+        errors[0] = std::current_exception();
+      }
+
+      for (unsigned int k = 0; k < spin_count && pending.load() != 0; k++) {
+        std::this_thread::yield();
+      }
+
+      {
+        std::unique_lock<std::mutex> lock (mutex);
+        while (pending.load() != 0) {
+          done_condition.wait (lock);
+        }
+      }
+
+      for (size_t t = 0; t < errors.size(); t++) {
+        if (errors[t]) {
+          std::exception_ptr error = errors[t];
+          for (size_t k = 0; k < errors.size(); k++) {
+            errors[k] = std::exception_ptr();
+          }
+          std::rethrow_exception (error);
+        }
+      }
+    }
+
+    void WorkerLoop (unsigned int thread_index) {
+      unsigned long seen_generation = 0;
+
+      while (true) {
+        for (unsigned int k = 0;
+            k < spin_count && generation.load() == seen_generation; k++) {
+          std::this_thread::yield();
+        }
+
+        void (*current_job)(void*, unsigned int);
+        void *current_context;
+        {
+          std::unique_lock<std::mutex> lock (mutex);
+          while (generation.load() == seen_generation) {
+            start_condition.wait (lock);
+          }
+          seen_generation = generation.load();
+
+          if (stop) {
+            return;
+          }
+          current_job = job;
+          current_context = context;
+        }
+
+        try {
+          current_job (current_context, thread_index);
+        } catch (...) {
+          errors[thread_index] = std::current_exception();
+        }
+
+        if (pending.fetch_sub (1) == 1) {
+          std::lock_guard<std::mutex> lock (mutex);
+          done_condition.notify_one();
+        }
+      }
+    }
+
+    static const unsigned int spin_count = 4000;
+
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors;
+
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+
+    void (*job)(void*, unsigned int);
+    void *context;
+    std::atomic<unsigned long> generation;
+    std::atomic<unsigned int> pending;
+    bool stop;
+};
+
+}
+
+/* RBDL_PARALLEL_H */
+#endif
@@ -12,6 +12,7 @@
 #include "rbdl/Model.h"
 #include "rbdl/Kinematics.h"
 
+#include <cctype>
 #include <sstream>
 #include <iomanip>
 
@@ -398,5 +399,414 @@ RBDL_DLLAPI double CalcKineticEnergy (
   return result;
 }
 
+
+/* Returns the index of the unit vector that equals axis or -1 if axis is
+ * not a unit vector. */
+int get_unit_axis_index (const SpatialVector &axis)
+{
+  for (unsigned int i = 0; i < 6; i++) {
+    if (axis == SpatialVector::Unit (i)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/* Writes code that evaluates S[body_index]^T * value. */
+string code_S_dot (const Model &model, unsigned int body_index,
+                   const string &value)
+{
+  stringstream result ("");
+  int axis_index = get_unit_axis_index (model.S[body_index]);
+
+  if (axis_index >= 0) {
+    result << value << "[" << axis_index << "]";
+  } else {
+    result << "S[" << body_index << "].dot (" << value << ")";
+  }
+
+  return result.str();
+}
+
+/* Writes code that evaluates target += S[body_index] * value. */
+string code_add_S_times (const Model &model, unsigned int body_index,
+                         const string &target, const string &value)
+{
+  stringstream result ("");
+  int axis_index = get_unit_axis_index (model.S[body_index]);
+
+  if (axis_index >= 0) {
+    result << target << "[" << axis_index << "] += " << value << ";";
+  } else {
+    result << target << " += S[" << body_index << "] * " << value << ";";
+  }
+
+  return result.str();
+}
+
+RBDL_DLLAPI std::string GenerateFixedSizeModelCode (
+  const Model &model,
+  const std::string &struct_name)
+{
+  if (model.mCustomJoints.size() > 0) {
+    throw Errors::RBDLError ("Error: cannot generate fixed-size code for "
+                             "models with custom joints.\n");
+  }
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    JointType type = model.mJoints[i].mJointType;
+    if (model.mJoints[i].mDoFCount != 1
+        || (type != JointTypeRevolute
+            && type != JointTypeRevoluteX
+            && type != JointTypeRevoluteY
+            && type != JointTypeRevoluteZ
+            && type != JointTypePrismatic)) {
+      std::ostringstream errormsg;
+      errormsg << "Error: cannot generate fixed-size code for joint of body "
+               << i << " (name: " << model.GetBodyName(i) << "). Only "
+               << "revolute and prismatic joints are supported, use emulated "
+               << "multi-dof joints instead." << endl;
+      throw Errors::RBDLError(errormsg.str());
+    }
+  }
+
+  unsigned int body_count = model.mBodies.size();
+
+  string guard = "RBDL_GENERATED_";
+  for (size_t i = 0; i < struct_name.size(); i++) {
+    guard += static_cast<char>(toupper (struct_name[i]));
+  }
+  guard += "_H";
+
+  stringstream result ("");
+  result << setprecision (17);
+
+  result << "/*" << endl
+         << " * Fixed-size dynamics of the model " << struct_name
+         << " with " << model.dof_count << " degrees of freedom." << endl
+         << " *" << endl
+         << " * Generated by "
+         << "RigidBodyDynamics::Utils::GenerateFixedSizeModelCode()." << endl
+         << " * Do not edit, regenerate the file when the model changes."
+         << endl
+         << " */" << endl
+         << endl
+         << "#ifndef " << guard << endl
+         << "#define " << guard << endl
+         << endl
+         << "#include <rbdl/rbdl_math.h>" << endl
+         << endl
+         << "struct " << struct_name << " {" << endl
+         << "  enum {" << endl
+         << "    DofCount = " << model.dof_count << "," << endl
+         << "    BodyCount = " << body_count << endl
+         << "  };" << endl
+         << endl
+         << "  typedef Eigen::Matrix<double, DofCount, 1> VectorQ;" << endl
+         << "  typedef Eigen::Matrix<double, DofCount, DofCount> MatrixQ;"
+         << endl
+         << endl
+         << "  // model constants" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector a_root;" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector S[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialTransform X_T[BodyCount];"
+         << endl
+         << "  RigidBodyDynamics::Math::SpatialRigidBodyInertia I[BodyCount];"
+         << endl
+         << endl
+         << "  // workspace" << endl
+         << "  RigidBodyDynamics::Math::SpatialTransform X_lambda[BodyCount];"
+         << endl
+         << "  RigidBodyDynamics::Math::SpatialVector v[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector c[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector a[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector f[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector pA[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialVector U[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialMatrix IA[BodyCount];" << endl
+         << "  RigidBodyDynamics::Math::SpatialRigidBodyInertia Ic[BodyCount];"
+         << endl
+         << "  double d[BodyCount];" << endl
+         << "  double u[BodyCount];" << endl
+         << endl;
+
+  // constructor with the model constants
+  result << "  " << struct_name << "() {" << endl
+         << "    using namespace RigidBodyDynamics::Math;" << endl
+         << endl
+         << "    a_root = SpatialVector (0., 0., 0., " << -model.gravity[0]
+         << ", " << -model.gravity[1] << ", " << -model.gravity[2] << ");"
+         << endl;
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    const SpatialVector &s = model.S[i];
+    const SpatialTransform &X_T = model.X_T[i];
+    const SpatialRigidBodyInertia &I = model.I[i];
+
+    result << endl
+           << "    // " << i << ": " << get_body_name (model, i)
+           << (model.mBodies[i].mIsVirtual ? " (virtual)" : "")
+           << ", parent " << model.lambda[i] << ", "
+           << get_dof_name (s) << endl
+           << "    S[" << i << "] = SpatialVector (" << s[0] << ", " << s[1]
+           << ", " << s[2] << ", " << s[3] << ", " << s[4] << ", " << s[5]
+           << ");" << endl
+           << "    X_T[" << i << "] = SpatialTransform (Matrix3d (" << endl
+           << "        " << X_T.E(0,0) << ", " << X_T.E(0,1) << ", "
+           << X_T.E(0,2) << "," << endl
+           << "        " << X_T.E(1,0) << ", " << X_T.E(1,1) << ", "
+           << X_T.E(1,2) << "," << endl
+           << "        " << X_T.E(2,0) << ", " << X_T.E(2,1) << ", "
+           << X_T.E(2,2) << ")," << endl
+           << "      Vector3d (" << X_T.r[0] << ", " << X_T.r[1] << ", "
+           << X_T.r[2] << "));" << endl
+           << "    I[" << i << "] = SpatialRigidBodyInertia (" << I.m
+           << ", Vector3d (" << I.h[0] << ", " << I.h[1] << ", " << I.h[2]
+           << ")," << endl
+           << "        " << I.Ixx << ", " << I.Iyx << ", " << I.Iyy << ", "
+           << I.Izx << ", " << I.Izy << ", " << I.Izz << ");" << endl;
+  }
+
+  result << "  }" << endl
+         << endl;
+
+  // joint transformations
+  result << "  /// Computes X_lambda of all bodies for the given positions"
+         << endl
+         << "  void CalcJointTransforms (const VectorQ &q) {" << endl
+         << "    using namespace RigidBodyDynamics::Math;" << endl
+         << endl;
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    unsigned int q_index = model.mJoints[i].q_index;
+    const SpatialVector &s = model.S[i];
+
+    result << "    X_lambda[" << i << "] = ";
+    switch (model.mJoints[i].mJointType) {
+      case JointTypeRevoluteX:
+        result << "Xrotx (q[" << q_index << "])";
+        break;
+      case JointTypeRevoluteY:
+        result << "Xroty (q[" << q_index << "])";
+        break;
+      case JointTypeRevoluteZ:
+        result << "Xrotz (q[" << q_index << "])";
+        break;
+      case JointTypeRevolute:
+        result << "Xrot (q[" << q_index << "], Vector3d (" << s[0] << ", "
+               << s[1] << ", " << s[2] << "))";
+        break;
+      default:
+        result << "Xtrans (Vector3d (" << s[3] << ", " << s[4] << ", "
+               << s[5] << ") * q[" << q_index << "])";
+        break;
+    }
+    result << " * X_T[" << i << "];" << endl;
+  }
+
+  result << "  }" << endl
+         << endl;
+
+  // articulated body algorithm
+  result << "  /// Computes the forward dynamics using the Articulated Body "
+         << "Algorithm" << endl
+         << "  void ForwardDynamics (const VectorQ &q, const VectorQ &qdot,"
+         << endl
+         << "      const VectorQ &tau, VectorQ &qddot) {" << endl
+         << "    using namespace RigidBodyDynamics::Math;" << endl
+         << endl
+         << "    CalcJointTransforms (q);" << endl;
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    unsigned int lambda = model.lambda[i];
+    stringstream qdot_i ("");
+    qdot_i << "qdot[" << model.mJoints[i].q_index << "]";
+
+    result << endl;
+    if (lambda == 0) {
+      result << "    v[" << i << "].setZero();" << endl
+             << "    " << code_add_S_times (model, i, "v[" + to_string (i)
+                 + "]", qdot_i.str()) << endl
+             << "    c[" << i << "].setZero();" << endl;
+    } else {
+      result << "    v[" << i << "] = X_lambda[" << i << "].apply (v["
+             << lambda << "]);" << endl
+             << "    " << code_add_S_times (model, i, "v[" + to_string (i)
+                 + "]", qdot_i.str()) << endl
+             << "    c[" << i << "] = crossm (v[" << i << "], SpatialVector (S["
+             << i << "] * " << qdot_i.str() << "));" << endl;
+    }
+
+    if (model.mBodies[i].mIsVirtual) {
+      result << "    IA[" << i << "].setZero();" << endl
+             << "    pA[" << i << "].setZero();" << endl;
+    } else {
+      result << "    IA[" << i << "] = I[" << i << "].toMatrix();" << endl
+             << "    pA[" << i << "] = crossf (v[" << i << "], I[" << i
+             << "] * v[" << i << "]);" << endl;
+    }
+  }
+
+  for (unsigned int i = body_count - 1; i > 0; i--) {
+    unsigned int lambda = model.lambda[i];
+
+    result << endl
+           << "    U[" << i << "] = IA[" << i << "] * S[" << i << "];" << endl
+           << "    d[" << i << "] = " << code_S_dot (model, i, "U["
+               + to_string (i) + "]") << ";" << endl
+           << "    u[" << i << "] = tau[" << model.mJoints[i].q_index << "] - "
+           << code_S_dot (model, i, "pA[" + to_string (i) + "]") << ";"
+           << endl;
+
+    if (lambda != 0) {
+      result << "    {" << endl
+             << "      SpatialMatrix Ia = IA[" << i << "] - U[" << i
+             << "] * (U[" << i << "] / d[" << i << "]).transpose();" << endl
+             << "      SpatialVector pa = pA[" << i << "] + Ia * c[" << i
+             << "] + U[" << i << "] * (u[" << i << "] / d[" << i << "]);"
+             << endl
+             << "      IA[" << lambda << "].noalias() += X_lambda[" << i
+             << "].toMatrixTranspose() * Ia * X_lambda[" << i
+             << "].toMatrix();" << endl
+             << "      pA[" << lambda << "].noalias() += X_lambda[" << i
+             << "].applyTranspose (pa);" << endl
+             << "    }" << endl;
+    }
+  }
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    unsigned int lambda = model.lambda[i];
+    unsigned int q_index = model.mJoints[i].q_index;
+    stringstream qddot_i ("");
+    qddot_i << "qddot[" << q_index << "]";
+
+    result << endl
+           << "    a[" << i << "] = X_lambda[" << i << "].apply ("
+           << (lambda == 0 ? string ("a_root") : "a[" + to_string (lambda)
+               + "]") << ") + c[" << i << "];" << endl
+           << "    " << qddot_i.str() << " = (u[" << i << "] - U[" << i
+           << "].dot (a[" << i << "])) / d[" << i << "];" << endl
+           << "    " << code_add_S_times (model, i, "a[" + to_string (i)
+               + "]", qddot_i.str()) << endl;
+  }
+
+  result << "  }" << endl
+         << endl;
+
+  // recursive Newton-Euler algorithm
+  result << "  /// Computes the inverse dynamics using the Recursive "
+         << "Newton-Euler Algorithm" << endl
+         << "  void InverseDynamics (const VectorQ &q, const VectorQ &qdot,"
+         << endl
+         << "      const VectorQ &qddot, VectorQ &tau) {" << endl
+         << "    using namespace RigidBodyDynamics::Math;" << endl
+         << endl
+         << "    CalcJointTransforms (q);" << endl;
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    unsigned int lambda = model.lambda[i];
+    unsigned int q_index = model.mJoints[i].q_index;
+    stringstream qdot_i (""), qddot_i ("");
+    qdot_i << "qdot[" << q_index << "]";
+    qddot_i << "qddot[" << q_index << "]";
+
+    result << endl;
+    if (lambda == 0) {
+      result << "    v[" << i << "].setZero();" << endl
+             << "    " << code_add_S_times (model, i, "v[" + to_string (i)
+                 + "]", qdot_i.str()) << endl
+             << "    a[" << i << "] = X_lambda[" << i << "].apply (a_root);"
+             << endl;
+    } else {
+      result << "    v[" << i << "] = X_lambda[" << i << "].apply (v["
+             << lambda << "]);" << endl
+             << "    " << code_add_S_times (model, i, "v[" + to_string (i)
+                 + "]", qdot_i.str()) << endl
+             << "    a[" << i << "] = X_lambda[" << i << "].apply (a["
+             << lambda << "]) + crossm (v[" << i << "], SpatialVector (S["
+             << i << "] * " << qdot_i.str() << "));" << endl;
+    }
+    result << "    " << code_add_S_times (model, i, "a[" + to_string (i)
+               + "]", qddot_i.str()) << endl;
+
+    if (model.mBodies[i].mIsVirtual) {
+      result << "    f[" << i << "].setZero();" << endl;
+    } else {
+      result << "    f[" << i << "] = I[" << i << "] * a[" << i
+             << "] + crossf (v[" << i << "], I[" << i << "] * v[" << i
+             << "]);" << endl;
+    }
+  }
+
+  result << endl;
+  for (unsigned int i = body_count - 1; i > 0; i--) {
+    unsigned int lambda = model.lambda[i];
+
+    result << "    tau[" << model.mJoints[i].q_index << "] = "
+           << code_S_dot (model, i, "f[" + to_string (i) + "]") << ";"
+           << endl;
+    if (lambda != 0) {
+      result << "    f[" << lambda << "] += X_lambda[" << i
+             << "].applyTranspose (f[" << i << "]);" << endl;
+    }
+  }
+
+  result << "  }" << endl
+         << endl;
+
+  // composite rigid body algorithm
+  result << "  /// Computes the joint space inertia matrix using the "
+         << "Composite Rigid Body" << endl
+         << "  /// Algorithm" << endl
+         << "  void CompositeRigidBodyAlgorithm (const VectorQ &q, MatrixQ &H) {"
+         << endl
+         << "    using namespace RigidBodyDynamics::Math;" << endl
+         << endl
+         << "    CalcJointTransforms (q);" << endl
+         << "    H.setZero();" << endl
+         << endl;
+
+  for (unsigned int i = 1; i < body_count; i++) {
+    result << "    Ic[" << i << "] = I[" << i << "];" << endl;
+  }
+
+  result << endl
+         << "    SpatialVector F;" << endl;
+
+  for (unsigned int i = body_count - 1; i > 0; i--) {
+    unsigned int lambda = model.lambda[i];
+    unsigned int dof_index_i = model.mJoints[i].q_index;
+
+    result << endl;
+    if (lambda != 0) {
+      result << "    Ic[" << lambda << "] = Ic[" << lambda << "] + X_lambda["
+             << i << "].applyTranspose (Ic[" << i << "]);" << endl;
+    }
+    result << "    F = Ic[" << i << "] * S[" << i << "];" << endl
+           << "    H(" << dof_index_i << ", " << dof_index_i << ") = "
+           << code_S_dot (model, i, "F") << ";" << endl;
+
+    unsigned int j = i;
+    while (model.lambda[j] != 0) {
+      result << "    F = X_lambda[" << j << "].applyTranspose (F);" << endl;
+      j = model.lambda[j];
+      unsigned int dof_index_j = model.mJoints[j].q_index;
+      result << "    H(" << dof_index_i << ", " << dof_index_j << ") = "
+             << "H(" << dof_index_j << ", " << dof_index_i << ") = "
+             << code_S_dot (model, j, "F") << ";" << endl;
+    }
+  }
+
+  result << "  }" << endl
+         << endl
+         << "  EIGEN_MAKE_ALIGNED_OPERATOR_NEW" << endl
+         << "};" << endl
+         << endl
+         << "/* " << guard << " */" << endl
+         << "#endif" << endl;
+
+  return result.str();
+}
+
 }
 }
@@ -0,0 +1,231 @@
+#include <UnitTest++.h>
+
+#include <iostream>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Dynamics.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+const double TEST_PREC = 1.0e-12;
+const unsigned int BATCH_SIZE = 7;
+
+struct Human36Batch : public Human36 {
+  Human36Batch() {
+    Qs = MatrixNd::Zero (model_emulated->q_size, BATCH_SIZE);
+    QDots = MatrixNd::Zero (model_emulated->qdot_size, BATCH_SIZE);
+    Taus = MatrixNd::Zero (model_emulated->qdot_size, BATCH_SIZE);
+    QDDots = MatrixNd::Zero (model_emulated->qdot_size, BATCH_SIZE);
+
+    for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+      randomizeStates();
+      Qs.col(k) = q;
+      QDots.col(k) = qdot;
+      Taus.col(k) = tau;
+      QDDots.col(k) = qddot;
+    }
+  }
+
+  MatrixNd Qs;
+  MatrixNd QDots;
+  MatrixNd Taus;
+  MatrixNd QDDots;
+};
+
+TEST_FIXTURE (Human36Batch, ForwardDynamicsBatchMatchesSingle) {
+  unsigned int thread_counts[3] = { 1, 3, 0 };
+
+  for (unsigned int t = 0; t < 3; t++) {
+    MatrixNd QDDots_batch;
+    ForwardDynamicsBatch (*model_emulated, Qs, QDots, Taus, QDDots_batch,
+        thread_counts[t]);
+
+    CHECK_EQUAL (Qs.cols(), QDDots_batch.cols());
+
+    for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+      VectorNd qddot_single (VectorNd::Zero (model_emulated->qdot_size));
+      ForwardDynamics (*model_emulated, Qs.col(k), QDots.col(k), Taus.col(k),
+          qddot_single);
+
+      VectorNd qddot_batch = QDDots_batch.col(k);
+      CHECK_ARRAY_CLOSE (qddot_single.data(), qddot_batch.data(),
+          qddot_single.size(), TEST_PREC);
+    }
+  }
+}
+
+TEST_FIXTURE (Human36Batch, InverseDynamicsBatchMatchesSingle) {
+  MatrixNd Taus_batch;
+  InverseDynamicsBatch (*model_3dof, Qs, QDots, QDDots, Taus_batch, 3);
+
+  for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+    VectorNd tau_single (VectorNd::Zero (model_3dof->qdot_size));
+    InverseDynamics (*model_3dof, Qs.col(k), QDots.col(k), QDDots.col(k),
+        tau_single);
+
+    VectorNd tau_batch = Taus_batch.col(k);
+    CHECK_ARRAY_CLOSE (tau_single.data(), tau_batch.data(),
+        tau_single.size(), TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36Batch, CompositeRigidBodyAlgorithmBatchMatchesSingle) {
+  unsigned int dof_count = model_emulated->dof_count;
+
+  MatrixNd Hs;
+  CompositeRigidBodyAlgorithmBatch (*model_emulated, Qs, Hs, 3);
+
+  CHECK_EQUAL (dof_count, Hs.rows());
+  CHECK_EQUAL (dof_count * BATCH_SIZE, Hs.cols());
+
+  for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+    MatrixNd H_single (MatrixNd::Zero (dof_count, dof_count));
+    CompositeRigidBodyAlgorithm (*model_emulated, Qs.col(k), H_single);
+
+    MatrixNd H_batch = Hs.block (0, k * dof_count, dof_count, dof_count);
+    CHECK_ARRAY_CLOSE (H_single.data(), H_batch.data(),
+        dof_count * dof_count, TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36Batch, ForwardDynamicsBatchSizeMismatch) {
+  MatrixNd QDots_short = QDots.leftCols (BATCH_SIZE - 1);
+
+  CHECK_THROW (ForwardDynamicsBatch (*model_emulated, Qs, QDots_short, Taus,
+        QDDots, 2), Errors::RBDLSizeMismatchError);
+}
+
+TEST_FIXTURE (Human36Batch, ForwardDynamicsLockstepMatchesSingle) {
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    MatrixNd QDDots_lockstep;
+    ForwardDynamicsLockstep (*models[m], Qs, QDots, Taus, QDDots_lockstep);
+
+    for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+      VectorNd qddot_single (VectorNd::Zero (models[m]->qdot_size));
+      ForwardDynamics (*models[m], Qs.col(k), QDots.col(k), Taus.col(k),
+          qddot_single);
+
+      VectorNd qddot_lockstep = QDDots_lockstep.col(k);
+      CHECK_ARRAY_CLOSE (qddot_single.data(), qddot_lockstep.data(),
+          qddot_single.size(), 1.0e-9);
+    }
+  }
+}
+
+TEST_FIXTURE (Human36Batch, InverseDynamicsLockstepMatchesSingle) {
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    MatrixNd Taus_lockstep;
+    InverseDynamicsLockstep (*models[m], Qs, QDots, QDDots, Taus_lockstep);
+
+    for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+      VectorNd tau_single (VectorNd::Zero (models[m]->qdot_size));
+      InverseDynamics (*models[m], Qs.col(k), QDots.col(k), QDDots.col(k),
+          tau_single);
+
+      VectorNd tau_lockstep = Taus_lockstep.col(k);
+      CHECK_ARRAY_CLOSE (tau_single.data(), tau_lockstep.data(),
+          tau_single.size(), 1.0e-9);
+    }
+  }
+}
+
+TEST_FIXTURE (Human36, SubtreeScheduleCoversAllBodies) {
+  Model &model = *model_emulated;
+  SubtreeSchedule schedule (model, 3);
+
+  CHECK_EQUAL (3u, schedule.num_threads);
+  CHECK (schedule.subtree_root.size() >= 2);
+
+  std::vector<unsigned int> count (model.mBodies.size(), 0);
+  for (unsigned int k = 0; k < schedule.trunk.size(); k++) {
+    count[schedule.trunk[k]]++;
+  }
+
+  for (unsigned int task = 0; task < schedule.subtree_root.size(); task++) {
+    unsigned int root = schedule.subtree_root[task];
+    CHECK_EQUAL (root, schedule.subtree_bodies[schedule.subtree_start[task]]);
+
+    for (unsigned int k = schedule.subtree_start[task];
+        k < schedule.subtree_start[task + 1]; k++) {
+      unsigned int body_id = schedule.subtree_bodies[k];
+      count[body_id]++;
+
+      // all bodies of a subtree except its root have their parent in the
+      // same subtree
+      if (body_id != root) {
+        bool parent_found = false;
+        for (unsigned int l = schedule.subtree_start[task]; l < k; l++) {
+          parent_found |= schedule.subtree_bodies[l] == model.lambda[body_id];
+        }
+        CHECK (parent_found);
+      }
+    }
+  }
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    CHECK_EQUAL (1u, count[i]);
+  }
+}
+
+TEST_FIXTURE (Human36Batch, ForwardDynamicsParallelMatchesSingle) {
+  Model *models[2] = { model_emulated, model_3dof };
+  unsigned int thread_counts[3] = { 1, 2, 4 };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    for (unsigned int t = 0; t < 3; t++) {
+      SubtreeSchedule schedule (*models[m], thread_counts[t]);
+
+      for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+        VectorNd qddot_single (VectorNd::Zero (models[m]->qdot_size));
+        VectorNd qddot_parallel (VectorNd::Zero (models[m]->qdot_size));
+
+        ForwardDynamics (*models[m], Qs.col(k), QDots.col(k), Taus.col(k),
+            qddot_single);
+        ForwardDynamicsParallel (*models[m], schedule, Qs.col(k),
+            QDots.col(k), Taus.col(k), qddot_parallel);
+
+        CHECK_ARRAY_CLOSE (qddot_single.data(), qddot_parallel.data(),
+            qddot_single.size(), TEST_PREC * qddot_single.norm());
+      }
+    }
+  }
+}
+
+TEST_FIXTURE (Human36Batch, CompositeRigidBodyAlgorithmParallelMatchesSingle) {
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    unsigned int dof_count = models[m]->dof_count;
+    SubtreeSchedule schedule (*models[m], 4);
+    ModelData data (*models[m]);
+
+    for (unsigned int k = 0; k < BATCH_SIZE; k++) {
+      MatrixNd H_single (MatrixNd::Zero (dof_count, dof_count));
+      MatrixNd H_parallel (MatrixNd::Zero (dof_count, dof_count));
+
+      CompositeRigidBodyAlgorithm (*models[m], Qs.col(k), H_single);
+      CompositeRigidBodyAlgorithmParallel (*models[m], data, schedule,
+          Qs.col(k), H_parallel);
+
+      CHECK_ARRAY_CLOSE (H_single.data(), H_parallel.data(),
+          dof_count * dof_count, TEST_PREC);
+    }
+  }
+}
+
+TEST_FIXTURE (Human36, SubtreeScheduleModelMismatch) {
+  SubtreeSchedule schedule (*model_emulated, 2);
+  VectorNd qddot_parallel (VectorNd::Zero (model_3dof->qdot_size));
+
+  CHECK_THROW (ForwardDynamicsParallel (*model_3dof, schedule, q, qdot, tau,
+        qddot_parallel), Errors::RBDLError);
+}
@@ -0,0 +1,164 @@
+#include <UnitTest++.h>
+
+#include <cstdio>
+#include <iostream>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Kinematics.h"
+#include "rbdl/Dynamics.h"
+#include "rbdl/BinaryModel.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+const double TEST_PREC = 1.0e-12;
+
+static void CheckModelsEqual (Model &model, Model &loaded) {
+  CHECK_EQUAL (model.dof_count, loaded.dof_count);
+  CHECK_EQUAL (model.q_size, loaded.q_size);
+  CHECK_EQUAL (model.mBodies.size(), loaded.mBodies.size());
+  CHECK_EQUAL (model.mFixedBodies.size(), loaded.mFixedBodies.size());
+  CHECK (model.lambda == loaded.lambda);
+  CHECK (model.mBodyNameMap == loaded.mBodyNameMap);
+  CHECK_ARRAY_EQUAL (model.gravity.data(), loaded.gravity.data(), 3);
+
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    CHECK_EQUAL (model.mJoints[i].mJointType, loaded.mJoints[i].mJointType);
+    CHECK_EQUAL (model.mJoints[i].q_index, loaded.mJoints[i].q_index);
+    CHECK_EQUAL (model.mBodies[i].mIsVirtual, loaded.mBodies[i].mIsVirtual);
+  }
+
+  VectorNd q (VectorNd::Zero (model.q_size));
+  VectorNd qdot (VectorNd::Zero (model.qdot_size));
+  VectorNd tau (VectorNd::Zero (model.qdot_size));
+  for (unsigned int i = 0; i < model.q_size; i++) {
+    q[i] = 0.1 * (i + 1) - 0.4;
+  }
+  for (unsigned int i = 0; i < model.qdot_size; i++) {
+    qdot[i] = 0.3 - 0.05 * i;
+    tau[i] = 0.2 * i - 1.;
+  }
+  if (model.q_size > model.qdot_size) {
+    // normalize the quaternions of spherical joints
+    for (unsigned int i = 1; i < model.mJoints.size(); i++) {
+      if (model.mJoints[i].mJointType == JointTypeSpherical) {
+        Quaternion quat = model.GetQuaternion (i, q);
+        quat /= quat.norm();
+        model.SetQuaternion (i, quat, q);
+      }
+    }
+  }
+
+  VectorNd qddot (VectorNd::Zero (model.qdot_size));
+  VectorNd qddot_loaded (VectorNd::Zero (model.qdot_size));
+  ForwardDynamics (model, q, qdot, tau, qddot);
+  ForwardDynamics (loaded, q, qdot, tau, qddot_loaded);
+  CHECK_ARRAY_CLOSE (qddot.data(), qddot_loaded.data(), qddot.size(),
+      TEST_PREC);
+
+  for (unsigned int i = 0; i < model.mFixedBodies.size(); i++) {
+    unsigned int body_id = model.fixed_body_discriminator + i;
+    Vector3d point (0.1, -0.2, 0.3);
+    Vector3d position = CalcBodyToBaseCoordinates (model, q, body_id, point,
+        false);
+    Vector3d position_loaded = CalcBodyToBaseCoordinates (loaded, q,
+        body_id, point, false);
+    CHECK_ARRAY_CLOSE (position.data(), position_loaded.data(), 3,
+        TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36, BinaryModelRoundTripEmulated) {
+  std::vector<char> buffer;
+  BinaryModelWriteToBuffer (*model_emulated, buffer);
+
+  Model loaded;
+  BinaryModelReadFromBuffer (&buffer[0], buffer.size(), &loaded);
+
+  CheckModelsEqual (*model_emulated, loaded);
+}
+
+TEST_FIXTURE (Human36, BinaryModelRoundTrip3Dof) {
+  std::vector<char> buffer;
+  BinaryModelWriteToBuffer (*model_3dof, buffer);
+
+  Model loaded;
+  BinaryModelReadFromBuffer (&buffer[0], buffer.size(), &loaded);
+
+  CheckModelsEqual (*model_3dof, loaded);
+}
+
+TEST (BinaryModelRoundTripSphericalFixedBodies) {
+  Model model;
+  model.gravity = Vector3d (0., -9.81, 0.);
+
+  Body body (1.3, Vector3d (0.1, 0.2, -0.3), Vector3d (0.2, 0.3, 0.4));
+  Body fixed_body (0.4, Vector3d (0., 0.1, 0.), Vector3d (0.1, 0.1, 0.1));
+
+  unsigned int base_id = model.AddBody (0, Xtrans (Vector3d (0., 0.5, 0.)),
+      Joint (JointTypeSpherical), body, "base");
+  model.AddBody (base_id, Xtrans (Vector3d (0.3, 0., 0.)),
+      Joint (SpatialVector (0., 0., 0., 1., 0., 0.)), body, "slider");
+  unsigned int fixed_id = model.AddBody (base_id,
+      Xroty (0.3) * Xtrans (Vector3d (0., 0., 0.2)), Joint (JointTypeFixed),
+      fixed_body, "sensor");
+  model.AddBody (fixed_id, Xtrans (Vector3d (0., 0.1, 0.)),
+      Joint (JointTypeEulerZYX), body, "tip");
+  model.AddBody (0, Xtrans (Vector3d (0.2, 0., 0.)), Joint (JointTypeFixed),
+      fixed_body, "ground_marker");
+
+  std::vector<char> buffer;
+  BinaryModelWriteToBuffer (model, buffer);
+
+  Model loaded;
+  BinaryModelReadFromBuffer (&buffer[0], buffer.size(), &loaded);
+
+  CheckModelsEqual (model, loaded);
+  CHECK_CLOSE (model.mBodies[0].mMass, loaded.mBodies[0].mMass, TEST_PREC);
+  CHECK_CLOSE (model.mBodies[base_id].mMass, loaded.mBodies[base_id].mMass,
+      TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, BinaryModelFileRoundTrip) {
+  const char *filename = "BinaryModelTests.rbdlbin";
+  BinaryModelWriteToFile (*model_emulated, filename);
+
+  Model loaded;
+  BinaryModelReadFromFile (filename, &loaded);
+  std::remove (filename);
+
+  CheckModelsEqual (*model_emulated, loaded);
+}
+
+TEST_FIXTURE (Human36, BinaryModelInvalidBuffer) {
+  std::vector<char> buffer;
+  BinaryModelWriteToBuffer (*model_emulated, buffer);
+
+  std::vector<char> wrong_magic (buffer);
+  wrong_magic[0] = 'X';
+  Model model_magic;
+  CHECK_THROW (BinaryModelReadFromBuffer (&wrong_magic[0],
+        wrong_magic.size(), &model_magic), Errors::RBDLFileParseError);
+
+  // the version follows the 8 bytes of the magic string
+  std::vector<char> wrong_version (buffer);
+  wrong_version[8] = wrong_version[8] + 1;
+  Model model_version;
+  CHECK_THROW (BinaryModelReadFromBuffer (&wrong_version[0],
+        wrong_version.size(), &model_version), Errors::RBDLFileParseError);
+
+  Model model_truncated;
+  CHECK_THROW (BinaryModelReadFromBuffer (&buffer[0], buffer.size() / 2,
+        &model_truncated), Errors::RBDLFileParseError);
+
+  CHECK_THROW (BinaryModelReadFromBuffer (&buffer[0], buffer.size(),
+        model_3dof), Errors::RBDLInvalidParameterError);
+
+  Model model_missing;
+  CHECK_THROW (BinaryModelReadFromFile ("does_not_exist.rbdlbin",
+        &model_missing), Errors::RBDLInvalidFileError);
+}
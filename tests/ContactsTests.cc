@@ -970,3 +970,198 @@ TEST_FIXTURE (Human36, ForwardDynamicsContactsImpulses) {
   CHECK_ARRAY_CLOSE (Vector3d(0., 0., 0.).data(), heel_left_velocity.data(), 3, TEST_PREC);
   CHECK_ARRAY_CLOSE (Vector3d(0., 0., 0.).data(), heel_right_velocity.data(), 3, TEST_PREC);
 }
+
+struct PointMassOnGround {
+  PointMassOnGround() {
+    ClearLogOutput();
+    model = new Model;
+    model->gravity = Vector3d (0., -9.81, 0.);
+
+    mass = 2.;
+    body_id = model->AddBody (0, SpatialTransform(),
+        Joint (JointTypeTranslationXYZ),
+        Body (mass, Vector3d (0., 0., 0.), Vector3d (1., 1., 1.)));
+
+    // the first normal of the contact is the unilateral contact normal, the
+    // remaining ones are the friction directions
+    unsigned int contact_row = constraint_set.AddContactConstraint (body_id,
+        Vector3d::Zero(), Vector3d (0., 1., 0.));
+    constraint_set.AddContactConstraint (body_id,
+        Vector3d::Zero(), Vector3d (1., 0., 0.));
+    constraint_set.AddContactConstraint (body_id,
+        Vector3d::Zero(), Vector3d (0., 0., 1.));
+    contact_group = constraint_set.getGroupIndexByAssignedId (contact_row);
+    constraint_set.Bind (*model);
+
+    Q = VectorNd::Zero (model->dof_count);
+    QDot = VectorNd::Zero (model->dof_count);
+    QDDot = VectorNd::Zero (model->dof_count);
+    Tau = VectorNd::Zero (model->dof_count);
+  }
+  ~PointMassOnGround() {
+    delete model;
+  }
+
+  Model *model;
+  double mass;
+  unsigned int body_id;
+  unsigned int contact_group;
+  ConstraintSet constraint_set;
+
+  VectorNd Q;
+  VectorNd QDot;
+  VectorNd QDDot;
+  VectorNd Tau;
+};
+
+TEST_FIXTURE (PointMassOnGround, ForwardDynamicsContactsPGSSticking) {
+  Tau[0] = 5.;
+
+  ConstraintSet constraint_set_kokkevis = constraint_set.Copy();
+  constraint_set_kokkevis.Bind (*model);
+  VectorNd QDDot_kokkevis = VectorNd::Zero (model->dof_count);
+
+  ForwardDynamicsContactsKokkevis (*model, Q, QDot, Tau,
+      constraint_set_kokkevis, QDDot_kokkevis);
+  ForwardDynamicsContactsPGS (*model, Q, QDot, Tau, constraint_set, QDDot);
+
+  CHECK_ARRAY_CLOSE (Vector3d (mass * 9.81, -5., 0.).data(),
+      constraint_set.force.data(), 3, TEST_PREC);
+  CHECK_ARRAY_CLOSE (constraint_set_kokkevis.force.data(),
+      constraint_set.force.data(), 3, TEST_PREC);
+  CHECK_ARRAY_CLOSE (QDDot_kokkevis.data(), QDDot.data(), 3, TEST_PREC);
+}
+
+TEST_FIXTURE (PointMassOnGround, ForwardDynamicsContactsPGSSliding) {
+  Tau[0] = 5.;
+  constraint_set.setFrictionCoefficient (contact_group, 0.1);
+
+  ForwardDynamicsContactsPGS (*model, Q, QDot, Tau, constraint_set, QDDot);
+
+  double normal_force = mass * 9.81;
+  CHECK_ARRAY_CLOSE (Vector3d (normal_force, -0.1 * normal_force, 0.).data(),
+      constraint_set.force.data(), 3, TEST_PREC);
+  CHECK_ARRAY_CLOSE (Vector3d ((5. - 0.1 * normal_force) / mass, 0., 0.).data(),
+      QDDot.data(), 3, TEST_PREC);
+}
+
+TEST_FIXTURE (PointMassOnGround, ForwardDynamicsContactsPGSSeparating) {
+  Tau[0] = 5.;
+  Tau[1] = 30.;
+  constraint_set.setFrictionCoefficient (contact_group, 0.5);
+
+  VectorNd QDDot_free = VectorNd::Zero (model->dof_count);
+  ForwardDynamics (*model, Q, QDot, Tau, QDDot_free);
+  ForwardDynamicsContactsPGS (*model, Q, QDot, Tau, constraint_set, QDDot);
+
+  CHECK_ARRAY_CLOSE (Vector3d (0., 0., 0.).data(),
+      constraint_set.force.data(), 3, TEST_PREC);
+  CHECK_ARRAY_CLOSE (QDDot_free.data(), QDDot.data(), 3, TEST_PREC);
+}
+
+TEST_FIXTURE (PointMassOnGround, ForwardDynamicsContactsPGSWarmStart) {
+  Tau[0] = 5.;
+  constraint_set.setFrictionCoefficient (contact_group, 0.1);
+
+  unsigned int cold_iterations =
+    ForwardDynamicsContactsPGS (*model, Q, QDot, Tau, constraint_set, QDDot);
+  VectorNd force_cold = constraint_set.force;
+
+  unsigned int warm_iterations =
+    ForwardDynamicsContactsPGS (*model, Q, QDot, Tau, constraint_set, QDDot);
+
+  CHECK (cold_iterations > 1);
+  CHECK_EQUAL (1u, warm_iterations);
+  CHECK_ARRAY_CLOSE (force_cold.data(), constraint_set.force.data(), 3,
+      TEST_PREC);
+}
+
+TEST_FIXTURE (PointMassOnGround, ForwardDynamicsContactsPGSFrictionErrors) {
+  CHECK_THROW (constraint_set.setFrictionCoefficient (contact_group, -1.),
+      Errors::RBDLError);
+
+  ConstraintSet loop_constraint_set;
+  loop_constraint_set.AddLoopConstraint (body_id, 0, SpatialTransform(),
+      SpatialTransform(), SpatialVector (0., 0., 0., 1., 0., 0.));
+  CHECK_THROW (loop_constraint_set.setFrictionCoefficient (0, 0.5),
+      Errors::RBDLError);
+}
+
+TEST_FIXTURE (Human36, ForwardDynamicsConstraintsDirectSchurComplement) {
+  randomizeStates();
+
+  Vector3d heel_point (-0.03, 0., -0.03);
+
+  ConstraintSet constraint_set_qr;
+  constraint_set_qr.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (1., 0., 0.));
+  constraint_set_qr.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (0., 1., 0.));
+  constraint_set_qr.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (0., 0., 1.));
+  constraint_set_qr.AddContactConstraint (body_id_3dof[BodyFootRight], heel_point, Vector3d (0., 1., 0.));
+  ConstraintSet constraint_set_schur = constraint_set_qr.Copy();
+  constraint_set_schur.SetSolver (LinearSolverLLT);
+  constraint_set_qr.Bind (*model_3dof);
+  constraint_set_schur.Bind (*model_3dof);
+
+  VectorNd qddot_qr (VectorNd::Zero (qddot.size()));
+  VectorNd qddot_schur (VectorNd::Zero (qddot.size()));
+
+  ForwardDynamicsConstraintsDirect (*model_3dof, q, qdot, tau, constraint_set_qr, qddot_qr);
+  ForwardDynamicsConstraintsDirect (*model_3dof, q, qdot, tau, constraint_set_schur, qddot_schur);
+
+  CHECK_ARRAY_CLOSE (qddot_qr.data(), qddot_schur.data(), qddot.size(), TEST_PREC * qddot_qr.norm());
+  CHECK_ARRAY_CLOSE (constraint_set_qr.force.data(), constraint_set_schur.force.data(), constraint_set_qr.size(), TEST_PREC * constraint_set_qr.force.norm());
+
+  VectorNd qdot_plus_qr (VectorNd::Zero (qdot.size()));
+  VectorNd qdot_plus_schur (VectorNd::Zero (qdot.size()));
+
+  ComputeConstraintImpulsesDirect (*model_3dof, q, qdot, constraint_set_qr, qdot_plus_qr);
+  ComputeConstraintImpulsesDirect (*model_3dof, q, qdot, constraint_set_schur, qdot_plus_schur);
+
+  CHECK_ARRAY_CLOSE (qdot_plus_qr.data(), qdot_plus_schur.data(), qdot.size(), TEST_PREC * qdot_plus_qr.norm());
+  CHECK_ARRAY_CLOSE (constraint_set_qr.impulse.data(), constraint_set_schur.impulse.data(), constraint_set_qr.size(), TEST_PREC * constraint_set_qr.impulse.norm());
+}
+
+TEST_FIXTURE (Human36, ForwardDynamicsConstraintsDirectReuseDecomposition) {
+  randomizeStates();
+
+  Vector3d heel_point (-0.03, 0., -0.03);
+
+  ConstraintSet constraint_set;
+  constraint_set.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (1., 0., 0.));
+  constraint_set.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (0., 1., 0.));
+  constraint_set.AddContactConstraint (body_id_3dof[BodyFootLeft], heel_point, Vector3d (0., 0., 1.));
+  ConstraintSet constraint_set_fresh = constraint_set.Copy();
+  constraint_set.Bind (*model_3dof);
+
+  LinearSolver solvers[2] = { LinearSolverColPivHouseholderQR, LinearSolverLLT };
+  VectorNd qdot_plus (VectorNd::Zero (qdot.size()));
+  VectorNd qdot_plus_fresh (VectorNd::Zero (qdot.size()));
+  VectorNd qddot_fresh (VectorNd::Zero (qddot.size()));
+
+  for (unsigned int s = 0; s < 2; s++) {
+    constraint_set.SetSolver (solvers[s]);
+    constraint_set_fresh.SetSolver (solvers[s]);
+
+    // impact followed by the dynamics at the same configuration, then a new
+    // configuration
+    for (unsigned int step = 0; step < 3; step++) {
+      if (step == 2) {
+        q[0] += 0.1;
+      }
+
+      ConstraintSet fresh = constraint_set_fresh.Copy();
+      fresh.Bind (*model_3dof);
+
+      ComputeConstraintImpulsesDirect (*model_3dof, q, qdot, constraint_set, qdot_plus);
+      ComputeConstraintImpulsesDirect (*model_3dof, q, qdot, fresh, qdot_plus_fresh);
+      CHECK_ARRAY_CLOSE (qdot_plus_fresh.data(), qdot_plus.data(), qdot.size(), TEST_PREC);
+
+      ForwardDynamicsConstraintsDirect (*model_3dof, q, qdot_plus, tau, constraint_set, qddot);
+      ForwardDynamicsConstraintsDirect (*model_3dof, q, qdot_plus, tau, fresh, qddot_fresh);
+      CHECK_ARRAY_CLOSE (qddot_fresh.data(), qddot.data(), qddot.size(), TEST_PREC);
+      CHECK_ARRAY_CLOSE (fresh.force.data(), constraint_set.force.data(), constraint_set.size(), TEST_PREC);
+
+      CHECK_EQUAL (solvers[s], constraint_set.A_factorized_solver);
+    }
+  }
+}
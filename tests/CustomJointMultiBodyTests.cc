@@ -852,6 +852,17 @@ TEST_FIXTURE (CustomJointMultiBodyFixture, CompositeRigidBodyAlgorithm) {
                       qddot_crba_cus.data(),
                       dof,
                       TEST_PREC);
+
+    SparseJointSpaceMatrix h_cus_sparse;
+    CompositeRigidBodyAlgorithmSparse (custom_model.at(idx),
+                                       q.at(idx),
+                                       h_cus_sparse);
+    MatrixNd h_cus_sparse_dense = h_cus_sparse.toMatrix();
+
+    CHECK_ARRAY_CLOSE(h_ref.data(),
+                      h_cus_sparse_dense.data(),
+                      dof * dof,
+                      TEST_PREC);
   }
 }
 
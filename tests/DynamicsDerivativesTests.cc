@@ -0,0 +1,143 @@
+#include <UnitTest++.h>
+
+#include <iostream>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Dynamics.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+const double TEST_PREC = 1.0e-5;
+const double FD_STEP = 1.0e-5;
+
+TEST_FIXTURE (Human36, InverseDynamicsDerivativesFiniteDifferences) {
+  randomizeStates();
+
+  Model &model = *model_emulated;
+  unsigned int dof_count = model.dof_count;
+
+  MatrixNd dTau_dQ;
+  MatrixNd dTau_dQDot;
+  InverseDynamicsDerivatives (model, q, qdot, qddot, dTau_dQ, dTau_dQDot);
+
+  CHECK_EQUAL (dof_count, dTau_dQ.rows());
+  CHECK_EQUAL (dof_count, dTau_dQ.cols());
+
+  VectorNd tau_plus (VectorNd::Zero (dof_count));
+  VectorNd tau_minus (VectorNd::Zero (dof_count));
+
+  for (unsigned int k = 0; k < dof_count; k++) {
+    VectorNd q_plus = q;
+    VectorNd q_minus = q;
+    q_plus[k] += FD_STEP;
+    q_minus[k] -= FD_STEP;
+
+    InverseDynamics (model, q_plus, qdot, qddot, tau_plus);
+    InverseDynamics (model, q_minus, qdot, qddot, tau_minus);
+    VectorNd column_fd = (tau_plus - tau_minus) / (2. * FD_STEP);
+    VectorNd column = dTau_dQ.col(k);
+
+    CHECK_ARRAY_CLOSE (column_fd.data(), column.data(), dof_count,
+        TEST_PREC);
+
+    VectorNd qdot_plus = qdot;
+    VectorNd qdot_minus = qdot;
+    qdot_plus[k] += FD_STEP;
+    qdot_minus[k] -= FD_STEP;
+
+    InverseDynamics (model, q, qdot_plus, qddot, tau_plus);
+    InverseDynamics (model, q, qdot_minus, qddot, tau_minus);
+    column_fd = (tau_plus - tau_minus) / (2. * FD_STEP);
+    column = dTau_dQDot.col(k);
+
+    CHECK_ARRAY_CLOSE (column_fd.data(), column.data(), dof_count,
+        TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36, ForwardDynamicsDerivativesFiniteDifferences) {
+  randomizeStates();
+
+  Model &model = *model_emulated;
+  unsigned int dof_count = model.dof_count;
+
+  VectorNd qddot_derivatives (VectorNd::Zero (dof_count));
+  MatrixNd dQDDot_dQ;
+  MatrixNd dQDDot_dQDot;
+  MatrixNd dQDDot_dTau;
+  ForwardDynamicsDerivatives (model, q, qdot, tau, qddot_derivatives,
+      dQDDot_dQ, dQDDot_dQDot, dQDDot_dTau);
+
+  ForwardDynamics (model, q, qdot, tau, qddot);
+  CHECK_ARRAY_CLOSE (qddot.data(), qddot_derivatives.data(), dof_count,
+      1.0e-10);
+
+  VectorNd qddot_plus (VectorNd::Zero (dof_count));
+  VectorNd qddot_minus (VectorNd::Zero (dof_count));
+
+  for (unsigned int k = 0; k < dof_count; k++) {
+    VectorNd q_plus = q;
+    VectorNd q_minus = q;
+    q_plus[k] += FD_STEP;
+    q_minus[k] -= FD_STEP;
+
+    ForwardDynamics (model, q_plus, qdot, tau, qddot_plus);
+    ForwardDynamics (model, q_minus, qdot, tau, qddot_minus);
+    VectorNd column_fd = (qddot_plus - qddot_minus) / (2. * FD_STEP);
+    VectorNd column = dQDDot_dQ.col(k);
+
+    CHECK_ARRAY_CLOSE (column_fd.data(), column.data(), dof_count,
+        TEST_PREC);
+
+    VectorNd qdot_plus = qdot;
+    VectorNd qdot_minus = qdot;
+    qdot_plus[k] += FD_STEP;
+    qdot_minus[k] -= FD_STEP;
+
+    ForwardDynamics (model, q, qdot_plus, tau, qddot_plus);
+    ForwardDynamics (model, q, qdot_minus, tau, qddot_minus);
+    column_fd = (qddot_plus - qddot_minus) / (2. * FD_STEP);
+    column = dQDDot_dQDot.col(k);
+
+    CHECK_ARRAY_CLOSE (column_fd.data(), column.data(), dof_count,
+        TEST_PREC);
+  }
+
+  MatrixNd H (MatrixNd::Zero (dof_count, dof_count));
+  CompositeRigidBodyAlgorithm (model, q, H);
+  MatrixNd identity = MatrixNd::Identity (dof_count, dof_count);
+  MatrixNd H_times_inverse = H * dQDDot_dTau;
+
+  CHECK_ARRAY_CLOSE (identity.data(), H_times_inverse.data(),
+      dof_count * dof_count, 1.0e-10);
+}
+
+TEST_FIXTURE (Human36, DynamicsDerivativesModelData) {
+  randomizeStates();
+
+  ModelData data (*model_emulated);
+
+  MatrixNd dTau_dQ, dTau_dQDot;
+  MatrixNd dTau_dQ_data, dTau_dQDot_data;
+  InverseDynamicsDerivatives (*model_emulated, q, qdot, qddot, dTau_dQ,
+      dTau_dQDot);
+  InverseDynamicsDerivatives (*model_emulated, data, q, qdot, qddot,
+      dTau_dQ_data, dTau_dQDot_data);
+
+  CHECK_ARRAY_CLOSE (dTau_dQ.data(), dTau_dQ_data.data(), dTau_dQ.size(),
+      1.0e-12);
+  CHECK_ARRAY_CLOSE (dTau_dQDot.data(), dTau_dQDot_data.data(),
+      dTau_dQDot.size(), 1.0e-12);
+}
+
+TEST_FIXTURE (Human36, DynamicsDerivativesUnsupportedJoints) {
+  MatrixNd dTau_dQ, dTau_dQDot;
+
+  CHECK_THROW (InverseDynamicsDerivatives (*model_3dof, q, qdot, qddot,
+        dTau_dQ, dTau_dQDot), Errors::RBDLError);
+}
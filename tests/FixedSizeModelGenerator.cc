@@ -0,0 +1,30 @@
+/*
+ * Writes the fixed-size code of the emulated Human36 model that is used by
+ * the FixedSizeModelTests.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "rbdl/rbdl.h"
+#include "rbdl/rbdl_utils.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+
+int main (int argc, char *argv[]) {
+  if (argc != 2) {
+    cerr << "Usage: " << argv[0] << " <header.h>" << endl;
+    return 1;
+  }
+
+  Human36 human36;
+
+  ofstream header (argv[1]);
+  header << Utils::GenerateFixedSizeModelCode (*human36.model_emulated,
+      "Human36FixedSize");
+
+  return header.good() ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#include <UnitTest++.h>
+
+#include <iostream>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Dynamics.h"
+#include "rbdl/rbdl_utils.h"
+
+#include "Human36Fixture.h"
+#include "Human36FixedSize.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+const double TEST_PREC = 1.0e-10;
+
+TEST_FIXTURE (Human36, FixedSizeModelForwardDynamics) {
+  randomizeStates();
+
+  Human36FixedSize fixed_model;
+  CHECK_EQUAL (model_emulated->dof_count, (unsigned int)
+      Human36FixedSize::DofCount);
+
+  Human36FixedSize::VectorQ qddot_fixed;
+  fixed_model.ForwardDynamics (q, qdot, tau, qddot_fixed);
+  ForwardDynamics (*model_emulated, q, qdot, tau, qddot);
+
+  CHECK_ARRAY_CLOSE (qddot.data(), qddot_fixed.data(), qddot.size(),
+      TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, FixedSizeModelInverseDynamics) {
+  randomizeStates();
+
+  Human36FixedSize fixed_model;
+
+  Human36FixedSize::VectorQ tau_fixed;
+  fixed_model.InverseDynamics (q, qdot, qddot, tau_fixed);
+  InverseDynamics (*model_emulated, q, qdot, qddot, tau);
+
+  CHECK_ARRAY_CLOSE (tau.data(), tau_fixed.data(), tau.size(), TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, FixedSizeModelCompositeRigidBodyAlgorithm) {
+  randomizeStates();
+
+  Human36FixedSize fixed_model;
+
+  Human36FixedSize::MatrixQ H_fixed;
+  MatrixNd H (MatrixNd::Zero (model_emulated->dof_count,
+        model_emulated->dof_count));
+  fixed_model.CompositeRigidBodyAlgorithm (q, H_fixed);
+  CompositeRigidBodyAlgorithm (*model_emulated, q, H);
+
+  CHECK_ARRAY_CLOSE (H.data(), H_fixed.data(), H.size(), TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, FixedSizeModelUnsupportedJoint) {
+  CHECK_THROW (Utils::GenerateFixedSizeModelCode (*model_3dof, "Human36"),
+      Errors::RBDLError);
+}
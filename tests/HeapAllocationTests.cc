@@ -0,0 +1,286 @@
+#include <UnitTest++.h>
+
+#include <iostream>
+#include <cstdlib>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Kinematics.h"
+#include "rbdl/Dynamics.h"
+#include "rbdl/Constraints.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+/*
+ * Allocation counting hook
+ *
+ * On glibc based systems malloc(), calloc(), and realloc() of this
+ * executable replace the ones of the C library. While counting is enabled
+ * every call increments a counter before the request is forwarded to the C
+ * library. As both operator new and Eigen obtain their memory through
+ * malloc() this catches all heap allocations of the library.
+ *
+ * On other systems allocations are not counted and the tests that rely on
+ * it always pass.
+ */
+#if defined(__GLIBC__)
+#define RBDL_COUNT_ALLOCATIONS
+
+extern "C" {
+  void *__libc_malloc (size_t size);
+  void *__libc_calloc (size_t count, size_t size);
+  void *__libc_realloc (void *ptr, size_t size);
+}
+#endif
+
+static bool allocation_counting_enabled = false;
+static unsigned int allocation_count = 0;
+
+#ifdef RBDL_COUNT_ALLOCATIONS
+extern "C" {
+  void *malloc (size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_malloc (size);
+  }
+
+  void *calloc (size_t count, size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_calloc (count, size);
+  }
+
+  void *realloc (void *ptr, size_t size) {
+    if (allocation_counting_enabled) {
+      allocation_count++;
+    }
+    return __libc_realloc (ptr, size);
+  }
+}
+#endif
+
+struct AllocationCounter {
+  AllocationCounter() {
+    allocation_count = 0;
+    allocation_counting_enabled = true;
+  }
+  ~AllocationCounter() {
+    allocation_counting_enabled = false;
+  }
+
+  unsigned int count() {
+    allocation_counting_enabled = false;
+    unsigned int result = allocation_count;
+    allocation_counting_enabled = true;
+    return result;
+  }
+};
+
+/// Evaluates the given expression once to warm up and checks that a second
+/// evaluation does not allocate any memory
+#define CHECK_NO_ALLOCATION(expression) \
+  do { \
+    expression; \
+    unsigned int allocations = 0; \
+    { \
+      AllocationCounter counter; \
+      expression; \
+      allocations = counter.count(); \
+    } \
+    if (allocations != 0) { \
+      cerr << "Heap allocation in " << #expression << endl; \
+    } \
+    CHECK_EQUAL (0u, allocations); \
+  } while (0)
+
+#ifdef RBDL_COUNT_ALLOCATIONS
+TEST (AllocationCounterWorks) {
+  unsigned int allocations = 0;
+  {
+    AllocationCounter counter;
+    VectorNd v (VectorNd::Zero (100));
+    allocations = counter.count();
+  }
+
+  CHECK_EQUAL (1u, allocations);
+}
+#endif
+
+TEST_FIXTURE (Human36, KinematicsNoAllocation) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+  unsigned int *body_ids[2] = { body_id_emulated, body_id_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    Model &model = *models[m];
+    unsigned int body_id = body_ids[m][BodyFootLeft];
+    Vector3d point (0.1, -0.2, 0.3);
+    Vector3d result;
+    Matrix3d orientation;
+    SpatialVector result_6d;
+    MatrixNd G3 (MatrixNd::Zero (3, model.qdot_size));
+    MatrixNd G6 (MatrixNd::Zero (6, model.qdot_size));
+    std::vector<unsigned int> point_body_ids (2, body_id);
+    std::vector<Vector3d> point_positions (2, point);
+    MatrixNd G_stacked (MatrixNd::Zero (6, model.qdot_size));
+
+    CHECK_NO_ALLOCATION (UpdateKinematics (model, q, qdot, qddot));
+    CHECK_NO_ALLOCATION (UpdateKinematicsCustom (model, &q, NULL, NULL));
+    CHECK_NO_ALLOCATION (UpdateKinematicsCustom (model, &q, &qdot, NULL));
+    CHECK_NO_ALLOCATION (UpdateKinematicsCached (model, &q, &qdot, &qddot));
+    CHECK_NO_ALLOCATION (UpdateKinematicsChain (model, q, body_id));
+    CHECK_NO_ALLOCATION (result = CalcBodyToBaseCoordinates (model, q,
+          body_id, point));
+    CHECK_NO_ALLOCATION (result = CalcBaseToBodyCoordinates (model, q,
+          body_id, point));
+    CHECK_NO_ALLOCATION (orientation = CalcBodyWorldOrientation (model, q,
+          body_id));
+    CHECK_NO_ALLOCATION (CalcPointJacobian (model, q, body_id, point, G3));
+    CHECK_NO_ALLOCATION (CalcPointJacobian6D (model, q, body_id, point, G6));
+    CHECK_NO_ALLOCATION (CalcBodySpatialJacobian (model, q, body_id, G6));
+    CHECK_NO_ALLOCATION (CalcPointJacobians (model, q, point_body_ids,
+          point_positions, G_stacked));
+    CHECK_NO_ALLOCATION (result = CalcPointVelocity (model, q, qdot, body_id,
+          point));
+    CHECK_NO_ALLOCATION (result_6d = CalcPointVelocity6D (model, q, qdot,
+          body_id, point));
+    CHECK_NO_ALLOCATION (result = CalcPointAcceleration (model, q, qdot,
+          qddot, body_id, point));
+    CHECK_NO_ALLOCATION (result_6d = CalcPointAcceleration6D (model, q, qdot,
+          qddot, body_id, point));
+  }
+}
+
+TEST_FIXTURE (Human36, DynamicsNoAllocation) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    Model &model = *models[m];
+    MatrixNd H (MatrixNd::Zero (model.qdot_size, model.qdot_size));
+    SparseJointSpaceMatrix H_sparse (model);
+
+    CHECK_NO_ALLOCATION (InverseDynamics (model, q, qdot, qddot, tau));
+    CHECK_NO_ALLOCATION (NonlinearEffects (model, q, qdot, tau));
+    CHECK_NO_ALLOCATION (CompositeRigidBodyAlgorithm (model, q, H));
+    CHECK_NO_ALLOCATION (CompositeRigidBodyAlgorithmSparse (model, q,
+          H_sparse));
+    CHECK_NO_ALLOCATION (ForwardDynamics (model, q, qdot, tau, qddot));
+    CHECK_NO_ALLOCATION (CalcMInvTimesTau (model, q, tau, qddot));
+  }
+}
+
+TEST_FIXTURE (Human36, InverseKinematicsNoAllocation) {
+  randomizeStates();
+
+  Model &model = *model_emulated;
+  UpdateKinematicsCustom (model, &q, NULL, NULL);
+
+  InverseKinematicsConstraintSet cs;
+  cs.AddPointConstraint (body_id_emulated[BodyFootLeft],
+      Vector3d (0.1, 0., 0.), CalcBodyToBaseCoordinates (model, q,
+        body_id_emulated[BodyFootLeft], Vector3d (0.1, 0., 0.), false));
+  cs.AddFullConstraint (body_id_emulated[BodyHandRight], Vector3d::Zero(),
+      CalcBodyToBaseCoordinates (model, q, body_id_emulated[BodyHandRight],
+        Vector3d::Zero(), false),
+      CalcBodyWorldOrientation (model, q, body_id_emulated[BodyHandRight],
+        false));
+
+  VectorNd qinit (VectorNd::Zero (model.q_size));
+  VectorNd qres (VectorNd::Zero (model.q_size));
+
+  CHECK_NO_ALLOCATION (InverseKinematicsLM (model, qinit, cs, qres));
+}
+
+TEST_FIXTURE (Human36, ConstraintsNoAllocation) {
+  randomizeStates();
+
+  Model &model = *model_3dof;
+
+  ConstraintSet cs;
+  cs.AddContactConstraint (body_id_3dof[BodyFootLeft], Vector3d::Zero(),
+      Vector3d (1., 0., 0.));
+  cs.AddContactConstraint (body_id_3dof[BodyFootLeft], Vector3d::Zero(),
+      Vector3d (0., 1., 0.));
+  cs.AddContactConstraint (body_id_3dof[BodyFootLeft], Vector3d::Zero(),
+      Vector3d (0., 0., 1.));
+  cs.AddContactConstraint (body_id_3dof[BodyFootRight], Vector3d::Zero(),
+      Vector3d (0., 0., 1.));
+  cs.Bind (model);
+
+  VectorNd err (VectorNd::Zero (cs.size()));
+  MatrixNd G (MatrixNd::Zero (cs.size(), model.qdot_size));
+  VectorNd qdot_plus (VectorNd::Zero (model.qdot_size));
+
+  CHECK_NO_ALLOCATION (CalcConstraintsPositionError (model, q, cs, err));
+  CHECK_NO_ALLOCATION (CalcConstraintsJacobian (model, q, cs, G));
+  CHECK_NO_ALLOCATION (CalcConstraintsVelocityError (model, q, qdot, cs,
+        err));
+  CHECK_NO_ALLOCATION (CalcConstrainedSystemVariables (model, q, qdot, tau,
+        cs));
+  CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsDirect (model, q, qdot, tau,
+        cs, qddot));
+  CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsRangeSpaceSparse (model, q,
+        qdot, tau, cs, qddot));
+  CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsNullSpace (model, q, qdot,
+        tau, cs, qddot));
+  CHECK_NO_ALLOCATION (ForwardDynamicsContactsKokkevis (model, q, qdot, tau,
+        cs, qddot));
+  CHECK_NO_ALLOCATION (ComputeConstraintImpulsesDirect (model, q, qdot, cs,
+        qdot_plus));
+  CHECK_NO_ALLOCATION (ComputeConstraintImpulsesRangeSpaceSparse (model, q,
+        qdot, cs, qdot_plus));
+  CHECK_NO_ALLOCATION (ComputeConstraintImpulsesNullSpace (model, q, qdot,
+        cs, qdot_plus));
+
+  cs.SetSolver (LinearSolverLLT);
+  CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsDirect (model, q, qdot, tau,
+        cs, qddot));
+  CHECK_NO_ALLOCATION (ComputeConstraintImpulsesDirect (model, q, qdot, cs,
+        qdot_plus));
+}
+
+TEST_FIXTURE (Human36, LoopConstraintsNoAllocation) {
+  randomizeStates();
+
+  Model &model = *model_emulated;
+
+  ConstraintSet cs;
+  cs.AddLoopConstraint (body_id_emulated[BodyHandLeft],
+      body_id_emulated[BodyHandRight], SpatialTransform(), SpatialTransform(),
+      SpatialVector (0., 0., 0., 1., 0., 0.), true);
+  cs.AddLoopConstraint (body_id_emulated[BodyHandLeft],
+      body_id_emulated[BodyHandRight], SpatialTransform(), SpatialTransform(),
+      SpatialVector (0., 0., 0., 0., 1., 0.), true);
+  cs.Bind (model);
+
+  VectorNd qdot_plus (VectorNd::Zero (model.qdot_size));
+
+  LinearSolver solvers[3] = {
+    LinearSolverPartialPivLU,
+    LinearSolverColPivHouseholderQR,
+    LinearSolverHouseholderQR
+  };
+
+  for (unsigned int s = 0; s < 3; s++) {
+    cs.SetSolver (solvers[s]);
+
+    CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsDirect (model, q, qdot,
+          tau, cs, qddot));
+    CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsNullSpace (model, q, qdot,
+          tau, cs, qddot));
+    CHECK_NO_ALLOCATION (ComputeConstraintImpulsesDirect (model, q, qdot, cs,
+          qdot_plus));
+  }
+
+  CHECK_NO_ALLOCATION (ForwardDynamicsConstraintsRangeSpaceSparse (model, q,
+        qdot, tau, cs, qddot));
+}
@@ -755,6 +755,82 @@ TEST_FIXTURE(SpatialBipedFloatingBase, TestCorrectness) {
 }
 
 
+TEST_FIXTURE(SpatialBipedFloatingBase, TestRecursiveMatchesDense) {
+
+  unsigned int n  = unsigned( int( q.rows()));
+  unsigned int nc = unsigned( int( cs.name.size()));
+
+  VectorNd q0 = VectorNd::Zero(n);
+  VectorNd qd0 = VectorNd::Zero(n);
+  VectorNd weights = VectorNd::Constant(n, 1.);
+  VectorNd qddTarget = VectorNd::Zero(n);
+  std::vector<bool> dofActuated(n);
+
+  for(unsigned int i=0; i<n;++i){
+    dofActuated[i] = (i >= 6);
+  }
+
+  q0[2]  = 0.75;
+  q0[7]  =  M_PI*0.25;
+  q0[9]  = -M_PI*0.25;
+  q0[13] = -M_PI*0.25;
+  q0[15] =  M_PI*0.25;
+
+  for(unsigned int i=0; i<n; ++i){
+    qd0[i] = 0.1*double(i%5) - 0.2;
+    tau[i] = (i >= 6) ? 3.*double(i%7) - 9. : 0.;
+  }
+
+  bool qAsm=CalcAssemblyQ(model,q0,cs,q,weights);
+  CHECK(qAsm==true);
+  CalcAssemblyQDot(model,q,qd0,cs,qd,weights);
+
+  //There are more constraints than unactuated dofs: use accelerations that
+  //are consistent with the constraints as the target
+  ForwardDynamicsConstraintsDirect(model, q, qd, tau, cs, qddTarget);
+
+  cs.SetActuationMap(model,dofActuated);
+
+  std::vector<SpatialVector> fext(model.mBodies.size(),
+                                  SpatialVector::Zero());
+  fext[idxLeftUpperLeg] = SpatialVector(0.1, -0.2, 0.3, 5., -3., 10.);
+  fext[idxRightFoot]    = SpatialVector(-0.4, 0.2, 0.1, -2., 1., 4.);
+
+  std::vector<SpatialVector> *fextPtr[2] = { NULL, &fext };
+
+  for(unsigned int k=0; k<2; ++k){
+    VectorNd tauIDC = VectorNd::Zero(n);
+    VectorNd qddIDC = VectorNd::Zero(n);
+    InverseDynamicsConstraints(model, q, qd, qddTarget, cs, qddIDC, tauIDC,
+                               fextPtr[k]);
+    VectorNd lambdaIdc = cs.force;
+
+    VectorNd tauRec = VectorNd::Zero(n);
+    VectorNd qddRec = VectorNd::Zero(n);
+    InverseDynamicsConstraintsRecursive(model, q, qd, qddTarget, cs,
+                                        qddRec, tauRec, fextPtr[k]);
+
+    for(unsigned int i=0; i<n;++i){
+      CHECK_CLOSE(qddIDC[i], qddRec[i], 1e-9);
+      CHECK_CLOSE(tauIDC[i], tauRec[i], 1e-9);
+      if(dofActuated[i]==false){
+        CHECK_EQUAL(0., tauRec[i]);
+      }
+    }
+    for(unsigned int i=0; i<nc;++i){
+      CHECK_CLOSE(lambdaIdc[i], cs.force[i], 1e-9);
+    }
+
+    //The result must satisfy the constrained equations of motion
+    VectorNd qddFwd = VectorNd::Zero(n);
+    ForwardDynamicsConstraintsDirect(model, q, qd, tauRec, cs, qddFwd,
+                                     fextPtr[k]);
+    for(unsigned int i=0; i<n;++i){
+      CHECK_CLOSE(qddRec[i], qddFwd[i], 1e-9);
+    }
+  }
+}
+
 TEST(CorrectnessTestWithSinglePlanarPendulum){
 
   //With loop constraints
@@ -272,3 +272,200 @@ TEST_FIXTURE ( Human36, ManyBodyFullConstraints ) {
   CHECK_ARRAY_CLOSE (target_orientation4.data(), result_orientation4.data(), 9, TEST_PREC); 
   CHECK_ARRAY_CLOSE (target_orientation5.data(), result_orientation5.data(), 9, TEST_PREC); 
 }
+
+TEST_FIXTURE ( Human36, InverseKinematicsLMManyBodyFullConstraints ) {
+  randomizeStates();
+
+  unsigned int body_ids[5] = {
+    body_id_emulated[BodyFootRight],
+    body_id_emulated[BodyFootLeft],
+    body_id_emulated[BodyHandRight],
+    body_id_emulated[BodyHandLeft],
+    body_id_emulated[BodyHead]
+  };
+  Vector3d local_points[5] = {
+    Vector3d (1., 0., 0.),
+    Vector3d (-1., 0., 0.),
+    Vector3d (0., 1., 0.),
+    Vector3d (1., 0., 1.),
+    Vector3d (0., 0., -1.)
+  };
+
+  InverseKinematicsConstraintSet cs;
+  UpdateKinematicsCustom (*model, &q, NULL, NULL);
+  for (unsigned int k = 0; k < 5; k++) {
+    cs.AddFullConstraint (body_ids[k], local_points[k],
+        CalcBodyToBaseCoordinates (*model, q, body_ids[k], local_points[k],
+          false),
+        CalcBodyWorldOrientation (*model, q, body_ids[k], false));
+  }
+
+  VectorNd qinit (VectorNd::Zero (model->q_size));
+  VectorNd qres (qinit);
+
+  CHECK (InverseKinematicsLM (*model, qinit, cs, qres));
+  CHECK_CLOSE (0., cs.error_norm, cs.constraint_tol);
+  CHECK (cs.damping > 0.);
+
+  UpdateKinematicsCustom (*model, &qres, NULL, NULL);
+  for (unsigned int k = 0; k < 5; k++) {
+    Vector3d position = CalcBodyToBaseCoordinates (*model, qres, body_ids[k],
+        local_points[k], false);
+    Matrix3d orientation = CalcBodyWorldOrientation (*model, qres,
+        body_ids[k], false);
+    CHECK_ARRAY_CLOSE (cs.target_positions[k].data(), position.data(), 3,
+        TEST_PREC);
+    CHECK_ARRAY_CLOSE (cs.target_orientations[k].data(), orientation.data(),
+        9, TEST_PREC);
+  }
+
+  // warm start from the solution converges immediately
+  VectorNd qres_warm (qres);
+  CHECK (InverseKinematicsLM (*model, qres, cs, qres_warm));
+  CHECK_EQUAL (0u, cs.num_steps);
+}
+
+TEST_FIXTURE ( Human36, InverseKinematicsLMPositionConstraintTypes ) {
+  randomizeStates();
+
+  UpdateKinematicsCustom (*model_3dof, &q, NULL, NULL);
+  double mass;
+  Vector3d com;
+  Utils::CalcCenterOfMass (*model_3dof, q, qdot, NULL, mass, com);
+
+  unsigned int foot_r = body_id_3dof[BodyFootRight];
+  unsigned int foot_l = body_id_3dof[BodyFootLeft];
+  unsigned int hand_r = body_id_3dof[BodyHandRight];
+  unsigned int pelvis = body_id_3dof[BodyPelvis];
+  Vector3d point (0.1, 0.2, -0.1);
+
+  InverseKinematicsConstraintSet cs;
+  cs.AddPointConstraint (foot_r, point,
+      CalcBodyToBaseCoordinates (*model_3dof, q, foot_r, point, false));
+  cs.AddPointConstraintXY (foot_l, point,
+      CalcBodyToBaseCoordinates (*model_3dof, q, foot_l, point, false));
+  cs.AddPointConstraintZ (foot_l, point,
+      CalcBodyToBaseCoordinates (*model_3dof, q, foot_l, point, false), 2.);
+  cs.AddOrientationConstraint (hand_r,
+      CalcBodyWorldOrientation (*model_3dof, q, hand_r, false), 0.5);
+  cs.AddPointConstraintCoMXY (pelvis, com);
+
+  VectorNd qinit (VectorNd::Zero (model_3dof->q_size));
+  VectorNd qres (qinit);
+
+  CHECK (InverseKinematicsLM (*model_3dof, qinit, cs, qres));
+  CHECK_CLOSE (0., cs.error_norm, cs.constraint_tol);
+
+  Vector3d com_res;
+  Utils::CalcCenterOfMass (*model_3dof, qres, qdot, NULL, mass, com_res);
+  CHECK_ARRAY_CLOSE (com.data(), com_res.data(), 2, TEST_PREC);
+
+  // the same constraints and residuals as InverseKinematics()
+  VectorNd qres_ref (qinit);
+  InverseKinematics (*model_3dof, qres, cs, qres_ref);
+  CHECK_ARRAY_CLOSE (qres.data(), qres_ref.data(), model_3dof->q_size,
+      TEST_PREC);
+}
+
+TEST ( InverseKinematicsLMSphericalJoint ) {
+  Model model;
+  Body body (1., Vector3d (0., 0., -0.5), Vector3d (0.1, 0.1, 0.1));
+  unsigned int upper = model.AddBody (0, SpatialTransform(),
+      Joint (JointTypeSpherical), body);
+  unsigned int lower = model.AddBody (upper, Xtrans (Vector3d (0., 0., -1.)),
+      Joint (JointTypeRevoluteY), body);
+
+  VectorNd q (VectorNd::Zero (model.q_size));
+  model.SetQuaternion (upper, Quaternion::fromAxisAngle (
+        Vector3d (1., 1., 0.).normalized(), 0.7), q);
+  q[3] = 0.4;
+
+  Vector3d point (0., 0., -1.);
+  InverseKinematicsConstraintSet cs;
+  cs.AddPointConstraint (lower, point,
+      CalcBodyToBaseCoordinates (model, q, lower, point));
+  cs.AddOrientationConstraint (upper,
+      CalcBodyWorldOrientation (model, q, upper));
+
+  VectorNd qinit (VectorNd::Zero (model.q_size));
+  model.SetQuaternion (upper, Quaternion(), qinit);
+  VectorNd qres (qinit);
+
+  CHECK (InverseKinematicsLM (model, qinit, cs, qres));
+  CHECK_CLOSE (0., cs.error_norm, cs.constraint_tol);
+  CHECK_CLOSE (1., model.GetQuaternion (upper, qres).norm(), TEST_PREC);
+  CHECK_ARRAY_CLOSE (q.data(), qres.data(), model.q_size, 1.0e-10);
+}
+
+TEST_FIXTURE ( Human36, InverseKinematicsTrajectory ) {
+  randomizeStates();
+
+  unsigned int body_ids[4] = {
+    body_id_emulated[BodyFootRight],
+    body_id_emulated[BodyFootLeft],
+    body_id_emulated[BodyHandRight],
+    body_id_emulated[BodyHandLeft]
+  };
+  Vector3d local_points[3] = {
+    Vector3d (0.1, 0., 0.),
+    Vector3d (0., 0.1, 0.),
+    Vector3d (0., 0., 0.1)
+  };
+
+  InverseKinematicsConstraintSet cs;
+  for (unsigned int k = 0; k < 4; k++) {
+    for (unsigned int p = 0; p < 3; p++) {
+      cs.AddPointConstraint (body_ids[k], local_points[p], Vector3d::Zero());
+    }
+  }
+  // also include the root such that the pose is fully determined
+  for (unsigned int p = 0; p < 3; p++) {
+    cs.AddPointConstraint (body_id_emulated[BodyPelvis], local_points[p],
+        Vector3d::Zero());
+  }
+
+  unsigned int num_frames = 40;
+  MatrixNd targets (3 * cs.body_ids.size(), num_frames);
+  for (unsigned int f = 0; f < num_frames; f++) {
+    VectorNd qf (q * sin (0.05 * f));
+    UpdateKinematicsCustom (*model, &qf, NULL, NULL);
+    for (unsigned int k = 0; k < cs.body_ids.size(); k++) {
+      targets.block<3,1>(3 * k, f) = CalcBodyToBaseCoordinates (*model, qf,
+          cs.body_ids[k], cs.body_points[k], false);
+    }
+  }
+
+  VectorNd qinit (VectorNd::Zero (model->q_size));
+  MatrixNd qs_sequential;
+  MatrixNd qs_parallel;
+  VectorNd error_norms;
+
+  CHECK_EQUAL (num_frames, InverseKinematicsTrajectory (*model, qinit, cs,
+        targets, qs_sequential, 1, &error_norms));
+  CHECK_EQUAL (num_frames, error_norms.size());
+  CHECK (error_norms.maxCoeff() < cs.constraint_tol);
+
+  CHECK_EQUAL (num_frames, InverseKinematicsTrajectory (*model, qinit, cs,
+        targets, qs_parallel, 3, &error_norms));
+  CHECK (error_norms.maxCoeff() < cs.constraint_tol);
+
+  CHECK_EQUAL (model->q_size, qs_parallel.rows());
+  CHECK_EQUAL (num_frames, qs_parallel.cols());
+
+  // The model is redundant with respect to the markers, so compare the
+  // marker positions instead of the states
+  for (unsigned int f = 0; f < num_frames; f++) {
+    VectorNd qf (qs_parallel.col(f));
+    UpdateKinematicsCustom (*model, &qf, NULL, NULL);
+    for (unsigned int k = 0; k < cs.body_ids.size(); k++) {
+      Vector3d position = CalcBodyToBaseCoordinates (*model, qf,
+          cs.body_ids[k], cs.body_points[k], false);
+      Vector3d target (targets.block<3,1>(3 * k, f));
+      CHECK_ARRAY_CLOSE (target.data(), position.data(), 3, TEST_PREC);
+    }
+  }
+
+  MatrixNd targets_wrong (3, num_frames);
+  CHECK_THROW (InverseKinematicsTrajectory (*model, qinit, cs, targets_wrong,
+        qs_parallel), Errors::RBDLSizeMismatchError);
+}
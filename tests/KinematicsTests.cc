@@ -678,3 +678,292 @@ TEST_FIXTURE ( Human36, CalcPointAcceleration6D ) {
 
   CHECK_ARRAY_CLOSE (a_foot_0_ref.data(), a_foot_0.data(), 6, TEST_PREC);
 }
+
+TEST_FIXTURE ( Human36, CalcPointJacobiansMatchesSingle ) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+  unsigned int *body_ids[2] = { body_id_emulated, body_id_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    Model &model = *models[m];
+
+    // several points on the same body, a fixed body, and bodies on
+    // different branches
+    std::vector<unsigned int> point_body_ids;
+    std::vector<Vector3d> point_positions;
+    point_body_ids.push_back (body_ids[m][BodyFootLeft]);
+    point_positions.push_back (Vector3d (0.1, -0.05, 0.));
+    point_body_ids.push_back (body_ids[m][BodyFootLeft]);
+    point_positions.push_back (Vector3d (-0.05, 0.05, 0.));
+    point_body_ids.push_back (body_ids[m][BodyFootRight]);
+    point_positions.push_back (Vector3d (0.1, 0.05, 0.));
+    point_body_ids.push_back (body_ids[m][BodyUpperTrunk]);
+    point_positions.push_back (Vector3d (0.2, 0.1, -0.3));
+    point_body_ids.push_back (body_ids[m][BodyHandRight]);
+    point_positions.push_back (Vector3d (0., 0., -0.1));
+
+    unsigned int point_count = point_body_ids.size();
+    MatrixNd G_stacked (MatrixNd::Zero (3 * point_count, model.qdot_size));
+    CalcPointJacobians (model, q, point_body_ids, point_positions,
+        G_stacked);
+
+    for (unsigned int i = 0; i < point_count; i++) {
+      MatrixNd G_single (MatrixNd::Zero (3, model.qdot_size));
+      CalcPointJacobian (model, q, point_body_ids[i], point_positions[i],
+          G_single);
+
+      MatrixNd G_row = G_stacked.block (3 * i, 0, 3, model.qdot_size);
+      CHECK_ARRAY_CLOSE (G_single.data(), G_row.data(),
+          3 * model.qdot_size, TEST_PREC);
+    }
+  }
+}
+
+TEST_FIXTURE ( Human36, CalcPointJacobiansSizeMismatch ) {
+  std::vector<unsigned int> point_body_ids (2, body_id_3dof[BodyFootLeft]);
+  std::vector<Vector3d> point_positions (1, Vector3d::Zero());
+  MatrixNd G (MatrixNd::Zero (6, model_3dof->qdot_size));
+
+  CHECK_THROW (CalcPointJacobians (*model_3dof, q, point_body_ids,
+        point_positions, G), Errors::RBDLSizeMismatchError);
+}
+
+TEST_FIXTURE ( Human36, BaseMotionSubspaceCacheFollowsQ ) {
+  Model &model = *model_3dof;
+  unsigned int foot_id = body_id_3dof[BodyFootLeft];
+  unsigned int hand_id = body_id_3dof[BodyHandRight];
+  Vector3d point_local (0.1, -0.2, 0.3);
+
+  for (unsigned int k = 0; k < 3; k++) {
+    randomizeStates();
+
+    // the first query fills the cache, the following ones reuse it
+    MatrixNd G_foot (MatrixNd::Zero (6, model.qdot_size));
+    MatrixNd G_hand (MatrixNd::Zero (6, model.qdot_size));
+    CalcPointJacobian6D (model, q, foot_id, point_local, G_foot);
+    CalcPointJacobian6D (model, q, hand_id, point_local, G_hand, false);
+
+    SpatialVector v_foot_ref = CalcPointVelocity6D (model, q, qdot, foot_id,
+        point_local);
+    SpatialVector v_hand_ref = CalcPointVelocity6D (model, q, qdot, hand_id,
+        point_local, false);
+    SpatialVector v_foot_jac = SpatialVector (G_foot * qdot);
+    SpatialVector v_hand_jac = SpatialVector (G_hand * qdot);
+
+    CHECK_ARRAY_CLOSE (v_foot_ref.data(), v_foot_jac.data(), 6, TEST_PREC);
+    CHECK_ARRAY_CLOSE (v_hand_ref.data(), v_hand_jac.data(), 6, TEST_PREC);
+  }
+}
+
+static void CheckKinematicsEqual (const Model &model, const ModelData &data,
+    const ModelData &data_ref, bool velocities, bool accelerations) {
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    CHECK_ARRAY_CLOSE (data_ref.X_base[i].E.data(), data.X_base[i].E.data(),
+        9, TEST_PREC);
+    CHECK_ARRAY_CLOSE (data_ref.X_base[i].r.data(), data.X_base[i].r.data(),
+        3, TEST_PREC);
+    if (velocities) {
+      CHECK_ARRAY_CLOSE (data_ref.v[i].data(), data.v[i].data(), 6,
+          TEST_PREC);
+    }
+    if (accelerations) {
+      CHECK_ARRAY_CLOSE (data_ref.a[i].data(), data.a[i].data(), 6,
+          TEST_PREC);
+    }
+  }
+}
+
+TEST_FIXTURE ( Human36, UpdateKinematicsCachedMatchesCustom ) {
+  Model &model = *model_3dof;
+  ModelData data (model);
+  ModelData data_ref (model);
+
+  randomizeStates();
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+
+  // nothing changed
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    CHECK_EQUAL (0, data.kinematics_cache_updated[i]);
+  }
+
+  // perturbing a knee only updates the subtree of the shank
+  unsigned int knee_index =
+    model.mJoints[body_id_3dof[BodyShankLeft]].q_index;
+  q[knee_index] += 0.1;
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+  for (unsigned int i = 1; i < model.mBodies.size(); i++) {
+    bool in_subtree = false;
+    for (unsigned int j = i; j != 0; j = model.lambda[j]) {
+      in_subtree = in_subtree || j == body_id_3dof[BodyShankLeft];
+    }
+    CHECK_EQUAL (in_subtree, data.kinematics_cache_updated[i] != 0);
+  }
+
+  // velocities and accelerations separately
+  qdot[knee_index] += 0.2;
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+
+  qddot[0] += 0.3;
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+
+  // positions only invalidate the velocities of the changed joints
+  q[0] += 0.1;
+  q[knee_index] -= 0.2;
+  UpdateKinematicsCached (model, data, &q, NULL, NULL);
+  UpdateKinematicsCustom (model, data_ref, &q, NULL, NULL);
+  CheckKinematicsEqual (model, data, data_ref, false, false);
+  CHECK_EQUAL (0, data.kinematics_cache_state[body_id_3dof[BodyFootLeft]]
+      & 2);
+
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+}
+
+TEST_FIXTURE ( Human36, UpdateKinematicsCachedAfterOtherAlgorithms ) {
+  Model &model = *model_3dof;
+  ModelData data (model);
+  ModelData data_ref (model);
+  data.use_kinematics_cache = true;
+
+  randomizeStates();
+  UpdateKinematics (model, data, q, qdot, qddot);
+
+  // InverseDynamics() adds the gravity to the accelerations and
+  // CompositeRigidBodyAlgorithm() evaluates the joints at another state
+  VectorNd q_other (q * 0.5);
+  InverseDynamics (model, data, q, qdot, qddot, tau);
+  MatrixNd H (MatrixNd::Zero (model.qdot_size, model.qdot_size));
+  CompositeRigidBodyAlgorithm (model, data, q_other, H);
+
+  UpdateKinematics (model, data, q, qdot, qddot);
+  UpdateKinematics (model, data_ref, q, qdot, qddot);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+
+  // jacobians use the motion subspaces of the updated bodies
+  unsigned int foot_id = body_id_3dof[BodyFootLeft];
+  Vector3d point_local (0.1, -0.2, 0.3);
+  MatrixNd G (MatrixNd::Zero (6, model.qdot_size));
+  MatrixNd G_ref (MatrixNd::Zero (6, model.qdot_size));
+
+  CalcPointJacobian6D (model, data, q, foot_id, point_local, G);
+  q[0] += 0.3;
+  q[model.mJoints[body_id_3dof[BodyThighLeft]].q_index] -= 0.2;
+  CalcPointJacobian6D (model, data, q, foot_id, point_local, G);
+  CalcPointJacobian6D (model, data_ref, q, foot_id, point_local, G_ref);
+  CHECK_ARRAY_CLOSE (G_ref.data(), G.data(), G.size(), TEST_PREC);
+}
+
+TEST ( UpdateKinematicsCachedSphericalJoint ) {
+  Model model;
+  Body body (1., Vector3d (0.1, 0.2, 0.3), Vector3d (1., 1., 1.));
+  unsigned int ball_id = model.AddBody (0, Xtrans (Vector3d (0., 0., 0.)),
+      Joint (JointTypeSpherical), body);
+  model.AddBody (ball_id, Xtrans (Vector3d (0., 1., 0.)),
+      Joint (SpatialVector (0., 0., 1., 0., 0., 0.)), body);
+
+  ModelData data (model);
+  ModelData data_ref (model);
+
+  VectorNd q (VectorNd::Zero (model.q_size));
+  VectorNd qdot (VectorNd::Zero (model.qdot_size));
+  VectorNd qddot (VectorNd::Zero (model.qdot_size));
+  qdot[0] = 0.4;
+  qdot[3] = -0.7;
+  qddot[1] = 1.1;
+
+  Quaternion quat (0.1, 0.2, 0.3, 0.9);
+  quat /= quat.norm();
+  model.SetQuaternion (ball_id, quat, q);
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+
+  // only the w component changes
+  q[model.multdof3_w_index[ball_id]] *= -1.;
+  UpdateKinematicsCached (model, data, &q, &qdot, &qddot);
+  UpdateKinematicsCustom (model, data_ref, &q, &qdot, &qddot);
+
+  CHECK_EQUAL (7, data.kinematics_cache_updated[ball_id]);
+  CheckKinematicsEqual (model, data, data_ref, true, true);
+}
+
+TEST_FIXTURE ( Human36, UpdateKinematicsChainMatchesFull ) {
+  Model &model = *model_3dof;
+  ModelData data (model);
+  ModelData data_ref (model);
+  unsigned int foot_id = body_id_3dof[BodyFootLeft];
+  unsigned int hand_id = body_id_3dof[BodyHandRight];
+  Vector3d point_local (0.1, -0.2, 0.3);
+
+  randomizeStates();
+  UpdateKinematicsCustom (model, data, &q, NULL, NULL);
+  SpatialTransform X_hand_before = data.X_base[hand_id];
+
+  randomizeStates();
+  UpdateKinematicsChain (model, data, q, foot_id);
+  UpdateKinematicsCustom (model, data_ref, &q, NULL, NULL);
+
+  Vector3d position = CalcBodyToBaseCoordinates (model, data, q, foot_id,
+      point_local, false);
+  Vector3d position_ref = CalcBodyToBaseCoordinates (model, data_ref, q,
+      foot_id, point_local, false);
+  CHECK_ARRAY_CLOSE (position_ref.data(), position.data(), 3, TEST_PREC);
+
+  MatrixNd G (MatrixNd::Zero (6, model.qdot_size));
+  MatrixNd G_ref (MatrixNd::Zero (6, model.qdot_size));
+  CalcPointJacobian6D (model, data, q, foot_id, point_local, G, false);
+  CalcPointJacobian6D (model, data_ref, q, foot_id, point_local, G_ref,
+      false);
+  CHECK_ARRAY_CLOSE (G_ref.data(), G.data(), G.size(), TEST_PREC);
+
+  // bodies on other branches are untouched
+  CHECK_ARRAY_EQUAL (X_hand_before.r.data(), data.X_base[hand_id].r.data(),
+      3);
+
+  std::vector<unsigned int> body_ids;
+  body_ids.push_back (foot_id);
+  body_ids.push_back (hand_id);
+  UpdateKinematicsChain (model, data, q, body_ids);
+
+  Matrix3d orientation = CalcBodyWorldOrientation (model, data, q, hand_id,
+      false);
+  Matrix3d orientation_ref = CalcBodyWorldOrientation (model, data_ref, q,
+      hand_id, false);
+  CHECK_ARRAY_CLOSE (orientation_ref.data(), orientation.data(), 9,
+      TEST_PREC);
+}
+
+TEST ( UpdateKinematicsChainFixedBody ) {
+  Model model;
+  Body body (1., Vector3d (0.1, 0.2, 0.3), Vector3d (1., 1., 1.));
+  Joint joint_rot_z (SpatialVector (0., 0., 1., 0., 0., 0.));
+
+  unsigned int base_id = model.AddBody (0, Xtrans (Vector3d (0., 0., 0.)),
+      joint_rot_z, body);
+  unsigned int link_id = model.AddBody (base_id, Xtrans (Vector3d (1., 0., 0.)),
+      joint_rot_z, body);
+  unsigned int tool_id = model.AddBody (link_id,
+      Xtrans (Vector3d (0., 1., 0.)), Joint (JointTypeFixed), body);
+
+  VectorNd q (VectorNd::Zero (model.q_size));
+  q[0] = 0.3;
+  q[1] = -0.5;
+
+  ModelData data (model);
+  UpdateKinematicsChain (model, data, q, tool_id);
+  Vector3d position = CalcBodyToBaseCoordinates (model, data, q, tool_id,
+      Vector3d (0.2, 0., 0.), false);
+  Vector3d position_ref = CalcBodyToBaseCoordinates (model, q, tool_id,
+      Vector3d (0.2, 0., 0.));
+
+  CHECK_ARRAY_CLOSE (position_ref.data(), position.data(), 3, TEST_PREC);
+}
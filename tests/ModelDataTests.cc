@@ -0,0 +1,102 @@
+#include <UnitTest++.h>
+
+#include <iostream>
+
+#include "rbdl/Logging.h"
+#include "rbdl/Model.h"
+#include "rbdl/Kinematics.h"
+#include "rbdl/Dynamics.h"
+
+#include "Human36Fixture.h"
+
+using namespace std;
+using namespace RigidBodyDynamics;
+using namespace RigidBodyDynamics::Math;
+
+const double TEST_PREC = 1.0e-12;
+
+TEST_FIXTURE (Human36, ModelDataForwardDynamics) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    const Model &shared_model = *models[m];
+    ModelData data (shared_model);
+
+    VectorNd qddot_data (VectorNd::Zero (qddot.size()));
+    ForwardDynamics (shared_model, data, q, qdot, tau, qddot_data);
+    ForwardDynamics (*models[m], q, qdot, tau, qddot);
+
+    CHECK_ARRAY_CLOSE (qddot.data(), qddot_data.data(), qddot.size(),
+        TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36, ModelDataInverseDynamicsAndCRBA) {
+  randomizeStates();
+
+  ModelData data (*model_3dof);
+
+  VectorNd tau_model (VectorNd::Zero (tau.size()));
+  VectorNd tau_data (VectorNd::Zero (tau.size()));
+  InverseDynamics (*model_3dof, q, qdot, qddot, tau_model);
+  InverseDynamics (*model_3dof, data, q, qdot, qddot, tau_data);
+
+  CHECK_ARRAY_CLOSE (tau_model.data(), tau_data.data(), tau.size(),
+      TEST_PREC);
+
+  MatrixNd H_model (MatrixNd::Zero (q.size(), q.size()));
+  MatrixNd H_data (MatrixNd::Zero (q.size(), q.size()));
+  CompositeRigidBodyAlgorithm (*model_3dof, q, H_model);
+  CompositeRigidBodyAlgorithm (*model_3dof, data, q, H_data);
+
+  CHECK_ARRAY_CLOSE (H_model.data(), H_data.data(), q.size() * q.size(),
+      TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, ModelDataPointJacobian) {
+  randomizeStates();
+
+  ModelData data (*model_emulated);
+  unsigned int body_id = body_id_emulated[BodyHandRight];
+  Vector3d point (0.1, 0.2, -0.3);
+
+  MatrixNd G_model (MatrixNd::Zero (3, model_emulated->qdot_size));
+  MatrixNd G_data (MatrixNd::Zero (3, model_emulated->qdot_size));
+  CalcPointJacobian (*model_emulated, q, body_id, point, G_model);
+  CalcPointJacobian (*model_emulated, data, q, body_id, point, G_data);
+
+  CHECK_ARRAY_CLOSE (G_model.data(), G_data.data(), G_model.size(),
+      TEST_PREC);
+
+  Vector3d pos_model = CalcBodyToBaseCoordinates (*model_emulated, q,
+      body_id, point);
+  Vector3d pos_data = CalcBodyToBaseCoordinates (*model_emulated, data, q,
+      body_id, point);
+
+  CHECK_ARRAY_CLOSE (pos_model.data(), pos_data.data(), 3, TEST_PREC);
+}
+
+TEST_FIXTURE (Human36, ModelDataIndependentStates) {
+  randomizeStates();
+
+  ModelData data_a (*model_emulated);
+  ModelData data_b (*model_emulated);
+
+  VectorNd q_b = q * 0.5;
+
+  UpdateKinematicsCustom (*model_emulated, &q, NULL, NULL);
+  UpdateKinematicsCustom (*model_emulated, data_a, &q, NULL, NULL);
+  UpdateKinematicsCustom (*model_emulated, data_b, &q_b, NULL, NULL);
+
+  unsigned int body_id = body_id_emulated[BodyHandLeft];
+
+  // evaluating data_b must neither affect data_a nor the model
+  CHECK_ARRAY_CLOSE (model_emulated->X_base[body_id].E.data(),
+      data_a.X_base[body_id].E.data(), 9, TEST_PREC);
+  CHECK_ARRAY_CLOSE (model_emulated->X_base[body_id].r.data(),
+      data_a.X_base[body_id].r.data(), 3, TEST_PREC);
+  CHECK ((data_a.X_base[body_id].r - data_b.X_base[body_id].r).norm()
+      > TEST_PREC);
+}
@@ -602,3 +602,107 @@ TEST (CalcBodyWorldOrientationFixedJoint) {
   CHECK_ARRAY_CLOSE (E_movable.data(), E_fixed.data(), 9, TEST_PREC);
 }
 
+
+TEST_FIXTURE (ModelFixture, JointCalcDispatchPerBody) {
+  Body body (1., Vector3d (1., 1., 1.), Vector3d (1., 1., 1.));
+
+  JointType joint_types[7] = {
+    JointTypeRevoluteX,
+    JointTypeRevoluteY,
+    JointTypeRevoluteZ,
+    JointTypeSpherical,
+    JointTypeEulerZYX,
+    JointTypeEulerXYZ,
+    JointTypeTranslationXYZ
+  };
+
+  for (unsigned int i = 0; i < 7; i++) {
+    model->AppendBody (Xtrans (Vector3d (0., 1., 0.)), Joint (joint_types[i]),
+        body);
+  }
+  model->AppendBody (Xtrans (Vector3d (0., 1., 0.)),
+      Joint (SpatialVector (0., 0., 1., 0., 0., 0.)), body);
+  model->AppendBody (Xtrans (Vector3d (0., 1., 0.)),
+      Joint (SpatialVector (0., 0., 0., 1., 0., 0.)), body);
+  model->AppendBody (Xtrans (Vector3d (0., 1., 0.)),
+      Joint (SpatialVector (0., 0., 1., 0., 0., 0.)), body);
+
+  CHECK_EQUAL (model->mJoints.size(), model->mJointCalcDispatch.size());
+
+  for (unsigned int i = 1; i < model->mJoints.size(); i++) {
+    JointCalcDispatch dispatch = jcalc_dispatch (model->mJoints[i]);
+    CHECK (dispatch.jcalc == model->mJointCalcDispatch[i].jcalc);
+    CHECK (dispatch.jcalc_X_lambda_S
+        == model->mJointCalcDispatch[i].jcalc_X_lambda_S);
+  }
+
+  // joints of the same kind share the implementation, different kinds
+  // do not
+  CHECK (model->mJointCalcDispatch[8].jcalc
+      == model->mJointCalcDispatch[10].jcalc);
+  CHECK (model->mJointCalcDispatch[1].jcalc
+      != model->mJointCalcDispatch[2].jcalc);
+  CHECK (model->mJointCalcDispatch[5].jcalc
+      != model->mJointCalcDispatch[6].jcalc);
+
+  VectorNd q (VectorNd::Constant (model->q_size, 0.3));
+  VectorNd qdot (VectorNd::Constant (model->qdot_size, -0.2));
+  CHECK_THROW (model->mJointCalcDispatch[0].jcalc (*model, *model, 0, q,
+        qdot), Errors::RBDLError);
+}
+
+TEST_FIXTURE (ModelFixture, ModelFinalize) {
+  Body body (1., Vector3d (0.1, 0.2, 0.3), Vector3d (1., 2., 3.));
+
+  unsigned int base_id = model->AddBody (0, SpatialTransform(),
+      Joint (JointTypeFloatingBase), body, "base");
+  unsigned int arm_id = model->AddBody (base_id,
+      Xtrans (Vector3d (0., 1., 0.)), Joint (JointTypeRevoluteZ), body, "arm");
+  model->AddBody (arm_id, Xtrans (Vector3d (1., 0., 0.)),
+      Joint (JointTypeFixed), body, "hand");
+  model->AddBody (base_id, Xtrans (Vector3d (0., -1., 0.)),
+      Joint (JointTypeEulerZYX), body, "leg");
+
+  VectorNd q (VectorNd::Zero (model->q_size));
+  VectorNd qdot (VectorNd::Zero (model->qdot_size));
+  VectorNd tau (VectorNd::Zero (model->qdot_size));
+  for (unsigned int i = 0; i < model->qdot_size; i++) {
+    q[i] = 0.1 * i - 0.3;
+    qdot[i] = -0.2 * i + 0.5;
+    tau[i] = 0.7 * i - 1.;
+  }
+  Quaternion quat = Quaternion::fromAxisAngle (
+      Vector3d (1., 2., 3.).normalized(), 0.4);
+  model->SetQuaternion (base_id, quat, q);
+
+  VectorNd qddot (VectorNd::Zero (model->qdot_size));
+  ForwardDynamics (*model, q, qdot, tau, qddot);
+
+  CHECK (model->finalized == false);
+  model->Finalize();
+  CHECK (model->finalized == true);
+
+  CHECK_EQUAL (model->mBodies.size(), model->mBodies.capacity());
+  CHECK_EQUAL (model->mBodies.size(), model->v.capacity());
+  CHECK_EQUAL (model->mBodies.size(), model->IA_packed.capacity());
+  CHECK_EQUAL (model->mBodies.size(), model->X_T.capacity());
+
+  CHECK_THROW (model->AppendBody (Xtrans (Vector3d (0., 1., 0.)),
+        Joint (JointTypeRevoluteX), body), Errors::RBDLError);
+  CHECK_THROW (model->AddBody (0, SpatialTransform(),
+        Joint (JointTypeFixed), body), Errors::RBDLError);
+  CHECK_EQUAL (5u, model->mBodies.size());
+  CHECK_EQUAL (1u, model->mFixedBodies.size());
+
+  // finalizing twice has no effect
+  model->Finalize();
+
+  VectorNd qddot_finalized (VectorNd::Zero (model->qdot_size));
+  ForwardDynamics (*model, q, qdot, tau, qddot_finalized);
+  CHECK_ARRAY_EQUAL (qddot.data(), qddot_finalized.data(), model->qdot_size);
+
+  ModelData data (*model);
+  qddot_finalized.setZero();
+  ForwardDynamics (*model, data, q, qdot, tau, qddot_finalized);
+  CHECK_ARRAY_EQUAL (qddot.data(), qddot_finalized.data(), model->qdot_size);
+}
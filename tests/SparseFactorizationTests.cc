@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "Fixtures.h"
+#include "Human36Fixture.h"
 #include "rbdl/rbdl_mathutils.h"
 #include "rbdl/rbdl_utils.h"
 #include "rbdl/Logging.h"
@@ -266,3 +267,133 @@ TEST ( TestSparseFactorizationMultiDofAndFixed) {
 
   CHECK_ARRAY_CLOSE (x_emulated.data(), x_3dof.data(), x_emulated.size(), 1.0e-9);
 }
+
+TEST_FIXTURE (Human36, TestSparseLambdaQBranches) {
+  Model &model = *model_3dof;
+
+  unsigned int arm_left = model.mJoints[body_id_3dof[BodyUpperArmLeft]].q_index;
+  unsigned int arm_right = model.mJoints[body_id_3dof[BodyUpperArmRight]].q_index;
+
+  // both arms depend on the same degree of freedom of the trunk but not
+  // on each other
+  CHECK_EQUAL (model.lambda_q[arm_left + 1], model.lambda_q[arm_right + 1]);
+  CHECK (model.lambda_q[arm_left + 1] < arm_left);
+  CHECK_EQUAL (arm_left + 1, model.lambda_q[arm_left + 2]);
+  CHECK_EQUAL (arm_left + 2, model.lambda_q[arm_left + 3]);
+
+  SparseJointSpaceMatrix H (model);
+  unsigned int dense_lower_size = model.qdot_size * (model.qdot_size + 1) / 2;
+  CHECK (H.values.size() < dense_lower_size);
+
+  // no entry of the right arm refers to the left arm
+  for (unsigned int i = arm_right; i < arm_right + 3; i++) {
+    for (unsigned int k = H.row_start[i]; k < H.row_start[i + 1]; k++) {
+      CHECK (H.col_index[k] < arm_left || H.col_index[k] >= arm_left + 3);
+    }
+  }
+}
+
+TEST_FIXTURE (Human36, TestSparseCompositeRigidBodyAlgorithm) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    Model &model = *models[m];
+
+    MatrixNd H (MatrixNd::Zero (model.qdot_size, model.qdot_size));
+    CompositeRigidBodyAlgorithm (model, q, H);
+
+    SparseJointSpaceMatrix H_sparse;
+    CompositeRigidBodyAlgorithmSparse (model, q, H_sparse);
+    MatrixNd H_sparse_dense = H_sparse.toMatrix();
+
+    CHECK_ARRAY_CLOSE (H.data(), H_sparse_dense.data(), H.size(), TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36, TestSparseFactorizationLTLCompact) {
+  randomizeStates();
+
+  Model *models[2] = { model_emulated, model_3dof };
+
+  for (unsigned int m = 0; m < 2; m++) {
+    Model &model = *models[m];
+
+    MatrixNd H (MatrixNd::Zero (model.qdot_size, model.qdot_size));
+    CompositeRigidBodyAlgorithm (model, q, H);
+
+    MatrixNd L_dense (H);
+    SparseFactorizeLTL (model, L_dense);
+    MatrixNd LTL = L_dense.transpose() * L_dense;
+    CHECK_ARRAY_CLOSE (H.data(), LTL.data(), H.size(), 1.0e-10);
+
+    SparseJointSpaceMatrix L (model);
+    CompositeRigidBodyAlgorithmSparse (model, q, L);
+    SparseFactorizeLTL (L);
+    MatrixNd L_sparse_dense = L.toLowerTriangularMatrix();
+
+    CHECK_ARRAY_CLOSE (L_dense.data(), L_sparse_dense.data(), H.size(),
+        TEST_PREC);
+  }
+}
+
+TEST_FIXTURE (Human36, TestSparseSolveCompact) {
+  randomizeStates();
+
+  Model &model = *model_3dof;
+
+  SparseJointSpaceMatrix L (model);
+  CompositeRigidBodyAlgorithmSparse (model, q, L);
+  MatrixNd H = L.toMatrix();
+  SparseFactorizeLTL (L);
+
+  // H x = b  <=>  L^T (L x) = b
+  VectorNd x = H * qdot;
+  SparseSolveLTx (L, x);
+  SparseSolveLx (L, x);
+
+  CHECK_ARRAY_CLOSE (qdot.data(), x.data(), qdot.size(), 1.0e-9);
+}
+
+TEST_FIXTURE (Human36, TestSparseMultiply) {
+  randomizeStates();
+
+  Model &model = *model_emulated;
+
+  SparseJointSpaceMatrix H_sparse (model);
+  CompositeRigidBodyAlgorithmSparse (model, q, H_sparse);
+  MatrixNd H = H_sparse.toMatrix();
+
+  SparseJointSpaceMatrix L_sparse (H_sparse);
+  SparseFactorizeLTL (L_sparse);
+  MatrixNd L = L_sparse.toLowerTriangularMatrix();
+
+  VectorNd result (VectorNd::Zero (model.qdot_size));
+  VectorNd result_dense (VectorNd::Zero (model.qdot_size));
+  VectorNd reference (VectorNd::Zero (model.qdot_size));
+
+  reference = H * qdot;
+  SparseMultiplyHx (H_sparse, qdot, result);
+  SparseMultiplyHx (model, H, qdot, result_dense);
+  CHECK_ARRAY_CLOSE (reference.data(), result.data(), reference.size(),
+      TEST_PREC);
+  CHECK_ARRAY_CLOSE (reference.data(), result_dense.data(), reference.size(),
+      TEST_PREC);
+
+  reference = L * qdot;
+  SparseMultiplyLx (L_sparse, qdot, result);
+  SparseMultiplyLx (model, L, qdot, result_dense);
+  CHECK_ARRAY_CLOSE (reference.data(), result.data(), reference.size(),
+      TEST_PREC);
+  CHECK_ARRAY_CLOSE (reference.data(), result_dense.data(), reference.size(),
+      TEST_PREC);
+
+  reference = L.transpose() * qdot;
+  SparseMultiplyLTx (L_sparse, qdot, result);
+  SparseMultiplyLTx (model, L, qdot, result_dense);
+  CHECK_ARRAY_CLOSE (reference.data(), result.data(), reference.size(),
+      TEST_PREC);
+  CHECK_ARRAY_CLOSE (reference.data(), result_dense.data(), reference.size(),
+      TEST_PREC);
+}
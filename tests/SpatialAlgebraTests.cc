@@ -566,6 +566,100 @@ TEST(TestSpatialRigidBodyInertiaCreateFromMatrix) {
   CHECK_ARRAY_EQUAL (inertia.data(), rbi_I_matrix.data(), 9);
 }
 
+SpatialArticulatedInertia CreateTestArticulatedInertia() {
+  SpatialRigidBodyInertia rbi (
+      1.1,
+      Vector3d (1.2, 1.3, 1.4),
+      Matrix3d (
+        1.1, 0.5, 0.3,
+        0.5, 1.2, 0.4,
+        0.3, 0.4, 1.3
+        ));
+  SpatialVector U (0.1, -0.2, 0.3, 0.4, 0.5, -0.6);
+
+  SpatialMatrix IA = rbi.toMatrix() - U * U.transpose() / 2.3;
+  SpatialArticulatedInertia result;
+  result.createFromMatrix (IA);
+  return result;
+}
+
+TEST(TestSpatialArticulatedInertiaFromRigidBodyInertia) {
+  SpatialRigidBodyInertia rbi (
+      1.1,
+      Vector3d (1.2, 1.3, 1.4),
+      Matrix3d (
+        1.1, 0.5, 0.3,
+        0.5, 1.2, 0.4,
+        0.3, 0.4, 1.3
+        ));
+
+  SpatialArticulatedInertia IA (rbi);
+
+  CHECK_ARRAY_EQUAL (rbi.toMatrix().data(), IA.toMatrix().data(), 36);
+}
+
+TEST(TestSpatialArticulatedInertiaMultiply) {
+  SpatialArticulatedInertia IA = CreateTestArticulatedInertia();
+  SpatialMatrix IA_matrix = IA.toMatrix();
+
+  CHECK_ARRAY_EQUAL (IA_matrix.data(),
+      SpatialMatrix (IA_matrix.transpose()).data(), 36);
+
+  SpatialVector v (1.1, 2.2, 3.3, -4.4, 5.5, -6.6);
+  SpatialVector v_expected = IA_matrix * v;
+  SpatialVector v_result = IA * v;
+  CHECK_ARRAY_CLOSE (v_expected.data(), v_result.data(), 6, TEST_PREC);
+
+  Matrix63 S;
+  S.col(0) = v;
+  S.col(1) = SpatialVector (0., 0., 1., 0., 0., 0.);
+  S.col(2) = SpatialVector (-0.3, 0.2, 0.1, 0.7, -0.8, 0.9);
+  Matrix63 S_expected = IA_matrix * S;
+  Matrix63 S_result = IA * S;
+  CHECK_ARRAY_CLOSE (S_expected.data(), S_result.data(), 18, TEST_PREC);
+}
+
+TEST(TestSpatialArticulatedInertiaSubtractSymmetricProduct) {
+  SpatialArticulatedInertia IA = CreateTestArticulatedInertia();
+  SpatialMatrix IA_matrix = IA.toMatrix();
+
+  Matrix63 U;
+  U.col(0) = SpatialVector (1.1, 2.2, 3.3, -4.4, 5.5, -6.6);
+  U.col(1) = SpatialVector (0., 0., 1., 0., 0., 0.);
+  U.col(2) = SpatialVector (-0.3, 0.2, 0.1, 0.7, -0.8, 0.9);
+  Matrix3d Dinv (
+      2.0, 0.1, 0.2,
+      0.1, 3.0, 0.3,
+      0.2, 0.3, 4.0);
+
+  SpatialMatrix expected = IA_matrix - U * Dinv * U.transpose();
+  IA.subtractSymmetricProduct (Matrix63 (U * Dinv), U);
+
+  CHECK_ARRAY_CLOSE (expected.data(), IA.toMatrix().data(), 36, 1.0e-13);
+}
+
+TEST(TestSpatialTransformApplyTransposeSpatialArticulatedInertia) {
+  SpatialArticulatedInertia IA = CreateTestArticulatedInertia();
+
+  SpatialTransform X (
+      Xrotz (0.5) *
+      Xroty (0.9) *
+      Xrotx (0.2) *
+      Xtrans (Vector3d (1.1, 1.2, 1.3))
+      );
+
+  SpatialArticulatedInertia IA_transformed = X.applyTranspose (IA);
+  SpatialMatrix IA_matrix_transformed = X.toMatrixTranspose()
+    * IA.toMatrix() * X.toMatrix();
+
+  CHECK_ARRAY_CLOSE (
+      IA_matrix_transformed.data(),
+      IA_transformed.toMatrix().data(),
+      36,
+      1.0e-13
+      );
+}
+
 #ifdef USE_SLOW_SPATIAL_ALGEBRA
 TEST(TestSpatialLinSolve) {
   SpatialVector b (1, 2, 0, 1, 1, 1);